@@ -10,6 +10,8 @@ featk3DGridSource::featk3DGridSource() {
     this->elementType = FEATK_HEX8;
     this->origin = {0.0, 0.0, 0.0};
     this->spacing = {1.0, 1.0, 1.0};
+    this->outputStructuredGrid = nullptr;
+    this->useImplicitGrid = false;
 }
 
 featk3DGridSource::~featk3DGridSource() {
@@ -18,6 +20,17 @@ featk3DGridSource::~featk3DGridSource() {
 
 void featk3DGridSource::execute() {
 
+    if (this->useImplicitGrid) {
+
+        this->outputMeshes[0] = nullptr;
+        this->outputStructuredGrid = new featkStructuredGrid<3>(this->dimensions, this->spacing, this->origin, this->elementType);
+
+        return;
+    }
+
+    this->outputStructuredGrid = nullptr;
+
+
     // Nodes
 
     AttributeValueType<3, 1> origin = (AttributeValueType<3, 1>() << this->origin[0], this->origin[1], this->origin[2]).finished();
@@ -105,6 +118,11 @@ void featk3DGridSource::execute() {
     this->outputMeshes[0] = mesh;
 }
 
+featkStructuredGrid<3>* featk3DGridSource::getOutputStructuredGrid() const {
+
+    return this->outputStructuredGrid;
+}
+
 void featk3DGridSource::setDimensions(std::array<unsigned int, 3> dimensions) {
 
     this->dimensions = dimensions;
@@ -134,3 +152,8 @@ void featk3DGridSource::setSpacing(std::array<double, 3> spacing) {
 
     this->spacing = spacing;
 }
+
+void featk3DGridSource::setUseImplicitGrid(bool use) {
+
+    this->useImplicitGrid = use;
+}
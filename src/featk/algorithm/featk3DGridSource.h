@@ -23,6 +23,11 @@
  *
  * @brief 3D grid mesh source.
  *
+ * With setUseImplicitGrid(true), execute() produces a featkStructuredGrid
+ * with the same node and element numbering, available through
+ * getOutputStructuredGrid(), instead of a featkMesh, so that no node nor
+ * element object is created.
+ *
  */
 
 #ifndef FEATK3DGRIDSOURCE_H
@@ -31,6 +36,7 @@
 #include <featk/algorithm/featkMeshProducerBase.h>
 #include <featk/core/featkGlobal.h>
 #include <featk/geometry/featkMesh.h>
+#include <featk/geometry/featkStructuredGrid.h>
 
 #include <array>
 
@@ -43,12 +49,14 @@ class FEATK_EXPORT featk3DGridSource : public featkMeshProducerBase<3> {
 
         void execute();
 
+        featkStructuredGrid<3>* getOutputStructuredGrid() const;  // nullptr unless implicit grid is used
         void setDimensions(std::array<unsigned int, 3> dimensions);
         void setElementType(featkElementType type);
         void setElementTypeToFEATKHex8();
         void setElementTypeToFEATKTet4();
         void setOrigin(std::array<double, 3> origin);
         void setSpacing(std::array<double, 3> spacing);
+        void setUseImplicitGrid(bool use);
 
     private:
 
@@ -56,6 +64,8 @@ class FEATK_EXPORT featk3DGridSource : public featkMeshProducerBase<3> {
         featkElementType elementType;
         std::array<double, 3> origin;
         std::array<double, 3> spacing;
+        featkStructuredGrid<3>* outputStructuredGrid;
+        bool useImplicitGrid;
 };
 
 #endif // FEATK3DGRIDSOURCE_H
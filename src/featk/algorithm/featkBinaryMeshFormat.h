@@ -0,0 +1,83 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkBinaryMeshFormat.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @brief Layout of the featk native binary mesh format.
+ *
+ * A featk binary mesh file, written by featkBinaryMeshWriter and read by
+ * featkBinaryMeshReader, starts with a featkBinaryMeshHeader immediately
+ * followed by numberOfSections featkBinaryMeshSection descriptors. Each
+ * descriptor locates a data section of numberOfItems x numberOfComponents
+ * scalars stored item-major, i.e. row major, at an absolute offset aligned
+ * on FEATK_BINARY_MESH_ALIGNMENT bytes, so that a page aligned mapping of
+ * the file can be viewed in place as Eigen matrices:
+ *
+ * - FEATK_COORDINATES_SECTION: the (nodes x Dimension) double node
+ *   coordinates;
+ * - FEATK_CONNECTIVITY_SECTION: the (elements x nodes per element) uint32
+ *   node indices of all the elements of elementType, elements being
+ *   numbered section after section;
+ * - FEATK_NODE_ATTRIBUTE_SECTION and FEATK_ELEMENT_ATTRIBUTE_SECTION: the
+ *   (items x Dimension^order) double values of a named attribute, each
+ *   item value being flattened row major as in
+ *   featkMesh::setNodeAttributeFromValues.
+ *
+ * All the values are stored in native endianness.
+ *
+ */
+
+#ifndef FEATKBINARYMESHFORMAT_H
+#define FEATKBINARYMESHFORMAT_H
+
+#include <cstdint>
+
+const char FEATK_BINARY_MESH_MAGIC[8] = {'F', 'E', 'A', 'T', 'K', 'M', 'S', 'H'};
+const uint32_t FEATK_BINARY_MESH_VERSION = 1;
+const uint64_t FEATK_BINARY_MESH_ALIGNMENT = 64;
+const unsigned int FEATK_BINARY_MESH_NAME_SIZE = 88;
+
+enum featkBinaryMeshSectionKind : uint32_t {FEATK_COORDINATES_SECTION, FEATK_CONNECTIVITY_SECTION, FEATK_NODE_ATTRIBUTE_SECTION, FEATK_ELEMENT_ATTRIBUTE_SECTION};
+
+struct featkBinaryMeshHeader {
+
+    char magic[8];
+    uint32_t version;
+    uint32_t dimension;
+    uint64_t numberOfNodes;
+    uint64_t numberOfElements;
+    uint64_t numberOfSections;
+};
+
+struct featkBinaryMeshSection {
+
+    char name[FEATK_BINARY_MESH_NAME_SIZE];  // Null terminated, attribute sections only
+    uint32_t kind;
+    uint32_t elementType;  // Connectivity sections only
+    uint32_t order;        // Attribute sections only
+    uint32_t scalarSize;
+    uint64_t numberOfItems;
+    uint64_t numberOfComponents;
+    uint64_t offset;
+};
+
+static_assert(sizeof(featkBinaryMeshHeader) == 40, "featkBinaryMeshHeader must not be padded.");
+static_assert(sizeof(featkBinaryMeshSection) == 128, "featkBinaryMeshSection must not be padded.");
+
+#endif // FEATKBINARYMESHFORMAT_H
@@ -0,0 +1,320 @@
+#include <featk/algorithm/featkBinaryMeshReader.h>
+#include <featk/core/featkDefines.h>
+#include <featk/geometry/featkHex8Element.h>
+#include <featk/geometry/featkNode.h>
+#include <featk/geometry/featkTet4Element.h>
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+featkBinaryMeshReader::featkBinaryMeshReader() {
+
+    this->passAllAttributes = true;
+    this->header = nullptr;
+    this->sections = nullptr;
+}
+
+featkBinaryMeshReader::~featkBinaryMeshReader() {
+
+}
+
+bool featkBinaryMeshReader::checkFile() {
+
+    /* Every section is bounds checked here so that the mapped arrays can then be accessed without any further test. */
+
+    size_t size = this->file.getSize();
+    const unsigned char* data = this->file.getData();
+
+    if (size < sizeof(featkBinaryMeshHeader) || std::memcmp(data, FEATK_BINARY_MESH_MAGIC, sizeof(FEATK_BINARY_MESH_MAGIC)) != 0) {
+
+        std::cout << "featkBinaryMeshReader: Error: " << this->fileName << " is not a featk binary mesh file." << std::endl;
+        return false;
+    }
+
+    this->header = reinterpret_cast<const featkBinaryMeshHeader*>(data);
+    this->sections = reinterpret_cast<const featkBinaryMeshSection*>(data+sizeof(featkBinaryMeshHeader));
+
+    if (this->header->version != FEATK_BINARY_MESH_VERSION || this->header->dimension != 3) {
+
+        std::cout << "featkBinaryMeshReader: Error: Unsupported version " << this->header->version << " or dimension " << this->header->dimension << "." << std::endl;
+        return false;
+    }
+
+    if (this->header->numberOfSections > (size-sizeof(featkBinaryMeshHeader))/sizeof(featkBinaryMeshSection)) {
+
+        std::cout << "featkBinaryMeshReader: Error: Truncated section descriptors." << std::endl;
+        return false;
+    }
+
+    uint64_t numberOfCoordinatesSections = 0;
+    uint64_t numberOfElements = 0;
+
+    for (uint64_t s=0; s!=this->header->numberOfSections; s++) {
+
+        const featkBinaryMeshSection& section = this->sections[s];
+
+        uint64_t expectedItems = 0;
+        uint64_t expectedComponents = 0;
+        uint32_t expectedScalarSize = sizeof(double);
+
+        switch (section.kind) {
+
+            case FEATK_COORDINATES_SECTION:
+
+                expectedItems = this->header->numberOfNodes;
+                expectedComponents = 3;
+                numberOfCoordinatesSections++;
+                break;
+
+            case FEATK_CONNECTIVITY_SECTION:
+
+                expectedItems = section.numberOfItems;
+                expectedComponents = section.elementType == FEATK_TET4 ? 4 : section.elementType == FEATK_HEX8 ? 8 : 0;
+                expectedScalarSize = sizeof(uint32_t);
+                numberOfElements += section.numberOfItems;
+                break;
+
+            case FEATK_NODE_ATTRIBUTE_SECTION:
+            case FEATK_ELEMENT_ATTRIBUTE_SECTION:
+
+                expectedItems = section.kind == FEATK_NODE_ATTRIBUTE_SECTION ? this->header->numberOfNodes : this->header->numberOfElements;
+                expectedComponents = section.order <= 4 ? POWER(3, section.order) : 0;
+                break;
+        }
+
+        bool valid = expectedComponents != 0 && section.numberOfItems == expectedItems && section.numberOfComponents == expectedComponents && section.scalarSize == expectedScalarSize;
+        valid = valid && std::memchr(section.name, '\0', FEATK_BINARY_MESH_NAME_SIZE) != nullptr;
+        valid = valid && section.offset%expectedScalarSize == 0 && section.offset <= size;
+        valid = valid && section.numberOfItems <= (size-section.offset)/(section.numberOfComponents*section.scalarSize);
+
+        if (!valid) {
+
+            std::cout << "featkBinaryMeshReader: Error: Invalid or truncated section " << s << "." << std::endl;
+            return false;
+        }
+
+        if (section.kind == FEATK_CONNECTIVITY_SECTION && section.numberOfItems != 0) {
+
+            ConnectivityType connectivity(reinterpret_cast<const uint32_t*>(data+section.offset), section.numberOfItems, section.numberOfComponents);
+
+            if (connectivity.maxCoeff() >= this->header->numberOfNodes) {
+
+                std::cout << "featkBinaryMeshReader: Error: Node index out of range in section " << s << "." << std::endl;
+                return false;
+            }
+        }
+    }
+
+    if (numberOfCoordinatesSections != 1 || numberOfElements != this->header->numberOfElements) {
+
+        std::cout << "featkBinaryMeshReader: Error: Inconsistent number of coordinates sections or elements." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void featkBinaryMeshReader::execute() {
+
+    this->header = nullptr;
+    this->sections = nullptr;
+
+    if (!this->file.open(this->fileName) || !this->checkFile()) {
+
+        this->header = nullptr;
+        this->sections = nullptr;
+        this->file.close();
+        return;
+    }
+
+
+    // Nodes
+
+    ValuesType coordinates = this->getCoordinates();
+    Index numberOfNodes = coordinates.rows();
+
+    std::vector<featkNode<3>*> nodes(numberOfNodes);
+
+    #pragma omp parallel for
+    for (Index n=0; n<numberOfNodes; n++) {
+
+        nodes[n] = new featkNode<3>(n, AttributeValueType<3, 1>(coordinates.row(n).transpose()));
+    }
+
+
+    // Elements, in section order
+
+    std::vector<featkElementInterface<3>*> elements;
+    elements.reserve(this->header->numberOfElements);
+
+    for (uint64_t s=0; s!=this->header->numberOfSections; s++) {
+
+        const featkBinaryMeshSection& section = this->sections[s];
+
+        if (section.kind == FEATK_CONNECTIVITY_SECTION) {
+
+            ConnectivityType connectivity(reinterpret_cast<const uint32_t*>(this->file.getData()+section.offset), section.numberOfItems, section.numberOfComponents);
+            std::vector<featkNode<3>*> elementNodes(connectivity.cols());
+
+            for (Index e=0; e!=connectivity.rows(); e++) {
+
+                for (Index j=0; j!=connectivity.cols(); j++) {
+
+                    elementNodes[j] = nodes[connectivity(e, j)];
+                }
+
+                switch (section.elementType) {
+
+                    case FEATK_TET4:
+
+                        elements.push_back(new featkTet4Element(elementNodes));
+                        break;
+
+                    case FEATK_HEX8:
+
+                        elements.push_back(new featkHex8Element(elementNodes));
+                        break;
+                }
+            }
+        }
+    }
+
+
+    // Mesh
+
+    featkMesh<3>* mesh = new featkMesh<3>(nodes, elements);
+
+
+    // Attributes, only the selected ones being accessed
+
+    for (uint64_t s=0; s!=this->header->numberOfSections; s++) {
+
+        const featkBinaryMeshSection& section = this->sections[s];
+
+        if (section.kind != FEATK_NODE_ATTRIBUTE_SECTION && section.kind != FEATK_ELEMENT_ATTRIBUTE_SECTION) {
+
+            continue;
+        }
+
+        std::string name = section.name;
+        const std::set<std::string>& attributesToPass = section.kind == FEATK_NODE_ATTRIBUTE_SECTION ? this->nodeAttributesToPass : this->elementAttributesToPass;
+
+        if (this->passAllAttributes || attributesToPass.count(name)) {
+
+            ValuesType values = this->getValues(&section);
+            Index numberOfItems = values.rows();
+            unsigned int rows = POWER(3, section.order/2+section.order%2);
+            unsigned int cols = POWER(3, section.order/2);
+
+            std::vector<std::shared_ptr<MatrixXd>> attributes(numberOfItems);
+
+            #pragma omp parallel for
+            for (Index i=0; i<numberOfItems; i++) {
+
+                attributes[i] = std::make_shared<MatrixXd>(ValuesType(values.row(i).data(), rows, cols));
+            }
+
+            if (section.kind == FEATK_NODE_ATTRIBUTE_SECTION) {
+
+                mesh->setNodeAttributes(name, section.order, attributes);
+            }
+
+            else {
+
+                mesh->setElementAttributes(name, section.order, attributes);
+            }
+        }
+    }
+
+
+    // Output
+
+    this->outputMeshes[0] = mesh;
+}
+
+featkBinaryMeshReader::ConnectivityType featkBinaryMeshReader::getConnectivity(featkElementType type) const {
+
+    const featkBinaryMeshSection* section = this->getSection(FEATK_CONNECTIVITY_SECTION, "", type);
+
+    if (section == nullptr) {
+
+        return ConnectivityType(nullptr, 0, 0);
+    }
+
+    return ConnectivityType(reinterpret_cast<const uint32_t*>(this->file.getData()+section->offset), section->numberOfItems, section->numberOfComponents);
+}
+
+featkBinaryMeshReader::ValuesType featkBinaryMeshReader::getCoordinates() const {
+
+    return this->getValues(this->getSection(FEATK_COORDINATES_SECTION, ""));
+}
+
+featkBinaryMeshReader::ValuesType featkBinaryMeshReader::getElementAttribute(std::string name) const {
+
+    return this->getValues(this->getSection(FEATK_ELEMENT_ATTRIBUTE_SECTION, name));
+}
+
+featkBinaryMeshReader::ValuesType featkBinaryMeshReader::getNodeAttribute(std::string name) const {
+
+    return this->getValues(this->getSection(FEATK_NODE_ATTRIBUTE_SECTION, name));
+}
+
+const featkBinaryMeshSection* featkBinaryMeshReader::getSection(featkBinaryMeshSectionKind kind, std::string name, uint32_t elementType) const {
+
+    if (this->header != nullptr) {
+
+        for (uint64_t s=0; s!=this->header->numberOfSections; s++) {
+
+            const featkBinaryMeshSection& section = this->sections[s];
+
+            if (section.kind == kind && name == section.name && (kind != FEATK_CONNECTIVITY_SECTION || section.elementType == elementType)) {
+
+                return &section;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+featkBinaryMeshReader::ValuesType featkBinaryMeshReader::getValues(const featkBinaryMeshSection* section) const {
+
+    if (section == nullptr) {
+
+        return ValuesType(nullptr, 0, 0);
+    }
+
+    return ValuesType(reinterpret_cast<const double*>(this->file.getData()+section->offset), section->numberOfItems, section->numberOfComponents);
+}
+
+void featkBinaryMeshReader::passAllAttributesOff() {
+
+    this->passAllAttributes = false;
+}
+
+void featkBinaryMeshReader::passAllAttributesOn() {
+
+    this->passAllAttributes = true;
+}
+
+void featkBinaryMeshReader::setElementAttributesToPass(std::set<std::string> attributes) {
+
+    this->elementAttributesToPass = attributes;
+}
+
+void featkBinaryMeshReader::setFileName(std::string fileName) {
+
+    this->fileName = fileName;
+}
+
+void featkBinaryMeshReader::setNodeAttributesToPass(std::set<std::string> attributes) {
+
+    this->nodeAttributesToPass = attributes;
+}
+
+void featkBinaryMeshReader::setPassAllAttributes(bool pass) {
+
+    this->passAllAttributes = pass;
+}
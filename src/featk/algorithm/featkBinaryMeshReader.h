@@ -0,0 +1,96 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkBinaryMeshReader.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkBinaryMeshReader
+ *
+ * @brief Reader of featkMesh in the featk native binary mesh format.
+ *
+ * featkBinaryMeshReader memory maps a file written by
+ * featkBinaryMeshWriter (see featkBinaryMeshFormat.h) and builds the
+ * featkMesh directly from the mapped arrays, without any parsing or
+ * intermediate buffer. As for featkVTKUnstructuredGridToMeshFilter, only
+ * the attributes selected with setNodeAttributesToPass() and
+ * setElementAttributesToPass() are loaded unless passAllAttributesOn() is
+ * set, the pages of the other attributes never being read from disk.
+ *
+ * The mapping is kept open until the next execute() or the destruction of
+ * the reader, so that getCoordinates(), getConnectivity(),
+ * getNodeAttribute() and getElementAttribute() give zero-copy, row major
+ * (items x components) Eigen::Map views of the file content, e.g. for
+ * assembling without going through featkNode and featkElementInterface.
+ *
+ * @warning For now, only 3D meshes with featkTet4Element and/or
+ * featkHex8Element are supported.
+ *
+ */
+
+#ifndef FEATKBINARYMESHREADER_H
+#define FEATKBINARYMESHREADER_H
+
+#include <featk/algorithm/featkBinaryMeshFormat.h>
+#include <featk/algorithm/featkMeshProducerBase.h>
+#include <featk/core/featkGlobal.h>
+#include <featk/core/featkMemoryMappedFile.h>
+#include <featk/geometry/featkMesh.h>
+
+#include <set>
+#include <string>
+
+class FEATK_EXPORT featkBinaryMeshReader : public featkMeshProducerBase<3> {
+
+    public:
+
+        using ConnectivityType = Map<const Matrix<uint32_t, Dynamic, Dynamic, RowMajor>>;
+        using ValuesType = Map<const Matrix<double, Dynamic, Dynamic, RowMajor>>;
+
+        featkBinaryMeshReader();
+        ~featkBinaryMeshReader();
+
+        void execute();
+
+        ConnectivityType getConnectivity(featkElementType type) const;
+        ValuesType getCoordinates() const;
+        ValuesType getElementAttribute(std::string name) const;
+        ValuesType getNodeAttribute(std::string name) const;
+        void passAllAttributesOff();
+        void passAllAttributesOn();
+        void setElementAttributesToPass(std::set<std::string> attributes);
+        void setFileName(std::string fileName);
+        void setNodeAttributesToPass(std::set<std::string> attributes);
+        void setPassAllAttributes(bool pass);
+
+    private:
+
+        bool checkFile();  // Bounds checks the mapped file, hence called by execute() once it is mapped
+        const featkBinaryMeshSection* getSection(featkBinaryMeshSectionKind kind, std::string name, uint32_t elementType=0) const;
+        ValuesType getValues(const featkBinaryMeshSection* section) const;
+
+        std::set<std::string> elementAttributesToPass;
+        std::string fileName;
+        std::set<std::string> nodeAttributesToPass;
+        bool passAllAttributes;
+
+        featkMemoryMappedFile file;
+        const featkBinaryMeshHeader* header;
+        const featkBinaryMeshSection* sections;
+};
+
+#endif // FEATKBINARYMESHREADER_H
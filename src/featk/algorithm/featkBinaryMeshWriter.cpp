@@ -0,0 +1,201 @@
+#include <featk/algorithm/featkBinaryMeshWriter.h>
+#include <featk/core/featkDefines.h>
+#include <featk/geometry/featkNode.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+featkBinaryMeshWriter::featkBinaryMeshWriter() {
+
+}
+
+featkBinaryMeshWriter::~featkBinaryMeshWriter() {
+
+}
+
+void featkBinaryMeshWriter::execute() {
+
+    featkMesh<3>* inputMesh = this->inputMeshes[0];
+
+    if (inputMesh == nullptr || this->fileName.empty()) {
+
+        std::cout << "featkBinaryMeshWriter: Error: No input mesh or file name." << std::endl;
+        return;
+    }
+
+
+    // Nodes
+
+    const std::vector<featkNode<3>*>& nodes = inputMesh->getNodes();
+    std::map<size_t, uint32_t> map;  // featkNode<Dimension>::id is supposed to match node index in featkMesh<Dimension>::nodes but keep a map in case
+
+    for (size_t n=0; n!=nodes.size(); n++) {
+
+        map[nodes[n]->getID()] = uint32_t(n);
+    }
+
+
+    // Elements grouped by type
+
+    std::map<featkElementType, std::vector<featkElementInterface<3>*>> typeElements;
+
+    for (featkElementInterface<3>* element : inputMesh->getElements()) {
+
+        typeElements[element->getElementType()].push_back(element);
+    }
+
+    std::vector<featkElementInterface<3>*> elements;  // In file order
+
+    for (const auto& pair : typeElements) {
+
+        elements.insert(elements.end(), pair.second.begin(), pair.second.end());
+    }
+
+
+    // Sections
+
+    std::vector<featkBinaryMeshSection> sections;
+    std::vector<size_t> attributeIDs;
+
+    sections.push_back(this->getSection(FEATK_COORDINATES_SECTION, "", 0, 1, sizeof(double), nodes.size(), 3));
+    attributeIDs.push_back(1);
+
+    for (const auto& pair : typeElements) {
+
+        sections.push_back(this->getSection(FEATK_CONNECTIVITY_SECTION, "", pair.first, 0, sizeof(uint32_t), pair.second.size(), pair.second[0]->getNodes().size()));
+        attributeIDs.push_back(0);
+    }
+
+    for (featkBinaryMeshSectionKind kind : {FEATK_NODE_ATTRIBUTE_SECTION, FEATK_ELEMENT_ATTRIBUTE_SECTION}) {
+
+        for (const auto& pair : kind == FEATK_NODE_ATTRIBUTE_SECTION ? inputMesh->getNodeAttributeTable() : inputMesh->getElementAttributeTable()) {
+
+            std::string name = pair.first;
+            size_t id = pair.second.first;
+            unsigned int order = pair.second.second;
+
+            if (kind == FEATK_NODE_ATTRIBUTE_SECTION && id == 1) {
+
+                continue;  // Cartesian coordinates, written in the coordinates section
+            }
+
+            if (name.size() >= FEATK_BINARY_MESH_NAME_SIZE) {
+
+                std::cout << "featkBinaryMeshWriter: Warning: Attribute name " << name << " is too long, attribute not written." << std::endl;
+                continue;
+            }
+
+            sections.push_back(this->getSection(kind, name, 0, order, sizeof(double), kind == FEATK_NODE_ATTRIBUTE_SECTION ? nodes.size() : elements.size(), POWER(3, order)));
+            attributeIDs.push_back(id);
+        }
+    }
+
+    uint64_t offset = sizeof(featkBinaryMeshHeader) + sections.size()*sizeof(featkBinaryMeshSection);
+
+    for (featkBinaryMeshSection& section : sections) {
+
+        offset = (offset+FEATK_BINARY_MESH_ALIGNMENT-1)/FEATK_BINARY_MESH_ALIGNMENT*FEATK_BINARY_MESH_ALIGNMENT;
+        section.offset = offset;
+        offset += section.numberOfItems*section.numberOfComponents*section.scalarSize;
+    }
+
+
+    // Header and section descriptors
+
+    std::ofstream stream(this->fileName, std::ios::binary | std::ios::trunc);
+
+    if (!stream) {
+
+        std::cout << "featkBinaryMeshWriter: Error: " << this->fileName << " could not be opened." << std::endl;
+        return;
+    }
+
+    featkBinaryMeshHeader header;
+    std::memcpy(header.magic, FEATK_BINARY_MESH_MAGIC, sizeof(header.magic));
+    header.version = FEATK_BINARY_MESH_VERSION;
+    header.dimension = 3;
+    header.numberOfNodes = nodes.size();
+    header.numberOfElements = elements.size();
+    header.numberOfSections = sections.size();
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(sections.data()), sections.size()*sizeof(featkBinaryMeshSection));
+
+    uint64_t position = sizeof(featkBinaryMeshHeader) + sections.size()*sizeof(featkBinaryMeshSection);
+
+
+    // Data sections
+
+    for (size_t s=0; s!=sections.size(); s++) {
+
+        const featkBinaryMeshSection& section = sections[s];
+
+        std::vector<char> padding(section.offset-position, 0);
+        stream.write(padding.data(), padding.size());
+
+        if (section.kind == FEATK_CONNECTIVITY_SECTION) {
+
+            const std::vector<featkElementInterface<3>*>& sectionElements = typeElements[featkElementType(section.elementType)];
+            Matrix<uint32_t, Dynamic, Dynamic, RowMajor> connectivity(sectionElements.size(), section.numberOfComponents);
+
+            for (size_t e=0; e!=sectionElements.size(); e++) {
+
+                for (Index j=0; j!=connectivity.cols(); j++) {
+
+                    connectivity(e, j) = map[sectionElements[e]->getNode(j)->getID()];
+                }
+            }
+
+            stream.write(reinterpret_cast<const char*>(connectivity.data()), connectivity.size()*sizeof(uint32_t));
+        }
+
+        else {
+
+            /* Coordinates are node attribute 1 of order 1. */
+
+            unsigned int rows = POWER(3, section.order/2+section.order%2);
+            unsigned int cols = POWER(3, section.order/2);
+
+            Matrix<double, Dynamic, Dynamic, RowMajor> values(section.numberOfItems, section.numberOfComponents);
+
+            for (size_t i=0; i!=section.numberOfItems; i++) {
+
+                featkAttributable<3>* item = section.kind == FEATK_ELEMENT_ATTRIBUTE_SECTION ? static_cast<featkAttributable<3>*>(elements[i]) : static_cast<featkAttributable<3>*>(nodes[i]);
+                Map<Matrix<double, Dynamic, Dynamic, RowMajor>>(values.row(i).data(), rows, cols) = item->getAttributeValue(attributeIDs[s]);
+            }
+
+            stream.write(reinterpret_cast<const char*>(values.data()), values.size()*sizeof(double));
+        }
+
+        position = section.offset + section.numberOfItems*section.numberOfComponents*section.scalarSize;
+    }
+
+    if (!stream) {
+
+        std::cout << "featkBinaryMeshWriter: Error: " << this->fileName << " could not be written." << std::endl;
+    }
+}
+
+featkBinaryMeshSection featkBinaryMeshWriter::getSection(featkBinaryMeshSectionKind kind, std::string name, uint32_t elementType, uint32_t order, uint32_t scalarSize, uint64_t numberOfItems, uint64_t numberOfComponents) const {
+
+    featkBinaryMeshSection section;
+    std::memset(&section, 0, sizeof(section));
+    std::memcpy(section.name, name.c_str(), name.size());
+    section.kind = kind;
+    section.elementType = elementType;
+    section.order = order;
+    section.scalarSize = scalarSize;
+    section.numberOfItems = numberOfItems;
+    section.numberOfComponents = numberOfComponents;
+    section.offset = 0;
+
+    return section;
+}
+
+void featkBinaryMeshWriter::setFileName(std::string fileName) {
+
+    this->fileName = fileName;
+}
@@ -0,0 +1,68 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkBinaryMeshWriter.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkBinaryMeshWriter
+ *
+ * @brief Writer of featkMesh in the featk native binary mesh format.
+ *
+ * featkBinaryMeshWriter writes the node coordinates, the connectivity of
+ * each element type and all the node and element attributes of a
+ * featkMesh in the binary format described in featkBinaryMeshFormat.h, to
+ * be loaded without parsing by featkBinaryMeshReader.
+ *
+ * Elements are grouped by type, featkTet4Element first, element attribute
+ * values following the same order, so that the element order of meshes
+ * mixing element types is not preserved.
+ *
+ * @warning For now, only featkMesh with featkTet4Element and/or
+ * featkHex8Element are supported.
+ *
+ */
+
+#ifndef FEATKBINARYMESHWRITER_H
+#define FEATKBINARYMESHWRITER_H
+
+#include <featk/algorithm/featkBinaryMeshFormat.h>
+#include <featk/algorithm/featkMeshConsumerBase.h>
+#include <featk/core/featkGlobal.h>
+#include <featk/geometry/featkMesh.h>
+
+#include <string>
+
+class FEATK_EXPORT featkBinaryMeshWriter : public featkMeshConsumerBase<3> {
+
+    public:
+
+        featkBinaryMeshWriter();
+        ~featkBinaryMeshWriter();
+
+        void execute();
+
+        void setFileName(std::string fileName);
+
+    private:
+
+        featkBinaryMeshSection getSection(featkBinaryMeshSectionKind kind, std::string name, uint32_t elementType, uint32_t order, uint32_t scalarSize, uint64_t numberOfItems, uint64_t numberOfComponents) const;
+
+        std::string fileName;
+};
+
+#endif // FEATKBINARYMESHWRITER_H
@@ -0,0 +1,548 @@
+#include <featk/algorithm/featkGmshReader.h>
+#include <featk/core/featkDefines.h>
+#include <featk/geometry/featkHex8Element.h>
+#include <featk/geometry/featkNode.h>
+#include <featk/geometry/featkTet4Element.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+static const int FEATK_GMSH_TETRAHEDRON = 4;
+static const int FEATK_GMSH_HEXAHEDRON = 5;
+static const uint64_t FEATK_GMSH_MINIMUM_NODE_SIZE = sizeof(uint64_t)+3*sizeof(double);  // Tag and x, y, z
+
+featkGmshReader::featkGmshReader() {
+
+    this->physicalGroupAttributeName = "Physical Group";
+    this->end = nullptr;
+}
+
+featkGmshReader::~featkGmshReader() {
+
+}
+
+void featkGmshReader::execute() {
+
+    this->physicalNames.clear();
+    this->volumePhysicalTags.clear();
+
+    if (!this->file.open(this->fileName)) {
+
+        return;
+    }
+
+    const unsigned char* position = this->file.getData();
+    this->end = position+this->file.getSize();
+
+
+    // Format
+
+    std::string version;
+    int fileType = 0;
+    int dataSize = 0;
+    int one = 0;
+
+    bool valid = this->getLine(position) == "$MeshFormat";
+    std::istringstream(this->getLine(position)) >> version >> fileType >> dataSize;
+    valid = valid && version == "4.1" && fileType == 1 && dataSize == sizeof(uint64_t) && this->read(position, one) && one == 1;
+
+    if (!valid) {
+
+        std::cout << "featkGmshReader: Error: " << this->fileName << " is not a MSH 4.1 binary file with native endianness and 8 bytes size_t." << std::endl;
+        this->file.close();
+        return;
+    }
+
+
+    // Sections
+
+    std::vector<featkGmshBlock> nodeBlocks;
+    std::vector<featkGmshBlock> elementBlocks;
+    uint64_t maximumNodeTag = 0;
+
+    while (valid && position < this->end) {
+
+        std::string section = this->getLine(position);
+
+        if (section.empty() || section[0] != '$' || section.compare(0, 4, "$End") == 0) {
+
+            continue;
+        }
+
+        if (section == "$PhysicalNames") {
+
+            valid = this->parsePhysicalNames(position);
+        }
+
+        else if (section == "$Entities") {
+
+            valid = this->parseEntities(position);
+        }
+
+        else if (section == "$Nodes") {
+
+            valid = this->parseNodes(position, nodeBlocks, maximumNodeTag);
+        }
+
+        else if (section == "$Elements") {
+
+            valid = this->parseElements(position, elementBlocks);
+        }
+
+        else {
+
+            /* Unsupported section, e.g. $NodeData or $PartitionedEntities, skipped up to its end tag. */
+
+            std::string endTag = "\n$End" + section.substr(1);
+            position = std::search(position, this->end, endTag.begin(), endTag.end());
+        }
+    }
+
+    if (!valid || nodeBlocks.empty() || elementBlocks.empty()) {
+
+        std::cout << "featkGmshReader: Error: Invalid or incomplete sections in " << this->fileName << "." << std::endl;
+        this->file.close();
+        return;
+    }
+
+
+    // Points, decoded in parallel within each block
+
+    std::vector<int64_t> tagToPoint(maximumNodeTag+1, -1);
+    std::vector<double> coordinates;
+    int64_t numberOfPoints = 0;
+    int invalid = 0;
+
+    for (const featkGmshBlock& block : nodeBlocks) {
+
+        numberOfPoints += block.size;
+    }
+
+    coordinates.resize(3*numberOfPoints);
+    int64_t firstPoint = 0;
+
+    for (const featkGmshBlock& block : nodeBlocks) {
+
+        Index size = block.size;
+        size_t stride = (3 + (block.type != 0 ? block.dimension : 0))*sizeof(double);  // Parametric coordinates follow x, y, z
+        const unsigned char* tags = block.data;
+        const unsigned char* values = block.data+size*sizeof(uint64_t);
+
+        #pragma omp parallel for reduction(+:invalid)
+        for (Index k=0; k<size; k++) {
+
+            uint64_t tag;
+            std::memcpy(&tag, tags+k*sizeof(uint64_t), sizeof(uint64_t));
+
+            if (tag > maximumNodeTag) {
+
+                invalid++;
+                continue;
+            }
+
+            tagToPoint[tag] = firstPoint+k;
+            std::memcpy(coordinates.data()+3*(firstPoint+k), values+k*stride, 3*sizeof(double));
+        }
+
+        firstPoint += size;
+    }
+
+
+    // Volume elements, decoded in parallel within each block
+
+    std::vector<const featkGmshBlock*> volumeBlocks;
+    int64_t numberOfElements = 0;
+    int64_t connectivitySize = 0;
+    uint64_t numberOfSkippedElements = 0;
+
+    for (const featkGmshBlock& block : elementBlocks) {
+
+        if (block.dimension == 3 && (block.type == FEATK_GMSH_TETRAHEDRON || block.type == FEATK_GMSH_HEXAHEDRON)) {
+
+            volumeBlocks.push_back(&block);
+            numberOfElements += block.size;
+            connectivitySize += block.size*this->getNumberOfElementNodes(block.type);
+        }
+
+        else {
+
+            numberOfSkippedElements += block.size;
+        }
+    }
+
+    std::vector<int64_t> connectivity(connectivitySize);
+    std::vector<int> types(numberOfElements);
+    std::vector<int> physicalTags(numberOfElements);
+
+    int64_t firstElement = 0;
+    int64_t firstNode = 0;
+
+    for (const featkGmshBlock* block : volumeBlocks) {
+
+        Index size = block->size;
+        unsigned int nodes = this->getNumberOfElementNodes(block->type);
+        int physicalTag = this->volumePhysicalTags.count(block->entityTag) ? this->volumePhysicalTags.at(block->entityTag) : 0;
+
+        #pragma omp parallel for reduction(+:invalid)
+        for (Index k=0; k<size; k++) {
+
+            const unsigned char* record = block->data+k*(1+nodes)*sizeof(uint64_t)+sizeof(uint64_t);  // Element tag skipped
+
+            for (unsigned int j=0; j!=nodes; j++) {
+
+                uint64_t tag;
+                std::memcpy(&tag, record+j*sizeof(uint64_t), sizeof(uint64_t));
+
+                int64_t point = tag <= maximumNodeTag ? tagToPoint[tag] : -1;
+                invalid += point < 0 ? 1 : 0;
+                connectivity[firstNode+k*nodes+j] = point < 0 ? 0 : point;
+            }
+
+            types[firstElement+k] = block->type;
+            physicalTags[firstElement+k] = physicalTag;
+        }
+
+        firstElement += size;
+        firstNode += size*nodes;
+    }
+
+    this->file.close();
+
+    if (invalid != 0) {
+
+        std::cout << "featkGmshReader: Error: " << invalid << " invalid node tags." << std::endl;
+        return;
+    }
+
+
+    // Used points
+
+    std::vector<int64_t> pointToNode(numberOfPoints, -1);
+
+    for (int64_t point : connectivity) {
+
+        pointToNode[point] = 0;
+    }
+
+    std::vector<int64_t> usedPoints;  // Node index to point index
+
+    for (int64_t p=0; p!=numberOfPoints; p++) {
+
+        if (pointToNode[p] != -1) {
+
+            pointToNode[p] = usedPoints.size();
+            usedPoints.push_back(p);
+        }
+    }
+
+
+    // Nodes
+
+    Index numberOfNodes = usedPoints.size();
+    std::vector<featkNode<3>*> nodes(numberOfNodes);
+
+    #pragma omp parallel for
+    for (Index n=0; n<numberOfNodes; n++) {
+
+        const double* point = coordinates.data()+3*usedPoints[n];
+        nodes[n] = new featkNode<3>(n, (AttributeValueType<3, 1>() << point[0], point[1], point[2]).finished());
+    }
+
+
+    // Elements
+
+    std::vector<featkElementInterface<3>*> elements(numberOfElements);
+    int64_t index = 0;
+
+    for (int64_t e=0; e!=numberOfElements; e++) {
+
+        unsigned int numberOfElementNodes = this->getNumberOfElementNodes(types[e]);
+        std::vector<featkNode<3>*> elementNodes(numberOfElementNodes);
+
+        for (unsigned int j=0; j!=numberOfElementNodes; j++) {
+
+            elementNodes[j] = nodes[pointToNode[connectivity[index]]];
+            index++;
+        }
+
+        if (types[e] == FEATK_GMSH_TETRAHEDRON) {
+
+            elements[e] = new featkTet4Element(elementNodes);
+        }
+
+        else {
+
+            elements[e] = new featkHex8Element(elementNodes);
+        }
+    }
+
+
+    // Mesh
+
+    featkMesh<3>* mesh = new featkMesh<3>(nodes, elements);
+
+    std::vector<std::shared_ptr<MatrixXd>> attributes(numberOfElements);
+
+    #pragma omp parallel for
+    for (Index e=0; e<Index(numberOfElements); e++) {
+
+        attributes[e] = std::make_shared<MatrixXd>(MatrixXd::Constant(1, 1, physicalTags[e]));
+    }
+
+    mesh->setElementAttributes(this->physicalGroupAttributeName, 0, attributes);
+
+    std::cout << "featkGmshReader: Info: " << numberOfNodes << " nodes and " << numberOfElements << " elements read, " << (numberOfPoints-numberOfNodes) << " unused nodes and " << numberOfSkippedElements << " lower dimensional or unsupported elements skipped." << std::endl;
+
+
+    // Output
+
+    this->outputMeshes[0] = mesh;
+}
+
+std::string featkGmshReader::getLine(const unsigned char*& position) const {
+
+    const unsigned char* lineEnd = std::find(position, this->end, '\n');
+    std::string line(position, lineEnd);
+
+    position = lineEnd == this->end ? this->end : lineEnd+1;
+
+    if (!line.empty() && line.back() == '\r') {
+
+        line.pop_back();
+    }
+
+    return line;
+}
+
+unsigned int featkGmshReader::getNumberOfElementNodes(int type) const {
+
+    /* Numbers of nodes of the Gmsh element types, needed to skip the blocks of elements that are not read. */
+
+    static const unsigned int numbers[32] = {0, 2, 3, 4, 4, 8, 6, 5, 3, 6, 9, 10, 27, 18, 14, 1, 8, 20, 15, 13, 9, 10, 12, 15, 15, 21, 4, 5, 6, 20, 35, 56};
+
+    return type >= 0 && type < 32 ? numbers[type] : type == 92 ? 64 : type == 93 ? 125 : 0;
+}
+
+std::map<int, std::string> featkGmshReader::getPhysicalNames() const {
+
+    return this->physicalNames;
+}
+
+bool featkGmshReader::parseElements(const unsigned char*& position, std::vector<featkGmshBlock>& blocks) const {
+
+    uint64_t numberOfBlocks, numberOfElements, minimumTag, maximumTag;
+
+    if (!this->read(position, numberOfBlocks) || !this->read(position, numberOfElements) || !this->read(position, minimumTag) || !this->read(position, maximumTag)) {
+
+        return false;
+    }
+
+    for (uint64_t b=0; b!=numberOfBlocks; b++) {
+
+        featkGmshBlock block;
+
+        if (!this->read(position, block.dimension) || !this->read(position, block.entityTag) || !this->read(position, block.type) || !this->read(position, block.size)) {
+
+            return false;
+        }
+
+        unsigned int nodes = this->getNumberOfElementNodes(block.type);
+        block.data = position;
+
+        if (nodes == 0) {
+
+            std::cout << "featkGmshReader: Error: Unknown element type " << block.type << "." << std::endl;
+            return false;
+        }
+
+        if (!this->skip(position, block.size, (1+nodes)*sizeof(uint64_t))) {
+
+            return false;
+        }
+
+        blocks.push_back(block);
+    }
+
+    return true;
+}
+
+bool featkGmshReader::parseEntities(const unsigned char*& position) {
+
+    /* Points have a position, other entities a bounding box and bounding entities. Only the physical tags of volumes are kept. */
+
+    uint64_t numbers[4];
+
+    for (unsigned int d=0; d!=4; d++) {
+
+        if (!this->read(position, numbers[d])) {
+
+            return false;
+        }
+    }
+
+    for (unsigned int d=0; d!=4; d++) {
+
+        for (uint64_t i=0; i!=numbers[d]; i++) {
+
+            int tag;
+            uint64_t numberOfPhysicalTags;
+
+            if (!this->read(position, tag) || !this->skip(position, d == 0 ? 3 : 6, sizeof(double)) || !this->read(position, numberOfPhysicalTags)) {
+
+                return false;
+            }
+
+            if (d == 3 && numberOfPhysicalTags != 0) {
+
+                int physicalTag;
+
+                if (!this->read(position, physicalTag)) {
+
+                    return false;
+                }
+
+                this->volumePhysicalTags[tag] = physicalTag;
+                numberOfPhysicalTags--;
+
+                if (numberOfPhysicalTags != 0) {
+
+                    std::cout << "featkGmshReader: Warning: Volume " << tag << " belongs to several physical groups, only the first one is kept." << std::endl;
+                }
+            }
+
+            if (!this->skip(position, numberOfPhysicalTags, sizeof(int))) {
+
+                return false;
+            }
+
+            if (d != 0) {
+
+                uint64_t numberOfBoundingEntities;
+
+                if (!this->read(position, numberOfBoundingEntities) || !this->skip(position, numberOfBoundingEntities, sizeof(int))) {
+
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool featkGmshReader::parseNodes(const unsigned char*& position, std::vector<featkGmshBlock>& blocks, uint64_t& maximumNodeTag) const {
+
+    uint64_t numberOfBlocks, numberOfNodes, minimumTag;
+
+    if (!this->read(position, numberOfBlocks) || !this->read(position, numberOfNodes) || !this->read(position, minimumTag) || !this->read(position, maximumNodeTag)) {
+
+        return false;
+    }
+
+    if (maximumNodeTag > uint64_t(this->end-position)/FEATK_GMSH_MINIMUM_NODE_SIZE) {  // Bounds the tag to point vector for corrupted headers, each node taking at least 32 bytes
+
+        return false;
+    }
+
+    for (uint64_t b=0; b!=numberOfBlocks; b++) {
+
+        featkGmshBlock block;
+
+        if (!this->read(position, block.dimension) || !this->read(position, block.entityTag) || !this->read(position, block.type) || !this->read(position, block.size)) {
+
+            return false;
+        }
+
+        block.data = position;
+
+        if (!this->skip(position, block.size, sizeof(uint64_t)) || !this->skip(position, block.size, (3 + (block.type != 0 ? block.dimension : 0))*sizeof(double))) {
+
+            return false;
+        }
+
+        blocks.push_back(block);
+    }
+
+    return true;
+}
+
+bool featkGmshReader::parsePhysicalNames(const unsigned char*& position) {
+
+    /* Always written in ASCII, one "dimension tag "name"" line per physical group. */
+
+    unsigned int numberOfPhysicalNames;
+
+    if (!(std::istringstream(this->getLine(position)) >> numberOfPhysicalNames)) {
+
+        return false;
+    }
+
+    for (unsigned int i=0; i!=numberOfPhysicalNames; i++) {
+
+        if (position >= this->end) {
+
+            return false;
+        }
+
+        std::string line = this->getLine(position);
+        std::istringstream stream(line);
+
+        int dimension, tag;
+        stream >> dimension >> tag;
+
+        size_t first = line.find('"');
+        size_t last = line.rfind('"');
+
+        if (!stream || first == std::string::npos || last == first) {
+
+            std::cout << "featkGmshReader: Error: Invalid physical name " << line << "." << std::endl;
+            return false;
+        }
+
+        if (dimension == 3) {
+
+            this->physicalNames[tag] = line.substr(first+1, last-first-1);
+        }
+    }
+
+    return true;
+}
+
+template<typename ValueType>
+bool featkGmshReader::read(const unsigned char*& position, ValueType& value) const {
+
+    if (uint64_t(this->end-position) < sizeof(ValueType)) {
+
+        return false;
+    }
+
+    std::memcpy(&value, position, sizeof(ValueType));
+    position += sizeof(ValueType);
+
+    return true;
+}
+
+void featkGmshReader::setFileName(std::string fileName) {
+
+    this->fileName = fileName;
+}
+
+void featkGmshReader::setPhysicalGroupAttributeName(std::string name) {
+
+    this->physicalGroupAttributeName = name;
+}
+
+bool featkGmshReader::skip(const unsigned char*& position, uint64_t count, uint64_t size) const {
+
+    if (size != 0 && count > uint64_t(this->end-position)/size) {
+
+        return false;
+    }
+
+    position += count*size;
+
+    return true;
+}
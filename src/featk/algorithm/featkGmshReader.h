@@ -0,0 +1,99 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkGmshReader.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkGmshReader
+ *
+ * @brief Reader of featkMesh from Gmsh MSH 4.1 binary files.
+ *
+ * featkGmshReader produces a featkMesh directly from a Gmsh MSH 4.1 binary
+ * file, without going through VTK. The file is memory mapped and its
+ * sections are walked once to locate the node and element blocks, whose
+ * fixed-size records are then decoded in parallel.
+ *
+ * Only the 4-node tetrahedra and 8-node hexahedra of volume entities are
+ * read, Gmsh and featk sharing the same node ordering, and nodes not used
+ * by any of them are discarded. Each element is given the physical tag of
+ * its volume entity, or 0 if it has none, as an order 0 element attribute
+ * named after setPhysicalGroupAttributeName() ("Physical Group" by
+ * default), and getPhysicalNames() gives the names of the volume physical
+ * groups, e.g. to threshold the mesh with featkThresholdMeshFilter.
+ *
+ * @warning ASCII and MSH 2 files, and files written on a machine with a
+ * different endianness or size_t size, are not supported.
+ *
+ */
+
+#ifndef FEATKGMSHREADER_H
+#define FEATKGMSHREADER_H
+
+#include <featk/algorithm/featkMeshProducerBase.h>
+#include <featk/core/featkGlobal.h>
+#include <featk/core/featkMemoryMappedFile.h>
+#include <featk/geometry/featkMesh.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class FEATK_EXPORT featkGmshReader : public featkMeshProducerBase<3> {
+
+    public:
+
+        featkGmshReader();
+        ~featkGmshReader();
+
+        void execute();
+
+        std::map<int, std::string> getPhysicalNames() const;
+        void setFileName(std::string fileName);
+        void setPhysicalGroupAttributeName(std::string name);
+
+    private:
+
+        struct featkGmshBlock {
+
+            int dimension;
+            int entityTag;
+            int type;  // Element type or parametric flag
+            uint64_t size;
+            const unsigned char* data;
+        };
+
+        unsigned int getNumberOfElementNodes(int type) const;
+        std::string getLine(const unsigned char*& position) const;
+        bool parseElements(const unsigned char*& position, std::vector<featkGmshBlock>& blocks) const;
+        bool parseEntities(const unsigned char*& position);
+        bool parseNodes(const unsigned char*& position, std::vector<featkGmshBlock>& blocks, uint64_t& maximumNodeTag) const;
+        bool parsePhysicalNames(const unsigned char*& position);
+        template<typename ValueType> bool read(const unsigned char*& position, ValueType& value) const;
+        bool skip(const unsigned char*& position, uint64_t count, uint64_t size) const;
+
+        std::string fileName;
+        std::string physicalGroupAttributeName;
+
+        featkMemoryMappedFile file;
+        const unsigned char* end;
+        std::map<int, std::string> physicalNames;  // Volume physical groups only
+        std::map<int, int> volumePhysicalTags;     // Volume entity tag to its first physical tag
+};
+
+#endif // FEATKGMSHREADER_H
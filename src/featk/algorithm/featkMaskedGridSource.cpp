@@ -0,0 +1,302 @@
+#include <featk/algorithm/featkMaskedGridSource.h>
+#include <featk/core/featkNIfTIImage.h>
+#include <featk/geometry/featkHex8Element.h>
+#include <featk/geometry/featkNode.h>
+#include <featk/geometry/featkTet4Element.h>
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+
+featkMaskedGridSource::featkMaskedGridSource() {
+
+    this->dimensions = {0, 0, 0};
+    this->elementType = FEATK_HEX8;
+    this->labelAttributeName = "Label";
+    this->origin = {0.0, 0.0, 0.0};
+    this->spacing = {1.0, 1.0, 1.0};
+}
+
+featkMaskedGridSource::~featkMaskedGridSource() {
+
+}
+
+void featkMaskedGridSource::execute() {
+
+    // Mask and node index to world transform
+
+    int64_t nx;
+    int64_t ny;
+    int64_t nz;
+    std::vector<int> voxelLabels;
+    Matrix<double, 3, 4> nodeToWorld;
+
+    if (!this->maskFileName.empty()) {
+
+        featkNIfTIImage image;
+
+        if (!image.open(this->maskFileName)) {
+
+            return;
+        }
+
+        nx = image.getDimensions()[0];
+        ny = image.getDimensions()[1];
+        nz = image.getDimensions()[2];
+
+        Index numberOfVoxels = image.getNumberOfVoxels();
+        voxelLabels.resize(numberOfVoxels);
+
+        #pragma omp parallel for
+        for (Index v=0; v<numberOfVoxels; v++) {
+
+            voxelLabels[v] = int(std::lround(image.getValue(v)));
+        }
+
+        /* Node (x, y, z) is the voxel corner at index (x-0.5, y-0.5, z-0.5). */
+
+        nodeToWorld = image.getIndexToWorld();
+        nodeToWorld.col(3) -= 0.5*nodeToWorld.leftCols<3>().rowwise().sum();
+    }
+
+    else {
+
+        nx = this->dimensions[0];
+        ny = this->dimensions[1];
+        nz = this->dimensions[2];
+
+        if (this->mask.size() != size_t(nx*ny*nz)) {
+
+            std::cout << "featkMaskedGridSource: Error: Mask size " << this->mask.size() << " does not match dimensions." << std::endl;
+            return;
+        }
+
+        voxelLabels = this->mask;
+
+        nodeToWorld << this->spacing[0], 0.0, 0.0, -this->origin[0],
+                       0.0, this->spacing[1], 0.0, -this->origin[1],
+                       0.0, 0.0, this->spacing[2], -this->origin[2];
+    }
+
+    std::vector<unsigned char> inside(voxelLabels.size());
+
+    #pragma omp parallel for
+    for (Index v=0; v<Index(voxelLabels.size()); v++) {
+
+        inside[v] = voxelLabels[v] != 0 && (this->labels.empty() || this->labels.count(voxelLabels[v]));
+    }
+
+
+    // Compact node numbering, slab by slab
+
+    int64_t mx = nx+1;
+    int64_t my = ny+1;
+    int64_t mz = nz+1;
+
+    std::vector<int64_t> nodeIndices(mx*my*mz, -1);
+    std::vector<int64_t> slabNodes(mz+1, 0);
+
+    #pragma omp parallel for
+    for (Index z=0; z<mz; z++) {
+
+        int64_t count = 0;
+
+        for (int64_t y=0; y!=my; y++) {
+
+            for (int64_t x=0; x!=mx; x++) {
+
+                bool used = false;
+
+                for (int64_t c=0; c!=8 && !used; c++) {
+
+                    int64_t vx = x-1+(c & 1);
+                    int64_t vy = y-1+((c >> 1) & 1);
+                    int64_t vz = z-1+((c >> 2) & 1);
+
+                    used = vx >= 0 && vx < nx && vy >= 0 && vy < ny && vz >= 0 && vz < nz && inside[vx + nx*(vy + ny*vz)];
+                }
+
+                if (used) {
+
+                    nodeIndices[x + mx*(y + my*z)] = count++;
+                }
+            }
+        }
+
+        slabNodes[z+1] = count;
+    }
+
+    for (int64_t z=0; z!=mz; z++) {
+
+        slabNodes[z+1] += slabNodes[z];
+    }
+
+    std::vector<featkNode<3>*> nodes(slabNodes[mz]);
+
+    #pragma omp parallel for
+    for (Index z=0; z<mz; z++) {
+
+        for (int64_t y=0; y!=my; y++) {
+
+            for (int64_t x=0; x!=mx; x++) {
+
+                int64_t& index = nodeIndices[x + mx*(y + my*z)];
+
+                if (index != -1) {
+
+                    index += slabNodes[z];
+
+                    AttributeValueType<3, 1> coordinates = nodeToWorld.leftCols<3>()*Vector3d(x, y, z)+nodeToWorld.col(3);
+                    nodes[index] = new featkNode<3>(index, coordinates);
+                }
+            }
+        }
+    }
+
+
+    // Elements, slabs of same parity at once as elements register themselves to their nodes
+
+    unsigned int elementsPerCell = this->elementType == FEATK_TET4 ? 5 : 1;
+    std::vector<int64_t> slabElements(nz+1, 0);
+
+    #pragma omp parallel for
+    for (Index z=0; z<nz; z++) {
+
+        int64_t count = 0;
+
+        for (int64_t v=nx*ny*z; v!=nx*ny*(z+1); v++) {
+
+            count += inside[v];
+        }
+
+        slabElements[z+1] = count*elementsPerCell;
+    }
+
+    for (int64_t z=0; z!=nz; z++) {
+
+        slabElements[z+1] += slabElements[z];
+    }
+
+    std::vector<featkElementInterface<3>*> elements(slabElements[nz]);
+    std::vector<std::shared_ptr<MatrixXd>> attributes(slabElements[nz]);
+
+    static const unsigned int EVEN_TETRAHEDRA[5][4] = {{0, 2, 5, 1}, {2, 7, 5, 6}, {0, 7, 2, 3}, {0, 5, 2, 7}, {0, 5, 7, 4}};  // As featk3DGridSource
+    static const unsigned int ODD_TETRAHEDRA[5][4] = {{0, 1, 3, 4}, {2, 3, 1, 6}, {1, 3, 4, 6}, {5, 1, 4, 6}, {7, 4, 3, 6}};
+
+    for (int parity=0; parity!=2; parity++) {
+
+        #pragma omp parallel for
+        for (Index z=parity; z<nz; z+=2) {
+
+            int64_t e = slabElements[z];
+
+            for (int64_t y=0; y!=ny; y++) {
+
+                for (int64_t x=0; x!=nx; x++) {
+
+                    int64_t v = x + nx*(y + ny*z);
+
+                    if (!inside[v]) {
+
+                        continue;
+                    }
+
+                    featkNode<3>* cellNodes[8];
+
+                    for (unsigned int c=0; c!=8; c++) {
+
+                        int64_t cx = x + ((c+1)/2 % 2);  // Hexahedron node order, 0 1 1 0 0 1 1 0
+                        int64_t cy = y + (c/2 % 2);
+                        int64_t cz = z + c/4;
+
+                        cellNodes[c] = nodes[nodeIndices[cx + mx*(cy + my*cz)]];
+                    }
+
+                    MatrixXd label = MatrixXd::Constant(1, 1, voxelLabels[v]);
+
+                    if (this->elementType == FEATK_TET4) {
+
+                        const unsigned int (*tetrahedra)[4] = (x+y+z) % 2 == 0 ? EVEN_TETRAHEDRA : ODD_TETRAHEDRA;
+
+                        for (unsigned int t=0; t!=5; t++) {
+
+                            elements[e] = new featkTet4Element(std::vector<featkNode<3>*>({cellNodes[tetrahedra[t][0]], cellNodes[tetrahedra[t][1]], cellNodes[tetrahedra[t][2]], cellNodes[tetrahedra[t][3]]}));
+                            attributes[e] = std::make_shared<MatrixXd>(label);
+                            e++;
+                        }
+                    }
+
+                    else {
+
+                        elements[e] = new featkHex8Element(std::vector<featkNode<3>*>(cellNodes, cellNodes+8));
+                        attributes[e] = std::make_shared<MatrixXd>(label);
+                        e++;
+                    }
+                }
+            }
+        }
+    }
+
+
+    // Mesh
+
+    featkMesh<3>* mesh = new featkMesh<3>(nodes, elements);
+    mesh->setElementAttributes(this->labelAttributeName, 0, attributes);
+
+    std::cout << "featkMaskedGridSource: Info: " << nodes.size() << " nodes and " << elements.size() << " elements generated from " << slabElements[nz]/elementsPerCell << " of " << nx*ny*nz << " voxels." << std::endl;
+
+
+    // Output
+
+    this->outputMeshes[0] = mesh;
+}
+
+void featkMaskedGridSource::setDimensions(std::array<unsigned int, 3> dimensions) {
+
+    this->dimensions = dimensions;
+}
+
+void featkMaskedGridSource::setElementType(featkElementType type) {
+
+    this->elementType = type;
+}
+
+void featkMaskedGridSource::setElementTypeToFEATKHex8() {
+
+    this->elementType = FEATK_HEX8;
+}
+
+void featkMaskedGridSource::setElementTypeToFEATKTet4() {
+
+    this->elementType = FEATK_TET4;
+}
+
+void featkMaskedGridSource::setLabelAttributeName(std::string name) {
+
+    this->labelAttributeName = name;
+}
+
+void featkMaskedGridSource::setLabels(std::set<int> labels) {
+
+    this->labels = labels;
+}
+
+void featkMaskedGridSource::setMask(std::vector<int> mask) {
+
+    this->mask = mask;
+}
+
+void featkMaskedGridSource::setMaskFileName(std::string fileName) {
+
+    this->maskFileName = fileName;
+}
+
+void featkMaskedGridSource::setOrigin(std::array<double, 3> origin) {
+
+    this->origin = origin;
+}
+
+void featkMaskedGridSource::setSpacing(std::array<double, 3> spacing) {
+
+    this->spacing = spacing;
+}
@@ -0,0 +1,89 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkMaskedGridSource.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkMaskedGridSource
+ *
+ * @brief 3D grid mesh source restricted to the voxels of a label mask.
+ *
+ * featkMaskedGridSource meshes each voxel of a label mask whose label is
+ * non zero, or one of the labels set with setLabels(), as one hexahedron
+ * or five tetrahedra, instead of the whole box as featk3DGridSource does.
+ * Only the nodes of these cells are created, numbered compactly in z, y, x
+ * order, and the label of each voxel is stored as an order 0 element
+ * attribute named after setLabelAttributeName() ("Label" by default).
+ *
+ * The mask is either given in memory with setMask(), x varying fastest,
+ * setDimensions() being then the number of voxels along each axis and the
+ * node coordinates spacing*index-origin as for featk3DGridSource, or read
+ * from the NIfTI label image set with setMaskFileName(), whose voxel to
+ * world transform then places each cell barycenter on its voxel center.
+ *
+ * Nodes and elements are created in parallel, and the five tetrahedra
+ * decomposition is mirrored from one cell to the next so that faces shared
+ * by neighbouring cells are split along the same diagonal.
+ *
+ */
+
+#ifndef FEATKMASKEDGRIDSOURCE_H
+#define FEATKMASKEDGRIDSOURCE_H
+
+#include <featk/algorithm/featkMeshProducerBase.h>
+#include <featk/core/featkGlobal.h>
+#include <featk/geometry/featkMesh.h>
+
+#include <array>
+#include <set>
+#include <string>
+#include <vector>
+
+class FEATK_EXPORT featkMaskedGridSource : public featkMeshProducerBase<3> {
+
+    public:
+
+        featkMaskedGridSource();
+        ~featkMaskedGridSource();
+
+        void execute();
+
+        void setDimensions(std::array<unsigned int, 3> dimensions);
+        void setElementType(featkElementType type);
+        void setElementTypeToFEATKHex8();
+        void setElementTypeToFEATKTet4();
+        void setLabelAttributeName(std::string name);
+        void setLabels(std::set<int> labels);
+        void setMask(std::vector<int> mask);
+        void setMaskFileName(std::string fileName);
+        void setOrigin(std::array<double, 3> origin);
+        void setSpacing(std::array<double, 3> spacing);
+
+    private:
+
+        std::array<unsigned int, 3> dimensions;
+        featkElementType elementType;
+        std::string labelAttributeName;
+        std::set<int> labels;
+        std::vector<int> mask;
+        std::string maskFileName;
+        std::array<double, 3> origin;
+        std::array<double, 3> spacing;
+};
+
+#endif // FEATKMASKEDGRIDSOURCE_H
@@ -1,5 +1,13 @@
 #include <featk/algorithm/featkMeshToVTKUnstructuredGridFilter.h>
 
+#include <algorithm>
+
+#include <vtkCellArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPoints.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkVersionMacros.h>
+
 void featkMeshToVTKUnstructuredGridFilter<3>::execute() {
 
     vtkSmartPointer<vtkUnstructuredGrid> unstructuredGrid = vtkSmartPointer<vtkUnstructuredGrid>::New();
@@ -9,182 +17,127 @@ void featkMeshToVTKUnstructuredGridFilter<3>::execute() {
     if (inputMesh != nullptr) {
 
 
-        // Nodes allocation
+        // Nodes
 
-        std::vector<featkNode<3>*> nodes = inputMesh->getNodes();
+        const std::vector<featkNode<3>*>& nodes = inputMesh->getNodes();
 
-        vtkSmartPointer<vtkPoints> points = vtkPoints::New();
-        points->SetNumberOfPoints(nodes.size());
+        vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+        points->SetData(this->getAttributeArray(nodes, "Points", 1, 1));  // Cartesian coordinates
 
+        unstructuredGrid->SetPoints(points);
 
-        // Node attributes allocation
 
-        std::vector<std::pair<size_t, vtkSmartPointer<vtkDoubleArray>>> nodeAttributes;
+        // Node attributes
 
         for (const auto& pair : inputMesh->getNodeAttributeTable()) {
 
-            std::string name = pair.first;
-            size_t id = pair.second.first;
-            unsigned int order = pair.second.second;
-            unsigned int components = POWER(3, order);
-
-            vtkSmartPointer<vtkDoubleArray> attributeArray = vtkDoubleArray::New();
-            attributeArray->SetName(name.c_str());
-            attributeArray->SetNumberOfComponents(components);
-            attributeArray->SetNumberOfTuples(nodes.size());
-            attributeArray->SetNumberOfValues(nodes.size()*components);
-
-            nodeAttributes.push_back(std::make_pair(id, attributeArray));
+            unstructuredGrid->GetPointData()->AddArray(this->getAttributeArray(nodes, pair.first, pair.second.first, pair.second.second));
         }
 
 
-        // Nodes loop
-
-        std::map<size_t, vtkIdType> map;  // featkNode<Dimension>::id is supposed to match node index in featkMesh<Dimension>::nodes but keep a map in case
-
-        for (vtkIdType n=0; n!=nodes.size(); n++) {
-
-            featkNode<3>* node = nodes[n];
-
-
-            // Insertion
-
-            AttributeValueType<3, 1> coordinates = node->getCoordinates();
-            points->SetPoint(n, coordinates(0, 0), coordinates(1, 0), coordinates(2, 0));
-            map[node->getID()] = n;
+        // Node indices, featkNode<Dimension>::id is supposed to match node index in featkMesh<Dimension>::nodes but remap in case
 
+        size_t maximumID = 0;
 
-            // Attributes
+        for (featkNode<3>* node : nodes) {
 
-            for (const auto& pair : nodeAttributes) {
-
-                MatrixXd matrix = node->getAttributeValue(pair.first);
-
-                double* values = new double[pair.second->GetNumberOfComponents()];
-                int index = 0;
-
-                for (int i=0; i!=matrix.rows(); i++) {
-
-                    for (int j=0; j!=matrix.cols(); j++) {
-
-                        values[index] = matrix(i, j);
-                        index++;
-                    }
-                }
-
-                pair.second->SetTuple(n, values);
-                delete[] values;
-            }
+            maximumID = std::max(maximumID, node->getID());
         }
 
-        unstructuredGrid->SetPoints(points);
-
+        std::vector<vtkIdType> map(nodes.empty() ? 0 : maximumID+1);
 
-        // Node attributes assginment
+        for (vtkIdType n=0; n!=vtkIdType(nodes.size()); n++) {
 
-        for (const auto& pair : nodeAttributes) {
-
-            unstructuredGrid->GetPointData()->AddArray(pair.second);
+            map[nodes[n]->getID()] = n;
         }
 
 
-        // Elements allocation
+        // Elements, cell types and offsets first so that connectivity can be filled in parallel
 
-        std::vector<featkElementInterface<3>*> elements = inputMesh->getElements();
+        const std::vector<featkElementInterface<3>*>& elements = inputMesh->getElements();
+        vtkIdType numberOfElements = elements.size();
 
-        unstructuredGrid->Allocate(elements.size());
+        vtkSmartPointer<vtkUnsignedCharArray> types = vtkSmartPointer<vtkUnsignedCharArray>::New();
+        types->SetNumberOfValues(numberOfElements);
 
+        vtkSmartPointer<vtkIdTypeArray> offsets = vtkSmartPointer<vtkIdTypeArray>::New();
+        offsets->SetNumberOfValues(numberOfElements+1);
+        offsets->SetValue(0, 0);
 
-        // Element attributes allocation
+        for (vtkIdType e=0; e!=numberOfElements; e++) {
 
-        std::vector<std::pair<size_t, vtkSmartPointer<vtkDoubleArray>>> elementAttributes;
-
-        for (const auto& pair : inputMesh->getElementAttributeTable()) {
-
-            std::string name = pair.first;
-            size_t id = pair.second.first;
-            unsigned int order = pair.second.second;
-            unsigned int components = POWER(3, order);
-
-            vtkSmartPointer<vtkDoubleArray> attributeArray = vtkDoubleArray::New();
-            attributeArray->SetName(name.c_str());
-            attributeArray->SetNumberOfComponents(components);
-            attributeArray->SetNumberOfTuples(elements.size());
-            attributeArray->SetNumberOfValues(elements.size()*components);
-
-            elementAttributes.push_back(std::make_pair(id, attributeArray));
-        }
-
-
-        // Elements loop
-
-        for (vtkIdType e=0; e!=elements.size(); e++) {
-
-            featkElementInterface<3>* element = elements[e];
-
-
-            // Cell type
-
-            int type;
-
-            switch (element->getElementType()) {
+            switch (elements[e]->getElementType()) {
 
                 case FEATK_TET4:
 
-                    type = VTK_TETRA;
+                    types->SetValue(e, VTK_TETRA);
+                    offsets->SetValue(e+1, offsets->GetValue(e)+4);
                     break;
 
                 case FEATK_HEX8:
 
-                    type = VTK_HEXAHEDRON;
+                    types->SetValue(e, VTK_HEXAHEDRON);
+                    offsets->SetValue(e+1, offsets->GetValue(e)+8);
                     break;
             }
+        }
 
+        vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+        connectivity->SetNumberOfValues(offsets->GetValue(numberOfElements));
 
-            // Insertion
-
-            std::vector<featkNode<3>*> elementNodes = element->getNodes();
+        const vtkIdType* offsetsPointer = offsets->GetPointer(0);
+        vtkIdType* connectivityPointer = connectivity->GetPointer(0);
 
-            vtkSmartPointer<vtkIdList> pointIDs = vtkIdList::New();
-            pointIDs->SetNumberOfIds(elementNodes.size());
+        #pragma omp parallel for
+        for (vtkIdType e=0; e<numberOfElements; e++) {
 
-            for (vtkIdType n=0; n!=elementNodes.size(); n++) {
+            for (vtkIdType j=offsetsPointer[e]; j!=offsetsPointer[e+1]; j++) {
 
-                pointIDs->SetId(n, map[elementNodes[n]->getID()]);
+                connectivityPointer[j] = map[elements[e]->getNode(j-offsetsPointer[e])->getID()];
             }
+        }
 
-            unstructuredGrid->InsertNextCell(type, pointIDs);
+        vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
 
+        #if VTK_MAJOR_VERSION >= 9
 
-            // Attributes
+        cells->SetData(offsets, connectivity);
+        unstructuredGrid->SetCells(types, cells);
 
-            for (const auto& pair : elementAttributes) {
+        #else
 
-                MatrixXd matrix = element->getAttributeValue(pair.first);
+        /* Legacy (size, ids...) layout, cell locations being the offsets shifted by one size per cell. */
 
-                double* values = new double[pair.second->GetNumberOfComponents()];
-                int index = 0;
+        vtkSmartPointer<vtkIdTypeArray> legacyCells = vtkSmartPointer<vtkIdTypeArray>::New();
+        legacyCells->SetNumberOfValues(numberOfElements+connectivity->GetNumberOfValues());
 
-                for (int i=0; i!=matrix.rows(); i++) {
+        vtkSmartPointer<vtkIdTypeArray> locations = vtkSmartPointer<vtkIdTypeArray>::New();
+        locations->SetNumberOfValues(numberOfElements);
 
-                    for (int j=0; j!=matrix.cols(); j++) {
+        vtkIdType* legacyCellsPointer = legacyCells->GetPointer(0);
+        vtkIdType* locationsPointer = locations->GetPointer(0);
 
-                        values[index] = matrix(i, j);
-                        index++;
-                    }
-                }
+        #pragma omp parallel for
+        for (vtkIdType e=0; e<numberOfElements; e++) {
 
-                pair.second->SetTuple(e, values);
-                delete[] values;
-            }
+            vtkIdType location = offsetsPointer[e]+e;
+
+            locationsPointer[e] = location;
+            legacyCellsPointer[location] = offsetsPointer[e+1]-offsetsPointer[e];
+            std::copy(connectivityPointer+offsetsPointer[e], connectivityPointer+offsetsPointer[e+1], legacyCellsPointer+location+1);
         }
 
+        cells->SetCells(numberOfElements, legacyCells);
+        unstructuredGrid->SetCells(types, locations, cells);
+
+        #endif
 
-        // Element attributes assginment
 
-        for (const auto& pair : elementAttributes) {
+        // Element attributes
+
+        for (const auto& pair : inputMesh->getElementAttributeTable()) {
 
-            unstructuredGrid->GetCellData()->AddArray(pair.second);
+            unstructuredGrid->GetCellData()->AddArray(this->getAttributeArray(elements, pair.first, pair.second.first, pair.second.second));
         }
     }
 
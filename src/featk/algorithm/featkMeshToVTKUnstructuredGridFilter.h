@@ -32,6 +32,10 @@
  * respectively assigned to the vtkPointData and vtkCellData of the output
  * vtkUnstructuredGrid.
  *
+ * Attribute values are gathered in parallel into contiguous buffers handed
+ * over to the vtkDoubleArray with SetArray(), and the vtkCellArray is built
+ * at once from offsets and connectivity arrays.
+ *
  * @warning For now, only 3D featkMesh with featkTet4Element and/or
  * featkHex8Element are supported.
  *
@@ -53,6 +57,9 @@
 #include <vtkUnstructuredGrid.h>
 #include <vtkSmartPointer.h>
 
+#include <string>
+#include <vector>
+
 template<unsigned int Dimension>
 class featkMeshToVTKUnstructuredGridFilter : public featkMeshConsumerBase<Dimension> {
 
@@ -66,6 +73,8 @@ class featkMeshToVTKUnstructuredGridFilter : public featkMeshConsumerBase<Dimens
 
     private:
 
+        template<typename AttributeOwnerType> vtkSmartPointer<vtkDoubleArray> getAttributeArray(const std::vector<AttributeOwnerType*>& items, std::string name, size_t id, unsigned int order) const;
+
         vtkSmartPointer<vtkUnstructuredGrid> output;
 };
 
@@ -80,6 +89,36 @@ featkMeshToVTKUnstructuredGridFilter<Dimension>::~featkMeshToVTKUnstructuredGrid
 
 }
 
+template<unsigned int Dimension>
+template<typename AttributeOwnerType>
+vtkSmartPointer<vtkDoubleArray> featkMeshToVTKUnstructuredGridFilter<Dimension>::getAttributeArray(const std::vector<AttributeOwnerType*>& items, std::string name, size_t id, unsigned int order) const {
+
+    /* The buffer is filled row major in place from the attribute storage and then owned by the array. */
+
+    unsigned int components = POWER(Dimension, order);
+    Index numberOfItems = items.size();
+
+    double* values = new double[numberOfItems*components]();
+
+    #pragma omp parallel for
+    for (Index i=0; i<numberOfItems; i++) {
+
+        const MatrixXd* value = items[i]->getAttribute(id);
+
+        if (value != nullptr && value->size() == components) {
+
+            Map<Matrix<double, Dynamic, Dynamic, RowMajor>>(values+i*components, value->rows(), value->cols()) = *value;
+        }
+    }
+
+    vtkSmartPointer<vtkDoubleArray> array = vtkSmartPointer<vtkDoubleArray>::New();
+    array->SetName(name.c_str());
+    array->SetNumberOfComponents(components);
+    array->SetArray(values, numberOfItems*components, 0, vtkDoubleArray::VTK_DATA_ARRAY_DELETE);
+
+    return array;
+}
+
 template<unsigned int Dimension>
 vtkSmartPointer<vtkUnstructuredGrid> featkMeshToVTKUnstructuredGridFilter<Dimension>::getOutputVTKUnstructuredGrid() {
 
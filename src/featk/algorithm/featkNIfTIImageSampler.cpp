@@ -0,0 +1,228 @@
+#include <featk/algorithm/featkNIfTIImageSampler.h>
+#include <featk/core/featkDefines.h>
+#include <featk/geometry/featkNode.h>
+
+#include <algorithm>
+#include <iostream>
+
+featkNIfTIImageSampler::featkNIfTIImageSampler() {
+
+    this->attributeName = "Image";
+    this->outsideValue = 0.0;
+    this->sampleNodes = false;
+}
+
+featkNIfTIImageSampler::~featkNIfTIImageSampler() {
+
+}
+
+void featkNIfTIImageSampler::execute() {
+
+    featkMesh<3>* inputMesh = this->inputMeshes[0];
+
+    if (inputMesh == nullptr) {
+
+        return;
+    }
+
+
+    // Image
+
+    featkNIfTIImage image;
+
+    if (!image.open(this->fileName)) {
+
+        return;
+    }
+
+    int64_t components = image.getNumberOfComponents();
+
+    if (components != 1 && components != 3 && components != 6 && components != 9) {
+
+        std::cout << "featkNIfTIImageSampler: Error: " << components << " components images not supported, only scalar, vector, symmetric and full tensor images are." << std::endl;
+        return;
+    }
+
+    unsigned int order = components == 1 ? 0 : components == 3 ? 1 : 2;
+
+
+    // Sample points
+
+    Index numberOfPoints = this->sampleNodes ? inputMesh->getNumberOfNodes() : inputMesh->getNumberOfElements();
+    std::vector<AttributeValueType<3, 1>> points(numberOfPoints);
+
+    #pragma omp parallel for
+    for (Index p=0; p<numberOfPoints; p++) {
+
+        points[p] = this->sampleNodes ? inputMesh->getNode(p)->getCoordinates() : inputMesh->getElement(p)->getBarycenter();
+    }
+
+
+    // Sampling
+
+    std::vector<std::shared_ptr<MatrixXd>> attributes(numberOfPoints);
+    int64_t exact = 0;
+    int64_t outside = 0;
+
+    switch (image.getDatatype()) {
+
+        case FEATK_NIFTI_UINT8:   this->sample<uint8_t>(image, points, attributes, exact, outside); break;
+        case FEATK_NIFTI_INT16:   this->sample<int16_t>(image, points, attributes, exact, outside); break;
+        case FEATK_NIFTI_INT32:   this->sample<int32_t>(image, points, attributes, exact, outside); break;
+        case FEATK_NIFTI_FLOAT32: this->sample<float>(image, points, attributes, exact, outside); break;
+        case FEATK_NIFTI_FLOAT64: this->sample<double>(image, points, attributes, exact, outside); break;
+        case FEATK_NIFTI_INT8:    this->sample<int8_t>(image, points, attributes, exact, outside); break;
+        case FEATK_NIFTI_UINT16:  this->sample<uint16_t>(image, points, attributes, exact, outside); break;
+        case FEATK_NIFTI_UINT32:  this->sample<uint32_t>(image, points, attributes, exact, outside); break;
+        case FEATK_NIFTI_INT64:   this->sample<int64_t>(image, points, attributes, exact, outside); break;
+        case FEATK_NIFTI_UINT64:  this->sample<uint64_t>(image, points, attributes, exact, outside); break;
+    }
+
+    if (this->sampleNodes) {
+
+        inputMesh->setNodeAttributes(this->attributeName, order, attributes);
+    }
+
+    else {
+
+        inputMesh->setElementAttributes(this->attributeName, order, attributes);
+    }
+
+    std::cout << "featkNIfTIImageSampler: Info: " << numberOfPoints << " points sampled, " << exact << " exactly on voxel centers." << std::endl;
+
+    if (outside != 0) {
+
+        std::cout << "featkNIfTIImageSampler: Warning: " << outside << " points outside the image set to " << this->outsideValue << "." << std::endl;
+    }
+}
+
+template<typename VoxelType>
+void featkNIfTIImageSampler::sample(const featkNIfTIImage& image, const std::vector<AttributeValueType<3, 1>>& points, std::vector<std::shared_ptr<MatrixXd>>& attributes, int64_t& exact, int64_t& outside) const {
+
+    /* Components are interpolated independently and then arranged into the attribute matrix, symmetric tensors being expanded. */
+
+    static const int SYMMETRIC_LOWER[9] = {0, 1, 3, 1, 2, 4, 3, 4, 5};
+    static const int SYMMETRIC_UPPER[9] = {0, 1, 2, 1, 3, 4, 2, 4, 5};
+
+    const int64_t nx = image.getDimensions()[0];
+    const int64_t ny = image.getDimensions()[1];
+    const int64_t nz = image.getDimensions()[2];
+    const int64_t volume = image.getNumberOfVoxels();
+    const int64_t components = image.getNumberOfComponents();
+    const int* symmetric = image.getIntent() == FEATK_NIFTI_INTENT_SYMMATRIX ? SYMMETRIC_LOWER : SYMMETRIC_UPPER;
+    const Matrix<double, 3, 4> worldToIndex = image.getWorldToIndex();
+
+    const unsigned int rows = components == 1 ? 1 : 3;
+    const unsigned int cols = components <= 3 ? 1 : 3;
+
+    Index numberOfPoints = points.size();
+    int64_t numberOfExact = 0;
+    int64_t numberOfOutside = 0;
+
+    #pragma omp parallel for reduction(+:numberOfExact,numberOfOutside)
+    for (Index p=0; p<numberOfPoints; p++) {
+
+        Vector3d index = worldToIndex.leftCols<3>()*points[p]+worldToIndex.col(3);
+        Vector3d rounded = index.array().round();
+
+        double values[9];
+        std::fill(values, values+9, this->outsideValue);
+
+        bool inside = index(0) > -0.5 && index(0) < nx-0.5 && index(1) > -0.5 && index(1) < ny-0.5 && index(2) > -0.5 && index(2) < nz-0.5;
+
+        if (!inside) {
+
+            numberOfOutside++;
+        }
+
+        else if ((index-rounded).cwiseAbs().maxCoeff() < 1e-6) {
+
+            /* Exact index mapping, no interpolation */
+
+            int64_t voxel = int64_t(rounded(0)) + nx*(int64_t(rounded(1)) + ny*int64_t(rounded(2)));
+
+            for (int64_t c=0; c!=components; c++) {
+
+                values[c] = image.scale(double(image.getVoxel<VoxelType>(voxel+c*volume)));
+            }
+
+            numberOfExact++;
+        }
+
+        else {
+
+            /* Trilinear interpolation, clamped at the borders */
+
+            int64_t i0[3];
+            int64_t i1[3];
+            double w[3];
+            const int64_t n[3] = {nx, ny, nz};
+
+            for (int a=0; a!=3; a++) {
+
+                double t = std::min(std::max(index(a), 0.0), double(n[a]-1));
+                i0[a] = std::min(int64_t(t), std::max(n[a]-2, int64_t(0)));
+                i1[a] = std::min(i0[a]+1, n[a]-1);
+                w[a] = t-i0[a];
+            }
+
+            for (int64_t c=0; c!=components; c++) {
+
+                double value = 0.0;
+
+                for (int corner=0; corner!=8; corner++) {
+
+                    int64_t x = corner & 1 ? i1[0] : i0[0];
+                    int64_t y = corner & 2 ? i1[1] : i0[1];
+                    int64_t z = corner & 4 ? i1[2] : i0[2];
+                    double weight = (corner & 1 ? w[0] : 1.0-w[0])*(corner & 2 ? w[1] : 1.0-w[1])*(corner & 4 ? w[2] : 1.0-w[2]);
+
+                    if (weight != 0.0) {
+
+                        int64_t voxel = x + nx*(y + ny*z);
+                        value += weight*double(image.getVoxel<VoxelType>(voxel+c*volume));
+                    }
+                }
+
+                values[c] = image.scale(value);
+            }
+        }
+
+        std::shared_ptr<MatrixXd> attribute = std::make_shared<MatrixXd>(rows, cols);
+
+        for (unsigned int i=0; i!=rows*cols; i++) {
+
+            (*attribute)(i/cols, i%cols) = components == 6 ? values[symmetric[i]] : values[i];
+        }
+
+        attributes[p] = attribute;
+    }
+
+    exact = numberOfExact;
+    outside = numberOfOutside;
+}
+
+void featkNIfTIImageSampler::setAttributeName(std::string name) {
+
+    this->attributeName = name;
+}
+
+void featkNIfTIImageSampler::setFileName(std::string fileName) {
+
+    this->fileName = fileName;
+}
+
+void featkNIfTIImageSampler::setOutsideValue(double value) {
+
+    this->outsideValue = value;
+}
+
+void featkNIfTIImageSampler::setSamplingLocationToElements() {
+
+    this->sampleNodes = false;
+}
+
+void featkNIfTIImageSampler::setSamplingLocationToNodes() {
+
+    this->sampleNodes = true;
+}
@@ -0,0 +1,87 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkNIfTIImageSampler.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkNIfTIImageSampler
+ *
+ * @brief Sampler of NIfTI images onto featkMesh node or element attributes.
+ *
+ * featkNIfTIImageSampler reads a NIfTI-1 or NIfTI-2 image with
+ * featkNIfTIImage and samples it onto the element barycenters (default) or
+ * the nodes of its input mesh, in parallel, storing the result as the
+ * attribute named after setAttributeName(). Scalar images give order 0
+ * attributes, 3-component images order 1 attributes, and 6- or 9-component
+ * images order 2 attributes, the components being stored along the 4th
+ * and/or 5th image dimensions. The 6 components of symmetric tensors are read in lower
+ * triangular order (xx, yx, yy, zx, zy, zz) for NIFTI_INTENT_SYMMATRIX
+ * images and in upper triangular order (xx, xy, xz, yy, yz, zz), as written
+ * by FSL, otherwise.
+ *
+ * Mesh coordinates are mapped to voxel indices through the inverse of the
+ * image sform, or qform, or else pixdim scaling. Sample points lying on
+ * voxel centers, e.g. the nodes of a featk3DGridSource mesh with the image
+ * spacing and origin, take the voxel value exactly, without interpolation,
+ * other points are trilinearly interpolated. Points lying more than half a
+ * voxel outside the image take the value set by setOutsideValue() (0.0 by
+ * default).
+ *
+ * @warning Tensor components are taken as is and not reoriented to the
+ * mesh frame.
+ *
+ */
+
+#ifndef FEATKNIFTIIMAGESAMPLER_H
+#define FEATKNIFTIIMAGESAMPLER_H
+
+#include <featk/algorithm/featkMeshConsumerBase.h>
+#include <featk/core/featkGlobal.h>
+#include <featk/core/featkNIfTIImage.h>
+#include <featk/geometry/featkMesh.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class FEATK_EXPORT featkNIfTIImageSampler : public featkMeshConsumerBase<3> {
+
+    public:
+
+        featkNIfTIImageSampler();
+        ~featkNIfTIImageSampler();
+
+        void execute();
+
+        void setAttributeName(std::string name);
+        void setFileName(std::string fileName);
+        void setOutsideValue(double value);
+        void setSamplingLocationToElements();
+        void setSamplingLocationToNodes();
+
+    private:
+
+        template<typename VoxelType> void sample(const featkNIfTIImage& image, const std::vector<AttributeValueType<3, 1>>& points, std::vector<std::shared_ptr<MatrixXd>>& attributes, int64_t& exact, int64_t& outside) const;
+
+        std::string attributeName;
+        std::string fileName;
+        double outsideValue;
+        bool sampleNodes;
+};
+
+#endif // FEATKNIFTIIMAGESAMPLER_H
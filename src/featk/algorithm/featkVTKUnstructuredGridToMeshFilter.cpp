@@ -5,9 +5,48 @@
 
 #include <vtkCellArray.h>
 #include <vtkCellData.h>
+#include <vtkDoubleArray.h>
 #include <vtkPointData.h>
 #include <vtkPoints.h>
 
+std::vector<std::shared_ptr<MatrixXd>> featkVTKUnstructuredGridToMeshFilter<3>::getAttributes(vtkDataArray* array, const std::vector<vtkIdType>& ids, unsigned int order) const {
+
+    /* vtkDoubleArray values are read in parallel in place, other arrays through the generic, non thread-safe, vtkDataArray interface. */
+
+    int numberOfComponents = array->GetNumberOfComponents();
+    unsigned int rows = POWER(3, order/2+order%2);
+    unsigned int cols = POWER(3, order/2);
+
+    vtkIdType numberOfItems = ids.size();
+    std::vector<std::shared_ptr<MatrixXd>> attributes(numberOfItems);
+
+    vtkDoubleArray* doubleArray = vtkDoubleArray::SafeDownCast(array);
+
+    if (doubleArray != nullptr) {
+
+        const double* values = doubleArray->GetPointer(0);
+
+        #pragma omp parallel for
+        for (vtkIdType i=0; i<numberOfItems; i++) {
+
+            attributes[i] = std::make_shared<MatrixXd>(Map<const Matrix<double, Dynamic, Dynamic, RowMajor>>(values+ids[i]*numberOfComponents, rows, cols));
+        }
+    }
+
+    else {
+
+        Matrix<double, Dynamic, Dynamic, RowMajor> value(rows, cols);
+
+        for (vtkIdType i=0; i!=numberOfItems; i++) {
+
+            array->GetTuple(ids[i], value.data());
+            attributes[i] = std::make_shared<MatrixXd>(value);
+        }
+    }
+
+    return attributes;
+}
+
 void featkVTKUnstructuredGridToMeshFilter<3>::execute() {
 
     if (this->input != nullptr) {
@@ -42,27 +81,53 @@ void featkVTKUnstructuredGridToMeshFilter<3>::execute() {
         }
 
 
-        // Nodes
+        // Nodes, point index to node remapping through a vector
 
         std::vector<featkNode<3>*> nodes;
-        std::map<vtkIdType, featkNode<3>*> map;
-        size_t id = 0;
+        std::vector<featkNode<3>*> map(numberOfPoints, nullptr);
+        std::vector<vtkIdType> usedPoints;  // Node index to point index
 
         for (vtkIdType n=0; n!=numberOfPoints; n++) {
 
             if (used[n]) {
 
+                usedPoints.push_back(n);
+            }
+        }
+
+        vtkIdType numberOfUsedPoints = usedPoints.size();
+        nodes.resize(numberOfUsedPoints);
+
+        vtkDoubleArray* pointArray = vtkDoubleArray::SafeDownCast(points->GetData());
+
+        if (pointArray != nullptr) {
+
+            const double* point = pointArray->GetPointer(0);
+
+            #pragma omp parallel for
+            for (vtkIdType n=0; n<numberOfUsedPoints; n++) {
+
+                const double* coordinates = point+3*usedPoints[n];
+                nodes[n] = new featkNode<3>(n, (AttributeValueType<3, 1>() << coordinates[0], coordinates[1], coordinates[2]).finished());
+            }
+        }
+
+        else {
+
+            for (vtkIdType n=0; n!=numberOfUsedPoints; n++) {
+
                 double point[3];
-                points->GetPoint(n, point);
+                points->GetPoint(usedPoints[n], point);
 
-                featkNode<3>* node = new featkNode<3>(id, (AttributeValueType<3, 1>() << point[0], point[1], point[2]).finished());
-                nodes.push_back(node);
-                map[n] = node;
-                id++;
+                nodes[n] = new featkNode<3>(n, (AttributeValueType<3, 1>() << point[0], point[1], point[2]).finished());
             }
         }
 
-        size_t numberOfUsedPoints = nodes.size();
+        for (vtkIdType n=0; n!=numberOfUsedPoints; n++) {
+
+            map[usedPoints[n]] = nodes[n];
+        }
+
         cout << "featkVTKUnstructuredGridToMeshFilter: " << (numberOfPoints-numberOfUsedPoints) << "/" << numberOfPoints << " points unused." << endl;
 
 
@@ -129,22 +194,8 @@ void featkVTKUnstructuredGridToMeshFilter<3>::execute() {
                 if (IS_POWER(numberOfComponents, 3)) {
 
                     unsigned int order = LOG(numberOfComponents, 3);
-                    VectorXd values(numberOfUsedPoints*numberOfComponents, 1);
-                    id = 0;
 
-                    for (vtkIdType j=0; j!=numberOfPoints; j++) {
-
-                        if (used[j]) {
-
-                            for (int k=0; k!=numberOfComponents; k++) {
-
-                                values[id] = array->GetComponent(j, k);
-                                id++;
-                            }
-                        }
-                    }
-
-                    mesh->setNodeAttributeFromValues(name, order, values);
+                    mesh->setNodeAttributes(name, order, this->getAttributes(array, usedPoints, order));
                 }
             }
         }
@@ -154,31 +205,27 @@ void featkVTKUnstructuredGridToMeshFilter<3>::execute() {
 
         vtkCellData* cellData = this->input->GetCellData();
 
+        std::vector<vtkIdType> cellIDs(numberOfCells);
+
+        for (vtkIdType j=0; j!=numberOfCells; j++) {
+
+            cellIDs[j] = j;
+        }
+
         for (int i=0; i!=cellData->GetNumberOfArrays(); i++) {
 
             vtkDataArray* array = cellData->GetArray(i);
             std::string name = array->GetName();
 
-            if (this->passAllAttributes || find(this->elementAttributesToPass.begin(), this->elementAttributesToPass.end(), name) != this->elementAttributesToPass.end()) {
+            if (this->passAllAttributes || this->elementAttributesToPass.count(name)) {
 
                 int numberOfComponents = array->GetNumberOfComponents();
 
                 if (IS_POWER(numberOfComponents, 3)) {
 
                     unsigned int order = LOG(numberOfComponents, 3);
-                    VectorXd values(numberOfCells*numberOfComponents);
-                    id = 0;
-
-                    for (vtkIdType j=0; j!=numberOfCells; j++) {
-
-                        for (int k=0; k!=numberOfComponents; k++) {
-
-                            values[id] = array->GetComponent(j, k);
-                            id++;
-                        }
-                    }
 
-                    mesh->setElementAttributeFromValues(name, order, values);
+                    mesh->setElementAttributes(name, order, this->getAttributes(array, cellIDs, order));
                 }
             }
         }
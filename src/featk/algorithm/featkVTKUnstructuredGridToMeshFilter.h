@@ -31,6 +31,9 @@
  * and vtkCellData arrays into featkNode and featkElement attributes
  * respectively.
  *
+ * Points are remapped to nodes through vectors, and vtkDoubleArray points
+ * and attributes are read in place and converted in parallel.
+ *
  * @warning For now, only 3D vtkUnstructuredGrid with VTK_TETRA and/or
  * VTK_HEXAHEDRON cells are supported.
  *
@@ -45,7 +48,9 @@
 #include <featk/core/featkGlobal.h>
 #include <featk/geometry/featkMesh.h>
 
+#include <memory>
 #include <set>
+#include <vector>
 #include <vtkSmartPointer.h>
 #include <vtkUnstructuredGrid.h>
 
@@ -67,6 +72,8 @@ class featkVTKUnstructuredGridToMeshFilter : public featkMeshProducerBase<Dimens
 
     private:
 
+        std::vector<std::shared_ptr<MatrixXd>> getAttributes(vtkDataArray* array, const std::vector<vtkIdType>& ids, unsigned int order) const;
+
         std::set<std::string> elementAttributesToPass;
         vtkSmartPointer<vtkUnstructuredGrid> input;
         std::set<std::string> nodeAttributesToPass;
@@ -0,0 +1,668 @@
+#include <featk/algorithm/featkVTUReader.h>
+#include <featk/core/featkDefines.h>
+#include <featk/geometry/featkHex8Element.h>
+#include <featk/geometry/featkNode.h>
+#include <featk/geometry/featkTet4Element.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+
+#ifdef FEATK_USE_ZLIB
+#include <zlib.h>
+#endif
+
+static const int64_t FEATK_VTK_TETRA = 10;
+static const int64_t FEATK_VTK_HEXAHEDRON = 12;
+static const uint64_t FEATK_ZLIB_MAXIMUM_RATIO = 1032;  // Upper bound of the deflate compression ratio
+
+featkVTUReader::featkVTUReader() {
+
+    this->passAllAttributes = true;
+    this->appendedData = nullptr;
+    this->compressed = false;
+    this->headerSize = sizeof(uint32_t);
+}
+
+featkVTUReader::~featkVTUReader() {
+
+}
+
+template<typename InputType, typename OutputType>
+void featkVTUReader::convert(const unsigned char* data, size_t count, OutputType* values) const {
+
+    /* Appended arrays are not aligned. */
+
+    for (size_t i=0; i!=count; i++) {
+
+        InputType value;
+        std::memcpy(&value, data+i*sizeof(InputType), sizeof(InputType));
+        values[i] = OutputType(value);
+    }
+}
+
+template<typename OutputType>
+bool featkVTUReader::decode(const featkVTUDataArray& array, std::vector<OutputType>& values) const {
+
+    std::vector<unsigned char> buffer;
+    const unsigned char* data;
+    uint64_t size;
+
+    if (!this->getBytes(array.offset, buffer, data, size)) {
+
+        return false;
+    }
+
+    std::string type = array.type;
+
+    size_t typeSize = type == "Int8" || type == "UInt8" ? 1 : type == "Int16" || type == "UInt16" ? 2 : type == "Int32" || type == "UInt32" || type == "Float32" ? 4 : type == "Int64" || type == "UInt64" || type == "Float64" ? 8 : 0;
+
+    if (typeSize == 0) {
+
+        return false;
+    }
+
+    size_t count = size/typeSize;
+    values.resize(count);
+
+    if      (type == "Int8")    this->convert<int8_t, OutputType>(data, count, values.data());
+    else if (type == "UInt8")   this->convert<uint8_t, OutputType>(data, count, values.data());
+    else if (type == "Int16")   this->convert<int16_t, OutputType>(data, count, values.data());
+    else if (type == "UInt16")  this->convert<uint16_t, OutputType>(data, count, values.data());
+    else if (type == "Int32")   this->convert<int32_t, OutputType>(data, count, values.data());
+    else if (type == "UInt32")  this->convert<uint32_t, OutputType>(data, count, values.data());
+    else if (type == "Int64")   this->convert<int64_t, OutputType>(data, count, values.data());
+    else if (type == "UInt64")  this->convert<uint64_t, OutputType>(data, count, values.data());
+    else if (type == "Float32") this->convert<float, OutputType>(data, count, values.data());
+    else                        this->convert<double, OutputType>(data, count, values.data());
+
+    return true;
+}
+
+void featkVTUReader::execute() {
+
+    std::vector<featkVTUDataArray> arrays;
+    size_t numberOfPoints;
+    size_t numberOfCells;
+
+    if (!this->file.open(this->fileName) || !this->parse(arrays, numberOfPoints, numberOfCells)) {
+
+        this->file.close();
+        return;
+    }
+
+
+    // Selection
+
+    std::vector<featkVTUDataArray> selectedArrays;
+
+    for (const featkVTUDataArray& array : arrays) {
+
+        bool selected = array.section == "Points" || array.section == "Cells";
+
+        if (array.section == "PointData" || array.section == "CellData") {
+
+            const std::set<std::string>& attributesToPass = array.section == "PointData" ? this->nodeAttributesToPass : this->elementAttributesToPass;
+
+            selected = (this->passAllAttributes || attributesToPass.count(array.name)) && IS_POWER(array.components, 3);
+        }
+
+        if (selected) {
+
+            selectedArrays.push_back(array);
+        }
+    }
+
+
+    // Parallel decoding
+
+    Index numberOfArrays = selectedArrays.size();
+    std::vector<std::vector<double>> realValues(numberOfArrays);
+    std::vector<std::vector<int64_t>> integerValues(numberOfArrays);
+    std::vector<char> decoded(numberOfArrays);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (Index a=0; a<numberOfArrays; a++) {
+
+        decoded[a] = selectedArrays[a].section == "Cells" ? this->decode(selectedArrays[a], integerValues[a]) : this->decode(selectedArrays[a], realValues[a]);
+    }
+
+    const std::vector<double>* points = nullptr;
+    const std::vector<int64_t>* connectivity = nullptr;
+    const std::vector<int64_t>* offsets = nullptr;
+    const std::vector<int64_t>* types = nullptr;
+
+    for (Index a=0; a!=numberOfArrays; a++) {
+
+        if (!decoded[a]) {
+
+            std::cout << "featkVTUReader: Error: Data array " << selectedArrays[a].name << " could not be decoded." << std::endl;
+            this->file.close();
+            return;
+        }
+
+        const featkVTUDataArray& array = selectedArrays[a];
+
+        if (array.section == "Points") {
+
+            points = &realValues[a];
+        }
+
+        else if (array.name == "connectivity") {
+
+            connectivity = &integerValues[a];
+        }
+
+        else if (array.name == "offsets") {
+
+            offsets = &integerValues[a];
+        }
+
+        else if (array.name == "types") {
+
+            types = &integerValues[a];
+        }
+    }
+
+    this->file.close();
+
+    if (points == nullptr || connectivity == nullptr || offsets == nullptr || types == nullptr || points->size() != 3*numberOfPoints || offsets->size() != numberOfCells || types->size() != numberOfCells) {
+
+        std::cout << "featkVTUReader: Error: Missing or inconsistent points or cells." << std::endl;
+        return;
+    }
+
+
+    // Supported cells and used points
+
+    std::vector<size_t> cells;
+    std::vector<int64_t> map(numberOfPoints, -1);  // Point index to node index
+
+    for (size_t c=0; c!=numberOfCells; c++) {
+
+        int64_t begin = c == 0 ? 0 : (*offsets)[c-1];
+        int64_t end = (*offsets)[c];
+
+        bool valid = ((*types)[c] == FEATK_VTK_TETRA && end-begin == 4) || ((*types)[c] == FEATK_VTK_HEXAHEDRON && end-begin == 8);
+        valid = valid && begin >= 0 && end <= int64_t(connectivity->size());
+
+        for (int64_t j=begin; valid && j!=end; j++) {
+
+            valid = (*connectivity)[j] >= 0 && (*connectivity)[j] < int64_t(numberOfPoints);
+        }
+
+        if (valid) {
+
+            cells.push_back(c);
+
+            for (int64_t j=begin; j!=end; j++) {
+
+                map[(*connectivity)[j]] = 0;
+            }
+        }
+    }
+
+    if (cells.size() != numberOfCells) {
+
+        std::cout << "featkVTUReader: Warning: " << (numberOfCells-cells.size()) << "/" << numberOfCells << " unsupported or invalid cells discarded." << std::endl;
+    }
+
+    std::vector<size_t> usedPoints;  // Node index to point index
+
+    for (size_t p=0; p!=numberOfPoints; p++) {
+
+        if (map[p] != -1) {
+
+            map[p] = usedPoints.size();
+            usedPoints.push_back(p);
+        }
+    }
+
+    std::cout << "featkVTUReader: " << (numberOfPoints-usedPoints.size()) << "/" << numberOfPoints << " points unused." << std::endl;
+
+
+    // Nodes
+
+    Index numberOfNodes = usedPoints.size();
+    std::vector<featkNode<3>*> nodes(numberOfNodes);
+
+    #pragma omp parallel for
+    for (Index n=0; n<numberOfNodes; n++) {
+
+        const double* point = points->data()+3*usedPoints[n];
+        nodes[n] = new featkNode<3>(n, (AttributeValueType<3, 1>() << point[0], point[1], point[2]).finished());
+    }
+
+
+    // Elements
+
+    std::vector<featkElementInterface<3>*> elements(cells.size());
+
+    for (size_t e=0; e!=cells.size(); e++) {
+
+        int64_t begin = cells[e] == 0 ? 0 : (*offsets)[cells[e]-1];
+        int64_t end = (*offsets)[cells[e]];
+
+        std::vector<featkNode<3>*> elementNodes;
+
+        for (int64_t j=begin; j!=end; j++) {
+
+            elementNodes.push_back(nodes[map[(*connectivity)[j]]]);
+        }
+
+        if ((*types)[cells[e]] == FEATK_VTK_TETRA) {
+
+            elements[e] = new featkTet4Element(elementNodes);
+        }
+
+        else {
+
+            elements[e] = new featkHex8Element(elementNodes);
+        }
+    }
+
+
+    // Mesh
+
+    featkMesh<3>* mesh = new featkMesh<3>(nodes, elements);
+
+
+    // Node and element attributes
+
+    for (Index a=0; a!=numberOfArrays; a++) {
+
+        const featkVTUDataArray& array = selectedArrays[a];
+
+        if (array.section != "PointData" && array.section != "CellData") {
+
+            continue;
+        }
+
+        bool node = array.section == "PointData";
+        const std::vector<size_t>& items = node ? usedPoints : cells;
+
+        if (realValues[a].size() != (node ? numberOfPoints : numberOfCells)*array.components) {
+
+            std::cout << "featkVTUReader: Warning: Data array " << array.name << " has an invalid size, attribute ignored." << std::endl;
+            continue;
+        }
+
+        unsigned int order = LOG(array.components, 3);
+        unsigned int rows = POWER(3, order/2+order%2);
+        unsigned int cols = POWER(3, order/2);
+
+        Index numberOfItems = items.size();
+        std::vector<std::shared_ptr<MatrixXd>> attributes(numberOfItems);
+
+        #pragma omp parallel for
+        for (Index i=0; i<numberOfItems; i++) {
+
+            attributes[i] = std::make_shared<MatrixXd>(Map<const Matrix<double, Dynamic, Dynamic, RowMajor>>(realValues[a].data()+items[i]*array.components, rows, cols));
+        }
+
+        if (node) {
+
+            mesh->setNodeAttributes(array.name, order, attributes);
+        }
+
+        else {
+
+            mesh->setElementAttributes(array.name, order, attributes);
+        }
+    }
+
+
+    // Output
+
+    this->outputMeshes[0] = mesh;
+}
+
+bool featkVTUReader::getBytes(uint64_t offset, std::vector<unsigned char>& buffer, const unsigned char*& data, uint64_t& size) const {
+
+    /*
+        Raw arrays are returned in place, compressed ones being inflated into buffer. Headers are
+        [byte count] or [number of blocks, block size, last block size if partial else 0, compressed
+        size of each block], in UInt32 or UInt64 according to header_type.
+    */
+
+    const unsigned char* end = this->file.getData()+this->file.getSize();
+    const unsigned char* header = this->appendedData+offset;
+
+    if (offset > uint64_t(end-this->appendedData) || uint64_t(end-header) < this->headerSize) {
+
+        return false;
+    }
+
+    if (!this->compressed) {
+
+        size = this->getHeaderValue(header, 0);
+        data = header+this->headerSize;
+
+        return size <= uint64_t(end-data);
+    }
+
+    #ifdef FEATK_USE_ZLIB
+
+    uint64_t numberOfBlocks = this->getHeaderValue(header, 0);
+
+    if (uint64_t(end-header)/this->headerSize < 3 || numberOfBlocks > uint64_t(end-header)/this->headerSize-3) {
+
+        return false;
+    }
+
+    uint64_t blockSize = this->getHeaderValue(header, 1);
+    uint64_t lastBlockSize = this->getHeaderValue(header, 2);
+    uint64_t remainingSize = uint64_t(end-header)-(3+numberOfBlocks)*this->headerSize;
+
+    if (lastBlockSize > blockSize) {
+
+        return false;
+    }
+
+    // Blocks are checked against the remaining data before allocating, no block inflating more than FEATK_ZLIB_MAXIMUM_RATIO times its compressed size
+
+    for (uint64_t b=0; b!=numberOfBlocks; b++) {
+
+        uint64_t compressedSize = this->getHeaderValue(header, 3+b);
+        uint64_t uncompressedSize = b+1 == numberOfBlocks && lastBlockSize != 0 ? lastBlockSize : blockSize;
+
+        if (compressedSize > remainingSize || uncompressedSize/FEATK_ZLIB_MAXIMUM_RATIO > compressedSize) {
+
+            return false;
+        }
+
+        remainingSize -= compressedSize;
+    }
+
+    size = numberOfBlocks == 0 ? 0 : (numberOfBlocks-1)*blockSize + (lastBlockSize != 0 ? lastBlockSize : blockSize);
+    buffer.resize(size);
+
+    const unsigned char* block = header+(3+numberOfBlocks)*this->headerSize;
+    uint64_t position = 0;
+
+    for (uint64_t b=0; b!=numberOfBlocks; b++) {
+
+        uint64_t compressedSize = this->getHeaderValue(header, 3+b);
+        uLongf uncompressedSize = uLongf(size-position);
+
+        if (uncompress(buffer.data()+position, &uncompressedSize, block, uLong(compressedSize)) != Z_OK) {
+
+            return false;
+        }
+
+        block += compressedSize;
+        position += uncompressedSize;
+    }
+
+    data = buffer.data();
+
+    return position == size;
+
+    #else
+
+    std::cout << "featkVTUReader: Error: featk built without zlib, compressed arrays cannot be read." << std::endl;
+    return false;
+
+    #endif
+}
+
+uint64_t featkVTUReader::getHeaderValue(const unsigned char* data, size_t index) const {
+
+    if (this->headerSize == sizeof(uint64_t)) {
+
+        uint64_t value;
+        std::memcpy(&value, data+index*sizeof(uint64_t), sizeof(uint64_t));
+        return value;
+    }
+
+    uint32_t value;
+    std::memcpy(&value, data+index*sizeof(uint32_t), sizeof(uint32_t));
+    return value;
+}
+
+std::map<std::string, std::string> featkVTUReader::getTagAttributes(const std::string& tag) const {
+
+    std::map<std::string, std::string> attributes;
+    size_t position = 0;
+
+    while (true) {
+
+        size_t equal = tag.find('=', position);
+
+        if (equal == std::string::npos) {
+
+            break;
+        }
+
+        size_t keyEnd = tag.find_last_not_of(" \t\r\n", equal-1);
+        size_t keyBegin = tag.find_last_of(" \t\r\n", keyEnd);
+        size_t valueBegin = tag.find_first_of("\"'", equal);
+
+        if (keyEnd == std::string::npos || valueBegin == std::string::npos) {
+
+            break;
+        }
+
+        size_t valueEnd = tag.find(tag[valueBegin], valueBegin+1);
+
+        if (valueEnd == std::string::npos) {
+
+            break;
+        }
+
+        std::string key = tag.substr(keyBegin == std::string::npos ? 0 : keyBegin+1, keyEnd-(keyBegin == std::string::npos ? 0 : keyBegin+1)+1);
+        attributes[key] = this->getUnescapedName(tag.substr(valueBegin+1, valueEnd-valueBegin-1));
+
+        position = valueEnd+1;
+    }
+
+    return attributes;
+}
+
+std::string featkVTUReader::getUnescapedName(std::string name) const {
+
+    static const std::pair<std::string, std::string> entities[5] = {{"&lt;", "<"}, {"&gt;", ">"}, {"&quot;", "\""}, {"&apos;", "'"}, {"&amp;", "&"}};
+
+    std::string unescapedName;
+    size_t position = 0;
+
+    while (position < name.size()) {
+
+        bool replaced = false;
+
+        if (name[position] == '&') {
+
+            for (const auto& entity : entities) {
+
+                if (name.compare(position, entity.first.size(), entity.first) == 0) {
+
+                    unescapedName += entity.second;
+                    position += entity.first.size();
+                    replaced = true;
+                    break;
+                }
+            }
+        }
+
+        if (!replaced) {
+
+            unescapedName += name[position];
+            position++;
+        }
+    }
+
+    return unescapedName;
+}
+
+bool featkVTUReader::getUnsignedValue(std::string text, uint64_t& value) const {
+
+    /* Unlike std::stoull(), which throws, empty, negative, partially numeric or out of range values are rejected. */
+
+    const char* begin = text.c_str();
+    char* end;
+
+    errno = 0;
+    value = std::strtoull(begin, &end, 10);
+
+    return !text.empty() && text.find('-') == std::string::npos && end == begin+text.size() && errno != ERANGE;
+}
+
+bool featkVTUReader::parse(std::vector<featkVTUDataArray>& arrays, size_t& numberOfPoints, size_t& numberOfCells) {
+
+    /* Only the XML before the appended data is parsed, tag by tag. */
+
+    const char* text = reinterpret_cast<const char*>(this->file.getData());
+    const char* end = text+this->file.getSize();
+
+    std::string marker = "<AppendedData";
+    const char* appended = std::search(text, end, marker.begin(), marker.end());
+    const char* underscore = appended == end ? end : std::find(appended, end, '_');
+
+    if (underscore == end) {
+
+        std::cout << "featkVTUReader: Error: " << this->fileName << " has no appended data." << std::endl;
+        return false;
+    }
+
+    this->appendedData = reinterpret_cast<const unsigned char*>(underscore+1);
+
+    std::string xml(text, underscore);
+    std::string section;
+    unsigned int numberOfPieces = 0;
+    size_t position = 0;
+
+    numberOfPoints = 0;
+    numberOfCells = 0;
+
+    while ((position = xml.find('<', position)) != std::string::npos) {
+
+        size_t tagEnd = xml.find('>', position);
+        std::string tag = xml.substr(position+1, tagEnd == std::string::npos ? std::string::npos : tagEnd-position-1);
+        position = tagEnd == std::string::npos ? xml.size() : tagEnd+1;
+
+        if (tag.empty() || tag[0] == '?' || tag[0] == '!' || tag[0] == '/') {
+
+            continue;
+        }
+
+        std::string name = tag.substr(0, tag.find_first_of(" \t\r\n/"));
+        std::map<std::string, std::string> attributes = this->getTagAttributes(tag);
+
+        if (name == "VTKFile") {
+
+            uint16_t one = 1;
+            std::string byteOrder = *reinterpret_cast<unsigned char*>(&one) == 1 ? "LittleEndian" : "BigEndian";
+
+            if (attributes["type"] != "UnstructuredGrid" || attributes["byte_order"] != byteOrder) {
+
+                std::cout << "featkVTUReader: Error: Only unstructured grids in native byte order are supported." << std::endl;
+                return false;
+            }
+
+            this->headerSize = attributes["header_type"] == "UInt64" ? sizeof(uint64_t) : sizeof(uint32_t);
+            this->compressed = !attributes["compressor"].empty();
+
+            if (this->compressed && attributes["compressor"] != "vtkZLibDataCompressor") {
+
+                std::cout << "featkVTUReader: Error: Unsupported compressor " << attributes["compressor"] << "." << std::endl;
+                return false;
+            }
+        }
+
+        else if (name == "Piece") {
+
+            uint64_t points;
+            uint64_t cells;
+
+            if (!this->getUnsignedValue(attributes.count("NumberOfPoints") ? attributes["NumberOfPoints"] : "0", points) || !this->getUnsignedValue(attributes.count("NumberOfCells") ? attributes["NumberOfCells"] : "0", cells)) {
+
+                std::cout << "featkVTUReader: Error: Invalid number of points or cells." << std::endl;
+                return false;
+            }
+
+            numberOfPieces++;
+            numberOfPoints = size_t(points);
+            numberOfCells = size_t(cells);
+        }
+
+        else if (name == "PointData" || name == "CellData" || name == "Points" || name == "Cells") {
+
+            section = name;
+        }
+
+        else if (name == "DataArray") {
+
+            if (attributes["format"] != "appended") {
+
+                std::cout << "featkVTUReader: Error: Only appended data arrays are supported." << std::endl;
+                return false;
+            }
+
+            uint64_t components;
+            uint64_t offset;
+
+            if (!this->getUnsignedValue(attributes.count("NumberOfComponents") ? attributes["NumberOfComponents"] : "1", components) || components > std::numeric_limits<unsigned int>::max() || !this->getUnsignedValue(attributes["offset"], offset)) {
+
+                std::cout << "featkVTUReader: Error: Invalid number of components or offset in data array " << attributes["Name"] << "." << std::endl;
+                return false;
+            }
+
+            featkVTUDataArray array;
+            array.section = section;
+            array.name = attributes["Name"];
+            array.type = attributes["type"];
+            array.components = (unsigned int)(components);
+            array.offset = offset;
+
+            arrays.push_back(array);
+        }
+
+        else if (name == "AppendedData" && attributes["encoding"] != "raw") {
+
+            std::cout << "featkVTUReader: Error: Only raw appended data is supported." << std::endl;
+            return false;
+        }
+    }
+
+    if (numberOfPieces != 1) {
+
+        std::cout << "featkVTUReader: Error: Only single piece files are supported." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void featkVTUReader::passAllAttributesOff() {
+
+    this->passAllAttributes = false;
+}
+
+void featkVTUReader::passAllAttributesOn() {
+
+    this->passAllAttributes = true;
+}
+
+void featkVTUReader::setElementAttributesToPass(std::set<std::string> attributes) {
+
+    this->elementAttributesToPass = attributes;
+}
+
+void featkVTUReader::setFileName(std::string fileName) {
+
+    this->fileName = fileName;
+}
+
+void featkVTUReader::setNodeAttributesToPass(std::set<std::string> attributes) {
+
+    this->nodeAttributesToPass = attributes;
+}
+
+void featkVTUReader::setPassAllAttributes(bool pass) {
+
+    this->passAllAttributes = pass;
+}
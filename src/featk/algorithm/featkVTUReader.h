@@ -0,0 +1,107 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkVTUReader.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkVTUReader
+ *
+ * @brief Reader of featkMesh from VTK XML unstructured grid files without
+ * VTK.
+ *
+ * featkVTUReader produces a featkMesh from a .vtu file with appended raw
+ * binary data, as written by featkVTUWriter or by VTK and ParaView with
+ * appended data encoding turned off, without depending on VTK as
+ * featkVTKUnstructuredGridToMeshFilter does.
+ *
+ * The file is memory mapped, and the points, cells and selected point and
+ * cell data arrays are decoded in parallel, zlib compressed arrays being
+ * supported if featk is built with FEATK_USE_ZLIB defined. As for
+ * featkVTKUnstructuredGridToMeshFilter, unused points are discarded and
+ * only the data arrays selected with setNodeAttributesToPass() and
+ * setElementAttributesToPass(), or all of them if passAllAttributesOn() is
+ * set, whose number of components is a power of 3 are passed.
+ *
+ * @warning For now, only single piece files with VTK_TETRA and/or
+ * VTK_HEXAHEDRON cells are supported, other cells being discarded, and
+ * inline or base64 encoded data arrays are not.
+ *
+ */
+
+#ifndef FEATKVTUREADER_H
+#define FEATKVTUREADER_H
+
+#include <featk/algorithm/featkMeshProducerBase.h>
+#include <featk/core/featkGlobal.h>
+#include <featk/core/featkMemoryMappedFile.h>
+#include <featk/geometry/featkMesh.h>
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+class FEATK_EXPORT featkVTUReader : public featkMeshProducerBase<3> {
+
+    public:
+
+        featkVTUReader();
+        ~featkVTUReader();
+
+        void execute();
+
+        void passAllAttributesOff();
+        void passAllAttributesOn();
+        void setElementAttributesToPass(std::set<std::string> attributes);
+        void setFileName(std::string fileName);
+        void setNodeAttributesToPass(std::set<std::string> attributes);
+        void setPassAllAttributes(bool pass);
+
+    private:
+
+        struct featkVTUDataArray {
+
+            std::string section;  // PointData, CellData, Points or Cells
+            std::string name;
+            std::string type;
+            unsigned int components;
+            uint64_t offset;
+        };
+
+        template<typename InputType, typename OutputType> void convert(const unsigned char* data, size_t count, OutputType* values) const;
+        template<typename OutputType> bool decode(const featkVTUDataArray& array, std::vector<OutputType>& values) const;
+        bool getBytes(uint64_t offset, std::vector<unsigned char>& buffer, const unsigned char*& data, uint64_t& size) const;
+        uint64_t getHeaderValue(const unsigned char* data, size_t index) const;
+        std::map<std::string, std::string> getTagAttributes(const std::string& tag) const;
+        std::string getUnescapedName(std::string name) const;
+        bool getUnsignedValue(std::string text, uint64_t& value) const;
+        bool parse(std::vector<featkVTUDataArray>& arrays, size_t& numberOfPoints, size_t& numberOfCells);
+
+        std::set<std::string> elementAttributesToPass;
+        std::string fileName;
+        std::set<std::string> nodeAttributesToPass;
+        bool passAllAttributes;
+
+        featkMemoryMappedFile file;
+        const unsigned char* appendedData;  // First byte after the '_' marker
+        bool compressed;
+        size_t headerSize;  // 4 for UInt32, 8 for UInt64
+};
+
+#endif // FEATKVTUREADER_H
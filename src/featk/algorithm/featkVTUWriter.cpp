@@ -0,0 +1,379 @@
+#include <featk/algorithm/featkVTUWriter.h>
+#include <featk/core/featkDefines.h>
+#include <featk/geometry/featkNode.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef FEATK_USE_ZLIB
+#include <zlib.h>
+#endif
+
+static const uint64_t FEATK_VTU_BLOCK_SIZE = 32768;  // Uncompressed size of zlib blocks, as in VTK
+static const size_t FEATK_VTU_OFFSET_WIDTH = 29;  // Width of offset="..." with any UInt64 value
+static const uint8_t FEATK_VTK_TETRA = 10;
+static const uint8_t FEATK_VTK_HEXAHEDRON = 12;
+
+featkVTUWriter::featkVTUWriter() {
+
+    this->useCompression = false;
+    this->useSinglePrecision = false;
+}
+
+featkVTUWriter::~featkVTUWriter() {
+
+}
+
+bool featkVTUWriter::encode(const std::vector<unsigned char>& data, std::vector<unsigned char>& block) const {
+
+    /*
+        Raw arrays are preceded by their UInt64 byte count. Compressed arrays are split into blocks of
+        FEATK_VTU_BLOCK_SIZE bytes compressed independently in parallel and preceded by the UInt64 header
+        [number of blocks, block size, last block size if partial else 0, compressed size of each block].
+    */
+
+    #ifdef FEATK_USE_ZLIB
+
+    if (this->useCompression) {
+
+        Index numberOfBlocks = Index((data.size()+FEATK_VTU_BLOCK_SIZE-1)/FEATK_VTU_BLOCK_SIZE);
+        uLong bound = compressBound(uLong(FEATK_VTU_BLOCK_SIZE));
+
+        std::vector<uint64_t> header(3+numberOfBlocks);
+        header[0] = numberOfBlocks;
+        header[1] = FEATK_VTU_BLOCK_SIZE;
+        header[2] = data.size()%FEATK_VTU_BLOCK_SIZE;
+
+        std::vector<unsigned char> compressed(numberOfBlocks*bound);
+        std::vector<char> valid(numberOfBlocks);
+
+        #pragma omp parallel for schedule(dynamic)
+        for (Index b=0; b<numberOfBlocks; b++) {
+
+            uLong blockSize = uLong(std::min<uint64_t>(FEATK_VTU_BLOCK_SIZE, data.size()-b*FEATK_VTU_BLOCK_SIZE));
+            uLongf size = bound;
+
+            valid[b] = compress2(compressed.data()+b*bound, &size, data.data()+b*FEATK_VTU_BLOCK_SIZE, blockSize, Z_DEFAULT_COMPRESSION) == Z_OK;
+            header[3+b] = size;
+        }
+
+        if (std::find(valid.begin(), valid.end(), 0) != valid.end()) {
+
+            return false;
+        }
+
+        block.reserve(header.size()*sizeof(uint64_t) + numberOfBlocks*bound);
+        block.resize(header.size()*sizeof(uint64_t));
+        std::memcpy(block.data(), header.data(), header.size()*sizeof(uint64_t));
+
+        for (Index b=0; b!=numberOfBlocks; b++) {
+
+            block.insert(block.end(), compressed.begin()+b*bound, compressed.begin()+b*bound+header[3+b]);
+        }
+
+        return true;
+    }
+
+    #endif
+
+    uint64_t size = data.size();
+
+    block.resize(sizeof(uint64_t) + data.size());
+    std::memcpy(block.data(), &size, sizeof(uint64_t));
+    std::memcpy(block.data()+sizeof(uint64_t), data.data(), data.size());
+
+    return true;
+}
+
+void featkVTUWriter::execute() {
+
+    featkMesh<3>* inputMesh = this->inputMeshes[0];
+
+    if (inputMesh == nullptr || this->fileName.empty()) {
+
+        std::cout << "featkVTUWriter: Error: No input mesh or file name." << std::endl;
+        return;
+    }
+
+    #ifndef FEATK_USE_ZLIB
+
+    if (this->useCompression) {
+
+        std::cout << "featkVTUWriter: Warning: featk built without zlib, arrays written uncompressed." << std::endl;
+    }
+
+    #endif
+
+    bool compress = false;
+
+    #ifdef FEATK_USE_ZLIB
+    compress = this->useCompression;
+    #endif
+
+    const std::vector<featkNode<3>*>& nodes = inputMesh->getNodes();
+    const std::vector<featkElementInterface<3>*>& elements = inputMesh->getElements();
+
+    std::vector<featkAttributable<3>*> nodeItems(nodes.begin(), nodes.end());
+    std::vector<featkAttributable<3>*> elementItems(elements.begin(), elements.end());
+
+
+    // Node indices, featkNode<Dimension>::id is supposed to match node index in featkMesh<Dimension>::nodes but remap in case
+
+    size_t maximumID = 0;
+
+    for (featkNode<3>* node : nodes) {
+
+        maximumID = std::max(maximumID, node->getID());
+    }
+
+    std::vector<int64_t> indices(nodes.empty() ? 0 : maximumID+1);
+
+    for (size_t n=0; n!=nodes.size(); n++) {
+
+        indices[nodes[n]->getID()] = int64_t(n);
+    }
+
+
+    size_t numberOfCellNodes = 0;
+
+    for (featkElementInterface<3>* element : elements) {
+
+        numberOfCellNodes += element->getElementType() == FEATK_TET4 ? 4 : 8;
+    }
+
+
+    // Arrays
+
+    std::string scalarType = this->useSinglePrecision ? "Float32" : "Float64";
+    std::vector<featkVTUArray> arrays;
+
+    arrays.push_back({FEATK_VTU_POINTS, "Points", 1, 3, "Float64"});
+    arrays.push_back({FEATK_VTU_CONNECTIVITY, "connectivity", 0, 1, "Int64"});
+    arrays.push_back({FEATK_VTU_OFFSETS, "offsets", 0, 1, "Int64"});
+    arrays.push_back({FEATK_VTU_TYPES, "types", 0, 1, "UInt8"});
+
+    for (const auto& pair : inputMesh->getNodeAttributeTable()) {
+
+        if (pair.second.first != 1) {  // Cartesian coordinates are the points
+
+            arrays.push_back({FEATK_VTU_POINT_DATA, pair.first, pair.second.first, POWER(3, pair.second.second), scalarType});
+        }
+    }
+
+    for (const auto& pair : inputMesh->getElementAttributeTable()) {
+
+        arrays.push_back({FEATK_VTU_CELL_DATA, pair.first, pair.second.first, POWER(3, pair.second.second), scalarType});
+    }
+
+
+    // XML header, offsets being written as blank fixed width fields patched once the arrays are written
+
+    uint16_t one = 1;
+    std::string byteOrder = *reinterpret_cast<unsigned char*>(&one) == 1 ? "LittleEndian" : "BigEndian";
+
+    std::string xml = "<?xml version=\"1.0\"?>\n";
+    xml += "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"" + byteOrder + "\" header_type=\"UInt64\"" + (compress ? " compressor=\"vtkZLibDataCompressor\"" : "") + ">\n";
+    xml += "  <UnstructuredGrid>\n";
+    xml += "    <Piece NumberOfPoints=\"" + std::to_string(nodes.size()) + "\" NumberOfCells=\"" + std::to_string(elements.size()) + "\">\n";
+
+    std::vector<size_t> offsetPositions(arrays.size());  // Position of each offset field in the file
+
+    std::string sections[4] = {"PointData", "CellData", "Points", "Cells"};
+    std::vector<featkVTUArrayKind> sectionKinds[4] = {{FEATK_VTU_POINT_DATA}, {FEATK_VTU_CELL_DATA}, {FEATK_VTU_POINTS}, {FEATK_VTU_CONNECTIVITY, FEATK_VTU_OFFSETS, FEATK_VTU_TYPES}};
+
+    for (unsigned int s=0; s!=4; s++) {
+
+        xml += "      <" + sections[s] + ">\n";
+
+        for (size_t a=0; a!=arrays.size(); a++) {
+
+            const featkVTUArray& array = arrays[a];
+
+            if (std::find(sectionKinds[s].begin(), sectionKinds[s].end(), array.kind) != sectionKinds[s].end()) {
+
+                xml += "        <DataArray type=\"" + array.type + "\" Name=\"" + this->getEscapedName(array.name) + "\" NumberOfComponents=\"" + std::to_string(array.components) + "\" format=\"appended\" ";
+                offsetPositions[a] = xml.size();
+                xml += std::string(FEATK_VTU_OFFSET_WIDTH, ' ') + "/>\n";
+            }
+        }
+
+        xml += "      </" + sections[s] + ">\n";
+    }
+
+    xml += "    </Piece>\n";
+    xml += "  </UnstructuredGrid>\n";
+    xml += "  <AppendedData encoding=\"raw\">\n   _";
+
+
+    // Output, each array being encoded and written before the next one so that only one is held in memory
+
+    std::ofstream stream(this->fileName, std::ios::binary | std::ios::trunc);
+
+    if (!stream) {
+
+        std::cout << "featkVTUWriter: Error: " << this->fileName << " could not be opened." << std::endl;
+        return;
+    }
+
+    stream.write(xml.data(), xml.size());
+
+    std::vector<uint64_t> offsets(arrays.size());
+    uint64_t offset = 0;
+
+    for (size_t a=0; a!=arrays.size(); a++) {
+
+        const featkVTUArray& array = arrays[a];
+        std::vector<unsigned char> data;
+        std::vector<unsigned char> block;
+
+        switch (array.kind) {
+
+            case FEATK_VTU_POINTS:
+
+                this->getAttributeData<double>(nodeItems, array.id, array.components, data);
+                break;
+
+            case FEATK_VTU_CONNECTIVITY: {
+
+                data.resize(numberOfCellNodes*sizeof(int64_t));
+                int64_t* connectivity = reinterpret_cast<int64_t*>(data.data());
+
+                for (featkElementInterface<3>* element : elements) {
+
+                    for (unsigned int j=0; j!=(element->getElementType() == FEATK_TET4 ? 4 : 8); j++) {
+
+                        *connectivity = indices[element->getNode(j)->getID()];
+                        connectivity++;
+                    }
+                }
+
+                break;
+            }
+
+            case FEATK_VTU_OFFSETS: {
+
+                data.resize(elements.size()*sizeof(int64_t));
+                int64_t* cellOffsets = reinterpret_cast<int64_t*>(data.data());
+                int64_t cellOffset = 0;
+
+                for (size_t e=0; e!=elements.size(); e++) {
+
+                    cellOffset += elements[e]->getElementType() == FEATK_TET4 ? 4 : 8;
+                    cellOffsets[e] = cellOffset;
+                }
+
+                break;
+            }
+
+            case FEATK_VTU_TYPES:
+
+                data.resize(elements.size());
+
+                for (size_t e=0; e!=elements.size(); e++) {
+
+                    data[e] = elements[e]->getElementType() == FEATK_TET4 ? FEATK_VTK_TETRA : FEATK_VTK_HEXAHEDRON;
+                }
+
+                break;
+
+            case FEATK_VTU_POINT_DATA:
+            case FEATK_VTU_CELL_DATA:
+
+                if (this->useSinglePrecision) {
+
+                    this->getAttributeData<float>(array.kind == FEATK_VTU_POINT_DATA ? nodeItems : elementItems, array.id, array.components, data);
+                }
+
+                else {
+
+                    this->getAttributeData<double>(array.kind == FEATK_VTU_POINT_DATA ? nodeItems : elementItems, array.id, array.components, data);
+                }
+
+                break;
+        }
+
+        if (!this->encode(data, block)) {
+
+            std::cout << "featkVTUWriter: Error: Data array " << array.name << " could not be compressed." << std::endl;
+            return;
+        }
+
+        offsets[a] = offset;
+        offset += block.size();
+
+        stream.write(reinterpret_cast<const char*>(block.data()), block.size());
+    }
+
+    stream << "\n  </AppendedData>\n</VTKFile>\n";
+
+    for (size_t a=0; a!=arrays.size(); a++) {
+
+        std::string field = "offset=\"" + std::to_string(offsets[a]) + "\"";
+
+        stream.seekp(offsetPositions[a]);
+        stream.write(field.data(), field.size());
+    }
+
+    if (!stream) {
+
+        std::cout << "featkVTUWriter: Error: " << this->fileName << " could not be written." << std::endl;
+    }
+}
+
+template<typename ScalarType>
+void featkVTUWriter::getAttributeData(const std::vector<featkAttributable<3>*>& items, size_t id, unsigned int components, std::vector<unsigned char>& data) const {
+
+    /* Values are read in place through featkAttributable::getAttribute(), missing or ill-sized ones being written as zeros. */
+
+    data.assign(items.size()*components*sizeof(ScalarType), 0);
+    ScalarType* values = reinterpret_cast<ScalarType*>(data.data());
+    Index numberOfItems = items.size();
+
+    #pragma omp parallel for
+    for (Index i=0; i<numberOfItems; i++) {
+
+        const MatrixXd* value = items[i]->getAttribute(id);
+
+        if (value != nullptr && value->size() == components) {
+
+            Map<Matrix<ScalarType, Dynamic, Dynamic, RowMajor>>(values+i*components, value->rows(), value->cols()) = value->template cast<ScalarType>();
+        }
+    }
+}
+
+std::string featkVTUWriter::getEscapedName(std::string name) {
+
+    std::string escapedName;
+
+    for (char c : name) {
+
+        switch (c) {
+
+            case '&': escapedName += "&amp;"; break;
+            case '<': escapedName += "&lt;"; break;
+            case '>': escapedName += "&gt;"; break;
+            case '"': escapedName += "&quot;"; break;
+            default: escapedName += c; break;
+        }
+    }
+
+    return escapedName;
+}
+
+void featkVTUWriter::setFileName(std::string fileName) {
+
+    this->fileName = fileName;
+}
+
+void featkVTUWriter::setUseCompression(bool use) {
+
+    this->useCompression = use;
+}
+
+void featkVTUWriter::setUseSinglePrecision(bool use) {
+
+    this->useSinglePrecision = use;
+}
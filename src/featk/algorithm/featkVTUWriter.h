@@ -0,0 +1,95 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkVTUWriter.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkVTUWriter
+ *
+ * @brief Writer of featkMesh in the VTK XML unstructured grid format
+ * without VTK.
+ *
+ * featkVTUWriter writes a featkMesh and all its node and element
+ * attributes in a .vtu file with appended raw binary data, that can be
+ * read by VTK, ParaView or featkVTUReader, without depending on VTK as
+ * featkMeshToVTKUnstructuredGridFilter does.
+ *
+ * Each data array is encoded directly from the attribute storage of the
+ * featkNode and featkElementInterface objects, in single precision if
+ * setUseSinglePrecision() is set (point coordinates always being written
+ * in double precision) and zlib compressed block by block in parallel if
+ * setUseCompression() is set, then written before the next one is
+ * encoded, so that only one array is held in memory at a time.
+ * As for featkMeshToVTKUnstructuredGridFilter, tensor attributes are
+ * flattened row major.
+ *
+ * @warning Compression requires featk to be built with FEATK_USE_ZLIB
+ * defined and linked against zlib, otherwise arrays are written
+ * uncompressed.
+ *
+ * @warning For now, only featkMesh with featkTet4Element and/or
+ * featkHex8Element are supported.
+ *
+ */
+
+#ifndef FEATKVTUWRITER_H
+#define FEATKVTUWRITER_H
+
+#include <featk/algorithm/featkMeshConsumerBase.h>
+#include <featk/core/featkGlobal.h>
+#include <featk/geometry/featkMesh.h>
+
+#include <string>
+#include <vector>
+
+class FEATK_EXPORT featkVTUWriter : public featkMeshConsumerBase<3> {
+
+    public:
+
+        featkVTUWriter();
+        ~featkVTUWriter();
+
+        void execute();
+        static std::string getEscapedName(std::string name);  // XML attribute value escaping, also used by featkXDMFTimeSeriesWriter
+
+        void setFileName(std::string fileName);
+        void setUseCompression(bool use);
+        void setUseSinglePrecision(bool use);
+
+    private:
+
+        enum featkVTUArrayKind : unsigned char {FEATK_VTU_POINTS, FEATK_VTU_CONNECTIVITY, FEATK_VTU_OFFSETS, FEATK_VTU_TYPES, FEATK_VTU_POINT_DATA, FEATK_VTU_CELL_DATA};
+
+        struct featkVTUArray {
+
+            featkVTUArrayKind kind;
+            std::string name;
+            size_t id;  // Attribute ID, data arrays only
+            unsigned int components;
+            std::string type;
+        };
+
+        bool encode(const std::vector<unsigned char>& data, std::vector<unsigned char>& block) const;
+        template<typename ScalarType> void getAttributeData(const std::vector<featkAttributable<3>*>& items, size_t id, unsigned int components, std::vector<unsigned char>& data) const;
+
+        std::string fileName;
+        bool useCompression;
+        bool useSinglePrecision;
+};
+
+#endif // FEATKVTUWRITER_H
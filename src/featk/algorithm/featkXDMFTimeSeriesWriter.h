@@ -0,0 +1,481 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkXDMFTimeSeriesWriter.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkXDMFTimeSeriesWriter
+ *
+ * @brief Streaming writer of featkMesh node attribute time series in the
+ * XDMF format.
+ *
+ * featkXDMFTimeSeriesWriter streams node attribute snapshots, e.g. the
+ * intermediate results of a featkDynamicSolverBase, to disk instead of
+ * storing them as featkMesh attributes, so that the memory footprint does
+ * not grow with the number of snapshots.
+ *
+ * execute() writes the geometry and topology of the input featkMesh and
+ * starts a background writer thread. write(), which implements
+ * featkTimeSeriesSinkInterface, copies a snapshot into a
+ * featkLockFreeQueue, wakes the writer thread up and returns immediately,
+ * the writer thread appending it to a raw binary file, in single precision
+ * if setUseSinglePrecision() is set. Snapshots written at the same time
+ * are gathered in the same time step. Whenever the queue has been emptied,
+ * the new time steps are appended to the XDMF file describing the temporal
+ * collection, only the last time step, which may still receive snapshots,
+ * and the closing tags being rewritten, so that the file can be opened,
+ * e.g. in ParaView, while the solver is still running. close() waits for
+ * the queued snapshots to be written and is called by the destructor.
+ *
+ * The raw binary file is named after the XDMF file with the ".bin"
+ * extension, in native endianness, and referenced by a relative path.
+ * Attribute names are XML escaped as by featkVTUWriter.
+ *
+ * @warning For now, only featkMesh with featkTet4Element and/or
+ * featkHex8Element are supported, check() rejecting any other mesh.
+ *
+ * @tparam Dimension The cartesian dimension of the writer.
+ *
+ */
+
+#ifndef FEATKXDMFTIMESERIESWRITER_H
+#define FEATKXDMFTIMESERIESWRITER_H
+
+#include <featk/algorithm/featkMeshConsumerBase.h>
+#include <featk/algorithm/featkVTUWriter.h>
+#include <featk/core/featkLockFreeQueue.h>
+#include <featk/geometry/featkMesh.h>
+#include <featk/solve/featkTimeSeriesSinkInterface.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+template<unsigned int Dimension>
+class featkXDMFTimeSeriesWriter : public featkMeshConsumerBase<Dimension>, public featkTimeSeriesSinkInterface {
+
+    public:
+
+        featkXDMFTimeSeriesWriter();
+        ~featkXDMFTimeSeriesWriter();
+
+        bool check();
+        void close();
+        void execute();
+        void setFileName(std::string fileName);
+        void setUseSinglePrecision(bool use);
+        void write(std::string name, double time, const MatrixXd& values);
+
+    private:
+
+        struct featkSnapshot {
+
+            std::string name;
+            double time;
+            MatrixXd values;  // One row per node
+        };
+
+        struct featkSnapshotRecord {
+
+            std::string name;
+            Index components;
+            uint64_t offset;
+        };
+
+        struct featkTimeStep {
+
+            double time;
+            std::vector<featkSnapshotRecord> records;
+        };
+
+        std::string getDataItem(std::string dimensions, std::string type, unsigned int precision, uint64_t offset) const;
+        void run();
+        void writeSnapshot(const featkSnapshot& snapshot);
+        void writeTimeStep(size_t t);
+        void writeXDMF();
+
+        std::string fileName;
+        bool useSinglePrecision;
+
+        featkLockFreeQueue<featkSnapshot> queue;
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool closing;  // Guarded by mutex, as pending
+        bool pending;
+        std::thread thread;
+        size_t numberOfNodes;
+
+
+        // Writer thread
+
+        std::ofstream rawStream;
+        std::string rawFileName;
+        uint64_t rawOffset;
+        std::fstream xdmfStream;
+        std::streamoff xdmfOffset;  // Start of the first time step still to be (re)written
+        size_t numberOfWrittenTimeSteps;
+        std::string xdmfGeometry;
+        std::string xdmfTopology;
+        std::vector<featkTimeStep> timeSteps;
+};
+
+template<unsigned int Dimension>
+featkXDMFTimeSeriesWriter<Dimension>::featkXDMFTimeSeriesWriter() {
+
+    this->useSinglePrecision = false;
+    this->closing = false;
+    this->pending = false;
+    this->numberOfNodes = 0;
+
+    this->rawOffset = 0;
+    this->xdmfOffset = 0;
+    this->numberOfWrittenTimeSteps = 0;
+}
+
+template<unsigned int Dimension>
+featkXDMFTimeSeriesWriter<Dimension>::~featkXDMFTimeSeriesWriter() {
+
+    this->close();
+}
+
+template<unsigned int Dimension>
+bool featkXDMFTimeSeriesWriter<Dimension>::check() {
+
+    if (this->inputMeshes[0] == nullptr) {
+
+        std::cout << "featkXDMFTimeSeriesWriter: Error: No input mesh." << std::endl;
+        return false;
+    }
+
+    if (this->fileName.empty()) {
+
+        std::cout << "featkXDMFTimeSeriesWriter: Error: No file name." << std::endl;
+        return false;
+    }
+
+    for (featkElementInterface<Dimension>* element : this->inputMeshes[0]->getElements()) {
+
+        featkElementType type = element->getElementType();
+
+        if ((type != FEATK_TET4 || element->getNodes().size() != 4) && (type != FEATK_HEX8 || element->getNodes().size() != 8)) {
+
+            std::cout << "featkXDMFTimeSeriesWriter: Error: Unsupported element type, only featkTet4Element and featkHex8Element are supported." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<unsigned int Dimension>
+void featkXDMFTimeSeriesWriter<Dimension>::close() {
+
+    if (this->thread.joinable()) {
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->closing = true;
+        }
+
+        this->condition.notify_one();
+        this->thread.join();
+        this->rawStream.close();
+        this->xdmfStream.close();
+    }
+}
+
+template<unsigned int Dimension>
+void featkXDMFTimeSeriesWriter<Dimension>::execute() {
+
+    this->close();
+
+    featkMesh<Dimension>* inputMesh = this->inputMeshes[0];
+
+    size_t separator = this->fileName.find_last_of("/\\");
+    size_t extension = this->fileName.find_last_of('.');
+    std::string rawPath = (extension != std::string::npos && (separator == std::string::npos || extension > separator) ? this->fileName.substr(0, extension) : this->fileName) + ".bin";
+
+    this->rawFileName = separator == std::string::npos ? rawPath : rawPath.substr(separator+1);
+    this->rawStream.open(rawPath, std::ios::binary | std::ios::trunc);
+
+    if (!this->rawStream) {
+
+        std::cout << "featkXDMFTimeSeriesWriter: Error: " << rawPath << " could not be opened." << std::endl;
+        return;
+    }
+
+
+    // Topology, mixed cells of type and node indices
+
+    const std::vector<featkNode<Dimension>*>& nodes = inputMesh->getNodes();
+    std::map<size_t, int32_t> map;  // featkNode<Dimension>::id is supposed to match node index in featkMesh<Dimension>::nodes but keep a map in case
+
+    for (size_t n=0; n!=nodes.size(); n++) {
+
+        map[nodes[n]->getID()] = int32_t(n);
+    }
+
+    std::vector<int32_t> topology;
+
+    for (featkElementInterface<Dimension>* element : inputMesh->getElements()) {
+
+        switch (element->getElementType()) {
+
+            case FEATK_TET4:
+
+                topology.push_back(6);
+                break;
+
+            case FEATK_HEX8:
+
+                topology.push_back(9);
+                break;
+
+            default:  // Rejected by check()
+
+                break;
+        }
+
+        for (featkNode<Dimension>* node : element->getNodes()) {
+
+            topology.push_back(map[node->getID()]);
+        }
+    }
+
+    this->rawStream.write(reinterpret_cast<const char*>(topology.data()), topology.size()*sizeof(int32_t));
+
+
+    // Geometry
+
+    Matrix<double, Dynamic, Dynamic, RowMajor> geometry(nodes.size(), Dimension);
+
+    for (size_t n=0; n!=nodes.size(); n++) {
+
+        geometry.row(n) = nodes[n]->getCoordinates().transpose();
+    }
+
+    this->rawStream.write(reinterpret_cast<const char*>(geometry.data()), geometry.size()*sizeof(double));
+
+    uint64_t geometryOffset = topology.size()*sizeof(int32_t);
+
+    this->numberOfNodes = nodes.size();
+    this->rawOffset = geometryOffset + geometry.size()*sizeof(double);
+    this->xdmfTopology = "<Topology TopologyType=\"Mixed\" NumberOfElements=\"" + std::to_string(inputMesh->getNumberOfElements()) + "\">" + this->getDataItem(std::to_string(topology.size()), "Int", 4, 0) + "</Topology>";
+    this->xdmfGeometry = "<Geometry GeometryType=\"" + std::string(Dimension == 2 ? "XY" : "XYZ") + "\">" + this->getDataItem(std::to_string(nodes.size()) + " " + std::to_string(Dimension), "Float", 8, geometryOffset) + "</Geometry>";
+    this->timeSteps.clear();
+
+
+    // XDMF header, time steps being inserted before the closing tags
+
+    this->xdmfStream.open(this->fileName, std::ios::in | std::ios::out | std::ios::trunc);
+    this->xdmfStream.precision(17);
+
+    if (!this->xdmfStream) {
+
+        std::cout << "featkXDMFTimeSeriesWriter: Error: " << this->fileName << " could not be opened." << std::endl;
+        this->rawStream.close();
+        return;
+    }
+
+    this->xdmfStream << "<?xml version=\"1.0\" ?>" << std::endl;
+    this->xdmfStream << "<Xdmf Version=\"2.0\">" << std::endl;
+    this->xdmfStream << "  <Domain>" << std::endl;
+    this->xdmfStream << "    <Grid Name=\"Time Series\" GridType=\"Collection\" CollectionType=\"Temporal\">" << std::endl;
+
+    this->xdmfOffset = this->xdmfStream.tellp();
+    this->numberOfWrittenTimeSteps = 0;
+    this->writeXDMF();
+
+
+    // Writer thread
+
+    this->closing = false;
+    this->pending = false;
+    this->thread = std::thread(&featkXDMFTimeSeriesWriter<Dimension>::run, this);
+}
+
+template<unsigned int Dimension>
+std::string featkXDMFTimeSeriesWriter<Dimension>::getDataItem(std::string dimensions, std::string type, unsigned int precision, uint64_t offset) const {
+
+    return "<DataItem Dimensions=\"" + dimensions + "\" NumberType=\"" + type + "\" Precision=\"" + std::to_string(precision) + "\" Format=\"Binary\" Endian=\"Native\" Seek=\"" + std::to_string(offset) + "\">" + this->rawFileName + "</DataItem>";
+}
+
+template<unsigned int Dimension>
+void featkXDMFTimeSeriesWriter<Dimension>::run() {
+
+    featkSnapshot snapshot;
+
+    while (true) {
+
+        bool closing;
+
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->condition.wait(lock, [this]() { return this->pending || this->closing; });
+
+            closing = this->closing;  // Read before the queue so that no snapshot is missed
+            this->pending = false;
+        }
+
+        bool written = false;
+
+        while (this->queue.pop(snapshot)) {
+
+            this->writeSnapshot(snapshot);
+            written = true;
+        }
+
+        if (written) {
+
+            this->rawStream.flush();
+            this->writeXDMF();
+        }
+
+        if (closing) {
+
+            break;
+        }
+    }
+
+    if (!this->rawStream) {
+
+        std::cout << "featkXDMFTimeSeriesWriter: Warning: " << this->rawFileName << " could not be written." << std::endl;
+    }
+}
+
+template<unsigned int Dimension>
+void featkXDMFTimeSeriesWriter<Dimension>::setFileName(std::string fileName) {
+
+    this->fileName = fileName;
+}
+
+template<unsigned int Dimension>
+void featkXDMFTimeSeriesWriter<Dimension>::setUseSinglePrecision(bool use) {
+
+    this->useSinglePrecision = use;
+}
+
+template<unsigned int Dimension>
+void featkXDMFTimeSeriesWriter<Dimension>::write(std::string name, double time, const MatrixXd& values) {
+
+    /* Only the copy of the snapshot is paid by the calling thread. */
+
+    if (!this->thread.joinable()) {
+
+        std::cout << "featkXDMFTimeSeriesWriter: Warning: Writer not started, snapshot " << name << " ignored." << std::endl;
+        return;
+    }
+
+    if (size_t(values.rows()) != this->numberOfNodes) {
+
+        std::cout << "featkXDMFTimeSeriesWriter: Warning: Snapshot " << name << " does not match the number of nodes, ignored." << std::endl;
+        return;
+    }
+
+    this->queue.push(featkSnapshot{name, time, values});
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pending = true;
+    }
+
+    this->condition.notify_one();
+}
+
+template<unsigned int Dimension>
+void featkXDMFTimeSeriesWriter<Dimension>::writeSnapshot(const featkSnapshot& snapshot) {
+
+    if (this->timeSteps.empty() || this->timeSteps.back().time != snapshot.time) {
+
+        this->timeSteps.push_back(featkTimeStep{snapshot.time, {}});
+    }
+
+    this->timeSteps.back().records.push_back(featkSnapshotRecord{snapshot.name, snapshot.values.cols(), this->rawOffset});
+
+    if (this->useSinglePrecision) {
+
+        Matrix<float, Dynamic, Dynamic, RowMajor> values = snapshot.values.template cast<float>();
+        this->rawStream.write(reinterpret_cast<const char*>(values.data()), values.size()*sizeof(float));
+        this->rawOffset += values.size()*sizeof(float);
+    }
+
+    else {
+
+        Matrix<double, Dynamic, Dynamic, RowMajor> values = snapshot.values;
+        this->rawStream.write(reinterpret_cast<const char*>(values.data()), values.size()*sizeof(double));
+        this->rawOffset += values.size()*sizeof(double);
+    }
+}
+
+template<unsigned int Dimension>
+void featkXDMFTimeSeriesWriter<Dimension>::writeTimeStep(size_t t) {
+
+    /* XDMF attribute types are given by the number of components, e.g. Vector only stands for 3 components. */
+
+    unsigned int precision = this->useSinglePrecision ? 4 : 8;
+
+    this->xdmfStream << "      <Grid Name=\"Step " << t << "\" GridType=\"Uniform\">" << std::endl;
+    this->xdmfStream << "        <Time Value=\"" << this->timeSteps[t].time << "\"/>" << std::endl;
+    this->xdmfStream << "        " << this->xdmfTopology << std::endl;
+    this->xdmfStream << "        " << this->xdmfGeometry << std::endl;
+
+    for (const featkSnapshotRecord& record : this->timeSteps[t].records) {
+
+        std::string type = record.components == 1 ? "Scalar" : record.components == 3 ? "Vector" : record.components == 6 ? "Tensor6" : record.components == 9 ? "Tensor" : "Matrix";
+        std::string dimensions = std::to_string(this->numberOfNodes) + " " + std::to_string(record.components);
+
+        this->xdmfStream << "        <Attribute Name=\"" << featkVTUWriter::getEscapedName(record.name) << "\" AttributeType=\"" << type << "\" Center=\"Node\">" << this->getDataItem(dimensions, "Float", precision, record.offset) << "</Attribute>" << std::endl;
+    }
+
+    this->xdmfStream << "      </Grid>" << std::endl;
+}
+
+template<unsigned int Dimension>
+void featkXDMFTimeSeriesWriter<Dimension>::writeXDMF() {
+
+    /**
+     * Time steps are only ever appended and gain records, so that the rewritten part, i.e. the last time step of the
+     * previous call and the closing tags, is always overwritten by longer contents and the file needs no truncation.
+     */
+
+    this->xdmfStream.seekp(this->xdmfOffset);
+
+    for (size_t t=this->numberOfWrittenTimeSteps; t<this->timeSteps.size(); t++) {
+
+        if (t+1 == this->timeSteps.size()) {
+
+            this->xdmfOffset = this->xdmfStream.tellp();
+            this->numberOfWrittenTimeSteps = t;
+        }
+
+        this->writeTimeStep(t);
+    }
+
+    this->xdmfStream << "    </Grid>" << std::endl;
+    this->xdmfStream << "  </Domain>" << std::endl;
+    this->xdmfStream << "</Xdmf>" << std::endl;
+    this->xdmfStream.flush();
+}
+
+#endif // FEATKXDMFTIMESERIESWRITER_H
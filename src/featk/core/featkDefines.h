@@ -27,6 +27,36 @@
  * featkElementType enumerated type is used by featkElementInterface to
  * identifiy its instantiated concrete featkElement type at run time.
  *
+ * featkTimeIntegrationScheme enumerated type is used by
+ * featkDynamicSolverBase to select its time integration scheme:
+ * semi-implicit Euler (FEATK_SBDF1), Crank-Nicolson/Adams-Bashforth
+ * (FEATK_CNAB2), semi-implicit BDF2 (FEATK_SBDF2), Strang splitting
+ * (FEATK_STRANG), fully implicit Euler solved by Newton iterations
+ * (FEATK_BDF1) or, on the lumped mass system, explicit forward Euler
+ * (FEATK_FORWARD_EULER) and strong stability preserving Runge-Kutta
+ * schemes of order 2 and 3 (FEATK_SSPRK2, FEATK_SSPRK3).
+ *
+ * featkIterativeSolverType enumerated type selects the iterative solver of
+ * featkStaticSolverBase and featkDynamicSolverBase: standard conjugate
+ * gradient (FEATK_CONJUGATE_GRADIENT), pipelined conjugate gradient with a
+ * single reduction per iteration (FEATK_PIPELINED_CONJUGATE_GRADIENT),
+ * Chebyshev iteration without inner products (FEATK_CHEBYSHEV_ITERATION)
+ * or single precision conjugate gradient within double precision iterative
+ * refinement (FEATK_MIXED_PRECISION_CONJUGATE_GRADIENT).
+ *
+ * featkMassLumping enumerated type selects how featkDynamicSolverBase lumps
+ * the mass matrix for explicit schemes: row-sum (FEATK_ROW_SUM) or
+ * Hinton-Rock-Zienkiewicz diagonal scaling (FEATK_HRZ).
+ *
+ * featkNormType enumerated type selects the vector norm used by
+ * featkDynamicSolverBase to detect steady states: euclidean (FEATK_L2_NORM),
+ * root mean square (FEATK_RMS_NORM) or maximum (FEATK_MAX_NORM) norm.
+ *
+ * featkStoragePrecision enumerated type selects the floating point type in
+ * which featkTimeSeriesAttribute stores its values: double
+ * (FEATK_DOUBLE_PRECISION), float (FEATK_SINGLE_PRECISION) or Eigen::half
+ * (FEATK_HALF_PRECISION).
+ *
  * As the dimensions of the various matrices involved in finite element
  * problems are known at compile time given the cartesian dimension of the
  * problem, the number of nodes and natural dimension of the element types
@@ -46,6 +76,11 @@
 using namespace Eigen;
 
 enum featkElementType : unsigned char {FEATK_TET4, FEATK_HEX8};
+enum featkIterativeSolverType : unsigned char {FEATK_CONJUGATE_GRADIENT, FEATK_PIPELINED_CONJUGATE_GRADIENT, FEATK_CHEBYSHEV_ITERATION, FEATK_MIXED_PRECISION_CONJUGATE_GRADIENT};
+enum featkMassLumping : unsigned char {FEATK_ROW_SUM, FEATK_HRZ};
+enum featkNormType : unsigned char {FEATK_L2_NORM, FEATK_RMS_NORM, FEATK_MAX_NORM};
+enum featkStoragePrecision : unsigned char {FEATK_DOUBLE_PRECISION, FEATK_SINGLE_PRECISION, FEATK_HALF_PRECISION};
+enum featkTimeIntegrationScheme : unsigned char {FEATK_SBDF1, FEATK_CNAB2, FEATK_SBDF2, FEATK_STRANG, FEATK_BDF1, FEATK_FORWARD_EULER, FEATK_SSPRK2, FEATK_SSPRK3};
 
 template<unsigned int Dimension, unsigned int Order> using AttributeValueType = Matrix<double, POWER(Dimension, Order/2+Order%2), POWER(Dimension, Order/2)>;
 
@@ -0,0 +1,129 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkLockFreeQueue.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkLockFreeQueue
+ *
+ * @brief Unbounded lock-free single producer single consumer queue.
+ *
+ * featkLockFreeQueue is a singly linked list whose tail is only accessed
+ * by the producer thread (push()) and whose head is only accessed by the
+ * consumer thread (pop()), the two threads synchronizing through the
+ * atomic link of the last node. Neither push() nor pop() ever blocks, so
+ * that e.g. a time loop handing results over to a writer thread never
+ * waits on it. The queue being unbounded, a consumer slower than the
+ * producer makes it grow.
+ *
+ * @warning At most one thread may call push() and at most one other
+ * thread may call pop() and empty() concurrently.
+ *
+ * @tparam ValueType The type of the queued values, which must be default
+ * and move constructible.
+ *
+ */
+
+#ifndef FEATKLOCKFREEQUEUE_H
+#define FEATKLOCKFREEQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+template<typename ValueType>
+class featkLockFreeQueue {
+
+    public:
+
+        featkLockFreeQueue();
+        ~featkLockFreeQueue();
+
+        bool empty() const;
+        bool pop(ValueType& value);
+        void push(ValueType value);
+
+    private:
+
+        featkLockFreeQueue(const featkLockFreeQueue&) = delete;
+        featkLockFreeQueue& operator=(const featkLockFreeQueue&) = delete;
+
+        struct featkQueueNode {
+
+            ValueType value;
+            std::atomic<featkQueueNode*> next;
+        };
+
+        featkQueueNode* head;  // Consumed dummy node, owned by the consumer
+        featkQueueNode* tail;  // Owned by the producer
+};
+
+template<typename ValueType>
+featkLockFreeQueue<ValueType>::featkLockFreeQueue() {
+
+    this->head = new featkQueueNode();
+    this->head->next.store(nullptr, std::memory_order_relaxed);
+    this->tail = this->head;
+}
+
+template<typename ValueType>
+featkLockFreeQueue<ValueType>::~featkLockFreeQueue() {
+
+    while (this->head != nullptr) {
+
+        featkQueueNode* next = this->head->next.load(std::memory_order_relaxed);
+        delete this->head;
+        this->head = next;
+    }
+}
+
+template<typename ValueType>
+bool featkLockFreeQueue<ValueType>::empty() const {
+
+    return this->head->next.load(std::memory_order_acquire) == nullptr;
+}
+
+template<typename ValueType>
+bool featkLockFreeQueue<ValueType>::pop(ValueType& value) {
+
+    featkQueueNode* next = this->head->next.load(std::memory_order_acquire);
+
+    if (next == nullptr) {
+
+        return false;
+    }
+
+    value = std::move(next->value);  // next becomes the dummy node
+
+    delete this->head;
+    this->head = next;
+
+    return true;
+}
+
+template<typename ValueType>
+void featkLockFreeQueue<ValueType>::push(ValueType value) {
+
+    featkQueueNode* node = new featkQueueNode();
+    node->value = std::move(value);
+    node->next.store(nullptr, std::memory_order_relaxed);
+
+    this->tail->next.store(node, std::memory_order_release);  // Publishes the value to the consumer
+    this->tail = node;
+}
+
+#endif // FEATKLOCKFREEQUEUE_H
@@ -0,0 +1,143 @@
+#include <featk/core/featkMemoryMappedFile.h>
+
+#include <iostream>
+
+#ifdef _WIN32
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <windows.h>
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+featkMemoryMappedFile::featkMemoryMappedFile() {
+
+    this->data = nullptr;
+    this->size = 0;
+}
+
+featkMemoryMappedFile::~featkMemoryMappedFile() {
+
+    this->close();
+}
+
+void featkMemoryMappedFile::close() {
+
+    if (this->data != nullptr) {
+
+        #ifdef _WIN32
+        UnmapViewOfFile(this->data);
+        #else
+        munmap(const_cast<unsigned char*>(this->data), this->size);
+        #endif
+    }
+
+    this->data = nullptr;
+    this->size = 0;
+}
+
+const unsigned char* featkMemoryMappedFile::getData() const {
+
+    return this->data;
+}
+
+size_t featkMemoryMappedFile::getSize() const {
+
+    return this->size;
+}
+
+bool featkMemoryMappedFile::isOpen() const {
+
+    return this->data != nullptr;
+}
+
+bool featkMemoryMappedFile::open(std::string fileName) {
+
+    /* Empty files cannot be mapped and are reported as errors, the callers expecting at least a header. */
+
+    this->close();
+
+    #ifdef _WIN32
+
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+
+        std::cout << "featkMemoryMappedFile: Error: " << fileName << " could not be opened." << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+
+        std::cout << "featkMemoryMappedFile: Error: " << fileName << " is empty or its size could not be read." << std::endl;
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);  // The mapping keeps the file open
+
+    if (mapping == nullptr) {
+
+        std::cout << "featkMemoryMappedFile: Error: " << fileName << " could not be mapped." << std::endl;
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);  // The view keeps the mapping alive
+
+    if (view == nullptr) {
+
+        std::cout << "featkMemoryMappedFile: Error: " << fileName << " could not be mapped." << std::endl;
+        return false;
+    }
+
+    this->data = static_cast<const unsigned char*>(view);
+    this->size = size_t(fileSize.QuadPart);
+
+    #else
+
+    int file = ::open(fileName.c_str(), O_RDONLY);
+
+    if (file == -1) {
+
+        std::cout << "featkMemoryMappedFile: Error: " << fileName << " could not be opened." << std::endl;
+        return false;
+    }
+
+    struct stat status;
+
+    if (fstat(file, &status) == -1 || status.st_size == 0) {
+
+        std::cout << "featkMemoryMappedFile: Error: " << fileName << " is empty or its size could not be read." << std::endl;
+        ::close(file);
+        return false;
+    }
+
+    void* view = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);  // The mapping keeps the file open
+
+    if (view == MAP_FAILED) {
+
+        std::cout << "featkMemoryMappedFile: Error: " << fileName << " could not be mapped." << std::endl;
+        return false;
+    }
+
+    this->data = static_cast<const unsigned char*>(view);
+    this->size = size_t(status.st_size);
+
+    #endif
+
+    return true;
+}
@@ -0,0 +1,63 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkMemoryMappedFile.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkMemoryMappedFile
+ *
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * featkMemoryMappedFile maps a file into the address space of the process
+ * with mmap() or MapViewOfFile() on Windows, so that its content can be
+ * accessed in place through getData() without being read into a buffer,
+ * pages being loaded by the operating system on first access only. The
+ * mapping is page aligned and released by close() or the destructor, which
+ * invalidates any pointer into it.
+ *
+ */
+
+#ifndef FEATKMEMORYMAPPEDFILE_H
+#define FEATKMEMORYMAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+class featkMemoryMappedFile {
+
+    public:
+
+        featkMemoryMappedFile();
+        ~featkMemoryMappedFile();
+
+        void close();
+        const unsigned char* getData() const;
+        size_t getSize() const;
+        bool isOpen() const;
+        bool open(std::string fileName);
+
+    private:
+
+        featkMemoryMappedFile(const featkMemoryMappedFile&) = delete;
+        featkMemoryMappedFile& operator=(const featkMemoryMappedFile&) = delete;
+
+        const unsigned char* data;
+        size_t size;
+};
+
+#endif // FEATKMEMORYMAPPEDFILE_H
@@ -0,0 +1,424 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkNIfTIImage.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkNIfTIImage
+ *
+ * @brief Read-only NIfTI-1 and NIfTI-2 image.
+ *
+ * featkNIfTIImage memory maps a single file NIfTI image, or decompresses it
+ * in memory if gzipped, and gives access to its voxels in place. The first
+ * three image dimensions are the spatial ones, the others being flattened
+ * into getNumberOfComponents() components stored volume after volume, so
+ * that component c of voxel (i, j, k) is at index
+ * i + nx*(j + ny*(k + nz*c)).
+ *
+ * getVoxel() returns raw voxel values of the type matching getDatatype(),
+ * one of the FEATK_NIFTI_* constants, whereas getValue() converts any
+ * supported datatype to double and applies the scl_slope and scl_inter
+ * scaling. getIndexToWorld() is the sform, or the qform, or else the pixdim
+ * scaling of the image.
+ *
+ * @warning Images with a non native endianness are not supported, and
+ * gzip compressed images (.nii.gz) require featk to be built with
+ * FEATK_USE_ZLIB defined.
+ *
+ */
+
+#ifndef FEATKNIFTIIMAGE_H
+#define FEATKNIFTIIMAGE_H
+
+#include <featk/core/featkDefines.h>
+#include <featk/core/featkMemoryMappedFile.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef FEATK_USE_ZLIB
+#include <zlib.h>
+#endif
+
+const int FEATK_NIFTI_UINT8 = 2;
+const int FEATK_NIFTI_INT16 = 4;
+const int FEATK_NIFTI_INT32 = 8;
+const int FEATK_NIFTI_FLOAT32 = 16;
+const int FEATK_NIFTI_FLOAT64 = 64;
+const int FEATK_NIFTI_INT8 = 256;
+const int FEATK_NIFTI_UINT16 = 512;
+const int FEATK_NIFTI_UINT32 = 768;
+const int FEATK_NIFTI_INT64 = 1024;
+const int FEATK_NIFTI_UINT64 = 1280;
+
+const int FEATK_NIFTI_INTENT_SYMMATRIX = 1005;
+
+class featkNIfTIImage {
+
+    public:
+
+        featkNIfTIImage();
+        ~featkNIfTIImage();
+
+        int getDatatype() const;
+        std::array<int64_t, 3> getDimensions() const;
+        Matrix<double, 3, 4> getIndexToWorld() const;
+        int getIntent() const;
+        int64_t getNumberOfComponents() const;
+        int64_t getNumberOfVoxels() const;
+        double getValue(int64_t index) const;
+        template<typename VoxelType> VoxelType getVoxel(int64_t index) const;
+        Matrix<double, 3, 4> getWorldToIndex() const;
+        bool open(std::string fileName);
+        double scale(double value) const;
+
+    private:
+
+        featkNIfTIImage(const featkNIfTIImage&) = delete;
+        featkNIfTIImage& operator=(const featkNIfTIImage&) = delete;
+
+        template<typename ValueType> ValueType getField(const unsigned char* data, size_t offset) const;
+        bool parse(const unsigned char* data, size_t size, std::string fileName);
+
+        featkMemoryMappedFile file;
+        std::vector<unsigned char> buffer;  // Decompressed gzipped image
+        const unsigned char* data;          // First voxel
+
+        int64_t components;
+        int datatype;
+        std::array<int64_t, 3> dimensions;
+        Matrix<double, 3, 4> indexToWorld;
+        double intercept;
+        int intent;
+        double slope;
+};
+
+inline featkNIfTIImage::featkNIfTIImage() {
+
+    this->data = nullptr;
+    this->components = 0;
+    this->datatype = 0;
+    this->dimensions = {0, 0, 0};
+    this->indexToWorld = Matrix<double, 3, 4>::Zero();
+    this->intercept = 0.0;
+    this->intent = 0;
+    this->slope = 1.0;
+}
+
+inline featkNIfTIImage::~featkNIfTIImage() {
+
+}
+
+inline int featkNIfTIImage::getDatatype() const {
+
+    return this->datatype;
+}
+
+inline std::array<int64_t, 3> featkNIfTIImage::getDimensions() const {
+
+    return this->dimensions;
+}
+
+template<typename ValueType>
+ValueType featkNIfTIImage::getField(const unsigned char* data, size_t offset) const {
+
+    ValueType value;
+    std::memcpy(&value, data+offset, sizeof(ValueType));
+
+    return value;
+}
+
+inline Matrix<double, 3, 4> featkNIfTIImage::getIndexToWorld() const {
+
+    return this->indexToWorld;
+}
+
+inline int featkNIfTIImage::getIntent() const {
+
+    return this->intent;
+}
+
+inline int64_t featkNIfTIImage::getNumberOfComponents() const {
+
+    return this->components;
+}
+
+inline int64_t featkNIfTIImage::getNumberOfVoxels() const {
+
+    return this->dimensions[0]*this->dimensions[1]*this->dimensions[2];
+}
+
+inline double featkNIfTIImage::getValue(int64_t index) const {
+
+    switch (this->datatype) {
+
+        case FEATK_NIFTI_UINT8:   return this->scale(double(this->getVoxel<uint8_t>(index)));
+        case FEATK_NIFTI_INT16:   return this->scale(double(this->getVoxel<int16_t>(index)));
+        case FEATK_NIFTI_INT32:   return this->scale(double(this->getVoxel<int32_t>(index)));
+        case FEATK_NIFTI_FLOAT32: return this->scale(double(this->getVoxel<float>(index)));
+        case FEATK_NIFTI_FLOAT64: return this->scale(this->getVoxel<double>(index));
+        case FEATK_NIFTI_INT8:    return this->scale(double(this->getVoxel<int8_t>(index)));
+        case FEATK_NIFTI_UINT16:  return this->scale(double(this->getVoxel<uint16_t>(index)));
+        case FEATK_NIFTI_UINT32:  return this->scale(double(this->getVoxel<uint32_t>(index)));
+        case FEATK_NIFTI_INT64:   return this->scale(double(this->getVoxel<int64_t>(index)));
+        case FEATK_NIFTI_UINT64:  return this->scale(double(this->getVoxel<uint64_t>(index)));
+    }
+
+    return 0.0;
+}
+
+template<typename VoxelType>
+VoxelType featkNIfTIImage::getVoxel(int64_t index) const {
+
+    /* Voxels are not necessarily aligned, vox_offset being only a multiple of 16 bytes. */
+
+    return this->getField<VoxelType>(this->data, index*sizeof(VoxelType));
+}
+
+inline Matrix<double, 3, 4> featkNIfTIImage::getWorldToIndex() const {
+
+    Matrix3d inverse = this->indexToWorld.leftCols<3>().inverse();
+
+    return (Matrix<double, 3, 4>() << inverse, -inverse*this->indexToWorld.col(3)).finished();
+}
+
+inline bool featkNIfTIImage::open(std::string fileName) {
+
+    this->buffer.clear();
+    this->data = nullptr;
+
+    if (!this->file.open(fileName)) {
+
+        return false;
+    }
+
+    if (this->file.getSize() >= 2 && this->file.getData()[0] == 0x1f && this->file.getData()[1] == 0x8b) {
+
+        this->file.close();
+
+        #ifdef FEATK_USE_ZLIB
+
+        gzFile gz = gzopen(fileName.c_str(), "rb");
+        std::vector<unsigned char> chunk(1 << 20);
+        int read = 0;
+
+        while (gz != nullptr && (read = gzread(gz, chunk.data(), unsigned(chunk.size()))) > 0) {
+
+            this->buffer.insert(this->buffer.end(), chunk.begin(), chunk.begin()+read);
+        }
+
+        if (gz != nullptr) {
+
+            gzclose(gz);
+        }
+
+        if (gz == nullptr || read < 0) {
+
+            std::cout << "featkNIfTIImage: Error: Could not decompress " << fileName << "." << std::endl;
+            return false;
+        }
+
+        return this->parse(this->buffer.data(), this->buffer.size(), fileName);
+
+        #else
+
+        std::cout << "featkNIfTIImage: Error: " << fileName << " is gzip compressed but featk was built without zlib." << std::endl;
+        return false;
+
+        #endif
+    }
+
+    return this->parse(this->file.getData(), this->file.getSize(), fileName);
+}
+
+inline bool featkNIfTIImage::parse(const unsigned char* data, size_t size, std::string fileName) {
+
+    /* Header fields offsets from the NIfTI-1 and NIfTI-2 specifications. */
+
+    int32_t headerSize = size >= sizeof(int32_t) ? this->getField<int32_t>(data, 0) : 0;
+    bool nifti2 = headerSize == 540 && size >= 540 && std::memcmp(data+4, "n+2", 4) == 0;
+    bool nifti1 = headerSize == 348 && size >= 348 && std::memcmp(data+344, "n+1", 4) == 0;
+
+    if (!nifti1 && !nifti2) {
+
+        std::cout << "featkNIfTIImage: Error: " << fileName << " is not a single file NIfTI image with native endianness." << std::endl;
+        return false;
+    }
+
+    int64_t dimensions[8];
+    double pixdim[8];
+    double quaternion[3];
+    double offset[3];
+    double srow[3][4];
+
+    for (int i=0; i!=8; i++) {
+
+        dimensions[i] = nifti2 ? this->getField<int64_t>(data, 16+8*i) : this->getField<int16_t>(data, 40+2*i);
+        pixdim[i] = nifti2 ? this->getField<double>(data, 104+8*i) : this->getField<float>(data, 76+4*i);
+    }
+
+    for (int i=0; i!=3; i++) {
+
+        quaternion[i] = nifti2 ? this->getField<double>(data, 352+8*i) : this->getField<float>(data, 256+4*i);
+        offset[i] = nifti2 ? this->getField<double>(data, 376+8*i) : this->getField<float>(data, 268+4*i);
+
+        for (int j=0; j!=4; j++) {
+
+            srow[i][j] = nifti2 ? this->getField<double>(data, 400+32*i+8*j) : this->getField<float>(data, 280+16*i+4*j);
+        }
+    }
+
+    this->datatype = nifti2 ? this->getField<int16_t>(data, 12) : this->getField<int16_t>(data, 70);
+    this->intent = nifti2 ? this->getField<int32_t>(data, 504) : this->getField<int16_t>(data, 68);
+    this->slope = nifti2 ? this->getField<double>(data, 176) : this->getField<float>(data, 112);
+    this->intercept = nifti2 ? this->getField<double>(data, 184) : this->getField<float>(data, 116);
+
+    int64_t voxelOffset = nifti2 ? this->getField<int64_t>(data, 168) : -1;
+    int qformCode = nifti2 ? this->getField<int32_t>(data, 344) : this->getField<int16_t>(data, 252);
+    int sformCode = nifti2 ? this->getField<int32_t>(data, 348) : this->getField<int16_t>(data, 254);
+
+    if (this->slope == 0.0 || !std::isfinite(this->slope) || !std::isfinite(this->intercept)) {
+
+        this->slope = 1.0;
+        this->intercept = 0.0;
+    }
+
+    size_t bytes = this->datatype == FEATK_NIFTI_UINT8 || this->datatype == FEATK_NIFTI_INT8 ? 1 :
+                   this->datatype == FEATK_NIFTI_INT16 || this->datatype == FEATK_NIFTI_UINT16 ? 2 :
+                   this->datatype == FEATK_NIFTI_INT32 || this->datatype == FEATK_NIFTI_UINT32 || this->datatype == FEATK_NIFTI_FLOAT32 ? 4 :
+                   this->datatype == FEATK_NIFTI_FLOAT64 || this->datatype == FEATK_NIFTI_INT64 || this->datatype == FEATK_NIFTI_UINT64 ? 8 : 0;
+
+    if (bytes == 0) {
+
+        std::cout << "featkNIfTIImage: Error: NIfTI datatype " << this->datatype << " not supported." << std::endl;
+        return false;
+    }
+
+    if (nifti1) {
+
+        float value = this->getField<float>(data, 108);  // A NaN, negative or too large float offset is left to -1 and rejected below
+
+        if (value >= 0.0f && value <= float(size)) {
+
+            voxelOffset = int64_t(value);
+        }
+    }
+
+    if (voxelOffset < headerSize || uint64_t(voxelOffset) > size) {
+
+        std::cout << "featkNIfTIImage: Error: Invalid voxel offset in " << fileName << "." << std::endl;
+        return false;
+    }
+
+    uint64_t capacity = (size-voxelOffset)/bytes;  // Number of values the file can hold after the offset
+
+
+    // Dimensions, components flattened from the 4th dimension on, each product being checked against the capacity before it is computed
+
+    uint64_t values = 1;
+    this->components = 1;
+
+    for (int i=1; i!=8; i++) {
+
+        int64_t dimension = i <= dimensions[0] ? dimensions[i] : 1;
+
+        if (dimensions[0] < 1 || dimensions[0] > 7 || dimension < 1) {
+
+            std::cout << "featkNIfTIImage: Error: Invalid dimensions in " << fileName << "." << std::endl;
+            return false;
+        }
+
+        if (uint64_t(dimension) > capacity/values) {
+
+            std::cout << "featkNIfTIImage: Error: " << fileName << " is truncated." << std::endl;
+            return false;
+        }
+
+        values *= dimension;
+
+        if (i <= 3) {
+
+            this->dimensions[i-1] = dimension;
+        }
+
+        else {
+
+            this->components *= dimension;
+        }
+    }
+
+
+    // Index to world transform
+
+    Matrix3d rotation;
+    Vector3d translation;
+
+    if (sformCode > 0) {
+
+        rotation << srow[0][0], srow[0][1], srow[0][2],
+                    srow[1][0], srow[1][1], srow[1][2],
+                    srow[2][0], srow[2][1], srow[2][2];
+
+        translation << srow[0][3], srow[1][3], srow[2][3];
+    }
+
+    else if (qformCode > 0) {
+
+        double b = quaternion[0];
+        double c = quaternion[1];
+        double d = quaternion[2];
+        double a = std::sqrt(std::max(1.0-b*b-c*c-d*d, 0.0));
+
+        rotation << a*a+b*b-c*c-d*d, 2*b*c-2*a*d,     2*b*d+2*a*c,
+                    2*b*c+2*a*d,     a*a+c*c-b*b-d*d, 2*c*d-2*a*b,
+                    2*b*d-2*a*c,     2*c*d+2*a*b,     a*a+d*d-c*c-b*b;
+
+        rotation = rotation*Vector3d(pixdim[1], pixdim[2], pixdim[0] < 0.0 ? -pixdim[3] : pixdim[3]).asDiagonal();
+        translation << offset[0], offset[1], offset[2];
+    }
+
+    else {
+
+        rotation = Vector3d(pixdim[1], pixdim[2], pixdim[3]).asDiagonal();
+        translation = Vector3d::Zero();
+    }
+
+    if (std::abs(rotation.determinant()) < 1e-12) {
+
+        std::cout << "featkNIfTIImage: Error: Singular voxel to world transform in " << fileName << "." << std::endl;
+        return false;
+    }
+
+    this->indexToWorld << rotation, translation;
+    this->data = data+voxelOffset;
+
+    return true;
+}
+
+inline double featkNIfTIImage::scale(double value) const {
+
+    return this->slope*value+this->intercept;
+}
+
+#endif // FEATKNIFTIIMAGE_H
@@ -31,7 +31,7 @@ inline size_t DOF_ID(const size_t nodeID, const unsigned int nodeDOF) {
 
 constexpr bool IS_POWER(const unsigned int a, const unsigned int b) {
 
-    return a==0 ? false : a==1 ? true : (a/b, b);
+    return a==0 ? false : a==1 ? true : a%b==0 && IS_POWER(a/b, b);
 }
 
 constexpr unsigned int LOG(const unsigned int a, const unsigned int b) {
@@ -48,6 +48,7 @@
 using namespace Eigen;
 
 template<unsigned int Dimension> class featkMesh;
+template<unsigned int Dimension> class featkStructuredGrid;
 
 template<unsigned int Dimension>
 class featkAttributable {
@@ -56,11 +57,13 @@ class featkAttributable {
 
         ~featkAttributable();
 
+        const MatrixXd* getAttribute(size_t id) const;  // No copy, nullptr if not set
         MatrixXd getAttributeValue(size_t id) const;
 
     protected:
 
         friend class featkMesh<Dimension>;
+        friend class featkStructuredGrid<Dimension>;
 
         featkAttributable();
 
@@ -88,6 +91,14 @@ void featkAttributable<Dimension>::addAttribute(size_t id, std::shared_ptr<Matri
     (*this->attributes[id]) += (*attribute);
 }
 
+template<unsigned int Dimension>
+const MatrixXd* featkAttributable<Dimension>::getAttribute(size_t id) const {
+
+    auto iterator = this->attributes.find(id);
+
+    return iterator != this->attributes.end() ? iterator->second.get() : nullptr;
+}
+
 template<unsigned int Dimension>
 MatrixXd featkAttributable<Dimension>::getAttributeValue(size_t id) const {
 
@@ -106,6 +106,8 @@ class featkElement final : public featkElementInterface<Dimension> {
         template<unsigned int Order> QMatrixType<Order> getNtCNQNQIntegralMatrix(size_t elementAttributeID, size_t nodeAttributeID) const;
         template<unsigned int Order> QMatrixType<Order> getQMatrix(size_t nodeAttributeID) const;
 
+        VectorXd getIntegrationPointWeights() const;
+        MatrixXd getIntegrationPointShapeFunctionValues() const;
         JacobianMatrixType getJacobian(const NaturalCoordinatesMatrixType& point) const;
         JacobianMatrixType getJacobian(const ShapeFunctionNaturalDerivativeValuesMatrixType& naturalDerivatives) const;
         NodesCartesianCoordinatesMatrixType getNodeCartesianCoordinates() const;
@@ -431,6 +433,38 @@ typename featkElement<Dimension, Nodes, Boundaries, NaturalDimension>::QMatrixTy
 }
 
 
+template<unsigned int Dimension, unsigned int Nodes, unsigned int Boundaries, unsigned int NaturalDimension=Dimension>
+VectorXd featkElement<Dimension, Nodes, Boundaries, NaturalDimension>::getIntegrationPointWeights() const {
+
+    /* Integration weights scaled by the Jacobian determinant, i.e. the physical quadrature weights of the element. */
+
+    std::vector<std::pair<double, NaturalCoordinatesMatrixType>> pointsAndWeights = this->integrationRule->getPointsAndWeights();
+    VectorXd weights = VectorXd(pointsAndWeights.size());
+
+    for (size_t p=0; p!=pointsAndWeights.size(); p++) {
+
+        weights(p) = pointsAndWeights[p].first*this->getJacobian(pointsAndWeights[p].second).determinant();
+    }
+
+    return weights;
+}
+
+template<unsigned int Dimension, unsigned int Nodes, unsigned int Boundaries, unsigned int NaturalDimension=Dimension>
+MatrixXd featkElement<Dimension, Nodes, Boundaries, NaturalDimension>::getIntegrationPointShapeFunctionValues() const {
+
+    /* One row per integration point. Only depends on the element type and integration rule. */
+
+    std::vector<std::pair<double, NaturalCoordinatesMatrixType>> pointsAndWeights = this->integrationRule->getPointsAndWeights();
+    MatrixXd values = MatrixXd(pointsAndWeights.size(), Nodes);
+
+    for (size_t p=0; p!=pointsAndWeights.size(); p++) {
+
+        values.row(p) = this->getShapeFunctionValues(pointsAndWeights[p].second);
+    }
+
+    return values;
+}
+
 template<unsigned int Dimension, unsigned int Nodes, unsigned int Boundaries, unsigned int NaturalDimension=Dimension>
 typename featkElement<Dimension, Nodes, Boundaries, NaturalDimension>::JacobianMatrixType featkElement<Dimension, Nodes, Boundaries, NaturalDimension>::getJacobian(const NaturalCoordinatesMatrixType& point) const {
 
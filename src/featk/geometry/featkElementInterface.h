@@ -66,6 +66,8 @@ class featkElementInterface : public featkAttributable<Dimension> {
 
         AttributeValueType<Dimension, 1> getBarycenter() const;
         featkElementType getElementType() const;
+        VectorXd getIntegrationPointWeights() const;
+        MatrixXd getIntegrationPointShapeFunctionValues() const;
         featkNode<Dimension>* getNode(unsigned int index) const;
         std::vector<featkNode<Dimension>*> getNodes() const;
 
@@ -427,6 +429,52 @@ featkElementType featkElementInterface<Dimension>::getElementType() const {
     return this->elementType;
 }
 
+template<unsigned int Dimension>
+VectorXd featkElementInterface<Dimension>::getIntegrationPointWeights() const {
+
+    VectorXd matrix;
+
+    switch (this->elementType) {
+
+        case FEATK_TET4:
+            matrix = static_cast<const featkTet4Element*>(this)->getIntegrationPointWeights();
+            break;
+
+        case FEATK_HEX8:
+            matrix = static_cast<const featkHex8Element*>(this)->getIntegrationPointWeights();
+            break;
+
+        default:
+            matrix = VectorXd::Zero(1);
+            break;
+    }
+
+    return matrix;
+}
+
+template<unsigned int Dimension>
+MatrixXd featkElementInterface<Dimension>::getIntegrationPointShapeFunctionValues() const {
+
+    MatrixXd matrix;
+
+    switch (this->elementType) {
+
+        case FEATK_TET4:
+            matrix = static_cast<const featkTet4Element*>(this)->getIntegrationPointShapeFunctionValues();
+            break;
+
+        case FEATK_HEX8:
+            matrix = static_cast<const featkHex8Element*>(this)->getIntegrationPointShapeFunctionValues();
+            break;
+
+        default:
+            matrix = MatrixXd::Zero(1, 1);
+            break;
+    }
+
+    return matrix;
+}
+
 template<unsigned int Dimension>
 featkNode<Dimension>* featkElementInterface<Dimension>::getNode(unsigned int index) const {
 
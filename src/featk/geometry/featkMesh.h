@@ -30,6 +30,11 @@
  * unique id to each attribute and keeping records of the attribute order
  * and name.
  *
+ * featkMesh also owns node featkTimeSeriesAttribute objects, storing the
+ * successive values of a node attribute, e.g. intermediate solver results,
+ * in a single contiguous buffer rather than as one attribute per node and
+ * per time step.
+ *
  * @tparam The cartesian dimension of the mesh.
  *
  */
@@ -39,6 +44,7 @@
 
 #include <featk/geometry/featkElementInterface.h>
 #include <featk/geometry/featkNode.h>
+#include <featk/geometry/featkTimeSeriesAttribute.h>
 
 #include <map>
 #include <memory>
@@ -66,15 +72,18 @@ class featkMesh {
         size_t getNodeAttributeID(std::string name, unsigned int order) const;
         std::map<std::string, std::pair<size_t, unsigned int>> getNodeAttributeTable() const;
         MatrixXd getNodeAttributeValues(std::string name, unsigned int order) const;
+        featkTimeSeriesAttribute* getNodeTimeSeriesAttribute(std::string name) const;
         const std::vector<featkNode<Dimension>*>& getNodes() const;
         size_t getNumberOfElements() const;
         size_t getNumberOfNodes() const;
         void removeElementAttribute(std::string name);
         void removeNodeAttribute(std::string name);
+        void removeNodeTimeSeriesAttribute(std::string name);
         size_t setElementAttributes(std::string name, unsigned int order, const std::vector<std::shared_ptr<MatrixXd>>& attributes);
         size_t setElementAttributeFromValues(std::string name, unsigned int order, const MatrixXd& values);
         size_t setNodeAttributes(std::string name, unsigned int order, const std::vector<std::shared_ptr<MatrixXd>>& attributes);
         size_t setNodeAttributeFromValues(std::string name, unsigned int order, const MatrixXd& values);
+        featkTimeSeriesAttribute* setNodeTimeSeriesAttribute(std::string name, unsigned int order, featkStoragePrecision precision=FEATK_DOUBLE_PRECISION);
 
     private:
 
@@ -94,6 +103,7 @@ class featkMesh {
         size_t nodeAttributeMaxID;
         std::map<std::string, std::pair<size_t, unsigned int>> nodeAttributeTable;
         std::vector<featkNode<Dimension>*> nodes;
+        std::map<std::string, std::unique_ptr<featkTimeSeriesAttribute>> nodeTimeSeriesAttributes;
 };
 
 template<unsigned int Dimension>
@@ -451,6 +461,12 @@ MatrixXd featkMesh<Dimension>::getNodeAttributeValues(std::string name, unsigned
     return this->getAttributeValues(this->nodeAttributeTable, this->nodes, name, order);
 }
 
+template<unsigned int Dimension>
+featkTimeSeriesAttribute* featkMesh<Dimension>::getNodeTimeSeriesAttribute(std::string name) const {
+
+    return this->nodeTimeSeriesAttributes.count(name) ? this->nodeTimeSeriesAttributes.at(name).get() : nullptr;
+}
+
 template<unsigned int Dimension>
 const std::vector<featkNode<Dimension>*>& featkMesh<Dimension>::getNodes() const {
 
@@ -521,6 +537,12 @@ void featkMesh<Dimension>::removeNodeAttribute(std::string name) {
     }
 }
 
+template<unsigned int Dimension>
+void featkMesh<Dimension>::removeNodeTimeSeriesAttribute(std::string name) {
+
+    this->nodeTimeSeriesAttributes.erase(name);
+}
+
 template<unsigned int Dimension>
 size_t featkMesh<Dimension>::setElementAttributes(std::string name, unsigned int order, const std::vector<std::shared_ptr<MatrixXd>>& attributes) {
 
@@ -557,4 +579,14 @@ size_t featkMesh<Dimension>::setNodeAttributeFromValues(std::string name, unsign
     return id;
 }
 
+template<unsigned int Dimension>
+featkTimeSeriesAttribute* featkMesh<Dimension>::setNodeTimeSeriesAttribute(std::string name, unsigned int order, featkStoragePrecision precision) {
+
+    /* Replaces any time series of the same name */
+
+    this->nodeTimeSeriesAttributes[name] = std::make_unique<featkTimeSeriesAttribute>(this->nodes.size(), POWER(Dimension, order), precision);
+
+    return this->nodeTimeSeriesAttributes[name].get();
+}
+
 #endif // FEATKMESH_H
@@ -54,6 +54,7 @@
 #include <vector>
 
 template<unsigned int Dimension> class featkElementInterface;
+template<unsigned int Dimension> class featkStructuredGrid;
 
 template<unsigned int Dimension>
 class featkNode : public featkAttributable<Dimension> {
@@ -70,6 +71,8 @@ class featkNode : public featkAttributable<Dimension> {
 
     private:
 
+        friend class featkStructuredGrid<Dimension>;
+
         std::vector<featkElementInterface<Dimension>*> elements;
         size_t id;  // Auto-assign id using a static counter variable?
 };
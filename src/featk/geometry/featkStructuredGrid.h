@@ -0,0 +1,594 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkStructuredGrid.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkStructuredGrid
+ *
+ * @brief Implicit structured grid in Dimension dimensions.
+ *
+ * featkStructuredGrid describes the same grid as featk3DGridSource, with
+ * the same node and element numbering, from its dimensions (number of
+ * nodes along each axis), spacing, origin and element type only, instead
+ * of one featkNode and one featkElementInterface object per node and
+ * element. Node coordinates and element node ids are computed on demand,
+ * and node and element attributes are stored as single (items x rows,
+ * cols) value matrices, as returned by featkMesh::getNodeAttributeValues()
+ * and featkMesh::getElementAttributeValues(), so that the memory footprint
+ * reduces to these attribute values.
+ *
+ * forEachElement() calls a function on each element in turn, the element
+ * being a flyweight featkElementInterface whose nodes, node and element
+ * attributes are overwritten from one element to the next, so that the
+ * featkElementInterface integral getters, and thus solvers through
+ * featkSolverBase::setInputStructuredGrid(), can be used unchanged. The
+ * element and its nodes are valid during the call only.
+ *
+ * "Cartesian Coordinates" is registered as node attribute of order 1 with
+ * id 1, as in featkMesh, but computed from the grid geometry and cannot be
+ * set.
+ *
+ * toMesh() builds the equivalent featkMesh, with copies of the node and
+ * element attributes and of the node time series, e.g. to write results
+ * with featkVTUWriter or featkXDMFTimeSeriesWriter.
+ *
+ * @warning As featk3DGridSource, featkStructuredGrid only supports
+ * Dimension 3 with FEATK_HEX8 or FEATK_TET4 elements, node derivative
+ * quantities (see featkMesh::computeNodeBQ()) not being available.
+ *
+ * @tparam Dimension The cartesian dimension of the grid.
+ *
+ */
+
+#ifndef FEATKSTRUCTUREDGRID_H
+#define FEATKSTRUCTUREDGRID_H
+
+#include <featk/core/featkDefines.h>
+#include <featk/geometry/featkHex8Element.h>
+#include <featk/geometry/featkMesh.h>
+#include <featk/geometry/featkNode.h>
+#include <featk/geometry/featkTet4Element.h>
+#include <featk/geometry/featkTimeSeriesAttribute.h>
+
+#include <array>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+template<unsigned int Dimension>
+class featkStructuredGrid {
+
+    static_assert(Dimension == 3, "featkStructuredGrid only supports Dimension 3.");
+
+    public:
+
+        featkStructuredGrid(std::array<unsigned int, 3> dimensions, std::array<double, 3> spacing, std::array<double, 3> origin, featkElementType elementType=FEATK_HEX8);
+        ~featkStructuredGrid();
+
+        template<typename Function> void forEachElement(Function function) const;
+
+        std::array<unsigned int, 3> getDimensions() const;
+        size_t getElementAttributeID(std::string name, unsigned int order) const;
+        std::map<std::string, std::pair<size_t, unsigned int>> getElementAttributeTable() const;
+        MatrixXd getElementAttributeValues(std::string name, unsigned int order) const;
+        std::vector<size_t> getElementNodeIDs(size_t index) const;
+        featkElementType getElementType() const;
+        size_t getNodeAttributeID(std::string name, unsigned int order) const;
+        std::map<std::string, std::pair<size_t, unsigned int>> getNodeAttributeTable() const;
+        MatrixXd getNodeAttributeValues(std::string name, unsigned int order) const;
+        AttributeValueType<Dimension, 1> getNodeCoordinates(size_t index) const;
+        featkTimeSeriesAttribute* getNodeTimeSeriesAttribute(std::string name) const;
+        size_t getNumberOfElements() const;
+        size_t getNumberOfNodes() const;
+        void removeElementAttribute(std::string name);
+        void removeNodeAttribute(std::string name);
+        void removeNodeTimeSeriesAttribute(std::string name);
+        size_t setElementAttributeFromValues(std::string name, unsigned int order, const MatrixXd& values);
+        size_t setNodeAttributeFromValues(std::string name, unsigned int order, const MatrixXd& values);
+        featkTimeSeriesAttribute* setNodeTimeSeriesAttribute(std::string name, unsigned int order, featkStoragePrecision precision=FEATK_DOUBLE_PRECISION);
+        featkMesh<Dimension>* toMesh() const;
+
+    private:
+
+        size_t getAttributeID(const std::map<std::string, std::pair<size_t, unsigned int>>& attributeTable, std::string name, unsigned int order) const;
+        MatrixXd getAttributeValues(const std::map<std::string, std::pair<size_t, unsigned int>>& attributeTable, const std::map<size_t, MatrixXd>& attributes, size_t items, std::string name, unsigned int order) const;
+        std::array<size_t, 8> getCellNodeIDs(size_t cell) const;
+        size_t setAttributeFromValues(std::map<std::string, std::pair<size_t, unsigned int>>& attributeTable, size_t& attributeMaxID, std::map<size_t, MatrixXd>& attributes, size_t items, std::string name, unsigned int order, const MatrixXd& values);
+
+        static const unsigned int TETRAHEDRA[5][4];  // Cell node indices of each tetrahedron, as featk3DGridSource
+
+        std::array<unsigned int, 3> dimensions;
+        featkElementType elementType;
+        std::array<double, 3> origin;
+        std::array<double, 3> spacing;
+
+        size_t elementAttributeMaxID;
+        std::map<std::string, std::pair<size_t, unsigned int>> elementAttributeTable;
+        std::map<size_t, MatrixXd> elementAttributes;  // (elements x rows, cols) values by id
+        size_t nodeAttributeMaxID;
+        std::map<std::string, std::pair<size_t, unsigned int>> nodeAttributeTable;
+        std::map<size_t, MatrixXd> nodeAttributes;     // (nodes x rows, cols) values by id, coordinates excepted
+        std::map<std::string, std::unique_ptr<featkTimeSeriesAttribute>> nodeTimeSeriesAttributes;
+};
+
+template<unsigned int Dimension>
+const unsigned int featkStructuredGrid<Dimension>::TETRAHEDRA[5][4] = {{0, 2, 5, 1}, {2, 7, 5, 6}, {0, 7, 2, 3}, {0, 5, 2, 7}, {0, 5, 7, 4}};
+
+template<unsigned int Dimension>
+featkStructuredGrid<Dimension>::featkStructuredGrid(std::array<unsigned int, 3> dimensions, std::array<double, 3> spacing, std::array<double, 3> origin, featkElementType elementType) {
+
+    this->dimensions = dimensions;
+    this->elementType = elementType;
+    this->origin = origin;
+    this->spacing = spacing;
+
+    this->elementAttributeMaxID = 0;
+    this->nodeAttributeMaxID = 0;
+
+    this->nodeAttributeTable["Cartesian Coordinates"] = std::make_pair(++this->nodeAttributeMaxID, 1);
+}
+
+template<unsigned int Dimension>
+featkStructuredGrid<Dimension>::~featkStructuredGrid() {
+
+}
+
+template<unsigned int Dimension>
+template<typename Function>
+void featkStructuredGrid<Dimension>::forEachElement(Function function) const {
+
+    /*
+        The 8 flyweight nodes of the current cell are shared by its flyweight elements and hold one preallocated value
+        per node attribute, overwritten cell after cell, so that no allocation occurs per element.
+    */
+
+    std::vector<std::unique_ptr<featkNode<Dimension>>> nodes;
+    std::vector<std::unique_ptr<featkElementInterface<Dimension>>> elements;
+
+    for (unsigned int c=0; c!=8; c++) {
+
+        nodes.push_back(std::make_unique<featkNode<Dimension>>(0, AttributeValueType<Dimension, 1>::Zero()));
+    }
+
+    if (this->elementType == FEATK_TET4) {
+
+        for (unsigned int t=0; t!=5; t++) {
+
+            elements.push_back(std::make_unique<featkTet4Element>(std::vector<featkNode<Dimension>*>({nodes[TETRAHEDRA[t][0]].get(), nodes[TETRAHEDRA[t][1]].get(), nodes[TETRAHEDRA[t][2]].get(), nodes[TETRAHEDRA[t][3]].get()})));
+        }
+    }
+
+    else {
+
+        elements.push_back(std::make_unique<featkHex8Element>(std::vector<featkNode<Dimension>*>({nodes[0].get(), nodes[1].get(), nodes[2].get(), nodes[3].get(), nodes[4].get(), nodes[5].get(), nodes[6].get(), nodes[7].get()})));
+    }
+
+    std::vector<std::shared_ptr<MatrixXd>> nodeCoordinates(8);
+    std::vector<std::vector<std::pair<MatrixXd*, const MatrixXd*>>> nodeValues(8);        // Flyweight value, grid values
+    std::vector<std::vector<std::pair<MatrixXd*, const MatrixXd*>>> elementValues(elements.size());
+
+    for (unsigned int c=0; c!=8; c++) {
+
+        nodeCoordinates[c] = std::make_shared<MatrixXd>(Dimension, 1);
+        nodes[c]->setAttribute(1, nodeCoordinates[c]);
+
+        for (const auto& pair : this->nodeAttributes) {
+
+            std::shared_ptr<MatrixXd> value = std::make_shared<MatrixXd>(pair.second.rows()/this->getNumberOfNodes(), pair.second.cols());
+            nodes[c]->setAttribute(pair.first, value);
+            nodeValues[c].push_back(std::make_pair(value.get(), &pair.second));
+        }
+    }
+
+    for (size_t t=0; t!=elements.size(); t++) {
+
+        for (const auto& pair : this->elementAttributes) {
+
+            std::shared_ptr<MatrixXd> value = std::make_shared<MatrixXd>(pair.second.rows()/this->getNumberOfElements(), pair.second.cols());
+            elements[t]->setAttribute(pair.first, value);
+            elementValues[t].push_back(std::make_pair(value.get(), &pair.second));
+        }
+    }
+
+    size_t numberOfCells = this->getNumberOfElements()/elements.size();
+    size_t e = 0;
+
+    for (size_t cell=0; cell!=numberOfCells; cell++) {
+
+        std::array<size_t, 8> ids = this->getCellNodeIDs(cell);
+
+        for (unsigned int c=0; c!=8; c++) {
+
+            nodes[c]->id = ids[c];
+            *nodeCoordinates[c] = this->getNodeCoordinates(ids[c]);
+
+            for (const auto& pair : nodeValues[c]) {
+
+                *pair.first = pair.second->block(ids[c]*pair.first->rows(), 0, pair.first->rows(), pair.first->cols());
+            }
+        }
+
+        for (size_t t=0; t!=elements.size(); t++) {
+
+            for (const auto& pair : elementValues[t]) {
+
+                *pair.first = pair.second->block(e*pair.first->rows(), 0, pair.first->rows(), pair.first->cols());
+            }
+
+            function(elements[t].get());
+            e++;
+        }
+    }
+}
+
+template<unsigned int Dimension>
+size_t featkStructuredGrid<Dimension>::getAttributeID(const std::map<std::string, std::pair<size_t, unsigned int>>& attributeTable, std::string name, unsigned int order) const {
+
+    return attributeTable.count(name) && attributeTable.at(name).second == order ? attributeTable.at(name).first : 0;
+}
+
+template<unsigned int Dimension>
+MatrixXd featkStructuredGrid<Dimension>::getAttributeValues(const std::map<std::string, std::pair<size_t, unsigned int>>& attributeTable, const std::map<size_t, MatrixXd>& attributes, size_t items, std::string name, unsigned int order) const {
+
+    size_t id = this->getAttributeID(attributeTable, name, order);
+
+    return attributes.count(id) ? attributes.at(id) : MatrixXd::Zero(items*POWER(Dimension, order/2+order%2), POWER(Dimension, order/2));
+}
+
+template<unsigned int Dimension>
+std::array<size_t, 8> featkStructuredGrid<Dimension>::getCellNodeIDs(size_t cell) const {
+
+    size_t nx = this->dimensions[0];
+    size_t ny = this->dimensions[1];
+
+    size_t x = cell % (nx-1);
+    size_t y = cell/(nx-1) % (ny-1);
+    size_t z = cell/((nx-1)*(ny-1));
+
+    return {    z*nx*ny +     y*nx +     x,
+                z*nx*ny +     y*nx + (x+1),
+                z*nx*ny + (y+1)*nx + (x+1),
+                z*nx*ny + (y+1)*nx +     x,
+            (z+1)*nx*ny +     y*nx +     x,
+            (z+1)*nx*ny +     y*nx + (x+1),
+            (z+1)*nx*ny + (y+1)*nx + (x+1),
+            (z+1)*nx*ny + (y+1)*nx +     x};
+}
+
+template<unsigned int Dimension>
+std::array<unsigned int, 3> featkStructuredGrid<Dimension>::getDimensions() const {
+
+    return this->dimensions;
+}
+
+template<unsigned int Dimension>
+size_t featkStructuredGrid<Dimension>::getElementAttributeID(std::string name, unsigned int order) const {
+
+    return this->getAttributeID(this->elementAttributeTable, name, order);
+}
+
+template<unsigned int Dimension>
+std::map<std::string, std::pair<size_t, unsigned int>> featkStructuredGrid<Dimension>::getElementAttributeTable() const {
+
+    return this->elementAttributeTable;
+}
+
+template<unsigned int Dimension>
+MatrixXd featkStructuredGrid<Dimension>::getElementAttributeValues(std::string name, unsigned int order) const {
+
+    return this->getAttributeValues(this->elementAttributeTable, this->elementAttributes, this->getNumberOfElements(), name, order);
+}
+
+template<unsigned int Dimension>
+std::vector<size_t> featkStructuredGrid<Dimension>::getElementNodeIDs(size_t index) const {
+
+    if (this->elementType == FEATK_TET4) {
+
+        std::array<size_t, 8> ids = this->getCellNodeIDs(index/5);
+        const unsigned int* tetrahedron = TETRAHEDRA[index % 5];
+
+        return {ids[tetrahedron[0]], ids[tetrahedron[1]], ids[tetrahedron[2]], ids[tetrahedron[3]]};
+    }
+
+    std::array<size_t, 8> ids = this->getCellNodeIDs(index);
+
+    return std::vector<size_t>(ids.begin(), ids.end());
+}
+
+template<unsigned int Dimension>
+featkElementType featkStructuredGrid<Dimension>::getElementType() const {
+
+    return this->elementType;
+}
+
+template<unsigned int Dimension>
+size_t featkStructuredGrid<Dimension>::getNodeAttributeID(std::string name, unsigned int order) const {
+
+    return this->getAttributeID(this->nodeAttributeTable, name, order);
+}
+
+template<unsigned int Dimension>
+std::map<std::string, std::pair<size_t, unsigned int>> featkStructuredGrid<Dimension>::getNodeAttributeTable() const {
+
+    return this->nodeAttributeTable;
+}
+
+template<unsigned int Dimension>
+MatrixXd featkStructuredGrid<Dimension>::getNodeAttributeValues(std::string name, unsigned int order) const {
+
+    if (this->getNodeAttributeID(name, order) == 1) {
+
+        MatrixXd values(this->getNumberOfNodes()*Dimension, 1);
+
+        for (size_t n=0; n!=this->getNumberOfNodes(); n++) {
+
+            values.block(n*Dimension, 0, Dimension, 1) = this->getNodeCoordinates(n);
+        }
+
+        return values;
+    }
+
+    return this->getAttributeValues(this->nodeAttributeTable, this->nodeAttributes, this->getNumberOfNodes(), name, order);
+}
+
+template<unsigned int Dimension>
+AttributeValueType<Dimension, 1> featkStructuredGrid<Dimension>::getNodeCoordinates(size_t index) const {
+
+    size_t nx = this->dimensions[0];
+    size_t ny = this->dimensions[1];
+
+    size_t x = index % nx;
+    size_t y = index/nx % ny;
+    size_t z = index/(nx*ny);
+
+    return (AttributeValueType<Dimension, 1>() << this->spacing[0]*x-this->origin[0], this->spacing[1]*y-this->origin[1], this->spacing[2]*z-this->origin[2]).finished();
+}
+
+template<unsigned int Dimension>
+featkTimeSeriesAttribute* featkStructuredGrid<Dimension>::getNodeTimeSeriesAttribute(std::string name) const {
+
+    return this->nodeTimeSeriesAttributes.count(name) ? this->nodeTimeSeriesAttributes.at(name).get() : nullptr;
+}
+
+template<unsigned int Dimension>
+size_t featkStructuredGrid<Dimension>::getNumberOfElements() const {
+
+    size_t cells = size_t(this->dimensions[0]-1)*(this->dimensions[1]-1)*(this->dimensions[2]-1);
+
+    return this->elementType == FEATK_TET4 ? 5*cells : cells;
+}
+
+template<unsigned int Dimension>
+size_t featkStructuredGrid<Dimension>::getNumberOfNodes() const {
+
+    return size_t(this->dimensions[0])*this->dimensions[1]*this->dimensions[2];
+}
+
+template<unsigned int Dimension>
+void featkStructuredGrid<Dimension>::removeElementAttribute(std::string name) {
+
+    if (this->elementAttributeTable.count(name)) {
+
+        this->elementAttributes.erase(this->elementAttributeTable.at(name).first);
+        this->elementAttributeTable.erase(name);
+    }
+}
+
+template<unsigned int Dimension>
+void featkStructuredGrid<Dimension>::removeNodeAttribute(std::string name) {
+
+    if (this->nodeAttributeTable.count(name) && this->nodeAttributeTable.at(name).first != 1) {
+
+        this->nodeAttributes.erase(this->nodeAttributeTable.at(name).first);
+        this->nodeAttributeTable.erase(name);
+    }
+}
+
+template<unsigned int Dimension>
+void featkStructuredGrid<Dimension>::removeNodeTimeSeriesAttribute(std::string name) {
+
+    this->nodeTimeSeriesAttributes.erase(name);
+}
+
+template<unsigned int Dimension>
+size_t featkStructuredGrid<Dimension>::setAttributeFromValues(std::map<std::string, std::pair<size_t, unsigned int>>& attributeTable, size_t& attributeMaxID, std::map<size_t, MatrixXd>& attributes, size_t items, std::string name, unsigned int order, const MatrixXd& values) {
+
+    /* Same value layouts as featkMesh::setNodeAttributeFromValues(), one value for all the items being broadcast. */
+
+    unsigned int rows = POWER(Dimension, order/2+order%2);
+    unsigned int cols = POWER(Dimension, order/2);
+    unsigned int components = rows*cols;
+
+    MatrixXd column;
+
+    if (values.cols() == cols && values.rows() == rows*items) {
+
+        column = values;
+    }
+
+    else if (values.cols() == 1 && values.rows() == components*items) {
+
+        column = MatrixXd(items*rows, cols);
+
+        for (size_t i=0; i!=items; i++) {
+
+            column.block(i*rows, 0, rows, cols) = Map<const Matrix<double, Dynamic, Dynamic, RowMajor>>(values.data()+i*components, rows, cols);
+        }
+    }
+
+    else if (values.cols() == cols && values.rows() == rows) {
+
+        column = values.replicate(items, 1);
+    }
+
+    else if (values.cols() == 1 && values.rows() == components) {
+
+        column = Map<const Matrix<double, Dynamic, Dynamic, RowMajor>>(values.data(), rows, cols).replicate(items, 1);
+    }
+
+    else {
+
+        std::cout << "featkStructuredGrid: Error: Values of attribute " << name << " do not match the number of items and order." << std::endl;
+        return 0;
+    }
+
+    if (attributeTable.count(name)) {
+
+        attributeTable[name].second = order;
+    }
+
+    else {
+
+        attributeTable[name] = std::make_pair(++attributeMaxID, order);
+    }
+
+    size_t id = attributeTable.at(name).first;
+    attributes[id] = column;
+
+    return id;
+}
+
+template<unsigned int Dimension>
+size_t featkStructuredGrid<Dimension>::setElementAttributeFromValues(std::string name, unsigned int order, const MatrixXd& values) {
+
+    return this->setAttributeFromValues(this->elementAttributeTable, this->elementAttributeMaxID, this->elementAttributes, this->getNumberOfElements(), name, order, values);
+}
+
+template<unsigned int Dimension>
+size_t featkStructuredGrid<Dimension>::setNodeAttributeFromValues(std::string name, unsigned int order, const MatrixXd& values) {
+
+    if (name == "Cartesian Coordinates") {
+
+        std::cout << "featkStructuredGrid: Error: Cartesian Coordinates are implicit and cannot be set." << std::endl;
+        return 0;
+    }
+
+    return this->setAttributeFromValues(this->nodeAttributeTable, this->nodeAttributeMaxID, this->nodeAttributes, this->getNumberOfNodes(), name, order, values);
+}
+
+template<unsigned int Dimension>
+featkTimeSeriesAttribute* featkStructuredGrid<Dimension>::setNodeTimeSeriesAttribute(std::string name, unsigned int order, featkStoragePrecision precision) {
+
+    /* Replaces any time series of the same name */
+
+    this->nodeTimeSeriesAttributes[name] = std::make_unique<featkTimeSeriesAttribute>(this->getNumberOfNodes(), POWER(Dimension, order), precision);
+
+    return this->nodeTimeSeriesAttributes[name].get();
+}
+
+template<unsigned int Dimension>
+featkMesh<Dimension>* featkStructuredGrid<Dimension>::toMesh() const {
+
+    /* Elements are created sequentially, as they register themselves to their nodes. */
+
+    Index numberOfNodes = this->getNumberOfNodes();
+    Index numberOfElements = this->getNumberOfElements();
+
+    std::vector<featkNode<Dimension>*> nodes(numberOfNodes);
+    std::vector<featkElementInterface<Dimension>*> elements(numberOfElements);
+
+    #pragma omp parallel for
+    for (Index n=0; n<numberOfNodes; n++) {
+
+        nodes[n] = new featkNode<Dimension>(n, this->getNodeCoordinates(n));
+    }
+
+    for (Index e=0; e!=numberOfElements; e++) {
+
+        std::vector<size_t> ids = this->getElementNodeIDs(e);
+        std::vector<featkNode<Dimension>*> elementNodes(ids.size());
+
+        for (size_t j=0; j!=ids.size(); j++) {
+
+            elementNodes[j] = nodes[ids[j]];
+        }
+
+        if (this->elementType == FEATK_TET4) {
+
+            elements[e] = new featkTet4Element(elementNodes);
+        }
+
+        else {
+
+            elements[e] = new featkHex8Element(elementNodes);
+        }
+    }
+
+    featkMesh<Dimension>* mesh = new featkMesh<Dimension>(nodes, elements);
+
+
+    // Attributes, split back into one value per item
+
+    for (unsigned int node=0; node!=2; node++) {
+
+        const std::map<std::string, std::pair<size_t, unsigned int>>& attributeTable = node ? this->nodeAttributeTable : this->elementAttributeTable;
+        const std::map<size_t, MatrixXd>& attributes = node ? this->nodeAttributes : this->elementAttributes;
+        Index items = node ? numberOfNodes : numberOfElements;
+
+        for (const auto& pair : attributeTable) {
+
+            if (!attributes.count(pair.second.first)) {  // Cartesian coordinates
+
+                continue;
+            }
+
+            const MatrixXd& values = attributes.at(pair.second.first);
+            Index rows = values.rows()/items;
+            std::vector<std::shared_ptr<MatrixXd>> itemValues(items);
+
+            #pragma omp parallel for
+            for (Index i=0; i<items; i++) {
+
+                itemValues[i] = std::make_shared<MatrixXd>(values.block(i*rows, 0, rows, values.cols()));
+            }
+
+            if (node) {
+
+                mesh->setNodeAttributes(pair.first, pair.second.second, itemValues);
+            }
+
+            else {
+
+                mesh->setElementAttributes(pair.first, pair.second.second, itemValues);
+            }
+        }
+    }
+
+
+    // Time series
+
+    for (const auto& pair : this->nodeTimeSeriesAttributes) {
+
+        const featkTimeSeriesAttribute* timeSeries = pair.second.get();
+        featkTimeSeriesAttribute* meshTimeSeries = mesh->setNodeTimeSeriesAttribute(pair.first, LOG(timeSeries->getNumberOfComponents(), Dimension), timeSeries->getPrecision());
+
+        meshTimeSeries->reserve(timeSeries->getNumberOfTimeSteps());
+
+        for (size_t step=0; step!=timeSeries->getNumberOfTimeSteps(); step++) {
+
+            meshTimeSeries->append(timeSeries->getTimes()[step], timeSeries->getTimeStepValues(step));
+        }
+    }
+
+    return mesh;
+}
+
+#endif // FEATKSTRUCTUREDGRID_H
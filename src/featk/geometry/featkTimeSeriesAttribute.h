@@ -0,0 +1,296 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkTimeSeriesAttribute.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkTimeSeriesAttribute
+ *
+ * @brief Time series of an attribute of all the nodes of a featkMesh in a
+ * single contiguous buffer.
+ *
+ * featkTimeSeriesAttribute stores the successive values of an attribute
+ * of numberOfItems items with numberOfComponents components each, in a
+ * single contiguous (time steps x items x components) buffer instead of
+ * one std::shared_ptr<MatrixXd> per item and per time step (see
+ * featkAttributable). featkMesh and featkStructuredGrid own such series
+ * for their nodes only (see featkMesh::setNodeTimeSeriesAttribute()).
+ *
+ * The values are converted at append() time into the storage precision
+ * selected at construction (see featkStoragePrecision), single and half
+ * precision dividing the memory footprint by 2 and 4 respectively at the
+ * cost of a relative rounding error of about 6e-8 and 5e-4, half precision
+ * values being moreover limited to [-65504, 65504].
+ *
+ * getTimeStep() returns a zero-copy, row major (items x components)
+ * Eigen::Map view of a time step, whose scalar type must be the one of the
+ * storage precision (double, float or Eigen::half), while
+ * getTimeStepValues() returns a double precision copy whatever the storage
+ * precision. Views are invalidated when appending beyond the capacity set
+ * by reserve(). truncate() drops the last time steps, e.g. those computed
+ * after the checkpoint a solver restarts from.
+ *
+ */
+
+#ifndef FEATKTIMESERIESATTRIBUTE_H
+#define FEATKTIMESERIESATTRIBUTE_H
+
+#include <featk/core/featkDefines.h>
+
+#include <Eigen/Dense>
+
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+using namespace Eigen;
+
+class featkTimeSeriesAttribute {
+
+    public:
+
+        template<typename ScalarType> using TimeStepType = Map<const Matrix<ScalarType, Dynamic, Dynamic, RowMajor>>;
+
+        featkTimeSeriesAttribute(size_t numberOfItems, Index numberOfComponents, featkStoragePrecision precision=FEATK_DOUBLE_PRECISION);
+        ~featkTimeSeriesAttribute();
+
+        bool append(double time, const MatrixXd& values);
+        void clear();
+        Index getNumberOfComponents() const;
+        size_t getNumberOfItems() const;
+        size_t getNumberOfTimeSteps() const;
+        featkStoragePrecision getPrecision() const;
+        const std::vector<double>& getTimes() const;
+        template<typename ScalarType> TimeStepType<ScalarType> getTimeStep(size_t step) const;
+        MatrixXd getTimeStepValues(size_t step) const;
+        void reserve(size_t timeSteps);
+        void truncate(size_t timeSteps);
+
+    private:
+
+        template<typename ScalarType> void convert(const Matrix<double, Dynamic, Dynamic, RowMajor>& values, unsigned char* data) const;
+        template<typename ScalarType> MatrixXd convert(const unsigned char* data) const;
+        size_t getScalarSize() const;
+        size_t getTimeStepSize() const;
+        template<typename ScalarType> bool isStorageType() const;
+
+        std::vector<unsigned char> buffer;
+        size_t numberOfItems;
+        Index numberOfComponents;
+        featkStoragePrecision precision;
+        std::vector<double> times;
+};
+
+inline featkTimeSeriesAttribute::featkTimeSeriesAttribute(size_t numberOfItems, Index numberOfComponents, featkStoragePrecision precision) {
+
+    this->numberOfItems = numberOfItems;
+    this->numberOfComponents = numberOfComponents;
+    this->precision = precision;
+}
+
+inline featkTimeSeriesAttribute::~featkTimeSeriesAttribute() {
+
+}
+
+inline bool featkTimeSeriesAttribute::append(double time, const MatrixXd& values) {
+
+    /* Accepts (items x components) matrices or item-wise stacked vectors, as featkMesh::setNodeAttributeFromValues. */
+
+    Matrix<double, Dynamic, Dynamic, RowMajor> rowMajorValues;
+
+    if (size_t(values.rows()) == this->numberOfItems && values.cols() == this->numberOfComponents) {
+
+        rowMajorValues = values;
+    }
+
+    else if (values.cols() == 1 && size_t(values.rows()) == this->numberOfItems*this->numberOfComponents) {
+
+        rowMajorValues = Map<const Matrix<double, Dynamic, Dynamic, RowMajor>>(values.data(), this->numberOfItems, this->numberOfComponents);
+    }
+
+    else {
+
+        std::cout << "featkTimeSeriesAttribute: Warning: Values do not match the number of items and components, time step ignored." << std::endl;
+        return false;
+    }
+
+    size_t offset = this->buffer.size();
+    this->buffer.resize(offset + this->getTimeStepSize());
+    this->times.push_back(time);
+
+    switch (this->precision) {
+
+        case FEATK_SINGLE_PRECISION:
+
+            this->convert<float>(rowMajorValues, this->buffer.data()+offset);
+            break;
+
+        case FEATK_HALF_PRECISION:
+
+            this->convert<Eigen::half>(rowMajorValues, this->buffer.data()+offset);
+            break;
+
+        default:
+
+            this->convert<double>(rowMajorValues, this->buffer.data()+offset);
+            break;
+    }
+
+    return true;
+}
+
+inline void featkTimeSeriesAttribute::clear() {
+
+    this->buffer.clear();
+    this->times.clear();
+}
+
+template<typename ScalarType>
+void featkTimeSeriesAttribute::convert(const Matrix<double, Dynamic, Dynamic, RowMajor>& values, unsigned char* data) const {
+
+    Map<Matrix<ScalarType, Dynamic, Dynamic, RowMajor>>(reinterpret_cast<ScalarType*>(data), this->numberOfItems, this->numberOfComponents) = values.template cast<ScalarType>();
+}
+
+template<typename ScalarType>
+MatrixXd featkTimeSeriesAttribute::convert(const unsigned char* data) const {
+
+    return Map<const Matrix<ScalarType, Dynamic, Dynamic, RowMajor>>(reinterpret_cast<const ScalarType*>(data), this->numberOfItems, this->numberOfComponents).template cast<double>();
+}
+
+inline Index featkTimeSeriesAttribute::getNumberOfComponents() const {
+
+    return this->numberOfComponents;
+}
+
+inline size_t featkTimeSeriesAttribute::getNumberOfItems() const {
+
+    return this->numberOfItems;
+}
+
+inline size_t featkTimeSeriesAttribute::getNumberOfTimeSteps() const {
+
+    return this->times.size();
+}
+
+inline featkStoragePrecision featkTimeSeriesAttribute::getPrecision() const {
+
+    return this->precision;
+}
+
+inline size_t featkTimeSeriesAttribute::getScalarSize() const {
+
+    switch (this->precision) {
+
+        case FEATK_SINGLE_PRECISION:
+
+            return sizeof(float);
+
+        case FEATK_HALF_PRECISION:
+
+            return sizeof(Eigen::half);
+
+        default:
+
+            return sizeof(double);
+    }
+}
+
+inline const std::vector<double>& featkTimeSeriesAttribute::getTimes() const {
+
+    return this->times;
+}
+
+template<typename ScalarType>
+featkTimeSeriesAttribute::TimeStepType<ScalarType> featkTimeSeriesAttribute::getTimeStep(size_t step) const {
+
+    if (step >= this->times.size() || !this->isStorageType<ScalarType>()) {
+
+        std::cout << "featkTimeSeriesAttribute: Warning: Invalid time step or scalar type." << std::endl;
+        return TimeStepType<ScalarType>(nullptr, 0, 0);
+    }
+
+    return TimeStepType<ScalarType>(reinterpret_cast<const ScalarType*>(this->buffer.data() + step*this->getTimeStepSize()), this->numberOfItems, this->numberOfComponents);
+}
+
+inline size_t featkTimeSeriesAttribute::getTimeStepSize() const {
+
+    return this->numberOfItems*this->numberOfComponents*this->getScalarSize();
+}
+
+inline MatrixXd featkTimeSeriesAttribute::getTimeStepValues(size_t step) const {
+
+    if (step >= this->times.size()) {
+
+        return MatrixXd::Zero(this->numberOfItems, this->numberOfComponents);
+    }
+
+    const unsigned char* data = this->buffer.data() + step*this->getTimeStepSize();
+
+    switch (this->precision) {
+
+        case FEATK_SINGLE_PRECISION:
+
+            return this->convert<float>(data);
+
+        case FEATK_HALF_PRECISION:
+
+            return this->convert<Eigen::half>(data);
+
+        default:
+
+            return this->convert<double>(data);
+    }
+}
+
+template<typename ScalarType>
+bool featkTimeSeriesAttribute::isStorageType() const {
+
+    switch (this->precision) {
+
+        case FEATK_SINGLE_PRECISION:
+
+            return std::is_same<ScalarType, float>::value;
+
+        case FEATK_HALF_PRECISION:
+
+            return std::is_same<ScalarType, Eigen::half>::value;
+
+        default:
+
+            return std::is_same<ScalarType, double>::value;
+    }
+}
+
+inline void featkTimeSeriesAttribute::reserve(size_t timeSteps) {
+
+    this->buffer.reserve(timeSteps*this->getTimeStepSize());
+    this->times.reserve(timeSteps);
+}
+
+inline void featkTimeSeriesAttribute::truncate(size_t timeSteps) {
+
+    /* Keeps the first timeSteps time steps, views of these remaining valid. */
+
+    if (timeSteps < this->times.size()) {
+
+        this->buffer.resize(timeSteps*this->getTimeStepSize());
+        this->times.resize(timeSteps);
+    }
+}
+
+#endif // FEATKTIMESERIESATTRIBUTE_H
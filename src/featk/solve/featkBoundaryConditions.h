@@ -31,6 +31,14 @@
  * system vector can be trivially modified, and non-zero prescrided values,
  * involving iteration over non-zeros entries of the global system matrix.
  *
+ * Prescribed values are recorded in insertion order and consolidated on
+ * demand, so that setting thousands of values (e.g. through the node set
+ * or coordinate predicate overloads of setDOFValues()) only costs vector
+ * appends. The compile() function turns the conditions into sorted dof
+ * index arrays, packed value vectors and a dense dof mask that solvers can
+ * reuse at every time step without rebuilding any std::set or std::map.
+ * The compiled data is invalidated whenever a value is set or added.
+ *
  * @tparam Dimension The cartesian dimension of the problem.
  *
  * @tparam Order The order of the variable the system is solved for.
@@ -40,10 +48,17 @@
 #ifndef FEATKBOUNDARYCONDITIONS_H
 #define FEATKBOUNDARYCONDITIONS_H
 
+#include <featk/core/featkDefines.h>
 #include <featk/core/featkUtils.h>
+#include <featk/geometry/featkMesh.h>
 
+#include <algorithm>
+#include <functional>
+#include <iostream>
 #include <map>
 #include <set>
+#include <tuple>
+#include <vector>
 
 template<unsigned int Dimension, unsigned int Order>
 class featkBoundaryConditions {
@@ -54,21 +69,43 @@ class featkBoundaryConditions {
         ~featkBoundaryConditions();
 
         void addDOFValue(size_t nodeID, unsigned int nodeDOF, double value);
+        void compile(size_t numberOfDOFs);
         std::set<size_t> getAllDOFs();
         std::map<size_t, double> getAllDOFValues();
+        const std::vector<bool>& getCompiledDOFMask();
+        const std::vector<size_t>& getCompiledDOFs();
+        const VectorXd& getCompiledDOFValues();
+        const std::vector<size_t>& getCompiledNonZeroDOFs();
+        const VectorXd& getCompiledNonZeroDOFValues();
         std::set<size_t> getNonZeroDOFs();
         std::map<size_t, double> getNonZeroDOFValues();
         std::set<size_t> getZeroDOFs();
+        bool isCompiled(size_t numberOfDOFs) const;
         void setDOFValue(size_t nodeID, unsigned int nodeDOF, double value);
+        void setDOFValues(const std::vector<size_t>& nodeIDs, unsigned int nodeDOF, double value);
+        void setDOFValues(const std::vector<size_t>& nodeIDs, unsigned int nodeDOF, const VectorXd& values);
+        void setDOFValues(const featkMesh<Dimension>* mesh, std::function<bool(const AttributeValueType<Dimension, 1>&)> predicate, unsigned int nodeDOF, double value);
 
     private:
 
-        std::map<size_t, double> values;
+        void consolidate();
+
+        std::vector<std::tuple<size_t, double, bool>> records;  // Pending (dof, value, additive) records in insertion order
+
+        std::vector<size_t> dofs;                               // Consolidated dofs, sorted
+        VectorXd values;                                        // Consolidated values packed in dofs order
+        std::vector<size_t> nonZeroDOFs;
+        VectorXd nonZeroValues;
+        std::vector<bool> mask;
+        size_t numberOfCompiledDOFs;
+        bool compiled;
 };
 
 template<unsigned int Dimension, unsigned int Order>
 featkBoundaryConditions<Dimension, Order>::featkBoundaryConditions() {
 
+    this->numberOfCompiledDOFs = 0;
+    this->compiled = false;
 }
 
 template<unsigned int Dimension, unsigned int Order>
@@ -79,38 +116,156 @@ featkBoundaryConditions<Dimension, Order>::~featkBoundaryConditions() {
 template<unsigned int Dimension, unsigned int Order>
 void featkBoundaryConditions<Dimension, Order>::addDOFValue(size_t nodeID, unsigned int nodeDOF, double value) {
 
-    this->values[DOF_ID(nodeID, nodeDOF)] += value;
+    this->records.push_back(std::make_tuple(DOF_ID<Dimension, Order>(nodeID, nodeDOF), value, true));
+    this->compiled = false;
 }
 
 template<unsigned int Dimension, unsigned int Order>
-std::set<size_t> featkBoundaryConditions<Dimension, Order>::getAllDOFs() {
+void featkBoundaryConditions<Dimension, Order>::compile(size_t numberOfDOFs) {
 
-    std::set<size_t> dofs;
+    if (this->isCompiled(numberOfDOFs)) {
+
+        return;
+    }
+
+    this->consolidate();
+
+    this->nonZeroDOFs.clear();
+    std::vector<double> nonZeroValues;
+
+    this->mask.assign(numberOfDOFs, false);
+
+    for (size_t i=0; i!=this->dofs.size(); i++) {
+
+        if (this->dofs[i] < numberOfDOFs) {
+
+            this->mask[this->dofs[i]] = true;
+        }
 
-    for (const auto& pair : this->values) {
+        else {
 
-        dofs.insert(dofs.end(), pair.first);
+            std::cout << "featkBoundaryConditions: Warning: DOF " << this->dofs[i] << " is out of range and will be ignored." << std::endl;
+        }
+
+        if (this->values(i)!=0.0) {
+
+            this->nonZeroDOFs.push_back(this->dofs[i]);
+            nonZeroValues.push_back(this->values(i));
+        }
     }
 
-    return dofs;
+    this->nonZeroValues = Map<VectorXd>(nonZeroValues.data(), nonZeroValues.size());
+
+    this->numberOfCompiledDOFs = numberOfDOFs;
+    this->compiled = true;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkBoundaryConditions<Dimension, Order>::consolidate() {
+
+    if (this->records.empty()) {
+
+        return;
+    }
+
+    /* Previously consolidated values are prepended as plain assignments so that the fold below
+     * reproduces the std::map semantics of the successive setDOFValue() and addDOFValue() calls. */
+
+    std::vector<std::tuple<size_t, double, bool>> records;
+    records.reserve(this->dofs.size()+this->records.size());
+
+    for (size_t i=0; i!=this->dofs.size(); i++) {
+
+        records.push_back(std::make_tuple(this->dofs[i], this->values(i), false));
+    }
+
+    records.insert(records.end(), this->records.begin(), this->records.end());
+    this->records.clear();
+
+    std::stable_sort(records.begin(), records.end(), [](const std::tuple<size_t, double, bool>& a, const std::tuple<size_t, double, bool>& b) { return std::get<0>(a) < std::get<0>(b); });
+
+    std::vector<double> values;
+    this->dofs.clear();
+
+    for (const auto& record : records) {
+
+        if (this->dofs.empty() || this->dofs.back() != std::get<0>(record)) {
+
+            this->dofs.push_back(std::get<0>(record));
+            values.push_back(0.0);
+        }
+
+        values.back() = std::get<2>(record) ? values.back()+std::get<1>(record) : std::get<1>(record);
+    }
+
+    this->values = Map<VectorXd>(values.data(), values.size());
+}
+
+template<unsigned int Dimension, unsigned int Order>
+std::set<size_t> featkBoundaryConditions<Dimension, Order>::getAllDOFs() {
+
+    this->consolidate();
+
+    return std::set<size_t>(this->dofs.begin(), this->dofs.end());
 }
 
 template<unsigned int Dimension, unsigned int Order>
 std::map<size_t, double> featkBoundaryConditions<Dimension, Order>::getAllDOFValues() {
 
+    this->consolidate();
+
+    std::map<size_t, double> values;
+
+    for (size_t i=0; i!=this->dofs.size(); i++) {
+
+        values.insert(values.end(), std::make_pair(this->dofs[i], this->values(i)));  // featkBoundaryConditions::dofs is already sorted so insert with hint is more efficient
+    }
+
+    return values;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+const std::vector<bool>& featkBoundaryConditions<Dimension, Order>::getCompiledDOFMask() {
+
+    return this->mask;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+const std::vector<size_t>& featkBoundaryConditions<Dimension, Order>::getCompiledDOFs() {
+
+    return this->dofs;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+const VectorXd& featkBoundaryConditions<Dimension, Order>::getCompiledDOFValues() {
+
     return this->values;
 }
 
+template<unsigned int Dimension, unsigned int Order>
+const std::vector<size_t>& featkBoundaryConditions<Dimension, Order>::getCompiledNonZeroDOFs() {
+
+    return this->nonZeroDOFs;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+const VectorXd& featkBoundaryConditions<Dimension, Order>::getCompiledNonZeroDOFValues() {
+
+    return this->nonZeroValues;
+}
+
 template<unsigned int Dimension, unsigned int Order>
 std::set<size_t> featkBoundaryConditions<Dimension, Order>::getNonZeroDOFs() {
 
+    this->consolidate();
+
     std::set<size_t> dofs;
 
-    for (const auto& pair : this->values) {
+    for (size_t i=0; i!=this->dofs.size(); i++) {
 
-        if (pair.second!=0.0) {
+        if (this->values(i)!=0.0) {
 
-            dofs.insert(dofs.end(), pair.first);  // featkBoundaryConditions::values is already sorted by keys so insert with hint is more efficient
+            dofs.insert(dofs.end(), this->dofs[i]);  // featkBoundaryConditions::dofs is already sorted so insert with hint is more efficient
         }
     }
 
@@ -120,13 +275,15 @@ std::set<size_t> featkBoundaryConditions<Dimension, Order>::getNonZeroDOFs() {
 template<unsigned int Dimension, unsigned int Order>
 std::map<size_t, double> featkBoundaryConditions<Dimension, Order>::getNonZeroDOFValues() {
 
+    this->consolidate();
+
     std::map<size_t, double> values;
 
-    for (const auto& pair : this->values) {
+    for (size_t i=0; i!=this->dofs.size(); i++) {
 
-        if (pair.second!=0.0) {
+        if (this->values(i)!=0.0) {
 
-            values.insert(values.end(), pair);  // featkBoundaryConditions::values is already sorted by keys so insert with hint is more efficient
+            values.insert(values.end(), std::make_pair(this->dofs[i], this->values(i)));  // featkBoundaryConditions::dofs is already sorted so insert with hint is more efficient
         }
     }
 
@@ -136,23 +293,78 @@ std::map<size_t, double> featkBoundaryConditions<Dimension, Order>::getNonZeroDO
 template<unsigned int Dimension, unsigned int Order>
 std::set<size_t> featkBoundaryConditions<Dimension, Order>::getZeroDOFs() {
 
+    this->consolidate();
+
     std::set<size_t> dofs;
 
-    for (const auto& pair : this->values) {
+    for (size_t i=0; i!=this->dofs.size(); i++) {
 
-        if (pair.second==0.0) {
+        if (this->values(i)==0.0) {
 
-            dofs.insert(dofs.end(), pair.first);  // featkBoundaryConditions::values is already sorted by keys so insert with hint is more efficient
+            dofs.insert(dofs.end(), this->dofs[i]);  // featkBoundaryConditions::dofs is already sorted so insert with hint is more efficient
         }
     }
 
     return dofs;
 }
 
+template<unsigned int Dimension, unsigned int Order>
+bool featkBoundaryConditions<Dimension, Order>::isCompiled(size_t numberOfDOFs) const {
+
+    return this->compiled && this->numberOfCompiledDOFs == numberOfDOFs;
+}
+
 template<unsigned int Dimension, unsigned int Order>
 void featkBoundaryConditions<Dimension, Order>::setDOFValue(size_t nodeID, unsigned int nodeDOF, double value) {
 
-    this->values[DOF_ID<Dimension, Order>(nodeID, nodeDOF)] = value;
+    this->records.push_back(std::make_tuple(DOF_ID<Dimension, Order>(nodeID, nodeDOF), value, false));
+    this->compiled = false;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkBoundaryConditions<Dimension, Order>::setDOFValues(const std::vector<size_t>& nodeIDs, unsigned int nodeDOF, double value) {
+
+    this->records.reserve(this->records.size()+nodeIDs.size());
+
+    for (size_t nodeID : nodeIDs) {
+
+        this->records.push_back(std::make_tuple(DOF_ID<Dimension, Order>(nodeID, nodeDOF), value, false));
+    }
+
+    this->compiled = false;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkBoundaryConditions<Dimension, Order>::setDOFValues(const std::vector<size_t>& nodeIDs, unsigned int nodeDOF, const VectorXd& values) {
+
+    if (values.size() != nodeIDs.size()) {
+
+        std::cout << "featkBoundaryConditions: Warning: Number of values does not match number of nodes." << std::endl;
+        return;
+    }
+
+    this->records.reserve(this->records.size()+nodeIDs.size());
+
+    for (size_t i=0; i!=nodeIDs.size(); i++) {
+
+        this->records.push_back(std::make_tuple(DOF_ID<Dimension, Order>(nodeIDs[i], nodeDOF), values(i), false));
+    }
+
+    this->compiled = false;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkBoundaryConditions<Dimension, Order>::setDOFValues(const featkMesh<Dimension>* mesh, std::function<bool(const AttributeValueType<Dimension, 1>&)> predicate, unsigned int nodeDOF, double value) {
+
+    for (featkNode<Dimension>* node : mesh->getNodes()) {
+
+        if (predicate(node->getCoordinates())) {
+
+            this->records.push_back(std::make_tuple(DOF_ID<Dimension, Order>(node->getID(), nodeDOF), value, false));
+        }
+    }
+
+    this->compiled = false;
 }
 
 #endif // FEATKBOUNDARYCONDITIONS_H
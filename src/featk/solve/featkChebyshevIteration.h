@@ -0,0 +1,452 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkChebyshevIteration.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkChebyshevIteration
+ *
+ * @brief Jacobi preconditioned Chebyshev iteration without inner products.
+ *
+ * featkChebyshevIteration solves symmetric positive definite systems
+ * \f$Ax=b\f$ with the Chebyshev semi-iterative method. Given bounds
+ * \f$[\lambda_{min}, \lambda_{max}]\f$ of the spectrum of the Jacobi
+ * preconditioned matrix \f$D^{-1}A\f$, the iterates are updated by a three
+ * term recurrence whose coefficients are known in advance, so that the
+ * recurrence itself needs no inner product. The residual norm used to test
+ * convergence is still a global reduction at every iteration, but it is
+ * accumulated in the same pass as the vector updates, i.e. one reduction
+ * per iteration against two separate ones for the conjugate gradient
+ * method.
+ *
+ * Unless set by setSpectralBounds(), the bounds are estimated once by
+ * compute() from the Ritz values of Lanczos steps (obtained from the
+ * coefficients of as many conjugate gradient iterations), taken until the
+ * extreme Ritz values settle or at most 300 steps: the largest Ritz
+ * value is enlarged by 10% and capped by the Gershgorin bound of
+ * \f$D^{-1}A\f$, the smallest one is used as is.
+ *
+ * Stability limits: the iteration diverges if the upper bound is smaller
+ * than the largest eigenvalue, hence the safety margin above. A lower bound
+ * larger than the smallest eigenvalue, as usually returned by the Lanczos
+ * estimate, does not cause divergence but slows down the convergence of
+ * the associated components. The convergence rate is that of the
+ * conjugate gradient method in the worst case, i.e.
+ * \f$(\sqrt{\kappa}-1)/(\sqrt{\kappa}+1)\f$ per iteration with
+ * \f$\kappa=\lambda_{max}/\lambda_{min}\f$, so that the method is best
+ * suited to the well conditioned systems of small time steps. The bounds
+ * must be recomputed (by calling compute() again) whenever the matrix
+ * changes. When the Jacobi preconditioned Rayleigh quotients of the new
+ * matrix are known to lie within a factor \f$\gamma\f$ of the previous
+ * ones, e.g. \f$\gamma=\max(g,1/g)\f$ for \f$M+g\,sK\f$ after
+ * \f$M+sK\f$, compute(matrix, gamma) widens the previous bounds by
+ * \f$\gamma\f$ instead of estimating them again, until the accumulated
+ * widening exceeds 4.
+ *
+ * The interface mimics the one of Eigen::ConjugateGradient for the
+ * functions used by featkStaticSolverBase and featkDynamicSolverBase, so
+ * that both solvers are interchangeable.
+ *
+ * See Saad. 2003. Iterative Methods for Sparse Linear Systems, 2nd ed.,
+ * Algorithm 12.1.
+ *
+ * @tparam ScalarType The scalar type of the Eigen::SparseMatrix.
+ *
+ */
+
+#ifndef FEATKCHEBYSHEVITERATION_H
+#define FEATKCHEBYSHEVITERATION_H
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace Eigen;
+
+template<typename ScalarType>
+class featkChebyshevIteration {
+
+    public:
+
+        typedef Matrix<ScalarType, Dynamic, 1> VectorType;
+        typedef Matrix<ScalarType, Dynamic, Dynamic> MatrixType;
+        typedef typename NumTraits<ScalarType>::Real RealScalar;
+
+        featkChebyshevIteration();
+        ~featkChebyshevIteration();
+
+        void compute(const SparseMatrix<ScalarType>& matrix);
+        void compute(const SparseMatrix<ScalarType>& matrix, RealScalar factor);
+        RealScalar error() const;
+        RealScalar getLowerSpectralBound() const;
+        RealScalar getUpperSpectralBound() const;
+        ComputationInfo info() const;
+        Index iterations() const;
+        void setMaxIterations(Index iterations);
+        void setSpectralBounds(RealScalar lower, RealScalar upper);
+        void setTolerance(RealScalar tolerance);
+        MatrixType solve(const MatrixType& b) const;
+        MatrixType solveWithGuess(const MatrixType& b, const MatrixType& guess) const;
+
+    private:
+
+        void estimateSpectralBounds();
+        RealScalar getGershgorinBound() const;
+        void solveColumn(const VectorType& b, VectorType& x) const;
+
+        SparseMatrix<ScalarType, RowMajor> matrix;
+        VectorType inverseDiagonal;
+
+        bool userSpectralBounds;
+        RealScalar boundWidening;  // Product of the factors applied to the last estimated bounds, 0 if none
+        RealScalar lowerSpectralBound;
+        RealScalar upperSpectralBound;
+
+        RealScalar tolerance;
+        Index maxIterations;
+        mutable Index lastIterations;
+        mutable RealScalar lastError;
+        mutable ComputationInfo lastInfo;
+};
+
+template<typename ScalarType>
+featkChebyshevIteration<ScalarType>::featkChebyshevIteration() {
+
+    this->userSpectralBounds = false;
+    this->boundWidening = RealScalar(0);
+    this->lowerSpectralBound = RealScalar(0);
+    this->upperSpectralBound = RealScalar(0);
+
+    this->tolerance = NumTraits<RealScalar>::epsilon();
+    this->maxIterations = -1;
+    this->lastIterations = 0;
+    this->lastError = RealScalar(0);
+    this->lastInfo = Success;
+}
+
+template<typename ScalarType>
+featkChebyshevIteration<ScalarType>::~featkChebyshevIteration() {
+
+}
+
+template<typename ScalarType>
+void featkChebyshevIteration<ScalarType>::compute(const SparseMatrix<ScalarType>& matrix) {
+
+    this->compute(matrix, RealScalar(0));
+}
+
+template<typename ScalarType>
+void featkChebyshevIteration<ScalarType>::compute(const SparseMatrix<ScalarType>& matrix, RealScalar factor) {
+
+    /**
+     * The Rayleigh quotient (a+g*b)/(c+g*d) of D^-1(M+g*s*K) lies within a factor max(g, 1/g) of (a+b)/(c+d), the one
+     * of D^-1(M+s*K), so widening the previous bounds by that factor keeps them valid. The Gershgorin bound of the new
+     * matrix still caps the upper bound.
+     */
+
+    this->matrix = matrix;  // Row major copy, OpenMP parallelized products
+    this->inverseDiagonal = matrix.diagonal();
+
+    for (Index i=0; i!=this->inverseDiagonal.size(); i++) {
+
+        this->inverseDiagonal(i) = this->inverseDiagonal(i) != ScalarType(0) ? ScalarType(1)/this->inverseDiagonal(i) : ScalarType(1);
+    }
+
+    if (this->userSpectralBounds) {
+
+        return;
+    }
+
+    if (factor >= RealScalar(1) && this->boundWidening > RealScalar(0) && this->boundWidening*factor <= RealScalar(4)) {
+
+        this->boundWidening *= factor;
+        this->lowerSpectralBound /= factor;
+        this->upperSpectralBound = std::min(factor*this->upperSpectralBound, this->getGershgorinBound());
+    }
+
+    else {
+
+        this->estimateSpectralBounds();
+        this->boundWidening = RealScalar(1);
+    }
+}
+
+template<typename ScalarType>
+typename featkChebyshevIteration<ScalarType>::RealScalar featkChebyshevIteration<ScalarType>::error() const {
+
+    return this->lastError;
+}
+
+template<typename ScalarType>
+void featkChebyshevIteration<ScalarType>::estimateSpectralBounds() {
+
+    /* Lanczos tridiagonal matrix from the coefficients of Jacobi preconditioned CG iterations on a fixed pseudo-random */
+    /* right-hand side, extended by 10 steps until its extreme Ritz values change by less than 1%                        */
+
+    Index n = this->matrix.rows();
+    Index maxSteps = std::min<Index>(n, 300);
+    RealScalar gershgorin = this->getGershgorinBound();
+
+    this->lowerSpectralBound = gershgorin/RealScalar(1000);  // Fallback if no Lanczos step can be taken
+    this->upperSpectralBound = gershgorin;
+
+    VectorType r(n);
+
+    for (Index i=0; i!=n; i++) {
+
+        r(i) = RealScalar((i*2654435761u)%1000)/RealScalar(1000) - RealScalar(0.5);
+    }
+
+    VectorType z = this->inverseDiagonal.cwiseProduct(r);
+    VectorType p = z;
+    ScalarType rz = r.dot(z);
+
+    std::vector<RealScalar> alphas;
+    std::vector<RealScalar> betas;
+    RealScalar lower = RealScalar(0);
+    RealScalar upper = RealScalar(0);
+    bool done = false;
+
+    while (!done) {
+
+        ScalarType pap = ScalarType(1);
+
+        for (Index j=0; j!=10 && Index(alphas.size()) != maxSteps && rz > RealScalar(0) && pap > RealScalar(0); j++) {
+
+            VectorType ap = this->matrix*p;
+            pap = p.dot(ap);
+
+            if (pap > ScalarType(0)) {
+
+                ScalarType alpha = rz/pap;
+                r -= alpha*ap;
+                z = this->inverseDiagonal.cwiseProduct(r);
+                ScalarType rzNew = r.dot(z);
+                ScalarType beta = rzNew/rz;
+                p = z + beta*p;
+                rz = rzNew;
+
+                alphas.push_back(alpha);
+                betas.push_back(beta);
+            }
+        }
+
+        Index m = alphas.size();
+
+        if (m == 0) {
+
+            return;
+        }
+
+        done = m == maxSteps || !(rz > RealScalar(0)) || !(pap > RealScalar(0));
+
+        MatrixType t = MatrixType::Zero(m, m);
+
+        for (Index j=0; j!=m; j++) {
+
+            t(j, j) = RealScalar(1)/alphas[j] + (j == 0 ? RealScalar(0) : betas[j-1]/alphas[j-1]);
+
+            if (j+1 != m) {
+
+                t(j, j+1) = t(j+1, j) = std::sqrt(betas[j])/alphas[j];
+            }
+        }
+
+        SelfAdjointEigenSolver<MatrixType> eigenSolver(t, EigenvaluesOnly);  // Eigenvalues sorted in increasing order
+
+        RealScalar newLower = eigenSolver.eigenvalues()(0);
+        RealScalar newUpper = eigenSolver.eigenvalues()(m-1);
+
+        done = done || (std::abs(newLower-lower) < RealScalar(0.01)*newLower && std::abs(newUpper-upper) < RealScalar(0.01)*newUpper);
+        lower = newLower;
+        upper = newUpper;
+    }
+
+    this->lowerSpectralBound = lower;
+    this->upperSpectralBound = std::min(RealScalar(1.1)*upper, gershgorin);
+}
+
+template<typename ScalarType>
+typename featkChebyshevIteration<ScalarType>::RealScalar featkChebyshevIteration<ScalarType>::getGershgorinBound() const {
+
+    RealScalar gershgorin = RealScalar(0);
+
+    for (Index i=0; i!=this->matrix.rows(); i++) {
+
+        RealScalar sum = RealScalar(0);
+
+        for (typename SparseMatrix<ScalarType, RowMajor>::InnerIterator it(this->matrix, i); it; ++it) {
+
+            sum += std::abs(it.value());
+        }
+
+        gershgorin = std::max(gershgorin, sum*std::abs(this->inverseDiagonal(i)));
+    }
+
+    return gershgorin;
+}
+
+template<typename ScalarType>
+typename featkChebyshevIteration<ScalarType>::RealScalar featkChebyshevIteration<ScalarType>::getLowerSpectralBound() const {
+
+    return this->lowerSpectralBound;
+}
+
+template<typename ScalarType>
+typename featkChebyshevIteration<ScalarType>::RealScalar featkChebyshevIteration<ScalarType>::getUpperSpectralBound() const {
+
+    return this->upperSpectralBound;
+}
+
+template<typename ScalarType>
+ComputationInfo featkChebyshevIteration<ScalarType>::info() const {
+
+    return this->lastInfo;
+}
+
+template<typename ScalarType>
+Index featkChebyshevIteration<ScalarType>::iterations() const {
+
+    return this->lastIterations;
+}
+
+template<typename ScalarType>
+void featkChebyshevIteration<ScalarType>::setMaxIterations(Index iterations) {
+
+    this->maxIterations = iterations;
+}
+
+template<typename ScalarType>
+void featkChebyshevIteration<ScalarType>::setSpectralBounds(RealScalar lower, RealScalar upper) {
+
+    /* Bounds of the spectrum of the Jacobi preconditioned matrix, estimated by compute() if not strictly positive */
+
+    this->userSpectralBounds = lower > RealScalar(0) && upper > lower;
+    this->lowerSpectralBound = lower;
+    this->upperSpectralBound = upper;
+}
+
+template<typename ScalarType>
+void featkChebyshevIteration<ScalarType>::setTolerance(RealScalar tolerance) {
+
+    this->tolerance = tolerance;
+}
+
+template<typename ScalarType>
+typename featkChebyshevIteration<ScalarType>::MatrixType featkChebyshevIteration<ScalarType>::solve(const MatrixType& b) const {
+
+    return this->solveWithGuess(b, MatrixType::Zero(b.rows(), b.cols()));
+}
+
+template<typename ScalarType>
+typename featkChebyshevIteration<ScalarType>::MatrixType featkChebyshevIteration<ScalarType>::solveWithGuess(const MatrixType& b, const MatrixType& guess) const {
+
+    /* Iterations and error are those of the worst column */
+
+    MatrixType x = guess;
+    Index iterations = 0;
+    RealScalar error = RealScalar(0);
+    ComputationInfo info = Success;
+
+    for (Index j=0; j!=b.cols(); j++) {
+
+        VectorType xj = x.col(j);
+        this->solveColumn(b.col(j), xj);
+        x.col(j) = xj;
+
+        iterations = std::max(iterations, this->lastIterations);
+        error = std::max(error, this->lastError);
+
+        if (this->lastInfo != Success) {
+
+            info = this->lastInfo;
+        }
+    }
+
+    this->lastIterations = iterations;
+    this->lastError = error;
+    this->lastInfo = info;
+
+    return x;
+}
+
+template<typename ScalarType>
+void featkChebyshevIteration<ScalarType>::solveColumn(const VectorType& b, VectorType& x) const {
+
+    Index n = this->matrix.rows();
+    Index maxIterations = this->maxIterations < 0 ? 2*n : this->maxIterations;
+    RealScalar bNorm = b.norm();
+
+    if (bNorm == RealScalar(0)) {
+
+        x.setZero();
+        this->lastIterations = 0;
+        this->lastError = RealScalar(0);
+        this->lastInfo = Success;
+        return;
+    }
+
+    RealScalar theta = (this->upperSpectralBound+this->lowerSpectralBound)/RealScalar(2);
+    RealScalar delta = (this->upperSpectralBound-this->lowerSpectralBound)/RealScalar(2);
+    RealScalar sigma = theta/delta;
+    RealScalar rho = RealScalar(1)/sigma;
+    RealScalar threshold = this->tolerance*bNorm;
+
+    VectorType r = b - this->matrix*x;
+    VectorType d = this->inverseDiagonal.cwiseProduct(r)/theta;
+    RealScalar rNorm = r.norm();
+    Index i = 0;
+
+    while (rNorm > threshold && i < maxIterations) {
+
+        VectorType ad = this->matrix*d;
+        RealScalar rhoNew = RealScalar(1)/(RealScalar(2)*sigma-rho);
+        RealScalar c0 = rhoNew*rho;
+        RealScalar c1 = RealScalar(2)*rhoNew/delta;
+        RealScalar rr = RealScalar(0);
+
+        // Fused updates and residual norm
+
+        #pragma omp parallel for reduction(+:rr)
+        for (Index k=0; k<n; k++) {
+
+            x(k) += d(k);
+            r(k) -= ad(k);
+            d(k) = c0*d(k) + c1*this->inverseDiagonal(k)*r(k);
+            rr += r(k)*r(k);
+        }
+
+        rho = rhoNew;
+        rNorm = std::sqrt(rr);
+        i++;
+
+        if (!std::isfinite(rNorm)) {
+
+            break;  // Divergence, e.g. underestimated upper spectral bound
+        }
+    }
+
+    this->lastIterations = i;
+    this->lastError = rNorm/bNorm;
+    this->lastInfo = rNorm <= threshold ? Success : NoConvergence;
+}
+
+#endif // FEATKCHEBYSHEVITERATION_H
@@ -0,0 +1,279 @@
+#include <featk/solve/featkCheckpoint.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+#ifdef _WIN32
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <windows.h>
+
+#else
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#endif
+
+featkCheckpoint::featkCheckpoint() {
+
+    this->timeIntegrationScheme = 0;
+    this->adaptive = 0;
+    this->numberOfComponents = 0;
+    this->numberOfDOFs = 0;
+
+    this->iteration = 0;
+    this->numberOfRejectedSteps = 0;
+    this->currentTime = 0.0;
+    this->timeStep = 0.0;
+    this->previousTimeStep = 0.0;
+    this->previousError = 1.0;
+    this->inexactSolveTolerance = 0.0;
+    this->steadyStateFunctionalValue = 0.0;
+}
+
+featkCheckpoint::~featkCheckpoint() {
+
+}
+
+const char* featkCheckpoint::getMagic() {
+
+    return "FEATKCKP";
+}
+
+uint32_t featkCheckpoint::getVersion() {
+
+    return 1;
+}
+
+bool featkCheckpoint::read(const std::string& fileName) {
+
+    std::ifstream stream(fileName, std::ios::binary | std::ios::ate);
+
+    if (!stream) {
+
+        return false;
+    }
+
+    uint64_t fileSize = uint64_t(stream.tellg());
+    stream.seekg(0);
+
+    auto readValue = [&stream](auto& value) {
+
+        stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+    };
+
+    auto readMatrix = [&stream, &readValue, fileSize](auto& matrix, bool vector) {
+
+        /* Sizes are checked against the bytes left in the file, without overflow, before anything is allocated */
+
+        uint64_t rows = 0;
+        uint64_t cols = 1;
+        readValue(rows);
+
+        if (!vector) {
+
+            readValue(cols);
+        }
+
+        uint64_t position = stream ? uint64_t(stream.tellg()) : fileSize;
+        uint64_t limit = (fileSize-std::min(position, fileSize))/sizeof(double);
+        uint64_t maximumIndex = uint64_t(std::numeric_limits<Index>::max());
+
+        if (!stream || rows > maximumIndex || cols > maximumIndex || (cols != 0 && rows > limit/cols)) {
+
+            stream.setstate(std::ios::failbit);
+            return;
+        }
+
+        matrix.resize(rows, cols);
+        stream.read(reinterpret_cast<char*>(matrix.data()), rows*cols*sizeof(double));
+    };
+
+    char header[8];
+    uint32_t fileVersion = 0;
+    stream.read(header, 8);
+    readValue(fileVersion);
+
+    if (!stream || std::string(header, 8) != featkCheckpoint::getMagic() || fileVersion != featkCheckpoint::getVersion()) {
+
+        return false;
+    }
+
+    featkCheckpoint checkpoint;
+
+    readValue(checkpoint.timeIntegrationScheme);
+    readValue(checkpoint.adaptive);
+    readValue(checkpoint.numberOfComponents);
+    readValue(checkpoint.numberOfDOFs);
+
+    readValue(checkpoint.iteration);
+    readValue(checkpoint.numberOfRejectedSteps);
+    readValue(checkpoint.currentTime);
+    readValue(checkpoint.timeStep);
+    readValue(checkpoint.previousTimeStep);
+    readValue(checkpoint.previousError);
+    readValue(checkpoint.inexactSolveTolerance);
+    readValue(checkpoint.steadyStateFunctionalValue);
+
+    VectorXd times;
+    readMatrix(times, true);
+    checkpoint.componentSteadyStateTimes.assign(times.data(), times.data()+times.size());
+
+    readMatrix(checkpoint.u, true);
+    readMatrix(checkpoint.uPrevious, true);
+    readMatrix(checkpoint.uPrevious2, true);
+    readMatrix(checkpoint.fPrevious, true);
+
+    uint32_t numberOfSystems = 0;
+    readValue(numberOfSystems);
+
+    for (uint32_t s=0; s!=numberOfSystems && stream; s++) {
+
+        MatrixXd w;
+        uint32_t solves = 0;
+        readMatrix(w, false);
+        readValue(solves);
+
+        checkpoint.ritzVectors.push_back(w);
+        checkpoint.numberOfSolves.push_back(solves);
+    }
+
+    if (!stream) {
+
+        return false;
+    }
+
+    *this = checkpoint;
+
+    return true;
+}
+
+bool featkCheckpoint::replaceFile(const std::string& temporaryFileName, const std::string& fileName) {
+
+    /* The temporary file is flushed to disk before being renamed over the previous checkpoint in a single step, so */
+    /* that a crash leaves either the previous or the new checkpoint, never a missing or partially written file. On  */
+    /* POSIX systems, the parent directory is then flushed too so that the rename itself survives a crash.           */
+
+    #ifdef _WIN32
+
+    HANDLE file = CreateFileA(temporaryFileName.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+
+        return false;
+    }
+
+    bool flushed = FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+
+    return flushed && MoveFileExA(temporaryFileName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+
+    #else
+
+    int file = open(temporaryFileName.c_str(), O_WRONLY);
+
+    if (file < 0) {
+
+        return false;
+    }
+
+    bool flushed = fsync(file) == 0;
+    close(file);
+
+    if (!flushed || std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0) {
+
+        return false;
+    }
+
+    size_t separator = fileName.find_last_of('/');
+    std::string directoryName = separator == std::string::npos ? "." : (separator == 0 ? "/" : fileName.substr(0, separator));
+    int directory = open(directoryName.c_str(), O_RDONLY);
+
+    if (directory < 0) {
+
+        return false;
+    }
+
+    flushed = fsync(directory) == 0;
+    close(directory);
+
+    return flushed;
+
+    #endif
+}
+
+bool featkCheckpoint::write(const std::string& fileName) const {
+
+    std::string temporaryFileName = fileName + ".tmp";
+
+    {
+        std::ofstream stream(temporaryFileName, std::ios::binary | std::ios::trunc);
+
+        if (!stream) {
+
+            return false;
+        }
+
+        auto writeValue = [&stream](const auto& value) {
+
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+
+        auto writeMatrix = [&stream, &writeValue](const auto& matrix, bool vector) {
+
+            writeValue(uint64_t(matrix.rows()));
+
+            if (!vector) {
+
+                writeValue(uint64_t(matrix.cols()));
+            }
+
+            stream.write(reinterpret_cast<const char*>(matrix.data()), matrix.size()*sizeof(double));
+        };
+
+        stream.write(featkCheckpoint::getMagic(), 8);
+        writeValue(featkCheckpoint::getVersion());
+
+        writeValue(this->timeIntegrationScheme);
+        writeValue(this->adaptive);
+        writeValue(this->numberOfComponents);
+        writeValue(this->numberOfDOFs);
+
+        writeValue(this->iteration);
+        writeValue(this->numberOfRejectedSteps);
+        writeValue(this->currentTime);
+        writeValue(this->timeStep);
+        writeValue(this->previousTimeStep);
+        writeValue(this->previousError);
+        writeValue(this->inexactSolveTolerance);
+        writeValue(this->steadyStateFunctionalValue);
+
+        writeMatrix(Map<const VectorXd>(this->componentSteadyStateTimes.data(), this->componentSteadyStateTimes.size()), true);
+
+        writeMatrix(this->u, true);
+        writeMatrix(this->uPrevious, true);
+        writeMatrix(this->uPrevious2, true);
+        writeMatrix(this->fPrevious, true);
+
+        writeValue(uint32_t(this->ritzVectors.size()));
+
+        for (size_t s=0; s!=this->ritzVectors.size(); s++) {
+
+            writeMatrix(this->ritzVectors[s], false);
+            writeValue(this->numberOfSolves[s]);
+        }
+
+        if (!stream.flush()) {
+
+            return false;
+        }
+    }
+
+    return featkCheckpoint::replaceFile(temporaryFileName, fileName);
+}
@@ -0,0 +1,98 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkCheckpoint.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkCheckpoint
+ *
+ * @brief State of a featkDynamicSolverBase time loop and its binary file
+ * representation.
+ *
+ * featkCheckpoint gathers everything a featkDynamicSolverBase time loop
+ * needs to resume exactly where it stopped: the number of completed
+ * iterations (or accepted steps), the current time and time steps, the
+ * stacked solution vectors of all components at the current and previous
+ * steps, the reaction vector of the previous step, the step size
+ * controller, inexact solve and steady state detection states, and the
+ * Ritz vectors of the deflated solvers.
+ *
+ * write() stores the checkpoint in a compact binary file (native
+ * endianness) starting with the "FEATKCKP" magic string and a format
+ * version. The file is first written under a temporary name, flushed to
+ * disk and then atomically renamed over the previous checkpoint, the
+ * parent directory being flushed too on POSIX systems, so that an
+ * interrupted write never corrupts nor removes it. read() returns false,
+ * leaving the checkpoint unchanged, if the file cannot be read or is not
+ * a valid checkpoint, e.g. if it is truncated or its matrix sizes exceed
+ * the size of the file.
+ *
+ */
+
+#ifndef FEATKCHECKPOINT_H
+#define FEATKCHECKPOINT_H
+
+#include <Eigen/Dense>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace Eigen;
+
+class featkCheckpoint {
+
+    public:
+
+        featkCheckpoint();
+        ~featkCheckpoint();
+
+        bool read(const std::string& fileName);
+        bool write(const std::string& fileName) const;
+
+        uint32_t timeIntegrationScheme;
+        uint32_t adaptive;
+        uint32_t numberOfComponents;
+        uint64_t numberOfDOFs;
+
+        uint32_t iteration;                     // Completed iterations, or accepted steps
+        uint32_t numberOfRejectedSteps;
+        double currentTime;
+        double timeStep;                        // Next (adaptive) time step
+        double previousTimeStep;
+        double previousError;                   // Step size controller
+        double inexactSolveTolerance;
+        double steadyStateFunctionalValue;
+        std::vector<double> componentSteadyStateTimes;
+
+        VectorXd u;
+        VectorXd uPrevious;
+        VectorXd uPrevious2;
+        VectorXd fPrevious;
+
+        std::vector<MatrixXd> ritzVectors;      // One per scheme system
+        std::vector<uint32_t> numberOfSolves;
+
+    private:
+
+        static const char* getMagic();
+        static uint32_t getVersion();
+        static bool replaceFile(const std::string& temporaryFileName, const std::string& fileName);
+};
+
+#endif // FEATKCHECKPOINT_H
@@ -0,0 +1,94 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkCheckpointWriter.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkCheckpointWriter
+ *
+ * @brief Writes featkCheckpoint files on a background thread.
+ *
+ * featkCheckpointWriter takes ownership of the checkpoints passed to
+ * write() and writes them on a background thread, so that the time loop
+ * only pays for the copy of its state. At most one write is in flight: a
+ * new write() first waits for the previous one to complete, which only
+ * stalls the time loop if checkpoints are requested faster than they can
+ * be written. wait() blocks until the last write completes and is called
+ * by the destructor.
+ *
+ */
+
+#ifndef FEATKCHECKPOINTWRITER_H
+#define FEATKCHECKPOINTWRITER_H
+
+#include <featk/solve/featkCheckpoint.h>
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+
+class featkCheckpointWriter {
+
+    public:
+
+        featkCheckpointWriter();
+        ~featkCheckpointWriter();
+
+        void wait();
+        void write(featkCheckpoint&& checkpoint, const std::string& fileName);
+
+    private:
+
+        featkCheckpointWriter(const featkCheckpointWriter&) = delete;
+        featkCheckpointWriter& operator=(const featkCheckpointWriter&) = delete;
+
+        std::thread thread;
+};
+
+inline featkCheckpointWriter::featkCheckpointWriter() {
+
+}
+
+inline featkCheckpointWriter::~featkCheckpointWriter() {
+
+    this->wait();
+}
+
+inline void featkCheckpointWriter::wait() {
+
+    if (this->thread.joinable()) {
+
+        this->thread.join();
+    }
+}
+
+inline void featkCheckpointWriter::write(featkCheckpoint&& checkpoint, const std::string& fileName) {
+
+    this->wait();
+
+    this->thread = std::thread([checkpoint = std::move(checkpoint), fileName]() {
+
+        if (!checkpoint.write(fileName)) {
+
+            std::cout << "featkCheckpointWriter: Warning: Checkpoint could not be written to " << fileName << "." << std::endl;
+        }
+    });
+}
+
+#endif // FEATKCHECKPOINTWRITER_H
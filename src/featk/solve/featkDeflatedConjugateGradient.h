@@ -0,0 +1,445 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkDeflatedConjugateGradient.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkDeflatedConjugateGradient
+ *
+ * @brief Jacobi preconditioned conjugate gradient solver recycling an
+ * approximate invariant subspace across solves.
+ *
+ * featkDeflatedConjugateGradient solves symmetric positive definite
+ * systems \f$Ax=b\f$ sharing the same (or a slowly varying) matrix, e.g. the
+ * system matrices of successive time steps. The eigenvectors associated to
+ * the smallest eigenvalues of \f$A\f$, which slow down the convergence of
+ * the conjugate gradient method, are approximated by Ritz vectors \f$W\f$
+ * and projected out of the Krylov subspace, i.e. the initial guess is
+ * corrected so that \f$W^Tr_0=0\f$ and the search directions are kept
+ * \f$A\f$-orthogonal to \f$W\f$.
+ *
+ * The Ritz vectors are refined every getDeflationUpdateFrequency() solves
+ * from the search directions of the solve: the current vectors and the
+ * directions are gathered in a buffer of \f$3k\f$ columns which, once full,
+ * is compressed to its \f$k\f$ smallest Ritz vectors of the Jacobi
+ * preconditioned pencil \f$(A, D)\f$, so that the only additional
+ * matrix-vector products are the exact images of the \f$k\f$ retained
+ * vectors. They are kept when compute() is called with a new
+ * matrix, only their images by the new matrix being recomputed.
+ * getRitzVectors() and setRitzVectors() save and restore them, together
+ * with the solve count driving the updates, e.g. across checkpoints.
+ *
+ * The interface mimics the one of Eigen::ConjugateGradient for the
+ * functions used by featkDynamicSolverBase, so that both solvers are
+ * interchangeable.
+ *
+ * See Saad, Yeung, Erhel and Guyomarc'h. 2000. A deflated version of the
+ * conjugate gradient algorithm. SIAM J. Sci. Comput. 21(5).
+ *
+ * @tparam ScalarType The scalar type of the Eigen::SparseMatrix.
+ *
+ */
+
+#ifndef FEATKDEFLATEDCONJUGATEGRADIENT_H
+#define FEATKDEFLATEDCONJUGATEGRADIENT_H
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Eigen;
+
+template<typename ScalarType>
+class featkDeflatedConjugateGradient {
+
+    public:
+
+        typedef Matrix<ScalarType, Dynamic, 1> VectorType;
+        typedef Matrix<ScalarType, Dynamic, Dynamic> MatrixType;
+        typedef typename NumTraits<ScalarType>::Real RealScalar;
+
+        featkDeflatedConjugateGradient();
+        ~featkDeflatedConjugateGradient();
+
+        void compute(const SparseMatrix<ScalarType>& matrix);
+        unsigned int getDeflationSpaceSize() const;
+        unsigned int getDeflationUpdateFrequency() const;
+        unsigned int getNumberOfSolves() const;
+        Index getNumberOfRitzVectors() const;
+        const MatrixType& getRitzVectors() const;
+        ComputationInfo info() const;
+        RealScalar error() const;
+        Index iterations() const;
+        void setDeflationSpaceSize(unsigned int size);
+        void setDeflationUpdateFrequency(unsigned int frequency);
+        void setMaxIterations(Index iterations);
+        void setRitzVectors(const MatrixType& vectors, unsigned int numberOfSolves);
+        void setTolerance(RealScalar tolerance);
+        MatrixType solveWithGuess(const MatrixType& b, const MatrixType& guess);
+
+    private:
+
+        void compressDirections();
+        void solveColumn(const VectorType& b, VectorType& x, bool collect);
+        void updateRitzVectors();
+
+        const SparseMatrix<ScalarType>* matrix;
+        VectorType inverseDiagonal;
+
+        unsigned int deflationSpaceSize;
+        unsigned int deflationUpdateFrequency;
+        unsigned int numberOfSolves;
+
+        MatrixType w;                   // Ritz vectors
+        MatrixType aw;                  // A*W
+        LDLT<MatrixType> wtaw;          // W^T*A*W
+        MatrixType directions;          // Search directions collected for the next update
+        MatrixType directionImages;     // A*directions
+        Index numberOfDirections;
+
+        RealScalar tolerance;
+        Index maxIterations;
+        Index lastIterations;
+        RealScalar lastError;
+        ComputationInfo lastInfo;
+};
+
+template<typename ScalarType>
+featkDeflatedConjugateGradient<ScalarType>::featkDeflatedConjugateGradient() {
+
+    this->matrix = nullptr;
+
+    this->deflationSpaceSize = 8;
+    this->deflationUpdateFrequency = 10;
+    this->numberOfSolves = 0;
+    this->numberOfDirections = 0;
+
+    this->tolerance = NumTraits<RealScalar>::epsilon();
+    this->maxIterations = -1;
+    this->lastIterations = 0;
+    this->lastError = RealScalar(0);
+    this->lastInfo = Success;
+}
+
+template<typename ScalarType>
+featkDeflatedConjugateGradient<ScalarType>::~featkDeflatedConjugateGradient() {
+
+}
+
+template<typename ScalarType>
+void featkDeflatedConjugateGradient<ScalarType>::compute(const SparseMatrix<ScalarType>& matrix) {
+
+    this->matrix = &matrix;
+    this->inverseDiagonal = matrix.diagonal();
+
+    for (Index i=0; i!=this->inverseDiagonal.size(); i++) {
+
+        this->inverseDiagonal(i) = this->inverseDiagonal(i) != ScalarType(0) ? ScalarType(1)/this->inverseDiagonal(i) : ScalarType(1);
+    }
+
+    if (this->w.rows() != matrix.rows()) {
+
+        this->w.resize(matrix.rows(), 0);
+    }
+
+    /* Ritz vectors are kept, only their images are updated */
+
+    this->aw = matrix*this->w;
+    this->wtaw.compute(this->w.transpose()*this->aw);
+}
+
+template<typename ScalarType>
+void featkDeflatedConjugateGradient<ScalarType>::compressDirections() {
+
+    /* Rayleigh-Ritz projection of the Jacobi preconditioned matrix on the collected directions, i.e. generalized */
+    /* eigenproblem (P^T*A*P, P^T*D*P), the Ritz vectors of the smallest Ritz values being kept                   */
+
+    Index n = this->numberOfDirections;
+    Index k = std::min<Index>(this->deflationSpaceSize, n);
+
+    MatrixType p = this->directions.leftCols(n);
+    MatrixType ap = this->directionImages.leftCols(n);
+    MatrixType ptap = p.transpose()*ap;
+    MatrixType ptdp = p.transpose()*this->inverseDiagonal.cwiseInverse().asDiagonal()*p;
+
+    GeneralizedSelfAdjointEigenSolver<MatrixType> eigenSolver((ptap+ptap.transpose())/2, (ptdp+ptdp.transpose())/2);  // Eigenvalues sorted in increasing order
+
+    if (eigenSolver.info() != Success) {
+
+        this->numberOfDirections = std::min<Index>(n, k);  // Degenerate directions, the first ones are kept
+        return;
+    }
+
+    this->directions.leftCols(k) = p*eigenSolver.eigenvectors().leftCols(k);
+    this->directionImages.leftCols(k) = ap*eigenSolver.eigenvectors().leftCols(k);
+    this->numberOfDirections = k;
+}
+
+template<typename ScalarType>
+typename featkDeflatedConjugateGradient<ScalarType>::RealScalar featkDeflatedConjugateGradient<ScalarType>::error() const {
+
+    return this->lastError;
+}
+
+template<typename ScalarType>
+unsigned int featkDeflatedConjugateGradient<ScalarType>::getDeflationSpaceSize() const {
+
+    return this->deflationSpaceSize;
+}
+
+template<typename ScalarType>
+unsigned int featkDeflatedConjugateGradient<ScalarType>::getDeflationUpdateFrequency() const {
+
+    return this->deflationUpdateFrequency;
+}
+
+template<typename ScalarType>
+unsigned int featkDeflatedConjugateGradient<ScalarType>::getNumberOfSolves() const {
+
+    return this->numberOfSolves;
+}
+
+template<typename ScalarType>
+Index featkDeflatedConjugateGradient<ScalarType>::getNumberOfRitzVectors() const {
+
+    return this->w.cols();
+}
+
+template<typename ScalarType>
+const typename featkDeflatedConjugateGradient<ScalarType>::MatrixType& featkDeflatedConjugateGradient<ScalarType>::getRitzVectors() const {
+
+    return this->w;
+}
+
+template<typename ScalarType>
+ComputationInfo featkDeflatedConjugateGradient<ScalarType>::info() const {
+
+    return this->lastInfo;
+}
+
+template<typename ScalarType>
+Index featkDeflatedConjugateGradient<ScalarType>::iterations() const {
+
+    return this->lastIterations;
+}
+
+template<typename ScalarType>
+void featkDeflatedConjugateGradient<ScalarType>::setDeflationSpaceSize(unsigned int size) {
+
+    this->deflationSpaceSize = size;
+}
+
+template<typename ScalarType>
+void featkDeflatedConjugateGradient<ScalarType>::setDeflationUpdateFrequency(unsigned int frequency) {
+
+    this->deflationUpdateFrequency = frequency;
+}
+
+template<typename ScalarType>
+void featkDeflatedConjugateGradient<ScalarType>::setMaxIterations(Index iterations) {
+
+    this->maxIterations = iterations;
+}
+
+template<typename ScalarType>
+void featkDeflatedConjugateGradient<ScalarType>::setRitzVectors(const MatrixType& vectors, unsigned int numberOfSolves) {
+
+    /* Images are computed here if a matrix of matching size is already set, by compute() otherwise */
+
+    this->w = vectors;
+    this->numberOfSolves = numberOfSolves;
+
+    if (this->matrix != nullptr && this->matrix->rows() == this->w.rows()) {
+
+        this->aw = (*this->matrix)*this->w;
+        this->wtaw.compute(this->w.transpose()*this->aw);
+    }
+}
+
+template<typename ScalarType>
+void featkDeflatedConjugateGradient<ScalarType>::setTolerance(RealScalar tolerance) {
+
+    this->tolerance = tolerance;
+}
+
+template<typename ScalarType>
+typename featkDeflatedConjugateGradient<ScalarType>::MatrixType featkDeflatedConjugateGradient<ScalarType>::solveWithGuess(const MatrixType& b, const MatrixType& guess) {
+
+    /* Directions are only collected from the first column, iterations and error are those of the worst column */
+
+    MatrixType x = guess;
+    Index iterations = 0;
+    RealScalar error = RealScalar(0);
+    ComputationInfo info = Success;
+
+    bool collect = this->deflationSpaceSize != 0 && (this->deflationUpdateFrequency == 0 ? this->w.cols() == 0 : this->numberOfSolves%this->deflationUpdateFrequency == 0);
+
+    for (Index j=0; j!=b.cols(); j++) {
+
+        VectorType xj = x.col(j);
+        this->solveColumn(b.col(j), xj, collect && j == 0);
+        x.col(j) = xj;
+
+        iterations = std::max(iterations, this->lastIterations);
+        error = std::max(error, this->lastError);
+
+        if (this->lastInfo != Success) {
+
+            info = this->lastInfo;
+        }
+    }
+
+    if (collect) {
+
+        this->updateRitzVectors();
+    }
+
+    this->numberOfSolves++;
+    this->lastIterations = iterations;
+    this->lastError = error;
+    this->lastInfo = info;
+
+    return x;
+}
+
+template<typename ScalarType>
+void featkDeflatedConjugateGradient<ScalarType>::solveColumn(const VectorType& b, VectorType& x, bool collect) {
+
+    const SparseMatrix<ScalarType>& a = *this->matrix;
+    Index maxIterations = this->maxIterations < 0 ? 2*a.cols() : this->maxIterations;
+    Index k = this->w.cols();
+
+    this->numberOfDirections = 0;
+
+    if (collect) {
+
+        Index m = std::max<Index>(3*this->deflationSpaceSize, k+this->deflationSpaceSize);
+        this->directions.resize(a.rows(), m);
+        this->directionImages.resize(a.rows(), m);
+        this->directions.leftCols(k) = this->w;
+        this->directionImages.leftCols(k) = this->aw;
+        this->numberOfDirections = k;
+    }
+
+    RealScalar bNorm = b.norm();
+
+    if (bNorm == RealScalar(0)) {
+
+        x.setZero();
+        this->lastIterations = 0;
+        this->lastError = RealScalar(0);
+        this->lastInfo = Success;
+        return;
+    }
+
+
+    // Deflated initial guess, W^T*r0 = 0
+
+    VectorType r = b - a*x;
+
+    if (k != 0) {
+
+        x += this->w*this->wtaw.solve(this->w.transpose()*r);
+        r = b - a*x;
+    }
+
+    VectorType z = this->inverseDiagonal.cwiseProduct(r);
+    VectorType p = z;
+
+    if (k != 0) {
+
+        p -= this->w*this->wtaw.solve(this->aw.transpose()*z);
+    }
+
+    ScalarType rz = r.dot(z);
+    RealScalar threshold = this->tolerance*bNorm;
+    RealScalar rNorm = r.norm();
+    Index i = 0;
+
+    while (rNorm > threshold && i < maxIterations) {
+
+        VectorType ap = a*p;
+        ScalarType pap = p.dot(ap);
+
+        if (pap <= ScalarType(0)) {
+
+            break;  // Breakdown, e.g. non positive definite matrix
+        }
+
+        if (collect) {
+
+            if (this->numberOfDirections == this->directions.cols()) {
+
+                this->compressDirections();
+            }
+
+            RealScalar pNorm = p.norm();
+            this->directions.col(this->numberOfDirections) = p/pNorm;
+            this->directionImages.col(this->numberOfDirections) = ap/pNorm;
+            this->numberOfDirections++;
+        }
+
+        ScalarType alpha = rz/pap;
+        x += alpha*p;
+        r -= alpha*ap;
+        i++;
+
+        if (k != 0) {
+
+            VectorType mu = this->wtaw.solve(this->w.transpose()*r);  // Restores W^T*r = 0 lost to round-off
+            x += this->w*mu;
+            r -= this->aw*mu;
+        }
+
+        rNorm = r.norm();
+
+        z = this->inverseDiagonal.cwiseProduct(r);
+        ScalarType rzNew = r.dot(z);
+        p = z + (rzNew/rz)*p;
+        rz = rzNew;
+
+        if (k != 0) {
+
+            p -= this->w*this->wtaw.solve(this->aw.transpose()*z);
+        }
+    }
+
+    this->lastIterations = i;
+    this->lastError = rNorm/bNorm;
+    this->lastInfo = rNorm <= threshold ? Success : NoConvergence;
+}
+
+template<typename ScalarType>
+void featkDeflatedConjugateGradient<ScalarType>::updateRitzVectors() {
+
+    if (this->numberOfDirections == 0) {
+
+        return;
+    }
+
+    this->compressDirections();
+
+    this->w = this->directions.leftCols(this->numberOfDirections);
+    this->aw = (*this->matrix)*this->w;  // Exact images rather than combined ones, so that they only depend on W
+    this->wtaw.compute(this->w.transpose()*this->aw);
+    this->numberOfDirections = 0;
+}
+
+#endif // FEATKDEFLATEDCONJUGATEGRADIENT_H
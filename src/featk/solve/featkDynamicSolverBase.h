@@ -46,6 +46,147 @@
  * d. Current solution is cut off if required.\n
  * e. Intermediate processing is performed on the current solution if required.
  *
+ * Derived classes describe their semi-discrete problem
+ * \f$M\dot{u} = -Ku + f(u)\f$ through the getGlobalMassMatrix(),
+ * getGlobalStiffnessMatrix() and getGlobalReactionVector() functions. The
+ * default global system matrix and vector are then those of the
+ * semi-implicit Euler scheme, i.e. \f$M+\Delta t K\f$ and
+ * \f$Mu_n+\Delta t f(u_n)\f$. Problems involving several components
+ * sharing the same mass and stiffness matrices (e.g. several cell
+ * populations) set numberOfComponents accordingly and work on stacked
+ * vectors, the blocks being the right-hand sides of one system sharing
+ * its matrix and preconditioner. Iterative solvers solve them one after
+ * the other, so the cost grows linearly with the number of components.
+ * setUseDirectSolver() replaces the conjugate gradient solver of the
+ * FEATK_SBDF1, FEATK_CNAB2, FEATK_SBDF2 and FEATK_STRANG schemes by a
+ * sparse LDLT factorization, computed once per system matrix and shared
+ * by all right-hand sides, which are then solved in a single call.
+ *
+ * The second order implicit-explicit schemes FEATK_CNAB2
+ * (Crank-Nicolson for \f$K\f$, Adams-Bashforth for \f$f\f$) and
+ * FEATK_SBDF2 (BDF2 for \f$K\f$, extrapolated \f$f\f$) can be selected
+ * through setTimeIntegrationScheme(). Their first step, lacking history, is
+ * taken with the semi-implicit Euler scheme. Their system matrices are
+ * formed from the mass and stiffness matrices, so the
+ * getGlobalSystemMatrix() and getGlobalSystemVector() functions are only
+ * used by the default FEATK_SBDF1 scheme with fixed time step.
+ *
+ * FEATK_STRANG selects Strang operator splitting: each step is made of a
+ * reaction half step performed by solveReaction(), a full Crank-Nicolson
+ * diffusion step \f$(M+\frac{\Delta t}{2}K)u^* = (M-\frac{\Delta t}{2}K)u\f$
+ * and a second reaction half step, which makes the splitting second order
+ * in time for a single solve per step, its system matrix being decomposed
+ * once. Derived classes whose reaction term has a closed-form nodal
+ * solution should override solveReaction(); its default implementation
+ * takes an explicit midpoint step on the lumped mass system. No cutoff is
+ * applied. Crank-Nicolson is A-stable but not L-stable: a mode of
+ * \f$M^{-1}K\f$ of eigenvalue \f$\lambda\f$ is multiplied by
+ * \f$(1-\frac{\Delta t}{2}\lambda)/(1+\frac{\Delta t}{2}\lambda)\f$ per
+ * step, which is negative beyond \f$\Delta t\lambda = 2\f$ and tends to
+ * -1. Steps larger than \f$2/\lambda_{max}\f$ therefore stay stable but
+ * let the stiffest diffusion modes, e.g. those of sharp initial fronts,
+ * oscillate with little damping and undershoot 0. Such steps call for the
+ * L-stable FEATK_SBDF1 or FEATK_BDF1 schemes instead.
+ *
+ * FEATK_BDF1 selects the fully implicit Euler scheme, whose nonlinear
+ * residual \f$M(u-u_n)+\Delta t Ku-\Delta t f(u)\f$ is solved by Newton
+ * iterations with backtracking line search. The Jacobian
+ * \f$M+\Delta t K-\Delta t A\,diag(g(u))\f$ is formed in place on the
+ * shared pattern, \f$A\f$ and \f$g\f$ being given by
+ * getGlobalReactionJacobianMatrix() and getGlobalReactionJacobianScaling()
+ * (\f$M+\Delta t K\f$ only by default, i.e. Picard iterations). For
+ * multi-component problems, the components are coupled through the
+ * reaction term and the Jacobian is formed on the stacked unknowns from
+ * getGlobalCoupledReactionJacobianMatrix() instead (block diagonal Picard
+ * iterations by default). Linear systems are solved by BiCGSTAB whose ILUT
+ * preconditioner is kept across Newton iterations and time steps, and only
+ * recomputed when the linear solver fails or slows down.
+ *
+ * FEATK_FORWARD_EULER, FEATK_SSPRK2 and FEATK_SSPRK3 select explicit
+ * schemes on the lumped mass system \f$M_l\dot{u} = -Ku + f(u)\f$, so
+ * that each stage only costs sparse matrix products and no linear solve.
+ * The lumped mass is given by getGlobalLumpedMassVector(), i.e. the row
+ * sums of the mass matrix or its HRZ lumping (see setMassLumping()). Each
+ * time step is split into as many substeps as required by the stable time
+ * step \f$c/\lambda\f$, \f$\lambda\f$ being the bound on the spectral
+ * radius of \f$M_l^{-1}J\f$ returned by getSpectralRadiusBound(), i.e. the
+ * Gershgorin bound of \f$M_l^{-1}K\f$ by default. Derived classes with
+ * stiff reaction terms should add the reaction contribution to this bound.
+ *
+ * When adaptive time stepping is enabled (see setUseAdaptiveTimeStep()),
+ * the number of iterations is replaced by an end time and each step is
+ * solved with the embedded pair formed by the semi-implicit Euler scheme
+ * and the selected variable step second order scheme (FEATK_SBDF2 unless
+ * FEATK_CNAB2 is selected). The difference
+ * between both solutions estimates the local error of the first order
+ * solution; the step is rejected if its weighted RMS norm exceeds 1 and
+ * the next step size is otherwise chosen by a PI controller. Accepted
+ * steps are advanced with the second order solution. All combinations
+ * \f$aM+bK\f$ are formed on a featkSharedPatternOperator, so step size
+ * changes never trigger reassembly. The first step, having no history, is
+ * taken with the given time step and is not error controlled.
+ *
+ * setUseDeflation() replaces the conjugate gradient solver by
+ * featkDeflatedConjugateGradient, which recycles Ritz vectors approximating
+ * the eigenvectors of the smallest eigenvalues of the system matrix from
+ * one time step to the next. The size of the recycled space and the number
+ * of solves between two updates are set by setDeflationSpaceSize() and
+ * setDeflationUpdateFrequency().
+ *
+ * setIterativeSolverType() replaces the conjugate gradient solver by one
+ * of the communication reducing variants featkPipelinedConjugateGradient
+ * or featkChebyshevIteration, whose stability limits are documented in
+ * their respective classes, or by featkMixedPrecisionSolver, i.e. single
+ * precision conjugate gradient iterations within double precision
+ * iterative refinement. Deflation, when enabled, takes precedence and the
+ * selected type is then ignored with a warning.
+ *
+ * Long runs can be checkpointed: every setCheckpointFrequency() iterations
+ * (accepted steps for adaptive time stepping), the state of the time loop
+ * (see featkCheckpoint) is copied and written to the file set by
+ * setCheckpointFileName() on a background thread (see
+ * featkCheckpointWriter). If a restart file is set by setRestartFileName(),
+ * solve() resumes from it instead of the initial state and, with the same
+ * settings and number of threads, reproduces the trajectory of the
+ * uninterrupted run exactly, except for the FEATK_BDF1 scheme whose
+ * preconditioner is recomputed on restart. A restart file written with a
+ * different fixed time step is rejected, whereas with adaptive time
+ * stepping the step size of the checkpoint overrides setTimeStep(), which
+ * only sets the first step of a new run.
+ *
+ * Derived solvers store their intermediate results (see
+ * setIntermediateProcessIterations() and setIntermediateProcessTimes()) by
+ * storeIntermediateResult(): if a featkTimeSeriesSinkInterface, e.g. a
+ * started featkXDMFTimeSeriesWriter, is set by setTimeSeriesWriter(), they
+ * are handed over to it, e.g. to be streamed to disk on a background
+ * thread so that memory does not grow with the number of snapshots; if
+ * setUseTimeSeriesAttributes() is set, they are appended to a featkMesh
+ * node featkTimeSeriesAttribute of the result name, stored in the
+ * precision set by setTimeSeriesPrecision(), which replaces any previous
+ * series of that name unless the solve restarts from a checkpoint, the
+ * series then being continued from the restart time; otherwise, each of
+ * them is stored as a featkMesh node attribute whose name is suffixed by
+ * its time.
+ *
+ * When inexact solves are enabled (see setUseInexactSolves()), the
+ * initial guess of each conjugate gradient solve is the polynomial
+ * extrapolation of the last two (first order schemes) or three (second
+ * order schemes) solutions, and the relative tolerance of the next solve is
+ * set to a fraction (see setInexactSolveFactor()) of the relative local
+ * truncation error, estimated by the difference between the extrapolated
+ * guess and the solution (or between both solutions of the embedded pair
+ * in adaptive mode). Solves are thus no more accurate than the time
+ * discretization requires.
+ *
+ * Time loops can be stopped early once a steady state is reached (see
+ * setSteadyStateTolerance()): after each step, the norm of
+ * \f$(u_{n+1}-u_n)/\Delta t\f$ is computed for each component separately
+ * and the loop stops when all of them are below the tolerance. When a
+ * functional is given through setSteadyStateFunctional(), the rate of
+ * change of its value is checked instead. The time at which the loop
+ * stopped and the times at which each component became stationary are
+ * returned by getSteadyStateTime() and getComponentSteadyStateTimes().
+ *
  * @tparam Dimension The cartesian dimension of the problem.
  *
  * @tparam Order The order of the variable the system is solved for.
@@ -55,7 +196,23 @@
 #ifndef FEATKDYNAMICSOLVERBASE_H
 #define FEATKDYNAMICSOLVERBASE_H
 
+#include <featk/solve/featkChebyshevIteration.h>
+#include <featk/solve/featkCheckpointWriter.h>
+#include <featk/solve/featkDeflatedConjugateGradient.h>
+#include <featk/solve/featkMixedPrecisionSolver.h>
+#include <featk/solve/featkPipelinedConjugateGradient.h>
+#include <featk/solve/featkSharedPatternOperator.h>
 #include <featk/solve/featkSolverBase.h>
+#include <featk/solve/featkTimeSeriesSinkInterface.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
 
 template<unsigned int Dimension, unsigned int Order>
 class featkDynamicSolverBase : public featkSolverBase<Dimension, Order> {
@@ -66,33 +223,189 @@ class featkDynamicSolverBase : public featkSolverBase<Dimension, Order> {
 
         void solve();
 
+        std::vector<double> getComponentSteadyStateTimes() const;
+        unsigned int getNumberOfAcceptedSteps() const;
+        unsigned int getNumberOfRejectedSteps() const;
+        double getSteadyStateTime() const;
+        void setAbsoluteTolerance(double tolerance);
+        void setCheckpointFileName(const std::string& fileName);
+        void setCheckpointFrequency(unsigned int frequency);
+        void setDeflationSpaceSize(unsigned int size);
+        void setDeflationUpdateFrequency(unsigned int frequency);
         void setDoCutoff(bool doCutoff);
         void setDoLowerCutoff(bool doCutoff);
         void setDoUpperCutoff(bool doCutoff);
+        void setEndTime(double time);
         void setIntermediateProcessIterations(std::vector<unsigned int> iterations);
+        void setInexactSolveFactor(double factor);
+        void setIntermediateProcessTimes(std::vector<double> times);
+        void setIterativeSolverType(featkIterativeSolverType type);
         void setLowerCutoffValue(double value);
+        void setMassLumping(featkMassLumping lumping);
+        void setMaximumNumberOfNewtonIterations(unsigned int iterations);
+        void setMaximumTimeStep(double step);
+        void setMinimumTimeStep(double step);
+        void setNewtonTolerance(double tolerance);
         void setNumberOfIterations(unsigned int iterations);
+        void setRelativeTolerance(double tolerance);
+        void setRestartFileName(const std::string& fileName);
+        void setSteadyStateFunctional(std::function<double(const VectorXd&)> functional);
+        void setSteadyStateNorm(featkNormType norm);
+        void setSteadyStateTolerance(double tolerance);
+        void setTimeIntegrationScheme(featkTimeIntegrationScheme scheme);
+        void setTimeSeriesPrecision(featkStoragePrecision precision);
+        void setTimeSeriesWriter(featkTimeSeriesSinkInterface* writer);
         void setTimeStep(double step);
         void setUpperCutoffValue(double value);
+        void setUseAdaptiveTimeStep(bool use);
+        void setUseDeflation(bool use);
+        void setUseDirectSolver(bool use);
+        void setUseInexactSolves(bool use);
+        void setUseTimeSeriesAttributes(bool use);
 
     protected:
 
+        /**
+         * System matrix aM+bK of a scheme, its EBC modified counterpart and
+         * the solvers decomposing the latter. The matrices are only recombined
+         * when the coefficients change.
+         */
+        struct featkSchemeSystem {
+
+            double massCoefficient = 0.0;
+            double stiffnessCoefficient = 0.0;
+            SparseMatrix<double> a;
+            SparseMatrix<double> k;
+            ConjugateGradient<SparseMatrix<double>, Lower|Upper> solver;
+            featkDeflatedConjugateGradient<double> deflatedSolver;
+            featkPipelinedConjugateGradient<double> pipelinedSolver;
+            featkChebyshevIteration<double> chebyshevSolver;
+            featkMixedPrecisionSolver<ConjugateGradient<SparseMatrix<float>, Lower|Upper>> mixedPrecisionSolver;
+            SimplicialLDLT<SparseMatrix<double>> directSolver;
+        };
+
+        /**
+         * Stacked pattern of the Jacobian of multi-component problems, built
+         * once for the structure of the coupled reaction Jacobian and rebuilt
+         * only if the latter changes.
+         */
+        struct featkCoupledJacobianPattern {
+
+            featkSharedPatternOperator<double> stackedOperator;                     // I x M, I x K and the reaction Jacobian pattern
+            std::vector<SparseMatrix<double>::StorageIndex> reactionOuterIndices;  // Structure of the reaction Jacobian
+            std::vector<SparseMatrix<double>::StorageIndex> reactionInnerIndices;
+            std::vector<Index> reactionEntries;                                     // Stacked pattern entry of each reaction Jacobian entry
+            bool rebuilt = false;                                                   // Whether the last call changed the structure
+        };
+
         featkDynamicSolverBase();
 
-        virtual SparseMatrix<double> getGlobalSystemMatrix()=0;
+        virtual const SparseMatrix<double>& getGlobalMassMatrix()=0;
+        virtual const SparseMatrix<double>& getGlobalStiffnessMatrix()=0;
+        virtual const VectorXd& getGlobalReactionVector(const VectorXd& u)=0;
+        virtual VectorXd getGlobalLumpedMassVector();
+        virtual const SparseMatrix<double>* getGlobalReactionJacobianMatrix();
+        virtual VectorXd getGlobalReactionJacobianScaling(const VectorXd& u);
+        virtual SparseMatrix<double> getGlobalCoupledReactionJacobianMatrix(const VectorXd& u);
+        virtual SparseMatrix<double> getGlobalSystemMatrix();
         virtual VectorXd getGlobalInitialVector()=0;
-        virtual VectorXd getGlobalSystemVector(const VectorXd& u)=0;
+        virtual VectorXd getGlobalSystemVector(const VectorXd& u);
         virtual void intermediateProcess(const VectorXd& u, unsigned int iteration);
+        virtual double getSpectralRadiusBound(const VectorXd& lumpedMass);
         virtual void postProcess(const VectorXd& solution)=0;
+        virtual void solveReaction(VectorXd& u, double step);
+
+        void applyCutoff(VectorXd& u) const;
+        void applyEBCToGlobalSystemVectors(const SparseMatrix<double>& globalSystemMatrix, VectorXd& globalSystemVectors);
+        void applyEBCToSolution(VectorXd& u, bool zero) const;
+        void computeSchemeSystemSolver(featkSchemeSystem& system, double factor=0.0);
+        bool formCoupledJacobianMatrix(const VectorXd& u, const featkSharedPatternOperator<double>& systemOperator, featkCoupledJacobianPattern& pattern, SparseMatrix<double>& jacobian);
+        featkCheckpoint getCheckpoint(unsigned int iteration, const std::vector<const featkSchemeSystem*>& systems) const;
+        double getEndTime() const;
+        double getErrorNorm(const VectorXd& error, const VectorXd& u0, const VectorXd& u1) const;
+        VectorXd getExtrapolatedGuess(const std::vector<const VectorXd*>& solutions, const std::vector<double>& steps, double step) const;
+        VectorXd getExplicitRateVector(const VectorXd& u, const SparseMatrix<double, RowMajor>& k, const VectorXd& inverseLumpedMass);
+        double getGershgorinBound(const SparseMatrix<double>& matrix, const VectorXd& lumpedMass) const;
+        VectorXd getGlobalResidualVector(const VectorXd& u, const VectorXd& uPrevious, double step);
+        std::string getSchemeSolverStatus(const featkSchemeSystem& system) const;
+        VectorXd getSchemeSystemVector(featkTimeIntegrationScheme scheme, double step, double w, const VectorXd& u, const VectorXd& uPrevious, const VectorXd& f, const VectorXd& fPrevious);
+        bool isSteadyState(const VectorXd& u, const VectorXd& uPrevious, double step);
+        bool isCheckpointIteration(unsigned int iteration) const;
+        void initializeSystemOperator(featkSharedPatternOperator<double>& systemOperator, const SparseMatrix<double>* reactionJacobianMatrix=nullptr);
+        VectorXd multiplyGlobalMatrix(const SparseMatrix<double>& globalMatrix, const VectorXd& u) const;
+        unsigned int restoreCheckpoint(const std::vector<featkSchemeSystem*>& systems);
+        template<typename SolverType> VectorXd solveGlobalSystem(const SolverType& solver, const VectorXd& globalSystemVectors, const VectorXd& guess) const;
+        VectorXd solveGlobalSystem(const SimplicialLDLT<SparseMatrix<double>>& solver, const VectorXd& globalSystemVectors, const VectorXd& guess) const;
+        VectorXd solveGlobalSystem(featkDeflatedConjugateGradient<double>& solver, const VectorXd& globalSystemVectors, const VectorXd& guess) const;
+        VectorXd solveScheme(featkTimeIntegrationScheme scheme, double step, double w, const VectorXd& u, const VectorXd& uPrevious, const VectorXd& f, const VectorXd& fPrevious, const VectorXd& guess, const featkSharedPatternOperator<double>& systemOperator, featkSchemeSystem& system);
+        VectorXd solveSchemeSystem(featkSchemeSystem& system, const VectorXd& globalSystemVectors, const VectorXd& guess);
+        void solveWithAdaptiveTimeStep(VectorXd& u);
+        void solveWithExplicitScheme(VectorXd& u);
+        void solveWithFixedTimeStep(VectorXd& u);
+        void solveWithNewton(VectorXd& u);
+        void solveWithSecondOrderScheme(VectorXd& u);
+        void solveWithSplitting(VectorXd& u);
+        void storeIntermediateResult(std::string name, unsigned int iteration, const VectorXd& values);
+        void updateInexactSolveTolerance(const VectorXd& guess, const VectorXd& u);
+        void writeCheckpoint(featkCheckpoint& checkpoint);
 
         bool doLowerCutoff;
         bool doUpperCutoff;
         double lowerCutoffValue;
         double upperCutoffValue;
 
+        unsigned int numberOfComponents;
         unsigned int numberOfIterations;
         double timeStep;
+        featkTimeIntegrationScheme timeIntegrationScheme;
         std::vector<unsigned int> intermediateProcessIterations;
+
+        unsigned int maximumNumberOfNewtonIterations;
+        double newtonTolerance;
+
+        bool useAdaptiveTimeStep;
+        double absoluteTolerance;
+        double currentTime;
+        double endTime;
+        std::vector<double> intermediateProcessTimes;
+        double maximumTimeStep;
+        double minimumTimeStep;
+        unsigned int numberOfAcceptedSteps;
+        unsigned int numberOfRejectedSteps;
+        double relativeTolerance;
+
+        bool useDirectSolver;
+
+        featkIterativeSolverType iterativeSolverType;
+
+        bool useDeflation;
+        unsigned int deflationSpaceSize;
+        unsigned int deflationUpdateFrequency;
+
+        featkMassLumping massLumping;
+
+        std::vector<double> componentSteadyStateTimes;
+        std::function<double(const VectorXd&)> steadyStateFunctional;
+        double steadyStateFunctionalValue;
+        featkNormType steadyStateNorm;
+        double steadyStateTime;
+        double steadyStateTolerance;
+
+        bool useInexactSolves;
+        double inexactSolveFactor;
+        double inexactSolveTolerance;
+
+        std::string checkpointFileName;
+        unsigned int checkpointFrequency;
+        featkCheckpointWriter checkpointWriter;
+        bool restart;
+        featkCheckpoint restartCheckpoint;
+        std::string restartFileName;
+
+        featkTimeSeriesSinkInterface* timeSeriesWriter;
+        bool useTimeSeriesAttributes;
+        featkStoragePrecision timeSeriesPrecision;
+        std::map<std::string, featkTimeSeriesAttribute*> timeSeriesAttributes;  // Appended to by the current solve
 };
 
 template<unsigned int Dimension, unsigned int Order>
@@ -103,8 +416,50 @@ featkDynamicSolverBase<Dimension, Order>::featkDynamicSolverBase() {
     this->lowerCutoffValue = 0.0;
     this->upperCutoffValue = 0.0;
 
+    this->numberOfComponents = 1;
     this->numberOfIterations = 500;
     this->timeStep = 1.0;
+    this->timeIntegrationScheme = FEATK_SBDF1;
+
+    this->maximumNumberOfNewtonIterations = 20;
+    this->newtonTolerance = 1.0e-8;
+
+    this->useAdaptiveTimeStep = false;
+    this->absoluteTolerance = 1.0e-4;
+    this->currentTime = 0.0;
+    this->endTime = 0.0;
+    this->maximumTimeStep = std::numeric_limits<double>::max();
+    this->minimumTimeStep = 1.0e-6;
+    this->numberOfAcceptedSteps = 0;
+    this->numberOfRejectedSteps = 0;
+    this->relativeTolerance = 1.0e-3;
+
+    this->useDirectSolver = false;
+
+    this->iterativeSolverType = FEATK_CONJUGATE_GRADIENT;
+
+    this->useDeflation = false;
+    this->deflationSpaceSize = 8;
+    this->deflationUpdateFrequency = 10;
+
+    this->massLumping = FEATK_ROW_SUM;
+
+    this->steadyStateFunctional = nullptr;
+    this->steadyStateFunctionalValue = std::numeric_limits<double>::quiet_NaN();
+    this->steadyStateNorm = FEATK_RMS_NORM;
+    this->steadyStateTime = -1.0;
+    this->steadyStateTolerance = 0.0;
+
+    this->useInexactSolves = false;
+    this->inexactSolveFactor = 0.01;
+    this->inexactSolveTolerance = NumTraits<double>::epsilon();
+
+    this->checkpointFrequency = 0;
+    this->restart = false;
+
+    this->timeSeriesWriter = nullptr;
+    this->useTimeSeriesAttributes = false;
+    this->timeSeriesPrecision = FEATK_DOUBLE_PRECISION;
 }
 
 template<unsigned int Dimension, unsigned int Order>
@@ -113,119 +468,1673 @@ featkDynamicSolverBase<Dimension, Order>::~featkDynamicSolverBase() {
 }
 
 template<unsigned int Dimension, unsigned int Order>
-void featkDynamicSolverBase<Dimension, Order>::intermediateProcess(const VectorXd &u, unsigned int iteration) {
+VectorXd featkDynamicSolverBase<Dimension, Order>::getGlobalLumpedMassVector() {
+
+    if (this->massLumping == FEATK_ROW_SUM) {
+
+        return this->getGlobalMassMatrix()*VectorXd::Ones(this->numberOfDOFs);
+    }
+
+    /* HRZ lumping: diagonal of each element mass matrix scaled to preserve the element mass. Assumes the global
+     * mass matrix is the NtN integral matrix. See Hinton et al. 1976. A note on mass lumping and related processes
+     * in the finite element method. Earthquake Eng. Struct. Dyn. 4(3). */
+
+    VectorXd ml = VectorXd::Zero(this->numberOfDOFs);
+    typename featkSolverBase<Dimension, Order>::ElementMatrixCacheType elementMatrices;
+
+    this->forEachElement([&](featkElementInterface<Dimension>* element) {
+
+        MatrixXd elementMatrix = this->getCachedElementMatrix(&featkSolverBase<Dimension, Order>::getElementNtNIntegralMatrix, element, {}, elementMatrices);
+        VectorXd diagonal = elementMatrix.diagonal();
+        diagonal *= elementMatrix.sum()/diagonal.sum();
+
+        size_t i = 0;
+
+        for (featkNode<Dimension>* node : element->getNodes()) {
 
+            for (unsigned int dof=0; dof!=this->dofsPerNode; dof++) {
+
+                ml(DOF_ID<Dimension, Order>(node->getID(), dof)) += diagonal(i);
+                i++;
+            }
+        }
+    });
+
+    return ml;
 }
 
 template<unsigned int Dimension, unsigned int Order>
-void featkDynamicSolverBase<Dimension, Order>::setDoCutoff(bool doCutoff) {
+SparseMatrix<double> featkDynamicSolverBase<Dimension, Order>::getGlobalCoupledReactionJacobianMatrix(const VectorXd& u) {
 
-    this->doLowerCutoff = doCutoff;
-    this->doUpperCutoff = doCutoff;
+    /* Jacobian of the stacked reaction vector of multi-component problems. Empty by default, i.e. ignored. */
+
+    return SparseMatrix<double>();
 }
 
 template<unsigned int Dimension, unsigned int Order>
-void featkDynamicSolverBase<Dimension, Order>::setDoLowerCutoff(bool doCutoff) {
+const SparseMatrix<double>* featkDynamicSolverBase<Dimension, Order>::getGlobalReactionJacobianMatrix() {
 
-    this->doLowerCutoff = doCutoff;
+    return nullptr;
 }
 
 template<unsigned int Dimension, unsigned int Order>
-void featkDynamicSolverBase<Dimension, Order>::setDoUpperCutoff(bool doCutoff) {
+VectorXd featkDynamicSolverBase<Dimension, Order>::getGlobalReactionJacobianScaling(const VectorXd& u) {
 
-    this->doUpperCutoff = doCutoff;
+    return VectorXd::Ones(u.size());
 }
 
 template<unsigned int Dimension, unsigned int Order>
-void featkDynamicSolverBase<Dimension, Order>::setIntermediateProcessIterations(std::vector<unsigned int> iterations) {
+SparseMatrix<double> featkDynamicSolverBase<Dimension, Order>::getGlobalSystemMatrix() {
 
-    this->intermediateProcessIterations = iterations;
+    return this->getGlobalMassMatrix() + this->timeStep*this->getGlobalStiffnessMatrix();
 }
 
 template<unsigned int Dimension, unsigned int Order>
-void featkDynamicSolverBase<Dimension, Order>::setLowerCutoffValue(double value) {
+VectorXd featkDynamicSolverBase<Dimension, Order>::getGlobalSystemVector(const VectorXd& u) {
 
-    this->lowerCutoffValue = value;
-    this->doLowerCutoff = true;
+    return this->multiplyGlobalMatrix(this->getGlobalMassMatrix(), u) + this->timeStep*this->getGlobalReactionVector(u);
 }
 
 template<unsigned int Dimension, unsigned int Order>
-void featkDynamicSolverBase<Dimension, Order>::setNumberOfIterations(unsigned int iterations) {
+double featkDynamicSolverBase<Dimension, Order>::getSpectralRadiusBound(const VectorXd& lumpedMass) {
 
-    this->numberOfIterations = iterations;
+    return this->getGershgorinBound(this->getGlobalStiffnessMatrix(), lumpedMass);
 }
 
 template<unsigned int Dimension, unsigned int Order>
-void featkDynamicSolverBase<Dimension, Order>::setTimeStep(double step) {
+void featkDynamicSolverBase<Dimension, Order>::intermediateProcess(const VectorXd &u, unsigned int iteration) {
 
-    this->timeStep = step;
 }
 
 template<unsigned int Dimension, unsigned int Order>
-void featkDynamicSolverBase<Dimension, Order>::setUpperCutoffValue(double value) {
+void featkDynamicSolverBase<Dimension, Order>::solveReaction(VectorXd& u, double step) {
 
-    this->upperCutoffValue	= value;
-    this->doUpperCutoff = true;
+    /* Explicit midpoint step on Ml*du/dt = f(u), Ml being the row-sum lumped mass matrix. */
+
+    VectorXd ml = this->multiplyGlobalMatrix(this->getGlobalMassMatrix(), VectorXd::Ones(u.size()));
+    VectorXd uHalf = u + 0.5*step*this->getGlobalReactionVector(u).cwiseQuotient(ml);
+
+    u += step*this->getGlobalReactionVector(uHalf).cwiseQuotient(ml);
 }
 
+
 template<unsigned int Dimension, unsigned int Order>
-void featkDynamicSolverBase<Dimension, Order>::solve() {
+void featkDynamicSolverBase<Dimension, Order>::applyCutoff(VectorXd& u) const {
 
-    cout << "featkDynamicSolverBase: Info: System has " << this->numberOfDOFs << " degrees of freedom." << endl;
+    if (this->doLowerCutoff) {
 
-    SparseMatrix<double> globalSystemMatrix = this->getGlobalSystemMatrix();
-    SparseMatrix<double> k = this->getEBCModifiedGlobalSystemMatrix(globalSystemMatrix);
+        u = (u.array() < this->lowerCutoffValue).select(this->lowerCutoffValue, u);
+    }
 
-    cout << "featkDynamicSolverBase: Info: System matrix density is " << globalSystemMatrix.nonZeros() << "/" << this->numberOfDOFs*this->numberOfDOFs << "." << endl;
+    if (this->doUpperCutoff) {
 
-    /*k.makeCompressed();
+        u = (u.array() > this->upperCutoffValue).select(this->upperCutoffValue, u);
+    }
+}
 
-    SimplicialLLT<SparseMatrix<double>> solver;
-    solver.compute(k);
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::applyEBCToGlobalSystemVectors(const SparseMatrix<double>& globalSystemMatrix, VectorXd& globalSystemVectors) {
 
-    if (solver.info() != Success) {
+    for (unsigned int i=0; i!=this->numberOfComponents; i++) {
 
-        cout << "featkDynamicSolverBase: Warning: Global system matrix decomposition failed." << endl;
-    }*/
+        VectorXd globalSystemVector = globalSystemVectors.segment(i*this->numberOfDOFs, this->numberOfDOFs);
+        this->applyEBCToGlobalSystemVector(globalSystemMatrix, globalSystemVector);
+        globalSystemVectors.segment(i*this->numberOfDOFs, this->numberOfDOFs) = globalSystemVector;
+    }
+}
 
-    //BiCGSTAB<SparseMatrix<double, RowMajor>> solver;  // OpenMP parallelized only for RowMajor. BiCGSTAB is more general than CG and works for all kind of matrices.
-    ConjugateGradient<SparseMatrix<double>, Lower|Upper> solver;  // Only for symmetric positive definite matrices, a bit faster than BiCGSTAB in this case.
-    solver.compute(k);
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::applyEBCToSolution(VectorXd& u, bool zero) const {
 
-    VectorXd u = this->getGlobalInitialVector();
-    VectorXd f = VectorXd(this->numberOfDOFs);
+    /* Sets the fixed DOFs of each component to their prescribed value, or to zero for residual and update vectors. */
 
-    for (unsigned int i=0; i!=this->numberOfIterations; i++) {
+    if (this->essentialBoundaryConditions == nullptr || !this->essentialBoundaryConditions->isCompiled(this->numberOfDOFs)) {
 
-        f = this->getGlobalSystemVector(u);
-        this->applyEBCToGlobalSystemVector(globalSystemMatrix, f);
-        u = solver.solveWithGuess(f, u).head(this->numberOfDOFs);
-        //u = solver.solve(u).head(this->numberOfDOFs);
+        return;
+    }
+
+    const std::vector<size_t>& dofs = this->essentialBoundaryConditions->getCompiledDOFs();
+    const VectorXd& values = this->essentialBoundaryConditions->getCompiledDOFValues();
+
+    for (unsigned int i=0; i!=this->numberOfComponents; i++) {
 
-        if (this->doLowerCutoff) {
+        for (size_t j=0; j!=dofs.size(); j++) {
 
-            u = (u.array() < this->lowerCutoffValue).select(this->lowerCutoffValue, u);
+            if (dofs[j] < this->numberOfDOFs) {
+
+                u(i*this->numberOfDOFs+dofs[j]) = zero ? 0.0 : values(j);
+            }
         }
+    }
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::computeSchemeSystemSolver(featkSchemeSystem& system, double factor) {
+
+    /* Decomposes system.k with the selected solver, the iterative solvers keeping a reference to it. factor bounds the */
+    /* change of the stiffness to mass coefficient ratio since the previous decomposition, 0 if unknown.                */
+
+    if (this->useDirectSolver) {
+
+        system.directSolver.compute(system.k);
 
-        if (this->doUpperCutoff) {
+        if (system.directSolver.info() != Success) {
 
-            u = (u.array() > this->upperCutoffValue).select(this->upperCutoffValue, u);
+            cout << "featkDynamicSolverBase: Warning: Global system matrix decomposition failed." << endl;
         }
+    }
 
-        cout << "featkDynamicSolverBase: Info: Iteration " << i+1 << "/" << this->numberOfIterations << " solved (" << solver.iterations() << " iterations, error: " << solver.error() << ")." << endl;
-        //cout << "featkDynamicSolverBase: Info: Iteration " << i+1 << "/" << this->numberOfIterations << " solved." << endl;
+    else if (this->useDeflation) {
 
-        if (find(this->intermediateProcessIterations.begin(), this->intermediateProcessIterations.end(), i) != this->intermediateProcessIterations.end()) {
+        system.deflatedSolver.setDeflationSpaceSize(this->deflationSpaceSize);
+        system.deflatedSolver.setDeflationUpdateFrequency(this->deflationUpdateFrequency);
+        system.deflatedSolver.compute(system.k);
+    }
 
-            this->intermediateProcess(u, i);
+    else if (this->iterativeSolverType == FEATK_PIPELINED_CONJUGATE_GRADIENT) {
+
+        system.pipelinedSolver.compute(system.k);
+    }
+
+    else if (this->iterativeSolverType == FEATK_CHEBYSHEV_ITERATION) {
+
+        system.chebyshevSolver.compute(system.k, factor);
+    }
+
+    else if (this->iterativeSolverType == FEATK_MIXED_PRECISION_CONJUGATE_GRADIENT) {
+
+        system.mixedPrecisionSolver.compute(system.k);
+    }
+
+    else {
+
+        system.solver.compute(system.k);
+    }
+}
+
+template<unsigned int Dimension, unsigned int Order>
+bool featkDynamicSolverBase<Dimension, Order>::formCoupledJacobianMatrix(const VectorXd& u, const featkSharedPatternOperator<double>& systemOperator, featkCoupledJacobianPattern& pattern, SparseMatrix<double>& jacobian) {
+
+    /**
+     * I x (M + dt*K) - dt*J(u) on the stacked components, essential boundary conditions being applied to every
+     * component. The stacked pattern is built the first time and whenever the structure of J(u), i.e. its outer
+     * and inner index arrays, changes; the values are otherwise updated in place, so that the solver always sees
+     * the current Jacobian and nothing is allocated.
+     */
+
+    SparseMatrix<double> jf = this->getGlobalCoupledReactionJacobianMatrix(u);
+
+    if (jf.rows() == 0) {
+
+        return false;
+    }
+
+    jf.makeCompressed();
+
+    pattern.rebuilt = pattern.reactionOuterIndices.size() != size_t(jf.outerSize()+1) || pattern.reactionInnerIndices.size() != size_t(jf.nonZeros())
+                   || !std::equal(pattern.reactionOuterIndices.begin(), pattern.reactionOuterIndices.end(), jf.outerIndexPtr())
+                   || !std::equal(pattern.reactionInnerIndices.begin(), pattern.reactionInnerIndices.end(), jf.innerIndexPtr());
+
+    if (pattern.rebuilt) {
+
+        /* I x M and I x K from the shared pattern of a single component, the reaction Jacobian only adding its pattern */
+
+        std::vector<SparseMatrix<double>> stacked;
+
+        for (const std::vector<double>& coefficients : std::vector<std::vector<double>>{{1.0, 0.0}, {0.0, 1.0}}) {
+
+            SparseMatrix<double> a;
+            systemOperator.combine(coefficients, a, false);
+
+            std::vector<Triplet<double>> triplets;
+            triplets.reserve(this->numberOfComponents*a.nonZeros());
+
+            for (unsigned int c=0; c!=this->numberOfComponents; c++) {
+
+                Index offset = c*this->numberOfDOFs;
+
+                for (Index k=0; k!=a.outerSize(); k++) {
+
+                    for (SparseMatrix<double>::InnerIterator it(a, k); it; ++it) {
+
+                        triplets.push_back(Triplet<double>(offset+it.row(), offset+it.col(), it.value()));
+                    }
+                }
+            }
+
+            stacked.push_back(SparseMatrix<double>(jf.rows(), jf.cols()));
+            stacked.back().setFromTriplets(triplets.begin(), triplets.end());
+        }
+
+        pattern.stackedOperator.setMatrices({&stacked[0], &stacked[1], &jf});
+
+        if (this->essentialBoundaryConditions != nullptr) {
+
+            const std::vector<bool>& mask = this->essentialBoundaryConditions->getCompiledDOFMask();
+            std::vector<bool> stackedMask(jf.rows());
+
+            for (Index i=0; i!=jf.rows(); i++) {
+
+                stackedMask[i] = mask[i%this->numberOfDOFs];
+            }
+
+            pattern.stackedOperator.setEssentialDOFMask(stackedMask);
+        }
+
+        const SparseMatrix<double>& p = pattern.stackedOperator.getPattern();
+        pattern.reactionEntries.resize(jf.nonZeros());
+
+        for (Index j=0; j!=jf.outerSize(); j++) {
+
+            Index k = p.outerIndexPtr()[j];
+
+            for (Index l=jf.outerIndexPtr()[j]; l!=jf.outerIndexPtr()[j+1]; l++) {
+
+                while (p.innerIndexPtr()[k] != jf.innerIndexPtr()[l]) {
+
+                    k++;
+                }
+
+                pattern.reactionEntries[l] = k;
+            }
         }
+
+        pattern.reactionOuterIndices.assign(jf.outerIndexPtr(), jf.outerIndexPtr()+jf.outerSize()+1);
+        pattern.reactionInnerIndices.assign(jf.innerIndexPtr(), jf.innerIndexPtr()+jf.nonZeros());
+        jacobian = SparseMatrix<double>();  // The structure is copied by the next combination
     }
 
-    cout << "featkDynamicSolverBase: Info: System solved" << endl;
+    pattern.stackedOperator.combine({1.0, this->timeStep}, jacobian, false);
 
-    this->postProcess(u);
+    for (Index l=0; l!=jf.nonZeros(); l++) {
 
-    cout << "featkDynamicSolverBase: Info: Post processing done" << endl;
+        jacobian.valuePtr()[pattern.reactionEntries[l]] -= this->timeStep*jf.valuePtr()[l];
+    }
+
+    pattern.stackedOperator.applyEssentialDOFMask(jacobian);
+
+    return true;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+std::vector<double> featkDynamicSolverBase<Dimension, Order>::getComponentSteadyStateTimes() const {
+
+    return this->componentSteadyStateTimes;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+featkCheckpoint featkDynamicSolverBase<Dimension, Order>::getCheckpoint(unsigned int iteration, const std::vector<const featkSchemeSystem*>& systems) const {
+
+    /* Time loop independent state, the solution vectors being set by the caller. */
+
+    featkCheckpoint checkpoint;
+
+    checkpoint.timeIntegrationScheme = this->timeIntegrationScheme;
+    checkpoint.adaptive = this->useAdaptiveTimeStep;
+    checkpoint.numberOfComponents = this->numberOfComponents;
+    checkpoint.numberOfDOFs = this->numberOfDOFs;
+
+    checkpoint.iteration = iteration;
+    checkpoint.numberOfRejectedSteps = this->numberOfRejectedSteps;
+    checkpoint.currentTime = this->currentTime;
+    checkpoint.timeStep = this->timeStep;
+    checkpoint.inexactSolveTolerance = this->inexactSolveTolerance;
+    checkpoint.steadyStateFunctionalValue = this->steadyStateFunctionalValue;
+    checkpoint.componentSteadyStateTimes = this->componentSteadyStateTimes;
+
+    for (const featkSchemeSystem* system : systems) {
+
+        checkpoint.ritzVectors.push_back(system->deflatedSolver.getRitzVectors());
+        checkpoint.numberOfSolves.push_back(system->deflatedSolver.getNumberOfSolves());
+    }
+
+    return checkpoint;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+double featkDynamicSolverBase<Dimension, Order>::getEndTime() const {
+
+    return this->endTime > 0.0 ? this->endTime : this->numberOfIterations*this->timeStep;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+double featkDynamicSolverBase<Dimension, Order>::getErrorNorm(const VectorXd& error, const VectorXd& u0, const VectorXd& u1) const {
+
+    /* Weighted RMS norm, see E. Hairer, G. Wanner. Solving Ordinary Differential Equations II, p.124, 1996. */
+
+    ArrayXd scale = this->absoluteTolerance + this->relativeTolerance*u0.cwiseAbs().cwiseMax(u1.cwiseAbs()).array();
+
+    return error.size() != 0 ? std::sqrt((error.array()/scale).square().mean()) : 0.0;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+VectorXd featkDynamicSolverBase<Dimension, Order>::getExtrapolatedGuess(const std::vector<const VectorXd*>& solutions, const std::vector<double>& steps, double step) const {
+
+    /**
+     * Lagrange extrapolation to t_n + dt of solutions = {u_n, u_n-1, u_n-2} with steps = {t_n - t_n-1, t_n-1 - t_n-2}.
+     * Only the first solutions.size() solutions are used (constant, linear or quadratic extrapolation).
+     */
+
+    if (solutions.size() >= 3 && steps.size() >= 2) {
+
+        double h = step;
+        double h1 = steps[0];
+        double h2 = steps[1];
+
+        double l0 = (h+h1)*(h+h1+h2)/(h1*(h1+h2));
+        double l1 = -h*(h+h1+h2)/(h1*h2);
+        double l2 = h*(h+h1)/(h2*(h1+h2));
+
+        return l0*(*solutions[0]) + l1*(*solutions[1]) + l2*(*solutions[2]);
+    }
+
+    if (solutions.size() >= 2 && steps.size() >= 1) {
+
+        return (*solutions[0]) + (step/steps[0])*((*solutions[0])-(*solutions[1]));
+    }
+
+    return *solutions[0];
+}
+
+template<unsigned int Dimension, unsigned int Order>
+VectorXd featkDynamicSolverBase<Dimension, Order>::getExplicitRateVector(const VectorXd& u, const SparseMatrix<double, RowMajor>& k, const VectorXd& inverseLumpedMass) {
+
+    /* Ml^-1*(f(u) - K*u) for all components at once. The row major stiffness matrix lets Eigen split the sparse
+     * matrix product across threads. */
+
+    VectorXd v = this->getGlobalReactionVector(u);
+    Map<MatrixXd> vs(v.data(), this->numberOfDOFs, this->numberOfComponents);
+
+    vs -= k*Map<const MatrixXd>(u.data(), this->numberOfDOFs, this->numberOfComponents);
+    vs = vs.array().colwise()*inverseLumpedMass.array();
+
+    return v;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+double featkDynamicSolverBase<Dimension, Order>::getGershgorinBound(const SparseMatrix<double>& matrix, const VectorXd& lumpedMass) const {
+
+    /* Bound on the spectral radius of Ml^-1*A given by the largest absolute row sum. */
+
+    VectorXd rows = VectorXd::Zero(matrix.rows());
+
+    for (Index j=0; j!=matrix.outerSize(); j++) {
+
+        for (SparseMatrix<double>::InnerIterator it(matrix, j); it; ++it) {
+
+            rows(it.row()) += std::abs(it.value());
+        }
+    }
+
+    return matrix.rows() != 0 ? rows.cwiseQuotient(lumpedMass).maxCoeff() : 0.0;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+VectorXd featkDynamicSolverBase<Dimension, Order>::getGlobalResidualVector(const VectorXd& u, const VectorXd& uPrevious, double step) {
+
+    VectorXd g = this->multiplyGlobalMatrix(this->getGlobalMassMatrix(), u-uPrevious) + step*(this->multiplyGlobalMatrix(this->getGlobalStiffnessMatrix(), u) - this->getGlobalReactionVector(u));
+    this->applyEBCToSolution(g, true);
+
+    return g;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+unsigned int featkDynamicSolverBase<Dimension, Order>::getNumberOfAcceptedSteps() const {
+
+    return this->numberOfAcceptedSteps;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+unsigned int featkDynamicSolverBase<Dimension, Order>::getNumberOfRejectedSteps() const {
+
+    return this->numberOfRejectedSteps;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+std::string featkDynamicSolverBase<Dimension, Order>::getSchemeSolverStatus(const featkSchemeSystem& system) const {
+
+    std::ostringstream stream;
+
+    if (this->useDirectSolver) {
+
+        stream << "direct solve";
+    }
+
+    else if (this->useDeflation) {
+
+        stream << system.deflatedSolver.iterations() << " iterations, error: " << system.deflatedSolver.error() << ", " << system.deflatedSolver.getNumberOfRitzVectors() << " Ritz vectors";
+    }
+
+    else if (this->iterativeSolverType == FEATK_PIPELINED_CONJUGATE_GRADIENT) {
+
+        stream << system.pipelinedSolver.iterations() << " pipelined iterations, error: " << system.pipelinedSolver.error();
+    }
+
+    else if (this->iterativeSolverType == FEATK_CHEBYSHEV_ITERATION) {
+
+        stream << system.chebyshevSolver.iterations() << " Chebyshev iterations, error: " << system.chebyshevSolver.error();
+    }
+
+    else if (this->iterativeSolverType == FEATK_MIXED_PRECISION_CONJUGATE_GRADIENT) {
+
+        stream << system.mixedPrecisionSolver.iterations() << " single precision iterations, " << system.mixedPrecisionSolver.getNumberOfRefinements() << " refinements, error: " << system.mixedPrecisionSolver.error();
+    }
+
+    else {
+
+        stream << system.solver.iterations() << " iterations, error: " << system.solver.error();
+    }
+
+    return stream.str();
+}
+
+template<unsigned int Dimension, unsigned int Order>
+VectorXd featkDynamicSolverBase<Dimension, Order>::getSchemeSystemVector(featkTimeIntegrationScheme scheme, double step, double w, const VectorXd& u, const VectorXd& uPrevious, const VectorXd& f, const VectorXd& fPrevious) {
+
+    /**
+     * Variable step coefficients with w = dt_n/dt_n-1:
+     *
+     *   SBDF1: (M + dt_n*K)*u_n+1 = M*u_n + dt_n*f(u_n)
+     *   CNAB2: (M + dt_n/2*K)*u_n+1 = (M - dt_n/2*K)*u_n + dt_n*((1+w/2)*f(u_n) - w/2*f(u_n-1))
+     *   SBDF2: ((1+2w)/(1+w)*M + dt_n*K)*u_n+1 = M*((1+w)*u_n - w^2/(1+w)*u_n-1) + dt_n*((1+w)*f(u_n) - w*f(u_n-1))
+     *
+     * See Wang and Ruuth. 2008. Variable step-size implicit-explicit linear multistep methods for time-dependent
+     * partial differential equations. J. Comput. Math. 26(6).
+     */
+
+    const SparseMatrix<double>& m = this->getGlobalMassMatrix();
+
+    VectorXd b;
+
+    switch (scheme) {
+
+        case FEATK_CNAB2:
+
+            b = this->multiplyGlobalMatrix(m, u) - 0.5*step*this->multiplyGlobalMatrix(this->getGlobalStiffnessMatrix(), u) + step*((1.0+0.5*w)*f-0.5*w*fPrevious);
+            break;
+
+        case FEATK_SBDF2:
+
+            b = this->multiplyGlobalMatrix(m, (1.0+w)*u-(w*w/(1.0+w))*uPrevious) + step*((1.0+w)*f-w*fPrevious);
+            break;
+
+        default:
+
+            b = this->multiplyGlobalMatrix(m, u) + step*f;
+            break;
+    }
+
+    return b;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+double featkDynamicSolverBase<Dimension, Order>::getSteadyStateTime() const {
+
+    return this->steadyStateTime;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+bool featkDynamicSolverBase<Dimension, Order>::isSteadyState(const VectorXd& u, const VectorXd& uPrevious, double step) {
+
+    /* Components stationary over the last step keep the time they first became so, others are reset to -1. */
+
+    if (this->steadyStateTolerance <= 0.0 || step <= 0.0) {
+
+        return false;
+    }
+
+    bool steady = true;
+
+    if (this->steadyStateFunctional) {
+
+        if (std::isnan(this->steadyStateFunctionalValue)) {
+
+            this->steadyStateFunctionalValue = this->steadyStateFunctional(uPrevious);
+        }
+
+        double value = this->steadyStateFunctional(u);
+        steady = std::abs(value-this->steadyStateFunctionalValue)/step < this->steadyStateTolerance;
+        this->steadyStateFunctionalValue = value;
+    }
+
+    else {
+
+        for (unsigned int i=0; i!=this->numberOfComponents; i++) {
+
+            ArrayXd rate = (u.segment(i*this->numberOfDOFs, this->numberOfDOFs)-uPrevious.segment(i*this->numberOfDOFs, this->numberOfDOFs)).array()/step;
+            double norm;
+
+            switch (this->steadyStateNorm) {
+
+                case FEATK_L2_NORM:
+
+                    norm = rate.matrix().norm();
+                    break;
+
+                case FEATK_MAX_NORM:
+
+                    norm = rate.size() != 0 ? rate.abs().maxCoeff() : 0.0;
+                    break;
+
+                default:
+
+                    norm = rate.size() != 0 ? std::sqrt(rate.square().mean()) : 0.0;
+                    break;
+            }
+
+            if (norm >= this->steadyStateTolerance) {
+
+                this->componentSteadyStateTimes[i] = -1.0;
+                steady = false;
+            }
+
+            else if (this->componentSteadyStateTimes[i] < 0.0) {
+
+                this->componentSteadyStateTimes[i] = this->currentTime;
+            }
+        }
+    }
+
+    if (steady) {
+
+        this->steadyStateTime = this->currentTime;
+        cout << "featkDynamicSolverBase: Info: Steady state reached at t = " << this->currentTime << ", time loop stopped." << endl;
+    }
+
+    return steady;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+bool featkDynamicSolverBase<Dimension, Order>::isCheckpointIteration(unsigned int iteration) const {
+
+    return this->checkpointFrequency != 0 && !this->checkpointFileName.empty() && iteration%this->checkpointFrequency == 0;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::initializeSystemOperator(featkSharedPatternOperator<double>& systemOperator, const SparseMatrix<double>* reactionJacobianMatrix) {
+
+    std::vector<const SparseMatrix<double>*> matrices = {&this->getGlobalMassMatrix(), &this->getGlobalStiffnessMatrix()};
+
+    if (reactionJacobianMatrix != nullptr) {
+
+        matrices.push_back(reactionJacobianMatrix);
+    }
+
+    systemOperator.setMatrices(matrices);
+
+    if (this->essentialBoundaryConditions != nullptr) {
+
+        this->essentialBoundaryConditions->compile(this->numberOfDOFs);
+        systemOperator.setEssentialDOFMask(this->essentialBoundaryConditions->getCompiledDOFMask());
+    }
+
+    cout << "featkDynamicSolverBase: Info: System matrix density is " << systemOperator.getPattern().nonZeros() << "/" << this->numberOfDOFs*this->numberOfDOFs << "." << endl;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+VectorXd featkDynamicSolverBase<Dimension, Order>::multiplyGlobalMatrix(const SparseMatrix<double>& globalMatrix, const VectorXd& u) const {
+
+    VectorXd v = VectorXd(u.size());
+    Map<MatrixXd>(v.data(), this->numberOfDOFs, this->numberOfComponents) = globalMatrix*Map<const MatrixXd>(u.data(), this->numberOfDOFs, this->numberOfComponents);
+
+    return v;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+unsigned int featkDynamicSolverBase<Dimension, Order>::restoreCheckpoint(const std::vector<featkSchemeSystem*>& systems) {
+
+    /* Restores the deflated solvers and returns the first iteration of the time loop. */
+
+    if (!this->restart) {
+
+        return 0;
+    }
+
+    for (size_t i=0; i!=systems.size() && i!=this->restartCheckpoint.ritzVectors.size(); i++) {
+
+        systems[i]->deflatedSolver.setRitzVectors(this->restartCheckpoint.ritzVectors[i], this->restartCheckpoint.numberOfSolves[i]);
+    }
+
+    return this->restartCheckpoint.iteration;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setAbsoluteTolerance(double tolerance) {
+
+    this->absoluteTolerance = tolerance;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setCheckpointFileName(const std::string& fileName) {
+
+    this->checkpointFileName = fileName;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setCheckpointFrequency(unsigned int frequency) {
+
+    this->checkpointFrequency = frequency;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setDeflationSpaceSize(unsigned int size) {
+
+    this->deflationSpaceSize = size;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setDeflationUpdateFrequency(unsigned int frequency) {
+
+    this->deflationUpdateFrequency = frequency;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setDoCutoff(bool doCutoff) {
+
+    this->doLowerCutoff = doCutoff;
+    this->doUpperCutoff = doCutoff;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setDoLowerCutoff(bool doCutoff) {
+
+    this->doLowerCutoff = doCutoff;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setDoUpperCutoff(bool doCutoff) {
+
+    this->doUpperCutoff = doCutoff;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setEndTime(double time) {
+
+    this->endTime = time;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setIntermediateProcessIterations(std::vector<unsigned int> iterations) {
+
+    this->intermediateProcessIterations = iterations;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setInexactSolveFactor(double factor) {
+
+    this->inexactSolveFactor = factor;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setIntermediateProcessTimes(std::vector<double> times) {
+
+    this->intermediateProcessTimes = times;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setIterativeSolverType(featkIterativeSolverType type) {
+
+    this->iterativeSolverType = type;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setLowerCutoffValue(double value) {
+
+    this->lowerCutoffValue = value;
+    this->doLowerCutoff = true;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setMassLumping(featkMassLumping lumping) {
+
+    this->massLumping = lumping;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setMaximumNumberOfNewtonIterations(unsigned int iterations) {
+
+    this->maximumNumberOfNewtonIterations = iterations;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setMaximumTimeStep(double step) {
+
+    this->maximumTimeStep = step;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setMinimumTimeStep(double step) {
+
+    this->minimumTimeStep = step;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setNewtonTolerance(double tolerance) {
+
+    this->newtonTolerance = tolerance;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setNumberOfIterations(unsigned int iterations) {
+
+    this->numberOfIterations = iterations;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setRelativeTolerance(double tolerance) {
+
+    this->relativeTolerance = tolerance;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setRestartFileName(const std::string& fileName) {
+
+    this->restartFileName = fileName;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setSteadyStateFunctional(std::function<double(const VectorXd&)> functional) {
+
+    this->steadyStateFunctional = functional;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setSteadyStateNorm(featkNormType norm) {
+
+    this->steadyStateNorm = norm;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setSteadyStateTolerance(double tolerance) {
+
+    this->steadyStateTolerance = tolerance;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setTimeIntegrationScheme(featkTimeIntegrationScheme scheme) {
+
+    this->timeIntegrationScheme = scheme;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setTimeSeriesPrecision(featkStoragePrecision precision) {
+
+    this->timeSeriesPrecision = precision;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setTimeSeriesWriter(featkTimeSeriesSinkInterface* writer) {
+
+    this->timeSeriesWriter = writer;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setTimeStep(double step) {
+
+    this->timeStep = step;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setUpperCutoffValue(double value) {
+
+    this->upperCutoffValue	= value;
+    this->doUpperCutoff = true;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setUseAdaptiveTimeStep(bool use) {
+
+    this->useAdaptiveTimeStep = use;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setUseDeflation(bool use) {
+
+    this->useDeflation = use;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setUseDirectSolver(bool use) {
+
+    this->useDirectSolver = use;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setUseInexactSolves(bool use) {
+
+    this->useInexactSolves = use;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::setUseTimeSeriesAttributes(bool use) {
+
+    this->useTimeSeriesAttributes = use;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::solve() {
+
+    cout << "featkDynamicSolverBase: Info: System has " << this->numberOfComponents*this->numberOfDOFs << " degrees of freedom." << endl;
+
+    VectorXd u = this->getGlobalInitialVector();
+
+    this->componentSteadyStateTimes.assign(this->numberOfComponents, -1.0);
+    this->steadyStateFunctionalValue = std::numeric_limits<double>::quiet_NaN();
+    this->steadyStateTime = -1.0;
+    this->inexactSolveTolerance = NumTraits<double>::epsilon();
+    this->restart = false;
+    this->timeSeriesAttributes.clear();
+
+    if (this->useDeflation && !this->useDirectSolver && this->iterativeSolverType != FEATK_CONJUGATE_GRADIENT) {
+
+        cout << "featkDynamicSolverBase: Warning: Deflation enabled, selected iterative solver type ignored." << endl;
+    }
+
+    if (!this->restartFileName.empty()) {
+
+        featkCheckpoint& checkpoint = this->restartCheckpoint;
+
+        if (!checkpoint.read(this->restartFileName)) {
+
+            cout << "featkDynamicSolverBase: Warning: Restart file could not be read, starting from the initial state." << endl;
+        }
+
+        else if (checkpoint.numberOfDOFs != this->numberOfDOFs || checkpoint.numberOfComponents != this->numberOfComponents || checkpoint.timeIntegrationScheme != this->timeIntegrationScheme || checkpoint.adaptive != this->useAdaptiveTimeStep || checkpoint.u.size() != u.size() || (!this->useAdaptiveTimeStep && checkpoint.timeStep != this->timeStep)) {
+
+            cout << "featkDynamicSolverBase: Warning: Restart file does not match the problem settings, starting from the initial state." << endl;
+        }
+
+        else {
+
+            u = checkpoint.u;
+            this->currentTime = checkpoint.currentTime;
+            this->componentSteadyStateTimes = checkpoint.componentSteadyStateTimes;
+            this->steadyStateFunctionalValue = checkpoint.steadyStateFunctionalValue;
+            this->inexactSolveTolerance = checkpoint.inexactSolveTolerance;
+            this->restart = true;
+
+            cout << "featkDynamicSolverBase: Info: Restarting from iteration " << checkpoint.iteration << " (t = " << checkpoint.currentTime << ")." << endl;
+        }
+    }
+
+    if (this->useAdaptiveTimeStep) {
+
+        this->solveWithAdaptiveTimeStep(u);
+    }
+
+    else if (this->timeIntegrationScheme == FEATK_STRANG) {
+
+        this->solveWithSplitting(u);
+    }
+
+    else if (this->timeIntegrationScheme == FEATK_BDF1) {
+
+        this->solveWithNewton(u);
+    }
+
+    else if (this->timeIntegrationScheme == FEATK_FORWARD_EULER || this->timeIntegrationScheme == FEATK_SSPRK2 || this->timeIntegrationScheme == FEATK_SSPRK3) {
+
+        this->solveWithExplicitScheme(u);
+    }
+
+    else if (this->timeIntegrationScheme != FEATK_SBDF1) {
+
+        this->solveWithSecondOrderScheme(u);
+    }
+
+    else {
+
+        this->solveWithFixedTimeStep(u);
+    }
+
+    this->checkpointWriter.wait();
+    this->restart = false;
+    this->restartCheckpoint = featkCheckpoint();
+
+    cout << "featkDynamicSolverBase: Info: System solved" << endl;
+
+    this->postProcess(u);
+
+    cout << "featkDynamicSolverBase: Info: Post processing done" << endl;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+template<typename SolverType>
+VectorXd featkDynamicSolverBase<Dimension, Order>::solveGlobalSystem(const SolverType& solver, const VectorXd& globalSystemVectors, const VectorXd& guess) const {
+
+    /* Components are stored as the columns of a numberOfDOFs x numberOfComponents right-hand side. */
+
+    VectorXd u = VectorXd(this->numberOfComponents*this->numberOfDOFs);
+    Map<MatrixXd>(u.data(), this->numberOfDOFs, this->numberOfComponents) = solver.solveWithGuess(Map<const MatrixXd>(globalSystemVectors.data(), this->numberOfDOFs, this->numberOfComponents), Map<const MatrixXd>(guess.data(), this->numberOfDOFs, this->numberOfComponents));
+
+    return u;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+VectorXd featkDynamicSolverBase<Dimension, Order>::solveGlobalSystem(const SimplicialLDLT<SparseMatrix<double>>& solver, const VectorXd& globalSystemVectors, const VectorXd& guess) const {
+
+    VectorXd u = VectorXd(this->numberOfComponents*this->numberOfDOFs);
+    Map<MatrixXd>(u.data(), this->numberOfDOFs, this->numberOfComponents) = solver.solve(Map<const MatrixXd>(globalSystemVectors.data(), this->numberOfDOFs, this->numberOfComponents));
+
+    return u;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+VectorXd featkDynamicSolverBase<Dimension, Order>::solveGlobalSystem(featkDeflatedConjugateGradient<double>& solver, const VectorXd& globalSystemVectors, const VectorXd& guess) const {
+
+    VectorXd u = VectorXd(this->numberOfComponents*this->numberOfDOFs);
+    Map<MatrixXd>(u.data(), this->numberOfDOFs, this->numberOfComponents) = solver.solveWithGuess(Map<const MatrixXd>(globalSystemVectors.data(), this->numberOfDOFs, this->numberOfComponents), Map<const MatrixXd>(guess.data(), this->numberOfDOFs, this->numberOfComponents));
+
+    return u;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+VectorXd featkDynamicSolverBase<Dimension, Order>::solveScheme(featkTimeIntegrationScheme scheme, double step, double w, const VectorXd& u, const VectorXd& uPrevious, const VectorXd& f, const VectorXd& fPrevious, const VectorXd& guess, const featkSharedPatternOperator<double>& systemOperator, featkSchemeSystem& system) {
+
+    double massCoefficient = scheme == FEATK_SBDF2 ? (1.0+2.0*w)/(1.0+w) : 1.0;
+    double stiffnessCoefficient = scheme == FEATK_CNAB2 ? 0.5*step : step;
+
+    if (massCoefficient != system.massCoefficient || stiffnessCoefficient != system.stiffnessCoefficient) {
+
+        systemOperator.combine({massCoefficient, stiffnessCoefficient}, system.a, false);
+        systemOperator.combine({massCoefficient, stiffnessCoefficient}, system.k);
+
+        double factor = 0.0;
+
+        if (system.massCoefficient > 0.0 && system.stiffnessCoefficient > 0.0) {
+
+            double g = (stiffnessCoefficient*system.massCoefficient)/(massCoefficient*system.stiffnessCoefficient);
+            factor = std::max(g, 1.0/g);
+        }
+
+        this->computeSchemeSystemSolver(system, factor);
+        system.massCoefficient = massCoefficient;
+        system.stiffnessCoefficient = stiffnessCoefficient;
+    }
+
+    VectorXd b = this->getSchemeSystemVector(scheme, step, w, u, uPrevious, f, fPrevious);
+    this->applyEBCToGlobalSystemVectors(system.a, b);
+
+    return this->solveSchemeSystem(system, b, guess);
+}
+
+template<unsigned int Dimension, unsigned int Order>
+VectorXd featkDynamicSolverBase<Dimension, Order>::solveSchemeSystem(featkSchemeSystem& system, const VectorXd& globalSystemVectors, const VectorXd& guess) {
+
+    if (this->useDirectSolver) {
+
+        return this->solveGlobalSystem(system.directSolver, globalSystemVectors, guess);
+    }
+
+    if (this->useInexactSolves) {
+
+        system.solver.setTolerance(this->inexactSolveTolerance);
+        system.deflatedSolver.setTolerance(this->inexactSolveTolerance);
+        system.pipelinedSolver.setTolerance(this->inexactSolveTolerance);
+        system.chebyshevSolver.setTolerance(this->inexactSolveTolerance);
+        system.mixedPrecisionSolver.setTolerance(this->inexactSolveTolerance);
+    }
+
+    if (this->useDeflation) {
+
+        return this->solveGlobalSystem(system.deflatedSolver, globalSystemVectors, guess);
+    }
+
+    else if (this->iterativeSolverType == FEATK_PIPELINED_CONJUGATE_GRADIENT) {
+
+        return this->solveGlobalSystem(system.pipelinedSolver, globalSystemVectors, guess);
+    }
+
+    else if (this->iterativeSolverType == FEATK_CHEBYSHEV_ITERATION) {
+
+        return this->solveGlobalSystem(system.chebyshevSolver, globalSystemVectors, guess);
+    }
+
+    else if (this->iterativeSolverType == FEATK_MIXED_PRECISION_CONJUGATE_GRADIENT) {
+
+        return this->solveGlobalSystem(system.mixedPrecisionSolver, globalSystemVectors, guess);
+    }
+
+    else {
+
+        return this->solveGlobalSystem(system.solver, globalSystemVectors, guess);
+    }
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::solveWithAdaptiveTimeStep(VectorXd& u) {
+
+    /* Step growth is limited to 2 to keep SBDF2 zero-stable. */
+
+    const double safety = 0.9;
+    const double minimumFactor = 0.2;
+    const double maximumFactor = 2.0;
+
+    featkTimeIntegrationScheme scheme = this->timeIntegrationScheme == FEATK_CNAB2 ? FEATK_CNAB2 : FEATK_SBDF2;
+
+    if (this->timeIntegrationScheme != scheme && this->timeIntegrationScheme != FEATK_SBDF1) {
+
+        cout << "featkDynamicSolverBase: Warning: Selected scheme has no embedded error estimate, SBDF2 used for adaptive time stepping." << endl;
+    }
+
+    featkSharedPatternOperator<double> systemOperator;
+    this->initializeSystemOperator(systemOperator);
+
+    featkSchemeSystem system1;
+    featkSchemeSystem system2;
+
+    std::vector<double> times = this->intermediateProcessTimes;
+    std::sort(times.begin(), times.end());
+    std::vector<double>::const_iterator nextTime = std::upper_bound(times.cbegin(), times.cend(), 0.0);
+
+    double endTime = this->getEndTime();
+    double dt = std::min(std::max(this->timeStep, this->minimumTimeStep), this->maximumTimeStep);
+    double dtPrevious = 0.0;
+    double errorPrevious = 1.0;
+
+    VectorXd fPrevious;
+    VectorXd uPrevious;
+
+    this->currentTime = 0.0;
+    this->numberOfAcceptedSteps = this->restoreCheckpoint({&system1, &system2});
+    this->numberOfRejectedSteps = 0;
+
+    if (this->restart) {
+
+        const featkCheckpoint& checkpoint = this->restartCheckpoint;
+
+        dt = checkpoint.timeStep;
+        dtPrevious = checkpoint.previousTimeStep;
+        errorPrevious = checkpoint.previousError;
+        fPrevious = checkpoint.fPrevious;
+        uPrevious = checkpoint.uPrevious;
+
+        this->currentTime = checkpoint.currentTime;
+        this->numberOfRejectedSteps = checkpoint.numberOfRejectedSteps;
+        nextTime = std::upper_bound(times.cbegin(), times.cend(), this->currentTime);
+    }
+
+    while (endTime-this->currentTime > 1.0e-12*endTime) {
+
+        double step = std::min(dt, endTime-this->currentTime);
+        bool process = false;
+
+        if (nextTime != times.cend() && *nextTime-this->currentTime <= step) {
+
+            step = *nextTime-this->currentTime;
+            process = true;
+        }
+
+        VectorXd f = this->getGlobalReactionVector(u);
+        VectorXd guess = this->useInexactSolves && this->numberOfAcceptedSteps != 0 ? this->getExtrapolatedGuess({&u, &uPrevious}, {dtPrevious}, step) : u;
+        VectorXd u1 = this->solveScheme(FEATK_SBDF1, step, 0.0, u, u, f, f, guess, systemOperator, system1);
+
+        VectorXd uNext;
+        double error = 0.0;
+
+        if (this->numberOfAcceptedSteps == 0) {
+
+            uNext = u1;
+        }
+
+        else {
+
+            VectorXd u2 = this->solveScheme(scheme, step, step/dtPrevious, u, uPrevious, f, fPrevious, u1, systemOperator, system2);
+            error = this->getErrorNorm(u2-u1, u, u2);
+
+            if (error > 1.0 && step > this->minimumTimeStep) {
+
+                dt = std::max(step*std::max(minimumFactor, safety*std::pow(error, -0.5)), this->minimumTimeStep);
+                this->numberOfRejectedSteps++;
+
+                cout << "featkDynamicSolverBase: Info: Step rejected (t = " << this->currentTime << ", dt = " << step << ", error: " << error << ")." << endl;
+
+                continue;
+            }
+
+            if (error > 1.0) {
+
+                cout << "featkDynamicSolverBase: Warning: Minimum time step reached, error tolerance not met." << endl;
+            }
+
+            uNext = u2;
+
+            if (this->useInexactSolves) {
+
+                this->updateInexactSolveTolerance(u1, u2);
+            }
+        }
+
+        uPrevious = u;
+        fPrevious = f;
+        dtPrevious = step;
+
+        u = uNext;
+        this->applyCutoff(u);
+
+        this->currentTime += step;
+        this->numberOfAcceptedSteps++;
+
+        cout << "featkDynamicSolverBase: Info: Step " << this->numberOfAcceptedSteps << " accepted (t = " << this->currentTime << ", dt = " << step << ", " << this->getSchemeSolverStatus(system1) << ", local error: " << error << ")." << endl;
+
+        if (process) {
+
+            this->intermediateProcess(u, this->numberOfAcceptedSteps-1);
+            ++nextTime;
+        }
+
+        if (this->isSteadyState(u, uPrevious, step)) {
+
+            break;
+        }
+
+
+        // PI step size controller, see E. Hairer, G. Wanner. Solving Ordinary Differential Equations II, p.124, 1996.
+
+        double factor = maximumFactor;
+
+        if (error > 0.0) {
+
+            factor = safety*std::pow(error, -0.7/2.0)*std::pow(errorPrevious, 0.4/2.0);
+            errorPrevious = std::max(error, 1.0e-4);
+        }
+
+        dt = std::min(std::max(step*std::min(std::max(factor, minimumFactor), maximumFactor), this->minimumTimeStep), this->maximumTimeStep);
+
+        if (this->isCheckpointIteration(this->numberOfAcceptedSteps)) {
+
+            featkCheckpoint checkpoint = this->getCheckpoint(this->numberOfAcceptedSteps, {&system1, &system2});
+            checkpoint.timeStep = dt;
+            checkpoint.previousTimeStep = dtPrevious;
+            checkpoint.previousError = errorPrevious;
+            checkpoint.u = u;
+            checkpoint.uPrevious = uPrevious;
+            checkpoint.fPrevious = fPrevious;
+            this->writeCheckpoint(checkpoint);
+        }
+    }
+
+    cout << "featkDynamicSolverBase: Info: " << this->numberOfAcceptedSteps << " steps accepted, " << this->numberOfRejectedSteps << " steps rejected." << endl;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::solveWithExplicitScheme(VectorXd& u) {
+
+    /**
+     * Shu-Osher form of the SSP Runge-Kutta schemes, each stage being v = a*u_n + (1-a)*(v + dt*L(v)):
+     *
+     *   Forward Euler: a = 0
+     *   SSPRK2: a = 0, 1/2
+     *   SSPRK3: a = 0, 3/4, 1/3
+     *
+     * See Gottlieb, Shu and Tadmor. 2001. Strong stability-preserving high-order time discretization methods.
+     * SIAM Rev. 43(1).
+     */
+
+    std::vector<double> stages;
+    double stabilityLimit;  // Stability interval on the negative real axis
+
+    switch (this->timeIntegrationScheme) {
+
+        case FEATK_SSPRK2:
+
+            stages = {0.0, 0.5};
+            stabilityLimit = 2.0;
+            break;
+
+        case FEATK_SSPRK3:
+
+            stages = {0.0, 0.75, 1.0/3.0};
+            stabilityLimit = 2.5;
+            break;
+
+        default:
+
+            stages = {0.0};
+            stabilityLimit = 2.0;
+            break;
+    }
+
+    if (this->essentialBoundaryConditions != nullptr) {
+
+        this->essentialBoundaryConditions->compile(this->numberOfDOFs);
+    }
+
+    VectorXd ml = this->getGlobalLumpedMassVector();
+
+    if ((ml.array() <= 0.0).any()) {
+
+        cout << "featkDynamicSolverBase: Warning: Lumped mass matrix is not positive, explicit scheme will be unstable." << endl;
+    }
+
+    VectorXd inverseLumpedMass = ml.cwiseInverse();
+    SparseMatrix<double, RowMajor> k = this->getGlobalStiffnessMatrix();
+
+    double lambda = this->getSpectralRadiusBound(ml);
+    double stableTimeStep = lambda > 0.0 ? 0.9*stabilityLimit/lambda : this->timeStep;
+    unsigned int numberOfSubsteps = std::max(1, static_cast<int>(std::ceil(this->timeStep/stableTimeStep)));
+    double step = this->timeStep/numberOfSubsteps;
+
+    cout << "featkDynamicSolverBase: Info: Stable time step is " << stableTimeStep << ", " << numberOfSubsteps << " substep(s) per iteration." << endl;
+
+    this->applyEBCToSolution(u, false);
+
+    for (unsigned int i=this->restoreCheckpoint({}); i<this->numberOfIterations; i++) {
+
+        VectorXd uPrevious = u;
+
+        for (unsigned int s=0; s!=numberOfSubsteps; s++) {
+
+            VectorXd v = u;
+
+            for (double a : stages) {
+
+                VectorXd rate = this->getExplicitRateVector(v, k, inverseLumpedMass);
+                Index size = v.size();
+
+                #pragma omp parallel for
+                for (Index j=0; j<size; j++) {
+
+                    v(j) = a*u(j) + (1.0-a)*(v(j) + step*rate(j));
+                }
+
+                this->applyEBCToSolution(v, false);
+            }
+
+            u = v;
+            this->applyCutoff(u);
+        }
+
+        this->currentTime = (i+1)*this->timeStep;
+
+        cout << "featkDynamicSolverBase: Info: Iteration " << i+1 << "/" << this->numberOfIterations << " solved (" << numberOfSubsteps << " substeps)." << endl;
+
+        if (find(this->intermediateProcessIterations.begin(), this->intermediateProcessIterations.end(), i) != this->intermediateProcessIterations.end()) {
+
+            this->intermediateProcess(u, i);
+        }
+
+        if (this->isSteadyState(u, uPrevious, this->timeStep)) {
+
+            break;
+        }
+
+        if (this->isCheckpointIteration(i+1)) {
+
+            featkCheckpoint checkpoint = this->getCheckpoint(i+1, {});
+            checkpoint.u = u;
+            this->writeCheckpoint(checkpoint);
+        }
+    }
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::solveWithFixedTimeStep(VectorXd& u) {
+
+    SparseMatrix<double> globalSystemMatrix = this->getGlobalSystemMatrix();
+    SparseMatrix<double> k = this->getEBCModifiedGlobalSystemMatrix(globalSystemMatrix);
+
+    cout << "featkDynamicSolverBase: Info: System matrix density is " << globalSystemMatrix.nonZeros() << "/" << this->numberOfDOFs*this->numberOfDOFs << "." << endl;
+
+    /*k.makeCompressed();
+
+    SimplicialLLT<SparseMatrix<double>> solver;
+    solver.compute(k);
+
+    if (solver.info() != Success) {
+
+        cout << "featkDynamicSolverBase: Warning: Global system matrix decomposition failed." << endl;
+    }*/
+
+    //BiCGSTAB<SparseMatrix<double, RowMajor>> solver;  // OpenMP parallelized only for RowMajor. BiCGSTAB is more general than CG and works for all kind of matrices.
+    featkSchemeSystem system;  // CG is only for symmetric positive definite matrices, a bit faster than BiCGSTAB in this case.
+    system.k = k;
+    this->computeSchemeSystemSolver(system);
+
+    VectorXd f = VectorXd(this->numberOfComponents*this->numberOfDOFs);
+    VectorXd uPrevious;
+    unsigned int first = this->restoreCheckpoint({&system});
+
+    if (this->restart) {
+
+        uPrevious = this->restartCheckpoint.uPrevious;
+    }
+
+    for (unsigned int i=first; i<this->numberOfIterations; i++) {
+
+        bool extrapolate = this->useInexactSolves && i != 0;
+        VectorXd guess = extrapolate ? this->getExtrapolatedGuess({&u, &uPrevious}, {this->timeStep}, this->timeStep) : u;
+        uPrevious = u;
+
+        f = this->getGlobalSystemVector(u);
+        this->applyEBCToGlobalSystemVectors(globalSystemMatrix, f);
+        u = this->solveSchemeSystem(system, f, guess);
+        //u = solver.solve(u).head(this->numberOfDOFs);
+
+        if (extrapolate) {
+
+            this->updateInexactSolveTolerance(guess, u);
+        }
+
+        this->applyCutoff(u);
+        this->currentTime = (i+1)*this->timeStep;
+
+        cout << "featkDynamicSolverBase: Info: Iteration " << i+1 << "/" << this->numberOfIterations << " solved (" << this->getSchemeSolverStatus(system) << ")." << endl;
+        //cout << "featkDynamicSolverBase: Info: Iteration " << i+1 << "/" << this->numberOfIterations << " solved." << endl;
+
+        if (find(this->intermediateProcessIterations.begin(), this->intermediateProcessIterations.end(), i) != this->intermediateProcessIterations.end()) {
+
+            this->intermediateProcess(u, i);
+        }
+
+        if (this->isSteadyState(u, uPrevious, this->timeStep)) {
+
+            break;
+        }
+
+        if (this->isCheckpointIteration(i+1)) {
+
+            featkCheckpoint checkpoint = this->getCheckpoint(i+1, {&system});
+            checkpoint.u = u;
+            checkpoint.uPrevious = uPrevious;
+            this->writeCheckpoint(checkpoint);
+        }
+    }
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::solveWithNewton(VectorXd& u) {
+
+    const SparseMatrix<double>* a = this->numberOfComponents == 1 ? this->getGlobalReactionJacobianMatrix() : nullptr;
+
+    featkSharedPatternOperator<double> systemOperator;
+    this->initializeSystemOperator(systemOperator, a);
+
+    SparseMatrix<double> j;  // Updated in place, so that the solver always sees the current Jacobian
+    featkCoupledJacobianPattern coupledPattern;
+    VectorXd scaling;
+    std::vector<const VectorXd*> scalings = {nullptr, nullptr, &scaling};
+
+    BiCGSTAB<SparseMatrix<double>, IncompleteLUT<double>> solver;
+    bool refresh = true;
+    Index referenceIterations = 0;
+
+    VectorXd zero = VectorXd::Zero(u.size());
+    this->applyEBCToSolution(u, false);
+
+    for (unsigned int i=this->restoreCheckpoint({}); i<this->numberOfIterations; i++) {
+
+        VectorXd uPrevious = u;
+        VectorXd g = this->getGlobalResidualVector(u, uPrevious, this->timeStep);
+
+        double g0 = g.norm();
+        double gNorm = g0;
+        unsigned int n = 0;
+
+        while (n != this->maximumNumberOfNewtonIterations && gNorm > this->newtonTolerance*g0 && gNorm > 0.0) {
+
+            bool coupled = this->numberOfComponents != 1 && this->formCoupledJacobianMatrix(u, systemOperator, coupledPattern, j);
+            refresh = refresh || (coupled && coupledPattern.rebuilt);  // New structure, the solver no longer refers to j
+
+            if (!coupled) {
+
+                if (a != nullptr) {
+
+                    scaling = this->getGlobalReactionJacobianScaling(u);
+                }
+
+                systemOperator.combine({1.0, this->timeStep, -this->timeStep}, scalings, j);
+            }
+
+            if (refresh) {
+
+                solver.compute(j);
+                referenceIterations = -1;
+                refresh = false;
+            }
+
+            VectorXd delta = coupled ? VectorXd(solver.solveWithGuess(-g, zero)) : this->solveGlobalSystem(solver, -g, zero);
+
+            if (referenceIterations < 0) {
+
+                referenceIterations = solver.iterations();
+            }
+
+            if (solver.info() != Success || solver.iterations() > 2*referenceIterations+5) {
+
+                refresh = true;  // Stale preconditioner, recomputed at next Newton iteration
+            }
+
+
+            // Backtracking line search on the residual norm
+
+            double lambda = 1.0;
+            VectorXd uTrial = u + delta;
+            VectorXd gTrial = this->getGlobalResidualVector(uTrial, uPrevious, this->timeStep);
+
+            for (unsigned int k=0; k!=10 && gTrial.norm() > (1.0-1.0e-4*lambda)*gNorm; k++) {
+
+                lambda *= 0.5;
+                uTrial = u + lambda*delta;
+                gTrial = this->getGlobalResidualVector(uTrial, uPrevious, this->timeStep);
+            }
+
+            u = uTrial;
+            g = gTrial;
+            gNorm = g.norm();
+            n++;
+        }
+
+        if (gNorm > this->newtonTolerance*g0 && gNorm > 0.0) {
+
+            cout << "featkDynamicSolverBase: Warning: Newton iterations did not converge (residual: " << gNorm/g0 << ")." << endl;
+        }
+
+        this->applyCutoff(u);
+        this->currentTime = (i+1)*this->timeStep;
+
+        cout << "featkDynamicSolverBase: Info: Iteration " << i+1 << "/" << this->numberOfIterations << " solved (" << n << " Newton iterations, " << solver.iterations() << " linear iterations)." << endl;
+
+        if (find(this->intermediateProcessIterations.begin(), this->intermediateProcessIterations.end(), i) != this->intermediateProcessIterations.end()) {
+
+            this->intermediateProcess(u, i);
+        }
+
+        if (this->isSteadyState(u, uPrevious, this->timeStep)) {
+
+            break;
+        }
+
+        if (this->isCheckpointIteration(i+1)) {
+
+            featkCheckpoint checkpoint = this->getCheckpoint(i+1, {});
+            checkpoint.u = u;
+            this->writeCheckpoint(checkpoint);
+        }
+    }
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::solveWithSecondOrderScheme(VectorXd& u) {
+
+    featkSharedPatternOperator<double> systemOperator;
+    this->initializeSystemOperator(systemOperator);
+
+    featkSchemeSystem system1;  // First step
+    featkSchemeSystem system2;
+
+    VectorXd fPrevious;
+    VectorXd uPrevious;
+    VectorXd uPrevious2;
+    unsigned int first = this->restoreCheckpoint({&system1, &system2});
+
+    if (this->restart) {
+
+        fPrevious = this->restartCheckpoint.fPrevious;
+        uPrevious = this->restartCheckpoint.uPrevious;
+        uPrevious2 = this->restartCheckpoint.uPrevious2;
+    }
+
+    for (unsigned int i=first; i<this->numberOfIterations; i++) {
+
+        VectorXd f = this->getGlobalReactionVector(u);
+        VectorXd uNext;
+
+        if (i == 0) {
+
+            uNext = this->solveScheme(FEATK_SBDF1, this->timeStep, 0.0, u, u, f, f, u, systemOperator, system1);
+        }
+
+        else {
+
+            bool quadratic = this->useInexactSolves && i > 1;
+            VectorXd guess = quadratic ? this->getExtrapolatedGuess({&u, &uPrevious, &uPrevious2}, {this->timeStep, this->timeStep}, this->timeStep) : 2.0*u-uPrevious;
+            uNext = this->solveScheme(this->timeIntegrationScheme, this->timeStep, 1.0, u, uPrevious, f, fPrevious, guess, systemOperator, system2);
+
+            if (this->useInexactSolves) {
+
+                this->updateInexactSolveTolerance(guess, uNext);
+            }
+        }
+
+        uPrevious2 = uPrevious;
+        uPrevious = u;
+        fPrevious = f;
+        u = uNext;
+
+        this->applyCutoff(u);
+        this->currentTime = (i+1)*this->timeStep;
+
+        const featkSchemeSystem& system = i == 0 ? system1 : system2;
+        cout << "featkDynamicSolverBase: Info: Iteration " << i+1 << "/" << this->numberOfIterations << " solved (" << this->getSchemeSolverStatus(system) << ")." << endl;
+
+        if (find(this->intermediateProcessIterations.begin(), this->intermediateProcessIterations.end(), i) != this->intermediateProcessIterations.end()) {
+
+            this->intermediateProcess(u, i);
+        }
+
+        if (this->isSteadyState(u, uPrevious, this->timeStep)) {
+
+            break;
+        }
+
+        if (this->isCheckpointIteration(i+1)) {
+
+            featkCheckpoint checkpoint = this->getCheckpoint(i+1, {&system1, &system2});
+            checkpoint.u = u;
+            checkpoint.uPrevious = uPrevious;
+            checkpoint.uPrevious2 = uPrevious2;
+            checkpoint.fPrevious = fPrevious;
+            this->writeCheckpoint(checkpoint);
+        }
+    }
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::solveWithSplitting(VectorXd& u) {
+
+    featkSharedPatternOperator<double> systemOperator;
+    this->initializeSystemOperator(systemOperator);
+
+    featkSchemeSystem system;  // Crank-Nicolson diffusion step on (M + dt/2*K), decomposed once
+    VectorXd zero = VectorXd::Zero(u.size());
+
+    for (unsigned int i=this->restoreCheckpoint({&system}); i<this->numberOfIterations; i++) {
+
+        VectorXd uPrevious = u;
+
+        this->solveReaction(u, 0.5*this->timeStep);
+        u = this->solveScheme(FEATK_CNAB2, this->timeStep, 0.0, u, u, zero, zero, u, systemOperator, system);
+        this->solveReaction(u, 0.5*this->timeStep);
+
+        this->currentTime = (i+1)*this->timeStep;
+
+        cout << "featkDynamicSolverBase: Info: Iteration " << i+1 << "/" << this->numberOfIterations << " solved (" << this->getSchemeSolverStatus(system) << ")." << endl;
+
+        if (find(this->intermediateProcessIterations.begin(), this->intermediateProcessIterations.end(), i) != this->intermediateProcessIterations.end()) {
+
+            this->intermediateProcess(u, i);
+        }
+
+        if (this->isSteadyState(u, uPrevious, this->timeStep)) {
+
+            break;
+        }
+
+        if (this->isCheckpointIteration(i+1)) {
+
+            featkCheckpoint checkpoint = this->getCheckpoint(i+1, {&system});
+            checkpoint.u = u;
+            this->writeCheckpoint(checkpoint);
+        }
+    }
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::storeIntermediateResult(std::string name, unsigned int iteration, const VectorXd& values) {
+
+    if (this->timeSeriesWriter != nullptr) {
+
+        this->timeSeriesWriter->write(name, this->currentTime, values);
+    }
+
+    else if (this->useTimeSeriesAttributes) {
+
+        featkTimeSeriesAttribute*& attribute = this->timeSeriesAttributes[name];
+
+        if (attribute == nullptr) {
+
+            // First result of the solve: the time series of an interrupted run is kept up to the restart time, any other
+            // previous time series is replaced. Sized for all the expected results.
+
+            attribute = this->getNodeTimeSeriesAttribute(name);
+
+            if (this->restart && attribute != nullptr && attribute->getNumberOfComponents() == 1 && attribute->getPrecision() == this->timeSeriesPrecision) {
+
+                const std::vector<double>& times = attribute->getTimes();
+                attribute->truncate(std::upper_bound(times.begin(), times.end(), this->restartCheckpoint.currentTime)-times.begin());
+            }
+
+            else {
+
+                attribute = this->setNodeTimeSeriesAttribute(name, 0, this->timeSeriesPrecision);
+            }
+
+            attribute->reserve(attribute->getNumberOfTimeSteps() + (this->useAdaptiveTimeStep ? this->intermediateProcessTimes.size() : this->intermediateProcessIterations.size()));
+        }
+
+        attribute->append(this->currentTime, values);
+    }
+
+    else {
+
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision(2) << (this->useAdaptiveTimeStep ? this->currentTime : iteration*this->timeStep);
+
+        this->setNodeAttributeFromValues(name + " (" + stream.str() + ")", 0, values);
+    }
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::updateInexactSolveTolerance(const VectorXd& guess, const VectorXd& u) {
+
+    /* The difference between the extrapolated predictor and the solution estimates the local truncation error. The
+     * relative residual tolerance of the next solve is set to a fraction of its relative size. */
+
+    double norm = u.norm();
+
+    if (norm > 0.0) {
+
+        this->inexactSolveTolerance = std::min(std::max(this->inexactSolveFactor*(u-guess).norm()/norm, NumTraits<double>::epsilon()), 1.0e-3);
+    }
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkDynamicSolverBase<Dimension, Order>::writeCheckpoint(featkCheckpoint& checkpoint) {
+
+    cout << "featkDynamicSolverBase: Info: Writing checkpoint at t = " << checkpoint.currentTime << "." << endl;
+
+    this->checkpointWriter.write(std::move(checkpoint), this->checkpointFileName);
 }
 
 #endif // FEATKDYNAMICSOLVERBASE_H
@@ -30,6 +30,10 @@
  * conditions. See Eigen::SparseMatrix::prune() member function for more
  * info.
  *
+ * Fixed degrees of freedom are given as a dense mask over all degrees of
+ * freedom (see featkBoundaryConditions::compile()) so that each test is a
+ * constant time lookup instead of a std::set search.
+ *
  * @tparam ScalarType The scalar type of the Eigen::SparseMatrix.
  *
  */
@@ -37,33 +41,32 @@
 #ifndef FEATKGLOBALSYSTEMMATRIXPRUNER_H
 #define FEATKGLOBALSYSTEMMATRIXPRUNER_H
 
-#include <set>
+#include <vector>
 
 template<typename ScalarType>
 class featkGlobalSystemMatrixPruner {
 
     public:
 
-        featkGlobalSystemMatrixPruner(std::set<size_t> dofs);
+        featkGlobalSystemMatrixPruner(const std::vector<bool>& mask);
         ~featkGlobalSystemMatrixPruner();
 
         bool operator() (const Index& row, const Index& col, const ScalarType& value) const;
 
     private:
 
-        std::set<size_t> dofs;
+        std::vector<bool> mask;
 };
 
 template<typename ScalarType>
-featkGlobalSystemMatrixPruner<ScalarType>::featkGlobalSystemMatrixPruner(std::set<size_t> dofs) {
+featkGlobalSystemMatrixPruner<ScalarType>::featkGlobalSystemMatrixPruner(const std::vector<bool>& mask) {
 
-    this->dofs = dofs;
+    this->mask = mask;
 }
 
 template<typename ScalarType>
 featkGlobalSystemMatrixPruner<ScalarType>::~featkGlobalSystemMatrixPruner() {
 
-    this->dofs = dofs;
 }
 
 template<typename ScalarType>
@@ -71,7 +74,7 @@ bool featkGlobalSystemMatrixPruner<ScalarType>::operator() (const Index& row, co
 
     /* Keep diagonal elements and elements whose neither i or j index is a BC fixed dof */
 
-    return (row == col || (this->dofs.count(row) == 0 && this->dofs.count(col) == 0));
+    return (row == col || (!this->mask[row] && !this->mask[col]));
 }
 
 #endif // FEATKGLOBALSYSTEMMATRIXPRUNER_H
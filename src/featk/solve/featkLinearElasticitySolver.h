@@ -27,6 +27,13 @@
  * featkLinearElasticitySolver is a static finite element solver for linear
  * elasticity problems in Dimension dimensions.
  *
+ * Load cases added with addLoadCase() are solved together on the same
+ * global stiffness matrix, each with its own natural boundary conditions and
+ * body force attribute. Each case writes its displacements, stress tensors
+ * and Von Mises stresses to attributes prefixed by its output name, and the
+ * mesh nodes are left in place. Without load cases, the solver behaves as a
+ * single case solver and moves the nodes by the computed displacements.
+ *
  * @tparam Dimension The cartesian dimension of the problem.
  *
  */
@@ -44,11 +51,27 @@ class featkLinearElasticitySolver : public featkStaticSolverBase<Dimension, 1> {
         featkLinearElasticitySolver();
         ~featkLinearElasticitySolver();
 
+        void addLoadCase(featkBoundaryConditions<Dimension, 1>* naturalConditions, std::string bodyForceAttributeName, std::string outputAttributeName);
+        void clearLoadCases();
+
     protected:
 
+        struct featkLoadCase {
+
+            featkBoundaryConditions<Dimension, 1>* naturalBoundaryConditions;
+            std::string bodyForceAttributeName;  // Empty for no body force
+            std::string outputAttributeName;
+        };
+
+        void computeVonMisesStresses(std::string stressAttributeName, std::string outputAttributeName);
         SparseMatrix<double> getGlobalSystemMatrix();
         VectorXd getGlobalSystemVector();
+        VectorXd getLoadCaseGlobalSystemVector(size_t loadCase);
+        size_t getNumberOfLoadCases();
         void postProcess(const VectorXd& u);
+        void postProcessLoadCase(const VectorXd& u, size_t loadCase);
+
+        std::vector<featkLoadCase> loadCases;
 
         std::string bodyForceAttributeName;  // Check if attributes are valid and assign their IDs to vars
         std::string outputAttributeName;
@@ -68,6 +91,35 @@ featkLinearElasticitySolver<Dimension>::~featkLinearElasticitySolver() {
 
 }
 
+template<unsigned int Dimension>
+void featkLinearElasticitySolver<Dimension>::addLoadCase(featkBoundaryConditions<Dimension, 1>* naturalConditions, std::string bodyForceAttributeName, std::string outputAttributeName) {
+
+    this->loadCases.push_back({naturalConditions, bodyForceAttributeName, outputAttributeName});
+}
+
+template<unsigned int Dimension>
+void featkLinearElasticitySolver<Dimension>::clearLoadCases() {
+
+    this->loadCases.clear();
+}
+
+template<unsigned int Dimension>
+void featkLinearElasticitySolver<Dimension>::computeVonMisesStresses(std::string stressAttributeName, std::string outputAttributeName) {
+
+    std::vector<featkNode<3>*> nodes = this->mesh->getNodes();
+    MatrixXd values(nodes.size(), 1);
+
+    size_t id = this->mesh->getNodeAttributeID(stressAttributeName, 2);
+
+    for (size_t n=0; n!=nodes.size(); n++) {
+
+        MatrixXd s = nodes[n]->getAttributeValue(id);
+        values(n, 0) = sqrt(0.5*((s(0,0)-s(1,1))*(s(0,0)-s(1,1)) + (s(1,1)-s(2,2))*(s(1,1)-s(2,2)) + (s(2,2)-s(0,0))*(s(2,2)-s(0,0))) + 3.0*(s(0,1)*s(1,0) + s(1,2)*s(2,1) + s(2,0)*s(0,2)));
+    }
+
+    this->mesh->setNodeAttributeFromValues(outputAttributeName, 0, values);
+}
+
 template<unsigned int Dimension>
 SparseMatrix<double> featkLinearElasticitySolver<Dimension>::getGlobalSystemMatrix() {
 
@@ -84,25 +136,56 @@ VectorXd featkLinearElasticitySolver<Dimension>::getGlobalSystemVector() {
     return fb+fs;
 }
 
+template<unsigned int Dimension>
+VectorXd featkLinearElasticitySolver<Dimension>::getLoadCaseGlobalSystemVector(size_t loadCase) {
+
+    if (this->loadCases.empty()) {
+
+        return this->getGlobalSystemVector();
+    }
+
+    const featkLoadCase& c = this->loadCases[loadCase];
+    VectorXd f = this->getGlobalVectorFromNBCs(c.naturalBoundaryConditions);
+
+    if (!c.bodyForceAttributeName.empty()) {
+
+        f += this->getGlobalVectorFromElements(&featkLinearElasticitySolver<Dimension>::getElementNtNQIntegralVector, {this->mesh->getNodeAttributeID(c.bodyForceAttributeName, 1)});
+    }
+
+    return f;
+}
+
+template<unsigned int Dimension>
+size_t featkLinearElasticitySolver<Dimension>::getNumberOfLoadCases() {
+
+    return this->loadCases.empty() ? 1 : this->loadCases.size();
+}
+
 template<unsigned int Dimension>
 void featkLinearElasticitySolver<Dimension>::postProcess(const VectorXd& u) {
 
     this->mesh->setNodeAttributeFromValues(this->outputAttributeName, 1, u);
     this->mesh->computeNodeCBQ<1>(this->stiffnessAttributeName, this->outputAttributeName, "Stress Tensor");  // Compute this before moving nodes!
     this->mesh->addNodeAttributeFromValues("Cartesian Coordinates", 1, u);
+    this->computeVonMisesStresses("Stress Tensor", "Von Mises Stresses");
+}
 
-    std::vector<featkNode<3>*> nodes = this->mesh->getNodes();
-    MatrixXd values(nodes.size(), 1);
-
-    size_t id = this->mesh->getNodeAttributeID("Stress Tensor", 2);
+template<unsigned int Dimension>
+void featkLinearElasticitySolver<Dimension>::postProcessLoadCase(const VectorXd& u, size_t loadCase) {
 
-    for (size_t n=0; n!=nodes.size(); n++) {
+    if (this->loadCases.empty()) {
 
-        MatrixXd s = nodes[n]->getAttributeValue(id);
-        values(n, 0) = sqrt(0.5*((s(0,0)-s(1,1))*(s(0,0)-s(1,1)) + (s(1,1)-s(2,2))*(s(1,1)-s(2,2)) + (s(2,2)-s(0,0))*(s(2,2)-s(0,0))) + 3.0*(s(0,1)*s(1,0) + s(1,2)*s(2,1) + s(2,0)*s(0,2)));
+        this->postProcess(u);
+        return;
     }
 
-    this->mesh->setNodeAttributeFromValues("Von Mises Stresses", 0, values);
+    /* Nodes are not moved so that all load cases are post-processed on the reference geometry */
+
+    const std::string& name = this->loadCases[loadCase].outputAttributeName;
+
+    this->mesh->setNodeAttributeFromValues(name, 1, u);
+    this->mesh->computeNodeCBQ<1>(this->stiffnessAttributeName, name, name + " Stress Tensor");
+    this->computeVonMisesStresses(name + " Stress Tensor", name + " Von Mises Stresses");
 }
 
 #endif // FEATKLINEARELASTICITYSOLVER_H
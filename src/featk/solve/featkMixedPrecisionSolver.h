@@ -0,0 +1,285 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkMixedPrecisionSolver.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkMixedPrecisionSolver
+ *
+ * @brief Double precision iterative refinement around a single precision
+ * iterative solver.
+ *
+ * featkMixedPrecisionSolver solves double precision systems \f$Ax=b\f$
+ * with an inner iterative solver working on a single precision copy of
+ * \f$A\f$, so that the memory traffic of the sparse matrix-vector products
+ * and of the preconditioner applications, which bound the performance of
+ * the inner iterations, is roughly halved.
+ *
+ * Each refinement step computes the residual \f$r=b-Ax\f$ in double
+ * precision, solves \f$A\delta=r\f$ in single precision up to the relative
+ * tolerance set by setInnerTolerance() and updates \f$x\leftarrow
+ * x+\delta\f$ in double precision. The refinement stops when the double
+ * precision residual meets the tolerance, so that the final accuracy is
+ * that of a double precision solve, or when a step fails to halve the
+ * residual. The latter is reported as a success if the backward error is
+ * at the double precision level (tolerances below the attainable accuracy,
+ * e.g. the default machine epsilon) and as NoConvergence otherwise, e.g.
+ * for systems too ill-conditioned for single precision
+ * (\f$\kappa(A)\gtrsim10^6\f$).
+ *
+ * The double precision matrix passed to compute() is referenced, not
+ * copied, and must outlive the solver. The interface mimics the one of
+ * Eigen::ConjugateGradient for the functions used by featkStaticSolverBase
+ * and featkDynamicSolverBase, iterations() returning the total number of
+ * inner iterations.
+ *
+ * @tparam InnerSolverType The single precision iterative solver, e.g.
+ * Eigen::ConjugateGradient<SparseMatrix<float>, Lower|Upper>. Solvers whose
+ * attainable accuracy is degraded by rounding errors, such as
+ * featkPipelinedConjugateGradient, are poor inner solvers in single
+ * precision.
+ *
+ */
+
+#ifndef FEATKMIXEDPRECISIONSOLVER_H
+#define FEATKMIXEDPRECISIONSOLVER_H
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <algorithm>
+
+using namespace Eigen;
+
+template<typename InnerSolverType>
+class featkMixedPrecisionSolver {
+
+    public:
+
+        featkMixedPrecisionSolver();
+        ~featkMixedPrecisionSolver();
+
+        void compute(const SparseMatrix<double>& matrix);
+        double error() const;
+        double getInnerTolerance() const;
+        unsigned int getNumberOfRefinements() const;
+        ComputationInfo info() const;
+        Index iterations() const;
+        void setInnerTolerance(double tolerance);
+        void setMaxIterations(Index iterations);
+        void setTolerance(double tolerance);
+        MatrixXd solve(const MatrixXd& b) const;
+        MatrixXd solveWithGuess(const MatrixXd& b, const MatrixXd& guess) const;
+
+    private:
+
+        void solveColumn(const VectorXd& b, VectorXd& x) const;
+
+        const SparseMatrix<double>* matrix;
+        double matrixNorm;
+        SparseMatrix<float> singleMatrix;  // Referenced by Eigen's inner solvers
+        mutable InnerSolverType innerSolver;
+
+        double innerTolerance;
+        double tolerance;
+        Index maxIterations;
+        mutable Index lastIterations;
+        mutable unsigned int lastRefinements;
+        mutable double lastError;
+        mutable ComputationInfo lastInfo;
+};
+
+template<typename InnerSolverType>
+featkMixedPrecisionSolver<InnerSolverType>::featkMixedPrecisionSolver() {
+
+    this->matrix = nullptr;
+    this->matrixNorm = 0.0;
+
+    this->innerTolerance = 1.0e-3;
+    this->tolerance = NumTraits<double>::epsilon();
+    this->maxIterations = -1;
+    this->lastIterations = 0;
+    this->lastRefinements = 0;
+    this->lastError = 0.0;
+    this->lastInfo = Success;
+}
+
+template<typename InnerSolverType>
+featkMixedPrecisionSolver<InnerSolverType>::~featkMixedPrecisionSolver() {
+
+}
+
+template<typename InnerSolverType>
+void featkMixedPrecisionSolver<InnerSolverType>::compute(const SparseMatrix<double>& matrix) {
+
+    this->matrix = &matrix;
+    this->matrixNorm = matrix.norm();  // Frobenius norm, bounds the spectral norm
+    this->singleMatrix = matrix.template cast<float>();
+    this->innerSolver.compute(this->singleMatrix);
+}
+
+template<typename InnerSolverType>
+double featkMixedPrecisionSolver<InnerSolverType>::error() const {
+
+    return this->lastError;
+}
+
+template<typename InnerSolverType>
+double featkMixedPrecisionSolver<InnerSolverType>::getInnerTolerance() const {
+
+    return this->innerTolerance;
+}
+
+template<typename InnerSolverType>
+unsigned int featkMixedPrecisionSolver<InnerSolverType>::getNumberOfRefinements() const {
+
+    return this->lastRefinements;
+}
+
+template<typename InnerSolverType>
+ComputationInfo featkMixedPrecisionSolver<InnerSolverType>::info() const {
+
+    return this->lastInfo;
+}
+
+template<typename InnerSolverType>
+Index featkMixedPrecisionSolver<InnerSolverType>::iterations() const {
+
+    return this->lastIterations;
+}
+
+template<typename InnerSolverType>
+void featkMixedPrecisionSolver<InnerSolverType>::setInnerTolerance(double tolerance) {
+
+    this->innerTolerance = tolerance;
+}
+
+template<typename InnerSolverType>
+void featkMixedPrecisionSolver<InnerSolverType>::setMaxIterations(Index iterations) {
+
+    this->maxIterations = iterations;
+}
+
+template<typename InnerSolverType>
+void featkMixedPrecisionSolver<InnerSolverType>::setTolerance(double tolerance) {
+
+    this->tolerance = tolerance;
+}
+
+template<typename InnerSolverType>
+MatrixXd featkMixedPrecisionSolver<InnerSolverType>::solve(const MatrixXd& b) const {
+
+    return this->solveWithGuess(b, MatrixXd::Zero(b.rows(), b.cols()));
+}
+
+template<typename InnerSolverType>
+MatrixXd featkMixedPrecisionSolver<InnerSolverType>::solveWithGuess(const MatrixXd& b, const MatrixXd& guess) const {
+
+    /* Iterations and refinements are summed over the columns, the error is that of the worst column */
+
+    MatrixXd x = guess;
+    Index iterations = 0;
+    unsigned int refinements = 0;
+    double error = 0.0;
+    ComputationInfo info = Success;
+
+    for (Index j=0; j!=b.cols(); j++) {
+
+        VectorXd xj = x.col(j);
+        this->solveColumn(b.col(j), xj);
+        x.col(j) = xj;
+
+        iterations += this->lastIterations;
+        refinements += this->lastRefinements;
+        error = std::max(error, this->lastError);
+
+        if (this->lastInfo != Success) {
+
+            info = this->lastInfo;
+        }
+    }
+
+    this->lastIterations = iterations;
+    this->lastRefinements = refinements;
+    this->lastError = error;
+    this->lastInfo = info;
+
+    return x;
+}
+
+template<typename InnerSolverType>
+void featkMixedPrecisionSolver<InnerSolverType>::solveColumn(const VectorXd& b, VectorXd& x) const {
+
+    const SparseMatrix<double>& a = *this->matrix;
+    Index maxIterations = this->maxIterations < 0 ? 2*a.cols() : this->maxIterations;
+    double bNorm = b.norm();
+
+    this->lastIterations = 0;
+    this->lastRefinements = 0;
+
+    if (bNorm == 0.0) {
+
+        x.setZero();
+        this->lastError = 0.0;
+        this->lastInfo = Success;
+        return;
+    }
+
+    double threshold = this->tolerance*bNorm;
+    bool converged = false;
+    VectorXd r = b - a*x;
+    double rNorm = r.norm();
+
+    while (rNorm > threshold && this->lastIterations < maxIterations) {
+
+        // Inner tolerance relative to the current residual, loosened on the last step so as not to oversolve
+
+        this->innerSolver.setTolerance(float(std::max(this->innerTolerance, 0.5*threshold/rNorm)));
+        this->innerSolver.setMaxIterations(maxIterations-this->lastIterations);
+
+        VectorXf rSingle = (r/rNorm).cast<float>();  // Scaled to avoid single precision underflows
+        VectorXf delta = this->innerSolver.solve(rSingle);
+
+        this->lastIterations += std::max<Index>(this->innerSolver.iterations(), 1);
+        this->lastRefinements++;
+
+        VectorXd xNew = x + rNorm*delta.cast<double>();
+        VectorXd rNew = b - a*xNew;
+        double rNormNew = rNew.norm();
+
+        if (rNormNew < rNorm) {
+
+            x = xNew;
+            r = rNew;
+        }
+
+        if (!(rNormNew < 0.5*rNorm)) {
+
+            rNorm = std::min(rNorm, rNormNew);
+            converged = rNorm <= 10.0*NumTraits<double>::epsilon()*std::sqrt(double(a.rows()))*(this->matrixNorm*x.norm()+bNorm);
+            break;  // Stagnation, converged only if the backward error is at the double precision level
+        }
+
+        rNorm = rNormNew;
+    }
+
+    this->lastError = rNorm/bNorm;
+    this->lastInfo = rNorm <= threshold || converged ? Success : NoConvergence;
+}
+
+#endif // FEATKMIXEDPRECISIONSOLVER_H
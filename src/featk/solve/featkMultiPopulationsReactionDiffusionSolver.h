@@ -0,0 +1,370 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkMultiPopulationsReactionDiffusionSolver.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkMultiPopulationsReactionDiffusionSolver
+ *
+ * @brief Dynamic finite element solver for reaction-diffusion problems
+ * involving several competing populations in Dimension dimensions.
+ *
+ * featkMultiPopulationsReactionDiffusionSolver solves, for each population
+ * \f$i\f$ among \f$P\f$,
+ *
+ * \f[
+ *
+ * \frac{\partial u_i(\bar{r}, t)}{\partial t} = \bar{\nabla} \cdot \left( d_i \bar{\bar{D}}(\bar{r}) \bar{\nabla} T(\bar{r}, t) \right) + p_i \rho(\bar{r}) u_i(\bar{r}, t) \left( 1-T(\bar{r}, t) \right)
+ *
+ * \f]
+ *
+ * where \f$T = \sum_{j=1}^P u_j\f$ is the total cell density and \f$d_i\f$
+ * and \f$p_i\f$ are the diffusion and proliferation factors of population
+ * \f$i\f$. The populations are coupled through \f$T\f$ only, hence all
+ * terms are treated explicitly and the populations share the mass matrix
+ * as system matrix. They are stored as the columns of a
+ * numberOfDOFs x P block whose columns are the right-hand sides of that
+ * system (see featkDynamicSolverBase), and their reaction vectors are
+ * evaluated with one sparse matrix-block product per global matrix.
+ *
+ * @tparam Dimension The cartesian dimension of the problem.
+ *
+ */
+
+#ifndef FEATKMULTIPOPULATIONSREACTIONDIFFUSIONSOLVER_H
+#define FEATKMULTIPOPULATIONSREACTIONDIFFUSIONSOLVER_H
+
+#include <featk/solve/featkDynamicSolverBase.h>
+#include <featk/solve/featkQuadraticReactionKernel.h>
+
+template<unsigned int Dimension>
+class featkMultiPopulationsReactionDiffusionSolver : public featkDynamicSolverBase<Dimension, 0> {
+
+    public:
+
+        featkMultiPopulationsReactionDiffusionSolver();
+        virtual ~featkMultiPopulationsReactionDiffusionSolver();
+
+        void setDiffusionElementAttributeName(std::string name);
+        void setDiffusionFactors(std::vector<double> factors);
+        void setInputNodeAttributeNames(std::vector<std::string> names);
+        void setOutputNodeAttributeNames(std::vector<std::string> names);
+        void setProliferationFactors(std::vector<double> factors);
+        void setReactionElementAttributeName(std::string name);
+        void setTotalOutputNodeAttributeName(std::string name);
+        void setUseSpeedHack(bool use);
+
+    protected:
+
+        const SparseMatrix<double>& getGlobalMassMatrix();
+        const SparseMatrix<double>& getGlobalStiffnessMatrix();
+        const VectorXd& getGlobalReactionVector(const VectorXd& u);
+        SparseMatrix<double> getGlobalCoupledReactionJacobianMatrix(const VectorXd& u);
+        VectorXd getGlobalInitialVector();
+        double getSpectralRadiusBound(const VectorXd& lumpedMass);
+        void initialize();
+        void intermediateProcess(const VectorXd& u, unsigned int iteration);
+        void postProcess(const VectorXd& u);
+
+        std::string diffusionElementAttributeName;  // Check if attributes are valid and assign their IDs to vars
+        std::vector<std::string> inputNodeAttributeNames;
+        std::vector<std::string> outputNodeAttributeNames;
+        std::string reactionElementAttributeName;
+        std::string totalOutputNodeAttributeName;
+        bool useSpeedHack;
+
+        std::vector<double> diffusionFactors;
+        std::vector<double> proliferationFactors;
+
+        SparseMatrix<double> m;
+        SparseMatrix<double> d;
+        SparseMatrix<double> k;  // Diffusion depends on the total density and is treated explicitly
+        SparseMatrix<double> r;
+
+        featkQuadraticReactionKernel<Dimension> reactionKernel;
+        VectorXd rut;
+        VectorXd f;  // Reaction vector, reused across time steps
+};
+
+template<unsigned int Dimension>
+featkMultiPopulationsReactionDiffusionSolver<Dimension>::featkMultiPopulationsReactionDiffusionSolver() {
+
+    this->diffusionElementAttributeName = "Diffusion Tensor";
+    this->inputNodeAttributeNames = {"Initial Cell Density"};
+    this->outputNodeAttributeNames = {"Final Cell Density"};
+    this->reactionElementAttributeName = "Proliferation Rate";
+    this->totalOutputNodeAttributeName = "Final Cell Density Tot";
+    this->useSpeedHack = true;
+
+    this->diffusionFactors = {1.0};
+    this->proliferationFactors = {1.0};
+
+    this->cacheableElementMatrixGetters[&featkMultiPopulationsReactionDiffusionSolver<Dimension>::getElementNtCNIntegralMatrix] = true;  // Linear in the proliferation rate
+}
+
+template<unsigned int Dimension>
+featkMultiPopulationsReactionDiffusionSolver<Dimension>::~featkMultiPopulationsReactionDiffusionSolver() {
+
+}
+
+template<unsigned int Dimension>
+SparseMatrix<double> featkMultiPopulationsReactionDiffusionSolver<Dimension>::getGlobalCoupledReactionJacobianMatrix(const VectorXd& u) {
+
+    /**
+     * d/du_j p_i*R(u_i*(1-T)) - d_i*D*T = p_i*R*diag(delta_ij*(1-T)-u_i) - d_i*D for each block (i, j). Also used, as
+     * an approximation, for the consistent reaction term.
+     */
+
+    Map<const MatrixXd> us(u.data(), this->numberOfDOFs, this->numberOfComponents);
+    VectorXd t = us.rowwise().sum();
+
+    std::vector<Triplet<double>> triplets;
+    triplets.reserve(this->numberOfComponents*this->numberOfComponents*(this->r.nonZeros()+this->d.nonZeros()));
+
+    for (unsigned int i=0; i!=this->numberOfComponents; i++) {
+
+        for (unsigned int j=0; j!=this->numberOfComponents; j++) {
+
+            Index rowOffset = i*this->numberOfDOFs;
+            Index colOffset = j*this->numberOfDOFs;
+
+            for (Index k=0; k!=this->r.outerSize(); k++) {
+
+                for (SparseMatrix<double>::InnerIterator it(this->r, k); it; ++it) {
+
+                    double scaling = (i == j ? 1.0-t(it.col()) : 0.0) - us(it.col(), i);
+                    triplets.push_back(Triplet<double>(rowOffset+it.row(), colOffset+it.col(), this->proliferationFactors[i]*it.value()*scaling));
+                }
+            }
+
+            for (Index k=0; k!=this->d.outerSize(); k++) {
+
+                for (SparseMatrix<double>::InnerIterator it(this->d, k); it; ++it) {
+
+                    triplets.push_back(Triplet<double>(rowOffset+it.row(), colOffset+it.col(), -this->diffusionFactors[i]*it.value()));
+                }
+            }
+        }
+    }
+
+    SparseMatrix<double> jacobian(u.size(), u.size());
+    jacobian.setFromTriplets(triplets.begin(), triplets.end());
+
+    return jacobian;
+}
+
+template<unsigned int Dimension>
+VectorXd featkMultiPopulationsReactionDiffusionSolver<Dimension>::getGlobalInitialVector() {
+
+    VectorXd u = VectorXd(this->numberOfComponents*this->numberOfDOFs);
+
+    for (unsigned int i=0; i!=this->numberOfComponents; i++) {
+
+        u.segment(i*this->numberOfDOFs, this->numberOfDOFs) = this->getNodeAttributeValues(this->inputNodeAttributeNames[i], 0);
+    }
+
+    return u;
+}
+
+template<unsigned int Dimension>
+const SparseMatrix<double>& featkMultiPopulationsReactionDiffusionSolver<Dimension>::getGlobalMassMatrix() {
+
+    return this->m;
+}
+
+template<unsigned int Dimension>
+const VectorXd& featkMultiPopulationsReactionDiffusionSolver<Dimension>::getGlobalReactionVector(const VectorXd &u) {
+
+    /*
+        The last term of the equation should be integral(Nt(NU)(NT)) instead of integral(NtN)*(U*T) = M(U*T).
+        See Mocenni et al. 2011. for handling of polynomial reaction terms in FEM.
+    */
+
+    Map<const MatrixXd> us(u.data(), this->numberOfDOFs, this->numberOfComponents);
+    Map<const VectorXd> df(this->diffusionFactors.data(), this->numberOfComponents);
+    Map<const VectorXd> pf(this->proliferationFactors.data(), this->numberOfComponents);
+
+    VectorXd t = us.rowwise().sum();
+    this->f.resize(u.size());
+    Map<MatrixXd> fs(this->f.data(), this->numberOfDOFs, this->numberOfComponents);
+
+    if (this->useSpeedHack) {
+
+        fs = this->r*(us.array().colwise()*(1.0-t.array())).matrix();
+    }
+
+    else {
+
+        fs = this->r*us;
+
+        for (unsigned int i=0; i!=this->numberOfComponents; i++) {
+
+            this->reactionKernel.getNtCNQNPIntegralVector(us.col(i), t, this->rut);
+            fs.col(i) -= this->rut;
+        }
+    }
+
+    fs = fs*pf.asDiagonal();
+    fs -= (this->d*t)*df.transpose();
+
+    return this->f;
+}
+
+template<unsigned int Dimension>
+const SparseMatrix<double>& featkMultiPopulationsReactionDiffusionSolver<Dimension>::getGlobalStiffnessMatrix() {
+
+    return this->k;
+}
+
+template<unsigned int Dimension>
+double featkMultiPopulationsReactionDiffusionSolver<Dimension>::getSpectralRadiusBound(const VectorXd& lumpedMass) {
+
+    /**
+     * Diffusion couples the populations through the total density, i.e. the block operator (df*1^T) x D whose
+     * spectral radius is sum(df) times the one of D. The reaction Jacobian rows are bounded by 2*pf_i*R for
+     * densities in [0, 1].
+     */
+
+    Map<const VectorXd> df(this->diffusionFactors.data(), this->diffusionFactors.size());
+    Map<const VectorXd> pf(this->proliferationFactors.data(), this->proliferationFactors.size());
+
+    return df.cwiseAbs().sum()*this->getGershgorinBound(this->d, lumpedMass) + 2.0*pf.cwiseAbs().maxCoeff()*this->getGershgorinBound(this->r, lumpedMass);
+}
+
+template<unsigned int Dimension>
+void featkMultiPopulationsReactionDiffusionSolver<Dimension>::initialize() {
+
+    this->numberOfComponents = this->inputNodeAttributeNames.size();
+
+    if (this->outputNodeAttributeNames.size() != this->numberOfComponents || this->diffusionFactors.size() != this->numberOfComponents || this->proliferationFactors.size() != this->numberOfComponents) {
+
+        cout << "featkMultiPopulationsReactionDiffusionSolver: Warning: Inconsistent number of populations, missing names and factors set to defaults." << endl;
+
+        for (size_t i=this->outputNodeAttributeNames.size(); i<this->numberOfComponents; i++) {
+
+            this->outputNodeAttributeNames.push_back(this->inputNodeAttributeNames[i] + " (Final)");
+        }
+
+        this->diffusionFactors.resize(this->numberOfComponents, 1.0);
+        this->proliferationFactors.resize(this->numberOfComponents, 1.0);
+    }
+
+    this->m = this->getGlobalMatrixFromElements(&featkMultiPopulationsReactionDiffusionSolver<Dimension>::getElementNtNIntegralMatrix, {});
+    cout << "featkMultiPopulationsReactionDiffusionSolver: Info: M matrix assembled." << endl;
+    this->d = this->getGlobalMatrixFromElements(&featkMultiPopulationsReactionDiffusionSolver<Dimension>::getElementBtCBIntegralMatrix, {this->getElementAttributeID(this->diffusionElementAttributeName, 2)});
+    cout << "featkMultiPopulationsReactionDiffusionSolver: Info: D matrix assembled." << endl;
+    this->r = this->getGlobalMatrixFromElements(&featkMultiPopulationsReactionDiffusionSolver<Dimension>::getElementNtCNIntegralMatrix, {this->getElementAttributeID(this->reactionElementAttributeName, 0)});
+    cout << "featkMultiPopulationsReactionDiffusionSolver: Info: R matrix assembled." << endl;
+
+    this->k = SparseMatrix<double>(this->numberOfDOFs, this->numberOfDOFs);
+
+    if (!this->useSpeedHack) {
+
+        if (this->grid != nullptr) {
+
+            this->reactionKernel.compute(this->grid, this->getElementAttributeID(this->reactionElementAttributeName, 0));
+        }
+
+        else {
+
+            this->reactionKernel.compute(this->mesh, this->getElementAttributeID(this->reactionElementAttributeName, 0));
+        }
+
+        cout << "featkMultiPopulationsReactionDiffusionSolver: Info: Reaction kernel computed." << endl;
+    }
+}
+
+template<unsigned int Dimension>
+void featkMultiPopulationsReactionDiffusionSolver<Dimension>::intermediateProcess(const VectorXd &u, unsigned int iteration) {
+
+    for (unsigned int i=0; i!=this->numberOfComponents; i++) {
+
+        this->storeIntermediateResult(this->outputNodeAttributeNames[i], iteration, u.segment(i*this->numberOfDOFs, this->numberOfDOFs));
+    }
+}
+
+template<unsigned int Dimension>
+void featkMultiPopulationsReactionDiffusionSolver<Dimension>::postProcess(const VectorXd& u) {
+
+    for (unsigned int i=0; i!=this->numberOfComponents; i++) {
+
+        if (this->steadyStateTolerance > 0.0 && this->componentSteadyStateTimes[i] >= 0.0) {
+
+            cout << "featkMultiPopulationsReactionDiffusionSolver: Info: Population " << i+1 << " stationary since t = " << this->componentSteadyStateTimes[i] << "." << endl;
+        }
+
+        this->setNodeAttributeFromValues(this->outputNodeAttributeNames[i], 0, u.segment(i*this->numberOfDOFs, this->numberOfDOFs));
+
+        if (this->mesh != nullptr) {  // Node derivatives not available on structured grids
+
+            this->mesh->computeNodeBQ<0>(this->outputNodeAttributeNames[i], this->outputNodeAttributeNames[i] + " Gradient");
+        }
+    }
+
+    this->setNodeAttributeFromValues(this->totalOutputNodeAttributeName, 0, Map<const MatrixXd>(u.data(), this->numberOfDOFs, this->numberOfComponents).rowwise().sum());
+}
+
+template<unsigned int Dimension>
+void featkMultiPopulationsReactionDiffusionSolver<Dimension>::setDiffusionElementAttributeName(std::string name) {
+
+    this->diffusionElementAttributeName = name;
+}
+
+template<unsigned int Dimension>
+void featkMultiPopulationsReactionDiffusionSolver<Dimension>::setDiffusionFactors(std::vector<double> factors) {
+
+    this->diffusionFactors = factors;
+}
+
+template<unsigned int Dimension>
+void featkMultiPopulationsReactionDiffusionSolver<Dimension>::setInputNodeAttributeNames(std::vector<std::string> names) {
+
+    this->inputNodeAttributeNames = names;
+}
+
+template<unsigned int Dimension>
+void featkMultiPopulationsReactionDiffusionSolver<Dimension>::setOutputNodeAttributeNames(std::vector<std::string> names) {
+
+    this->outputNodeAttributeNames = names;
+}
+
+template<unsigned int Dimension>
+void featkMultiPopulationsReactionDiffusionSolver<Dimension>::setProliferationFactors(std::vector<double> factors) {
+
+    this->proliferationFactors = factors;
+}
+
+template<unsigned int Dimension>
+void featkMultiPopulationsReactionDiffusionSolver<Dimension>::setReactionElementAttributeName(std::string name) {
+
+    this->reactionElementAttributeName = name;
+}
+
+template<unsigned int Dimension>
+void featkMultiPopulationsReactionDiffusionSolver<Dimension>::setTotalOutputNodeAttributeName(std::string name) {
+
+    this->totalOutputNodeAttributeName = name;
+}
+
+template<unsigned int Dimension>
+void featkMultiPopulationsReactionDiffusionSolver<Dimension>::setUseSpeedHack(bool use) {
+
+    this->useSpeedHack = use;
+}
+
+#endif // FEATKMULTIPOPULATIONSREACTIONDIFFUSIONSOLVER_H
@@ -0,0 +1,308 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkPipelinedConjugateGradient.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkPipelinedConjugateGradient
+ *
+ * @brief Jacobi preconditioned pipelined conjugate gradient solver with a
+ * single global reduction per iteration.
+ *
+ * featkPipelinedConjugateGradient solves symmetric positive definite
+ * systems \f$Ax=b\f$ with the pipelined conjugate gradient method of
+ * Ghysels and Vanroose. The recurrences are rearranged so that the three
+ * inner products of an iteration (\f$(r,u)\f$, \f$(w,u)\f$ and
+ * \f$(r,r)\f$) are computed in a single fused pass over the vectors, i.e.
+ * one synchronization point instead of the two separated reductions of the
+ * standard method, and so that the eight vector updates are fused in a
+ * second pass. The matrix is stored row major so that the sparse
+ * matrix-vector product is parallelized by Eigen.
+ *
+ * Stability limits: the residual is updated by longer recurrences than in
+ * the standard method, so that rounding errors accumulate faster and the
+ * attainable relative residual is typically \f$\sqrt{\kappa(A)}\f$ times
+ * larger. Requested tolerances below about \f$10^{-10}\f$ may therefore not
+ * be reached on ill-conditioned systems. The true residual is recomputed
+ * whenever the recursive residual meets the tolerance, the iteration being
+ * restarted from it as long as it decreases. As for
+ * Eigen::ConjugateGradient, info() reports a success once the recursive
+ * residual meets the tolerance, while error() returns the true residual.
+ *
+ * The interface mimics the one of Eigen::ConjugateGradient for the
+ * functions used by featkStaticSolverBase and featkDynamicSolverBase, so
+ * that both solvers are interchangeable.
+ *
+ * See Ghysels and Vanroose. 2014. Hiding global synchronization latency in
+ * the preconditioned conjugate gradient algorithm. Parallel Comput. 40(7).
+ *
+ * @tparam ScalarType The scalar type of the Eigen::SparseMatrix.
+ *
+ */
+
+#ifndef FEATKPIPELINEDCONJUGATEGRADIENT_H
+#define FEATKPIPELINEDCONJUGATEGRADIENT_H
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Eigen;
+
+template<typename ScalarType>
+class featkPipelinedConjugateGradient {
+
+    public:
+
+        typedef Matrix<ScalarType, Dynamic, 1> VectorType;
+        typedef Matrix<ScalarType, Dynamic, Dynamic> MatrixType;
+        typedef typename NumTraits<ScalarType>::Real RealScalar;
+
+        featkPipelinedConjugateGradient();
+        ~featkPipelinedConjugateGradient();
+
+        void compute(const SparseMatrix<ScalarType>& matrix);
+        RealScalar error() const;
+        ComputationInfo info() const;
+        Index iterations() const;
+        void setMaxIterations(Index iterations);
+        void setTolerance(RealScalar tolerance);
+        MatrixType solve(const MatrixType& b) const;
+        MatrixType solveWithGuess(const MatrixType& b, const MatrixType& guess) const;
+
+    private:
+
+        void solveColumn(const VectorType& b, VectorType& x) const;
+
+        SparseMatrix<ScalarType, RowMajor> matrix;
+        VectorType inverseDiagonal;
+
+        RealScalar tolerance;
+        Index maxIterations;
+        mutable Index lastIterations;
+        mutable RealScalar lastError;
+        mutable ComputationInfo lastInfo;
+};
+
+template<typename ScalarType>
+featkPipelinedConjugateGradient<ScalarType>::featkPipelinedConjugateGradient() {
+
+    this->tolerance = NumTraits<RealScalar>::epsilon();
+    this->maxIterations = -1;
+    this->lastIterations = 0;
+    this->lastError = RealScalar(0);
+    this->lastInfo = Success;
+}
+
+template<typename ScalarType>
+featkPipelinedConjugateGradient<ScalarType>::~featkPipelinedConjugateGradient() {
+
+}
+
+template<typename ScalarType>
+void featkPipelinedConjugateGradient<ScalarType>::compute(const SparseMatrix<ScalarType>& matrix) {
+
+    this->matrix = matrix;  // Row major copy, OpenMP parallelized products
+    this->inverseDiagonal = matrix.diagonal();
+
+    for (Index i=0; i!=this->inverseDiagonal.size(); i++) {
+
+        this->inverseDiagonal(i) = this->inverseDiagonal(i) != ScalarType(0) ? ScalarType(1)/this->inverseDiagonal(i) : ScalarType(1);
+    }
+}
+
+template<typename ScalarType>
+typename featkPipelinedConjugateGradient<ScalarType>::RealScalar featkPipelinedConjugateGradient<ScalarType>::error() const {
+
+    return this->lastError;
+}
+
+template<typename ScalarType>
+ComputationInfo featkPipelinedConjugateGradient<ScalarType>::info() const {
+
+    return this->lastInfo;
+}
+
+template<typename ScalarType>
+Index featkPipelinedConjugateGradient<ScalarType>::iterations() const {
+
+    return this->lastIterations;
+}
+
+template<typename ScalarType>
+void featkPipelinedConjugateGradient<ScalarType>::setMaxIterations(Index iterations) {
+
+    this->maxIterations = iterations;
+}
+
+template<typename ScalarType>
+void featkPipelinedConjugateGradient<ScalarType>::setTolerance(RealScalar tolerance) {
+
+    this->tolerance = tolerance;
+}
+
+template<typename ScalarType>
+typename featkPipelinedConjugateGradient<ScalarType>::MatrixType featkPipelinedConjugateGradient<ScalarType>::solve(const MatrixType& b) const {
+
+    return this->solveWithGuess(b, MatrixType::Zero(b.rows(), b.cols()));
+}
+
+template<typename ScalarType>
+typename featkPipelinedConjugateGradient<ScalarType>::MatrixType featkPipelinedConjugateGradient<ScalarType>::solveWithGuess(const MatrixType& b, const MatrixType& guess) const {
+
+    /* Iterations and error are those of the worst column */
+
+    MatrixType x = guess;
+    Index iterations = 0;
+    RealScalar error = RealScalar(0);
+    ComputationInfo info = Success;
+
+    for (Index j=0; j!=b.cols(); j++) {
+
+        VectorType xj = x.col(j);
+        this->solveColumn(b.col(j), xj);
+        x.col(j) = xj;
+
+        iterations = std::max(iterations, this->lastIterations);
+        error = std::max(error, this->lastError);
+
+        if (this->lastInfo != Success) {
+
+            info = this->lastInfo;
+        }
+    }
+
+    this->lastIterations = iterations;
+    this->lastError = error;
+    this->lastInfo = info;
+
+    return x;
+}
+
+template<typename ScalarType>
+void featkPipelinedConjugateGradient<ScalarType>::solveColumn(const VectorType& b, VectorType& x) const {
+
+    Index n = this->matrix.rows();
+    Index maxIterations = this->maxIterations < 0 ? 2*n : this->maxIterations;
+    RealScalar bNorm = b.norm();
+
+    this->lastIterations = 0;
+
+    if (bNorm == RealScalar(0)) {
+
+        x.setZero();
+        this->lastError = RealScalar(0);
+        this->lastInfo = Success;
+        return;
+    }
+
+    RealScalar threshold = this->tolerance*bNorm;
+    RealScalar restartNorm = NumTraits<RealScalar>::highest();
+
+    VectorType r, u, w, m, q, s, p, z;
+    Index i = 0;
+    bool converged = false;  // Recursive residual converged
+
+    while (true) {
+
+        // (Re)start from the true residual, as long as it decreases
+
+        r = b - this->matrix*x;
+        RealScalar rNorm = r.norm();
+
+        if (rNorm <= threshold || rNorm >= restartNorm || i >= maxIterations) {
+
+            this->lastError = rNorm/bNorm;
+            this->lastInfo = rNorm <= threshold || converged ? Success : NoConvergence;
+            break;
+        }
+
+        restartNorm = rNorm;
+        converged = false;
+        u = this->inverseDiagonal.cwiseProduct(r);
+        w = this->matrix*u;
+        z = q = s = p = VectorType::Zero(n);
+
+        ScalarType gammaPrevious = ScalarType(0);
+        ScalarType alpha = ScalarType(0);
+        Index start = i;
+
+        while (i < maxIterations) {
+
+            // Single fused reduction
+
+            ScalarType gamma = ScalarType(0);
+            ScalarType delta = ScalarType(0);
+            RealScalar rr = RealScalar(0);
+
+            #pragma omp parallel for reduction(+:gamma, delta, rr)
+            for (Index k=0; k<n; k++) {
+
+                gamma += r(k)*u(k);
+                delta += w(k)*u(k);
+                rr += r(k)*r(k);
+            }
+
+            if (std::sqrt(rr) <= threshold) {
+
+                converged = true;  // Checked against the true residual
+                break;
+            }
+
+            // Overlapped with the reduction in a distributed implementation
+
+            m = this->inverseDiagonal.cwiseProduct(w);
+            VectorType an = this->matrix*m;
+
+            ScalarType beta = i == start ? ScalarType(0) : gamma/gammaPrevious;
+            ScalarType denominator = i == start ? delta : delta - beta*gamma/alpha;
+
+            if (denominator <= ScalarType(0)) {
+
+                break;  // Breakdown, e.g. loss of positive definiteness by rounding errors
+            }
+
+            alpha = gamma/denominator;
+            gammaPrevious = gamma;
+
+            // Fused vector updates
+
+            #pragma omp parallel for
+            for (Index k=0; k<n; k++) {
+
+                z(k) = an(k) + beta*z(k);
+                q(k) = m(k) + beta*q(k);
+                s(k) = w(k) + beta*s(k);
+                p(k) = u(k) + beta*p(k);
+
+                x(k) += alpha*p(k);
+                r(k) -= alpha*s(k);
+                u(k) -= alpha*q(k);
+                w(k) -= alpha*z(k);
+            }
+
+            i++;
+        }
+    }
+
+    this->lastIterations = i;
+}
+
+#endif // FEATKPIPELINEDCONJUGATEGRADIENT_H
@@ -0,0 +1,292 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkQuadraticReactionKernel.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkQuadraticReactionKernel
+ *
+ * @brief Precomputed quadrature kernel for consistent quadratic reaction
+ * vectors of scalar problems.
+ *
+ * featkQuadraticReactionKernel evaluates the global vector
+ * \f$\int_{\Omega} N^T c (Nq)^2 d\Omega\f$, i.e. the assembly of
+ * featkElement::getNtCNQNQIntegralMatrix<0>(), directly from a global
+ * solution vector instead of a node attribute. The bilinear variant
+ * \f$\int_{\Omega} N^T c (Nq)(Np) d\Omega\f$ is also provided for coupled
+ * reaction terms.
+ *
+ * The element connectivity, the scalar element coefficient \f$c\f$ times
+ * the physical quadrature weights, and the shape function values at the
+ * integration points (shared by all elements of the same type) are gathered
+ * once by compute(). getNtCNQNQIntegralVector() then computes the element
+ * contributions in parallel into a preallocated buffer and gathers them
+ * node by node, so that no allocation nor write conflict occurs and the
+ * result does not depend on the number of threads.
+ *
+ * compute() accepts a featkMesh or a featkStructuredGrid, whose flyweight
+ * elements are then visited once to gather the same quantities.
+ *
+ * @tparam Dimension The cartesian dimension of the problem.
+ *
+ */
+
+#ifndef FEATKQUADRATICREACTIONKERNEL_H
+#define FEATKQUADRATICREACTIONKERNEL_H
+
+#include <featk/geometry/featkMesh.h>
+#include <featk/geometry/featkStructuredGrid.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <vector>
+
+using namespace Eigen;
+
+template<unsigned int Dimension>
+class featkQuadraticReactionKernel {
+
+    public:
+
+        featkQuadraticReactionKernel();
+        ~featkQuadraticReactionKernel();
+
+        void compute(const featkMesh<Dimension>* mesh, size_t elementAttributeID);
+        void compute(const featkStructuredGrid<Dimension>* grid, size_t elementAttributeID);
+        void getNtCNQNPIntegralVector(const Ref<const VectorXd>& q, const Ref<const VectorXd>& p, VectorXd& f) const;
+        void getNtCNQNQIntegralVector(const Ref<const VectorXd>& q, VectorXd& f) const;
+
+    private:
+
+        void computeNodeContributions(size_t numberOfNodes);
+
+        struct featkElementBlock {
+
+            Index nodes;                    // Nodes per element
+            MatrixXd shapeFunctionValues;   // Integration points x nodes
+            MatrixXd weights;               // Integration points x elements, c*w*det(J)
+            std::vector<Index> ids;         // Elements x nodes node IDs
+            Index offset;                   // Offset of the block in contributions
+        };
+
+        std::vector<featkElementBlock> blocks;
+        mutable VectorXd contributions;
+        std::vector<Index> nodeContributions;        // Contribution indices sorted by node (CSR)
+        std::vector<Index> nodeContributionOffsets;
+};
+
+template<unsigned int Dimension>
+featkQuadraticReactionKernel<Dimension>::featkQuadraticReactionKernel() {
+
+}
+
+template<unsigned int Dimension>
+featkQuadraticReactionKernel<Dimension>::~featkQuadraticReactionKernel() {
+
+}
+
+template<unsigned int Dimension>
+void featkQuadraticReactionKernel<Dimension>::compute(const featkMesh<Dimension>* mesh, size_t elementAttributeID) {
+
+    this->blocks.clear();
+
+    std::vector<std::vector<featkElementInterface<Dimension>*>> elementsByType;
+    std::vector<featkElementType> types;
+
+    for (featkElementInterface<Dimension>* element : mesh->getElements()) {
+
+        size_t t = std::find(types.begin(), types.end(), element->getElementType())-types.begin();
+
+        if (t == types.size()) {
+
+            types.push_back(element->getElementType());
+            elementsByType.push_back({});
+        }
+
+        elementsByType[t].push_back(element);
+    }
+
+    Index offset = 0;
+
+    for (const std::vector<featkElementInterface<Dimension>*>& elements : elementsByType) {
+
+        featkElementBlock block;
+        block.shapeFunctionValues = elements[0]->getIntegrationPointShapeFunctionValues();
+        block.nodes = block.shapeFunctionValues.cols();
+        block.weights = MatrixXd(block.shapeFunctionValues.rows(), elements.size());
+        block.ids.reserve(elements.size()*block.nodes);
+        block.offset = offset;
+
+        for (size_t e=0; e!=elements.size(); e++) {
+
+            block.weights.col(e) = elements[e]->getAttributeValue(elementAttributeID)(0, 0)*elements[e]->getIntegrationPointWeights();
+
+            for (featkNode<Dimension>* node : elements[e]->getNodes()) {
+
+                block.ids.push_back(node->getID());
+            }
+        }
+
+        offset += block.ids.size();
+        this->blocks.push_back(block);
+    }
+
+    this->computeNodeContributions(mesh->getNumberOfNodes());
+}
+
+template<unsigned int Dimension>
+void featkQuadraticReactionKernel<Dimension>::compute(const featkStructuredGrid<Dimension>* grid, size_t elementAttributeID) {
+
+    /* Single element type, hence a single block */
+
+    this->blocks.clear();
+
+    featkElementBlock block;
+    block.offset = 0;
+    size_t e = 0;
+
+    grid->forEachElement([&](featkElementInterface<Dimension>* element) {
+
+        if (e == 0) {
+
+            block.shapeFunctionValues = element->getIntegrationPointShapeFunctionValues();
+            block.nodes = block.shapeFunctionValues.cols();
+            block.weights = MatrixXd(block.shapeFunctionValues.rows(), grid->getNumberOfElements());
+            block.ids.reserve(grid->getNumberOfElements()*block.nodes);
+        }
+
+        block.weights.col(e) = element->getAttributeValue(elementAttributeID)(0, 0)*element->getIntegrationPointWeights();
+
+        for (featkNode<Dimension>* node : element->getNodes()) {
+
+            block.ids.push_back(node->getID());
+        }
+
+        e++;
+    });
+
+    if (e != 0) {
+
+        this->blocks.push_back(block);
+    }
+
+    this->computeNodeContributions(grid->getNumberOfNodes());
+}
+
+template<unsigned int Dimension>
+void featkQuadraticReactionKernel<Dimension>::computeNodeContributions(size_t numberOfNodes) {
+
+    /* Node to contributions map */
+
+    Index offset = this->blocks.empty() ? 0 : this->blocks.back().offset+this->blocks.back().ids.size();
+    this->contributions = VectorXd::Zero(offset);
+    this->nodeContributionOffsets.assign(numberOfNodes+1, 0);
+
+    for (const featkElementBlock& block : this->blocks) {
+
+        for (Index id : block.ids) {
+
+            this->nodeContributionOffsets[id+1]++;
+        }
+    }
+
+    for (size_t i=0; i!=numberOfNodes; i++) {
+
+        this->nodeContributionOffsets[i+1] += this->nodeContributionOffsets[i];
+    }
+
+    std::vector<Index> position(this->nodeContributionOffsets.begin(), this->nodeContributionOffsets.end()-1);
+    this->nodeContributions.resize(offset);
+
+    for (const featkElementBlock& block : this->blocks) {
+
+        for (size_t k=0; k!=block.ids.size(); k++) {
+
+            this->nodeContributions[position[block.ids[k]]++] = block.offset+k;
+        }
+    }
+}
+
+template<unsigned int Dimension>
+void featkQuadraticReactionKernel<Dimension>::getNtCNQNPIntegralVector(const Ref<const VectorXd>& q, const Ref<const VectorXd>& p, VectorXd& f) const {
+
+    for (const featkElementBlock& block : this->blocks) {
+
+        Index numberOfElements = block.weights.cols();
+        Index numberOfPoints = block.weights.rows();
+
+        #pragma omp parallel for
+        for (Index e=0; e<numberOfElements; e++) {
+
+            const Index* ids = block.ids.data()+e*block.nodes;
+            double* contribution = this->contributions.data()+block.offset+e*block.nodes;
+
+            for (Index a=0; a!=block.nodes; a++) {
+
+                contribution[a] = 0.0;
+            }
+
+            for (Index g=0; g!=numberOfPoints; g++) {
+
+                double nq = 0.0;
+                double np = 0.0;
+
+                for (Index a=0; a!=block.nodes; a++) {
+
+                    nq += block.shapeFunctionValues(g, a)*q(ids[a]);
+                    np += block.shapeFunctionValues(g, a)*p(ids[a]);
+                }
+
+                double s = block.weights(g, e)*nq*np;
+
+                for (Index a=0; a!=block.nodes; a++) {
+
+                    contribution[a] += s*block.shapeFunctionValues(g, a);
+                }
+            }
+        }
+    }
+
+    Index numberOfNodes = this->nodeContributionOffsets.empty() ? 0 : this->nodeContributionOffsets.size()-1;
+
+    if (f.size() != numberOfNodes) {
+
+        f.resize(numberOfNodes);
+    }
+
+    #pragma omp parallel for
+    for (Index i=0; i<numberOfNodes; i++) {
+
+        double sum = 0.0;
+
+        for (Index k=this->nodeContributionOffsets[i]; k!=this->nodeContributionOffsets[i+1]; k++) {
+
+            sum += this->contributions(this->nodeContributions[k]);
+        }
+
+        f(i) = sum;
+    }
+}
+
+template<unsigned int Dimension>
+void featkQuadraticReactionKernel<Dimension>::getNtCNQNQIntegralVector(const Ref<const VectorXd>& q, VectorXd& f) const {
+
+    this->getNtCNQNPIntegralVector(q, q, f);
+}
+
+#endif // FEATKQUADRATICREACTIONKERNEL_H
@@ -60,8 +60,7 @@
 #define FEATKREACTIONDIFFUSIONSOLVER_H
 
 #include <featk/solve/featkDynamicSolverBase.h>
-
-#include <iomanip>
+#include <featk/solve/featkQuadraticReactionKernel.h>
 
 template<unsigned int Dimension>
 class featkReactionDiffusionSolver final : public featkDynamicSolverBase<Dimension, 0> {
@@ -79,12 +78,17 @@ class featkReactionDiffusionSolver final : public featkDynamicSolverBase<Dimensi
 
     protected:
 
-        SparseMatrix<double> getGlobalSystemMatrix();
+        const SparseMatrix<double>& getGlobalMassMatrix();
+        const SparseMatrix<double>& getGlobalStiffnessMatrix();
+        const VectorXd& getGlobalReactionVector(const VectorXd& u);
+        const SparseMatrix<double>* getGlobalReactionJacobianMatrix();
+        VectorXd getGlobalReactionJacobianScaling(const VectorXd& u);
         VectorXd getGlobalInitialVector();
-        VectorXd getGlobalSystemVector(const VectorXd& u);
+        double getSpectralRadiusBound(const VectorXd& lumpedMass);
         void initialize();
         void intermediateProcess(const VectorXd& u, unsigned int iteration);
         void postProcess(const VectorXd& u);
+        void solveReaction(VectorXd& u, double step);
 
         std::string diffusionElementAttributeName;  // Check if attributes are valid and assign their IDs to vars
         std::string inputNodeAttributeName;
@@ -95,6 +99,11 @@ class featkReactionDiffusionSolver final : public featkDynamicSolverBase<Dimensi
         SparseMatrix<double> m;
         SparseMatrix<double> d;
         SparseMatrix<double> r;
+        VectorXd rho;  // Nodal proliferation rates, i.e. lumped R over lumped M
+
+        featkQuadraticReactionKernel<Dimension> reactionKernel;
+        VectorXd ru2;
+        VectorXd f;  // Reaction vector, reused across time steps
 };
 
 template<unsigned int Dimension>
@@ -105,6 +114,8 @@ featkReactionDiffusionSolver<Dimension>::featkReactionDiffusionSolver() {
     this->outputNodeAttributeName = "Final Cell Density";
     this->reactionElementAttributeName = "Proliferation Rate";
     this->useSpeedHack = true;
+
+    this->cacheableElementMatrixGetters[&featkReactionDiffusionSolver<Dimension>::getElementNtCNIntegralMatrix] = true;  // Linear in the proliferation rate
 }
 
 template<unsigned int Dimension>
@@ -113,40 +124,67 @@ featkReactionDiffusionSolver<Dimension>::~featkReactionDiffusionSolver() {
 }
 
 template<unsigned int Dimension>
-SparseMatrix<double> featkReactionDiffusionSolver<Dimension>::getGlobalSystemMatrix() {
+VectorXd featkReactionDiffusionSolver<Dimension>::getGlobalInitialVector() {
 
-    return this->m + this->timeStep*d;
+    return this->getNodeAttributeValues(this->inputNodeAttributeName, 0);
 }
 
 template<unsigned int Dimension>
-VectorXd featkReactionDiffusionSolver<Dimension>::getGlobalInitialVector() {
+const SparseMatrix<double>& featkReactionDiffusionSolver<Dimension>::getGlobalMassMatrix() {
 
-    return this->mesh->getNodeAttributeValues(this->inputNodeAttributeName, 0);
+    return this->m;
 }
 
 template<unsigned int Dimension>
-VectorXd featkReactionDiffusionSolver<Dimension>::getGlobalSystemVector(const VectorXd &u) {
+const VectorXd& featkReactionDiffusionSolver<Dimension>::getGlobalReactionVector(const VectorXd &u) {
 
     /*
         The last term of the equation should be integral(Nt(NU)^2) instead of integral(NtN)*U^2 = MU^2.
         See Mocenni et al. 2011. for handling of polynomial reaction terms in FEM.
     */
 
-    VectorXd f;
-
     if (this->useSpeedHack) {
 
-        f = this->m*u + this->timeStep*this->r*(u-u.cwiseProduct(u));
+        this->ru2 = u-u.cwiseProduct(u);  // No allocation once sized
+        this->f.noalias() = this->r*this->ru2;
     }
 
     else {
 
-        size_t id = this->mesh->setNodeAttributeFromValues("tmp", 0, u);
-        VectorXd ru2 = this->getGlobalVectorFromElements(&featkReactionDiffusionSolver<Dimension>::getElementNtCNQNQIntegralVector, {this->mesh->getElementAttributeID(this->reactionElementAttributeName, 0), id});
-        f = this->m*u + this->timeStep*(this->r*u-ru2);
+        this->reactionKernel.getNtCNQNQIntegralVector(u, this->ru2);
+        this->f.noalias() = this->r*u;
+        this->f -= this->ru2;
     }
 
-    return f;
+    return this->f;
+}
+
+template<unsigned int Dimension>
+const SparseMatrix<double>* featkReactionDiffusionSolver<Dimension>::getGlobalReactionJacobianMatrix() {
+
+    return &this->r;
+}
+
+template<unsigned int Dimension>
+VectorXd featkReactionDiffusionSolver<Dimension>::getGlobalReactionJacobianScaling(const VectorXd& u) {
+
+    /* d/du R(u-u^2) = R*diag(1-2u). Also used, as an approximation, for the consistent reaction term. */
+
+    return VectorXd::Ones(u.size())-2.0*u;
+}
+
+template<unsigned int Dimension>
+const SparseMatrix<double>& featkReactionDiffusionSolver<Dimension>::getGlobalStiffnessMatrix() {
+
+    return this->d;
+}
+
+template<unsigned int Dimension>
+double featkReactionDiffusionSolver<Dimension>::getSpectralRadiusBound(const VectorXd& lumpedMass) {
+
+    /* The reaction Jacobian R*diag(1-2u) is bounded by R for densities in [0, 1]. */
+
+    return this->getGershgorinBound(this->d, lumpedMass) + this->getGershgorinBound(this->r, lumpedMass);
 }
 
 template<unsigned int Dimension>
@@ -154,28 +192,59 @@ void featkReactionDiffusionSolver<Dimension>::initialize() {
 
     this->m = this->getGlobalMatrixFromElements(&featkReactionDiffusionSolver<Dimension>::getElementNtNIntegralMatrix, {});
     cout << "featkReactionDiffusionSolver: Info: M matrix assembled." << endl;
-    this->d = this->getGlobalMatrixFromElements(&featkReactionDiffusionSolver<Dimension>::getElementBtCBIntegralMatrix, {this->mesh->getElementAttributeID(this->diffusionElementAttributeName, 2)});
+    this->d = this->getGlobalMatrixFromElements(&featkReactionDiffusionSolver<Dimension>::getElementBtCBIntegralMatrix, {this->getElementAttributeID(this->diffusionElementAttributeName, 2)});
     cout << "featkReactionDiffusionSolver: Info: D matrix assembled." << endl;
-    this->r = this->getGlobalMatrixFromElements(&featkReactionDiffusionSolver<Dimension>::getElementNtCNIntegralMatrix, {this->mesh->getElementAttributeID(this->reactionElementAttributeName, 0)});
+    this->r = this->getGlobalMatrixFromElements(&featkReactionDiffusionSolver<Dimension>::getElementNtCNIntegralMatrix, {this->getElementAttributeID(this->reactionElementAttributeName, 0)});
     cout << "featkReactionDiffusionSolver: Info: R matrix assembled." << endl;
+
+    VectorXd ones = VectorXd::Ones(this->numberOfDOFs);
+    this->rho = (this->r*ones).cwiseQuotient(this->m*ones);
+
+    if (!this->useSpeedHack) {
+
+        if (this->grid != nullptr) {
+
+            this->reactionKernel.compute(this->grid, this->getElementAttributeID(this->reactionElementAttributeName, 0));
+        }
+
+        else {
+
+            this->reactionKernel.compute(this->mesh, this->getElementAttributeID(this->reactionElementAttributeName, 0));
+        }
+
+        cout << "featkReactionDiffusionSolver: Info: Reaction kernel computed." << endl;
+    }
 }
 
 template<unsigned int Dimension>
 void featkReactionDiffusionSolver<Dimension>::intermediateProcess(const VectorXd &u, unsigned int iteration) {
 
-    std::ostringstream stream;
-    stream << std::fixed << std::setprecision(2) << iteration*this->timeStep;
-
-    this->mesh->setNodeAttributeFromValues(this->outputNodeAttributeName + " (" + stream.str() + ")", 0, u);
+    this->storeIntermediateResult(this->outputNodeAttributeName, iteration, u);
 }
 
 template<unsigned int Dimension>
 void featkReactionDiffusionSolver<Dimension>::postProcess(const VectorXd& u) {
 
-    this->mesh->setNodeAttributeFromValues(this->outputNodeAttributeName, 0, u);
+    this->setNodeAttributeFromValues(this->outputNodeAttributeName, 0, u);
     // this->mesh->computeNodeBQ<0>(this->outputNodeAttributeName, this->outputNodeAttributeName + " Gradient");  // No more perfmored here since gradient is zero along CSF boundaries
 }
 
+template<unsigned int Dimension>
+void featkReactionDiffusionSolver<Dimension>::solveReaction(VectorXd& u, double step) {
+
+    /**
+     * Closed-form solution u*e/(1+u*(e-1)) of du/dt = rho*u*(1-u) at each node, e being exp(rho*dt). u is not
+     * clamped to [0, 1], which would hide diffusion undershoots and add mass. The denominator only vanishes for
+     * u below -1/(e-1), the exact solution then blowing up within the step, and such undershoots are advanced
+     * with the linearized growth u*e instead.
+     */
+
+    ArrayXd v = u.array();
+    ArrayXd e = (step*this->rho).array().exp();
+    ArrayXd denominator = 1.0+v*(e-1.0);
+    u = (denominator > 0.0).select(v*e/denominator, v*e).matrix();
+}
+
 
 template<unsigned int Dimension>
 void featkReactionDiffusionSolver<Dimension>::setDiffusionElementAttributeName(std::string name) {
@@ -0,0 +1,256 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkSharedPatternOperator.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkSharedPatternOperator
+ *
+ * @brief Linear combinations of global matrices sharing a sparsity
+ * pattern.
+ *
+ * featkSharedPatternOperator stores several global matrices (e.g. the mass
+ * and stiffness matrices of a dynamic problem) on the union of their
+ * sparsity patterns, so that any linear combination of them, e.g.
+ * \f$M+\Delta t K\f$ for a new time step \f$\Delta t\f$, is formed by a
+ * single pass over the non-zero values without reassembly nor
+ * reallocation.
+ *
+ * Each matrix can also be scaled column-wise before being combined, i.e.
+ * \f$\sum_i c_i A_i diag(s_i)\f$, which allows Jacobian matrices such as
+ * \f$M+\Delta t K-\Delta t R\,diag(g(u))\f$ to be formed in place.
+ *
+ * Essential boundary conditions can be applied to the combinations: the
+ * entries lying on fixed rows or columns are zeroed and the fixed diagonal
+ * entries are set to 1. This is equivalent to
+ * featkSolverBase::applyEBCToGlobalSystemMatrix() except that pruned
+ * entries are kept as explicit zeros so the pattern never changes.
+ * applyEssentialDOFMask() applies them to a matrix holding the pattern,
+ * e.g. after further terms have been added to a combination in place.
+ *
+ * @tparam ScalarType The scalar type of the Eigen::SparseMatrix.
+ *
+ */
+
+#ifndef FEATKSHAREDPATTERNOPERATOR_H
+#define FEATKSHAREDPATTERNOPERATOR_H
+
+#include <Eigen/Sparse>
+#include <vector>
+
+using namespace Eigen;
+
+template<typename ScalarType>
+class featkSharedPatternOperator {
+
+    public:
+
+        featkSharedPatternOperator();
+        ~featkSharedPatternOperator();
+
+        void applyEssentialDOFMask(SparseMatrix<ScalarType>& matrix) const;
+        void combine(const std::vector<ScalarType>& coefficients, SparseMatrix<ScalarType>& matrix, bool applyEBC=true) const;
+        void combine(const std::vector<ScalarType>& coefficients, const std::vector<const Matrix<ScalarType, Dynamic, 1>*>& columnScalings, SparseMatrix<ScalarType>& matrix, bool applyEBC=true) const;
+        size_t getNumberOfMatrices() const;
+        const SparseMatrix<ScalarType>& getPattern() const;
+        void setEssentialDOFMask(const std::vector<bool>& mask);
+        void setMatrices(const std::vector<const SparseMatrix<ScalarType>*>& matrices);
+
+    private:
+
+        std::vector<size_t> diagonalEntries;
+        SparseMatrix<ScalarType> pattern;
+        std::vector<size_t> prunedEntries;
+        std::vector<Matrix<ScalarType, Dynamic, 1>> values;
+};
+
+template<typename ScalarType>
+featkSharedPatternOperator<ScalarType>::featkSharedPatternOperator() {
+
+}
+
+template<typename ScalarType>
+featkSharedPatternOperator<ScalarType>::~featkSharedPatternOperator() {
+
+}
+
+template<typename ScalarType>
+void featkSharedPatternOperator<ScalarType>::applyEssentialDOFMask(SparseMatrix<ScalarType>& matrix) const {
+
+    for (size_t entry : this->prunedEntries) {
+
+        matrix.valuePtr()[entry] = ScalarType(0);
+    }
+
+    for (size_t entry : this->diagonalEntries) {
+
+        matrix.valuePtr()[entry] = ScalarType(1);
+    }
+}
+
+template<typename ScalarType>
+void featkSharedPatternOperator<ScalarType>::combine(const std::vector<ScalarType>& coefficients, SparseMatrix<ScalarType>& matrix, bool applyEBC) const {
+
+    this->combine(coefficients, {}, matrix, applyEBC);
+}
+
+template<typename ScalarType>
+void featkSharedPatternOperator<ScalarType>::combine(const std::vector<ScalarType>& coefficients, const std::vector<const Matrix<ScalarType, Dynamic, 1>*>& columnScalings, SparseMatrix<ScalarType>& matrix, bool applyEBC) const {
+
+    if (matrix.rows() != this->pattern.rows() || matrix.cols() != this->pattern.cols() || matrix.nonZeros() != this->pattern.nonZeros() || !matrix.isCompressed()) {
+
+        matrix = this->pattern;  // Structure is only copied the first time
+    }
+
+    Map<Matrix<ScalarType, Dynamic, 1>> result(matrix.valuePtr(), matrix.nonZeros());
+    result.setZero();
+
+    for (size_t i=0; i!=this->values.size() && i!=coefficients.size(); i++) {
+
+        if (coefficients[i] == ScalarType(0)) {
+
+            continue;
+        }
+
+        if (i >= columnScalings.size() || columnScalings[i] == nullptr) {
+
+            result += coefficients[i]*this->values[i];
+        }
+
+        else {
+
+            for (Index j=0; j!=this->pattern.outerSize(); j++) {
+
+                ScalarType factor = coefficients[i]*(*columnScalings[i])(j);
+
+                for (Index k=this->pattern.outerIndexPtr()[j]; k!=this->pattern.outerIndexPtr()[j+1]; k++) {
+
+                    result(k) += factor*this->values[i](k);
+                }
+            }
+        }
+    }
+
+    if (applyEBC) {
+
+        this->applyEssentialDOFMask(matrix);
+    }
+}
+
+template<typename ScalarType>
+size_t featkSharedPatternOperator<ScalarType>::getNumberOfMatrices() const {
+
+    return this->values.size();
+}
+
+template<typename ScalarType>
+const SparseMatrix<ScalarType>& featkSharedPatternOperator<ScalarType>::getPattern() const {
+
+    return this->pattern;
+}
+
+template<typename ScalarType>
+void featkSharedPatternOperator<ScalarType>::setEssentialDOFMask(const std::vector<bool>& mask) {
+
+    this->diagonalEntries.clear();
+    this->prunedEntries.clear();
+
+    for (Index j=0; j!=this->pattern.outerSize(); j++) {
+
+        for (Index k=this->pattern.outerIndexPtr()[j]; k!=this->pattern.outerIndexPtr()[j+1]; k++) {
+
+            Index i = this->pattern.innerIndexPtr()[k];
+
+            if (i == j && mask[i]) {
+
+                this->diagonalEntries.push_back(k);
+            }
+
+            else if (mask[i] || mask[j]) {
+
+                this->prunedEntries.push_back(k);
+            }
+        }
+    }
+}
+
+template<typename ScalarType>
+void featkSharedPatternOperator<ScalarType>::setMatrices(const std::vector<const SparseMatrix<ScalarType>*>& matrices) {
+
+    this->values.clear();
+    this->diagonalEntries.clear();
+    this->prunedEntries.clear();
+
+    if (matrices.empty()) {
+
+        this->pattern = SparseMatrix<ScalarType>();
+        return;
+    }
+
+
+    // Union pattern, diagonal always included so that essential boundary conditions can be applied
+
+    std::vector<Triplet<ScalarType>> triplets;
+
+    for (const SparseMatrix<ScalarType>* matrix : matrices) {
+
+        for (Index j=0; j!=matrix->outerSize(); j++) {
+
+            for (typename SparseMatrix<ScalarType>::InnerIterator it(*matrix, j); it; ++it) {
+
+                triplets.push_back(Triplet<ScalarType>(it.row(), it.col(), ScalarType(0)));
+            }
+        }
+    }
+
+    for (Index i=0; i!=std::min(matrices[0]->rows(), matrices[0]->cols()); i++) {
+
+        triplets.push_back(Triplet<ScalarType>(i, i, ScalarType(0)));
+    }
+
+    this->pattern = SparseMatrix<ScalarType>(matrices[0]->rows(), matrices[0]->cols());
+    this->pattern.setFromTriplets(triplets.begin(), triplets.end());
+    this->pattern.makeCompressed();
+
+
+    // Values of each matrix aligned on the union pattern (inner indices are sorted in both matrices)
+
+    for (const SparseMatrix<ScalarType>* matrix : matrices) {
+
+        Matrix<ScalarType, Dynamic, 1> values = Matrix<ScalarType, Dynamic, 1>::Zero(this->pattern.nonZeros());
+
+        for (Index j=0; j!=matrix->outerSize(); j++) {
+
+            Index k = this->pattern.outerIndexPtr()[j];
+
+            for (typename SparseMatrix<ScalarType>::InnerIterator it(*matrix, j); it; ++it) {
+
+                while (this->pattern.innerIndexPtr()[k] != it.index()) {
+
+                    k++;
+                }
+
+                values(k) += it.value();
+            }
+        }
+
+        this->values.push_back(values);
+    }
+}
+
+#endif // FEATKSHAREDPATTERNOPERATOR_H
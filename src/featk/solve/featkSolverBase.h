@@ -32,6 +32,25 @@
  * well as for applyingy essential boundary conditions to the global system
  * matrix and vector.
  *
+ * The input featkMesh may be replaced by a featkStructuredGrid with
+ * setInputStructuredGrid(), element quantities being then assembled from
+ * its flyweight elements (see forEachElement()) and node attributes read
+ * from and written to the grid. Derived classes relying on the featkMesh
+ * nodes or on node derivative quantities still require a featkMesh.
+ *
+ * With setUseElementMatrixCache(true), getGlobalMatrixFromElements()
+ * fingerprints each element from its type, its node coordinates relative
+ * to its first node and the values of the attributes involved, all
+ * quantized relative to their largest magnitude, and computes the element
+ * matrix once per distinct fingerprint, so that assembly on structured or
+ * semi-structured meshes reduces to a handful of element matrix
+ * evaluations. Only the getters of cacheableElementMatrixGetters, which
+ * depend on nothing but the element geometry and the attributes passed,
+ * are cached. For those linear in their single attribute, the attribute
+ * magnitude is left out of the fingerprint and the cached matrix rescaled
+ * instead. At most maximumNumberOfCachedElementMatrices matrices are kept
+ * per assembly, further elements being computed without caching.
+ *
  * featkReactionDiffusionSolver also defines the update() routine as the
  * sucession of calls to initialize() and solve() functions.
  * The initialize() function is used to initialize matrices and vectors that
@@ -58,11 +77,17 @@
 
 #include <featk/core/featkUtils.h>
 #include <featk/geometry/featkMesh.h>
+#include <featk/geometry/featkStructuredGrid.h>
 #include <featk/solve/featkBoundaryConditions.h>
 #include <featk/solve/featkGlobalSystemMatrixPruner.h>
 
 #include <Eigen/Sparse>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <map>
+#include <unordered_map>
+#include <vector>
 
 using namespace Eigen;
 
@@ -79,12 +104,21 @@ class featkSolverBase {
         void update();
         void setEssentialBoundaryConditions(featkBoundaryConditions<Dimension, Order>* conditions);
         void setInputMesh(featkMesh<Dimension>* mesh);
+        void setInputStructuredGrid(featkStructuredGrid<Dimension>* grid);
         void setNaturalBoundaryConditions(featkBoundaryConditions<Dimension, Order>* conditions);
+        void setUseElementMatrixCache(bool use);  // Off by default
 
         static const unsigned int dofsPerNode = POWER(Dimension, Order);
 
     protected:
 
+        struct featkFingerprintHash {
+
+            size_t operator()(const std::vector<int64_t>& fingerprint) const;
+        };
+
+        typedef std::unordered_map<std::vector<int64_t>, MatrixXd, featkFingerprintHash> ElementMatrixCacheType;
+
         static MatrixXd getElementBtBIntegralMatrix(featkElementInterface<Dimension>* element, std::vector<size_t> attributeIDs);
         static MatrixXd getElementBtCBIntegralMatrix(featkElementInterface<Dimension>* element, std::vector<size_t> attributeIDs);
         static MatrixXd getElementNtCNIntegralMatrix(featkElementInterface<Dimension>* element, std::vector<size_t> attributeIDs);
@@ -98,20 +132,40 @@ class featkSolverBase {
         virtual SparseMatrix<double> getGlobalSystemMatrix()=0;
         virtual void postProcess(const VectorXd& solution)=0;
 
+        template<typename Function> void forEachElement(Function function) const;  // Input mesh elements or input structured grid flyweight elements
+
         void applyEBC(SparseMatrix<double>& k, VectorXd& f);
         void applyEBCToGlobalSystemVector(const SparseMatrix<double>& globalStiffnessMatrix, VectorXd& f);
         void applyEBCToGlobalSystemMatrix(SparseMatrix<double>& k);
         VectorXd getEBCModifiedGlobalSystemVector(const SparseMatrix<double>& k, const VectorXd& vector);
         SparseMatrix<double> getEBCModifiedGlobalSystemMatrix(const SparseMatrix<double>& matrix);
+        MatrixXd getCachedElementMatrix(MatrixXd (*getElementMatrix)(featkElementInterface<Dimension>*, std::vector<size_t>), featkElementInterface<Dimension>* element, std::vector<size_t> attributeIDs, ElementMatrixCacheType& cache) const;  // Computed directly unless caching is enabled and the getter cacheable
         SparseMatrix<double> getGlobalMatrixFromElements(MatrixXd (*getElementMatrix)(featkElementInterface<Dimension>*, std::vector<size_t>), std::vector<size_t> attributeIDs);           // Assembles global matrix from element matrix getter
         // void getGlobalMatrixFromElements(MatrixXd (*getElementMatrix)(featkElementInterface<Dimensions>*), SparseMatrix<double>& k);  // Check if performs faster (i.e. if NRVO is not applied to Eigen::SparseMatrix)
         VectorXd getGlobalVectorFromNBCs();
+        VectorXd getGlobalVectorFromNBCs(featkBoundaryConditions<Dimension, Order>* conditions);
         VectorXd getGlobalVectorFromElements(VectorXd (*getElementVector)(featkElementInterface<Dimension>*, std::vector<size_t>), std::vector<size_t> attributeIDs);                        // Assembles global vector from element vector getter
 
+        size_t getElementAttributeID(std::string name, unsigned int order) const;                      // From the input mesh or structured grid
+        MatrixXd getNodeAttributeValues(std::string name, unsigned int order) const;
+        featkTimeSeriesAttribute* getNodeTimeSeriesAttribute(std::string name) const;
+        size_t setNodeAttributeFromValues(std::string name, unsigned int order, const MatrixXd& values);
+        featkTimeSeriesAttribute* setNodeTimeSeriesAttribute(std::string name, unsigned int order, featkStoragePrecision precision);
+
+        std::map<MatrixXd (*)(featkElementInterface<Dimension>*, std::vector<size_t>), bool> cacheableElementMatrixGetters;  // Whether each is linear in its single attribute
         featkBoundaryConditions<Dimension, Order>* essentialBoundaryConditions;
+        featkStructuredGrid<Dimension>* grid;
         featkMesh<Dimension>* mesh;
         featkBoundaryConditions<Dimension, Order>* naturalBoundaryConditions;
         size_t numberOfDOFs;
+        bool useElementMatrixCache;
+
+    private:
+
+        static double appendFingerprint(std::vector<int64_t>& fingerprint, const double* values, Index size, bool withScale);
+
+        static const int64_t fingerprintResolution = int64_t(1) << 32;  // Relative quantization step of the fingerprints, about 2e-10
+        static const size_t maximumNumberOfCachedElementMatrices = 4096;
 };
 
 template<unsigned int Dimension, unsigned int Order>
@@ -161,9 +215,15 @@ template<unsigned int Dimension, unsigned int Order>
 featkSolverBase<Dimension, Order>::featkSolverBase() {
 
     this-> essentialBoundaryConditions = nullptr;
+    this->grid = nullptr;
     this->mesh = nullptr;
     this->naturalBoundaryConditions = nullptr;
     this->numberOfDOFs = 0;
+    this->useElementMatrixCache = false;
+
+    this->cacheableElementMatrixGetters[&featkSolverBase<Dimension, Order>::getElementBtBIntegralMatrix] = false;
+    this->cacheableElementMatrixGetters[&featkSolverBase<Dimension, Order>::getElementBtCBIntegralMatrix] = true;
+    this->cacheableElementMatrixGetters[&featkSolverBase<Dimension, Order>::getElementNtNIntegralMatrix] = false;
 }
 
 template<unsigned int Dimension, unsigned int Order>
@@ -172,6 +232,48 @@ featkSolverBase<Dimension, Order>::~featkSolverBase() {
 }
 
 
+template<unsigned int Dimension, unsigned int Order>
+double featkSolverBase<Dimension, Order>::appendFingerprint(std::vector<int64_t>& fingerprint, const double* values, Index size, bool withScale) {
+
+    /* Values are quantized relative to their largest magnitude, which is itself quantized unless left out. */
+
+    double scale = 0.0;
+
+    for (Index i=0; i!=size; i++) {
+
+        scale = std::max(scale, std::abs(values[i]));
+    }
+
+    if (withScale) {
+
+        int exponent;
+        double mantissa = std::frexp(scale, &exponent);
+
+        fingerprint.push_back(exponent);
+        fingerprint.push_back(std::llround(mantissa*fingerprintResolution));
+    }
+
+    for (Index i=0; i!=size; i++) {
+
+        fingerprint.push_back(scale == 0.0 ? 0 : std::llround(values[i]/scale*fingerprintResolution));
+    }
+
+    return scale;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+size_t featkSolverBase<Dimension, Order>::featkFingerprintHash::operator()(const std::vector<int64_t>& fingerprint) const {
+
+    size_t hash = fingerprint.size();
+
+    for (int64_t value : fingerprint) {
+
+        hash ^= std::hash<int64_t>()(value)+0x9e3779b97f4a7c15+(hash << 6)+(hash >> 2);
+    }
+
+    return hash;
+}
+
 template<unsigned int Dimension, unsigned int Order>
 void featkSolverBase<Dimension, Order>::applyEBC(SparseMatrix<double>& k, VectorXd& f) {
 
@@ -182,24 +284,39 @@ void featkSolverBase<Dimension, Order>::applyEBC(SparseMatrix<double>& k, Vector
 template<unsigned int Dimension, unsigned int Order>
 void featkSolverBase<Dimension, Order>::applyEBCToGlobalSystemVector(const SparseMatrix<double>& k, VectorXd& f) {
 
-    std::map<size_t, double> allDOFValues = this->essentialBoundaryConditions->getAllDOFValues();
-    std::map<size_t, double> nonZeroDOFValues = this->essentialBoundaryConditions->getNonZeroDOFValues();
-    std::cout << "featkSolverBase: Info: System has " << nonZeroDOFValues.size() << " non-zero essential boundary conditions." << std::endl;
+    if (this->essentialBoundaryConditions == nullptr) {
 
-    for (const auto& pair : allDOFValues) {
+        return;
+    }
+
+    this->essentialBoundaryConditions->compile(this->numberOfDOFs);
+
+    const std::vector<size_t>& allDOFs = this->essentialBoundaryConditions->getCompiledDOFs();
+    const VectorXd& allDOFValues = this->essentialBoundaryConditions->getCompiledDOFValues();
+    const std::vector<bool>& mask = this->essentialBoundaryConditions->getCompiledDOFMask();
+    const std::vector<size_t>& nonZeroDOFs = this->essentialBoundaryConditions->getCompiledNonZeroDOFs();
+    const VectorXd& nonZeroDOFValues = this->essentialBoundaryConditions->getCompiledNonZeroDOFValues();
+
+    for (size_t i=0; i!=allDOFs.size(); i++) {
+
+        if (allDOFs[i] < this->numberOfDOFs) {
 
-        f(pair.first, 0) = pair.second;
+            f(allDOFs[i], 0) = allDOFValues(i);
+        }
     }
 
-    if (nonZeroDOFValues.size()!=0) {
+    /* Only the columns of the non-zero fixed dofs contribute to the right-hand side, so iterate over
+     * these columns of the (column major) global system matrix instead of over all its non-zeros. */
+
+    for (size_t i=0; i!=nonZeroDOFs.size(); i++) {
 
-        for (size_t i=0; i!=k.outerSize(); i++) {  // Iterate over all non zero entries of the sparse matrix
+        if (nonZeroDOFs[i] < this->numberOfDOFs) {
 
-            for (SparseMatrix<double>::InnerIterator it(k, i); it; ++it) {
+            for (SparseMatrix<double>::InnerIterator it(k, nonZeroDOFs[i]); it; ++it) {
 
-                if (allDOFValues.count(it.row()) == 0 && nonZeroDOFValues.count(it.col()) != 0) {
+                if (!mask[it.row()]) {
 
-                    f(it.row(), 0) -= it.value()*nonZeroDOFValues[it.col()];
+                    f(it.row(), 0) -= it.value()*nonZeroDOFValues(i);
                 }
             }
         }
@@ -209,16 +326,27 @@ void featkSolverBase<Dimension, Order>::applyEBCToGlobalSystemVector(const Spars
 template<unsigned int Dimension, unsigned int Order>
 void featkSolverBase<Dimension, Order>::applyEBCToGlobalSystemMatrix(SparseMatrix<double>& k) {
 
-    std::set<size_t> allDOFs = this->essentialBoundaryConditions->getAllDOFs();
+    if (this->essentialBoundaryConditions == nullptr) {
+
+        return;
+    }
+
+    this->essentialBoundaryConditions->compile(this->numberOfDOFs);
+
+    const std::vector<size_t>& allDOFs = this->essentialBoundaryConditions->getCompiledDOFs();
+    const std::vector<bool>& mask = this->essentialBoundaryConditions->getCompiledDOFMask();
     cout << "featkSolverBase: Info: System has " << allDOFs.size() << " essential boundary conditions." << endl;
 
-    for (int i=0; i!=k.outerSize(); i++) {
+    for (size_t dof : allDOFs) {
 
-        for (SparseMatrix<double>::InnerIterator it(k, i); it; ++it) {
+        if (dof < this->numberOfDOFs) {
 
-            if (allDOFs.count(it.row()) != 0 && it.row() == it.col()) {  // Diagonal elements are always non zero or explicit zero, so first test if dof is fixed.
+            for (SparseMatrix<double>::InnerIterator it(k, dof); it; ++it) {
 
-                it.valueRef() = 1.0;
+                if (it.row() == it.col()) {  // Diagonal elements are always non zero or explicit zero
+
+                    it.valueRef() = 1.0;
+                }
             }
         }
     }
@@ -227,7 +355,87 @@ void featkSolverBase<Dimension, Order>::applyEBCToGlobalSystemMatrix(SparseMatri
      * to first change their value to 1, and prune non-diagonal elements afterwards. Indeed, non-zero element
      * insertion into an Eigen::SparseMatrix is very expensive */
 
-    k.prune(featkGlobalSystemMatrixPruner<double>(allDOFs));
+    k.prune(featkGlobalSystemMatrixPruner<double>(mask));
+}
+
+template<unsigned int Dimension, unsigned int Order>
+template<typename Function>
+void featkSolverBase<Dimension, Order>::forEachElement(Function function) const {
+
+    if (this->grid != nullptr) {
+
+        this->grid->forEachElement(function);
+    }
+
+    else {
+
+        for (featkElementInterface<Dimension>* element : this->mesh->getElements()) {
+
+            function(element);
+        }
+    }
+}
+
+template<unsigned int Dimension, unsigned int Order>
+MatrixXd featkSolverBase<Dimension, Order>::getCachedElementMatrix(MatrixXd (*getElementMatrix)(featkElementInterface<Dimension>*, std::vector<size_t>), featkElementInterface<Dimension>* element, std::vector<size_t> attributeIDs, ElementMatrixCacheType& cache) const {
+
+    /* Matrices of getters linear in their single attribute are cached for a unit attribute magnitude. */
+
+    auto getter = this->cacheableElementMatrixGetters.find(getElementMatrix);
+
+    if (!this->useElementMatrixCache || getter == this->cacheableElementMatrixGetters.end()) {
+
+        return getElementMatrix(element, attributeIDs);
+    }
+
+    bool linear = getter->second && attributeIDs.size() == 1;
+
+    std::vector<featkNode<Dimension>*> nodes = element->getNodes();
+    AttributeValueType<Dimension, 1> origin = nodes[0]->getCoordinates();
+    Matrix<double, Dimension, Dynamic> coordinates(Dimension, nodes.size()-1);
+
+    for (size_t n=1; n!=nodes.size(); n++) {
+
+        coordinates.col(n-1) = nodes[n]->getCoordinates()-origin;
+    }
+
+    std::vector<int64_t> fingerprint;
+    fingerprint.push_back(element->getElementType());
+    this->appendFingerprint(fingerprint, coordinates.data(), coordinates.size(), true);
+
+    double scale = 1.0;
+
+    for (size_t id : attributeIDs) {
+
+        const MatrixXd* attribute = element->getAttribute(id);
+
+        if (attribute == nullptr) {
+
+            fingerprint.push_back(-1);
+        }
+
+        else {
+
+            double magnitude = this->appendFingerprint(fingerprint, attribute->data(), attribute->size(), !linear);
+            scale = linear && magnitude != 0.0 ? magnitude : 1.0;
+        }
+    }
+
+    auto it = cache.find(fingerprint);
+
+    if (it != cache.end()) {
+
+        return it->second*scale;
+    }
+
+    MatrixXd elementMatrix = getElementMatrix(element, attributeIDs);
+
+    if (cache.size() < maximumNumberOfCachedElementMatrices) {
+
+        cache.emplace(fingerprint, elementMatrix/scale);
+    }
+
+    return elementMatrix;
 }
 
 template<unsigned int Dimension, unsigned int Order>
@@ -248,12 +456,21 @@ SparseMatrix<double> featkSolverBase<Dimension, Order>::getEBCModifiedGlobalSyst
     return k;
 }
 
+template<unsigned int Dimension, unsigned int Order>
+size_t featkSolverBase<Dimension, Order>::getElementAttributeID(std::string name, unsigned int order) const {
+
+    return this->grid != nullptr ? this->grid->getElementAttributeID(name, order) : this->mesh->getElementAttributeID(name, order);
+}
+
 template<unsigned int Dimension, unsigned int Order>
 SparseMatrix<double> featkSolverBase<Dimension, Order>::getGlobalMatrixFromElements(MatrixXd (*getElementMatrix)(featkElementInterface<Dimension>*, std::vector<size_t>), std::vector<size_t> attributeIDs) {
 
     std::map<size_t, std::map<size_t, double>> coefficients;
 
-    for (featkElementInterface<Dimension>* element : this->mesh->getElements()) {
+    ElementMatrixCacheType elementMatrices;
+    size_t numberOfElements = 0;
+
+    this->forEachElement([&](featkElementInterface<Dimension>* element) {
 
         std::vector<size_t> elementDOFs;
 
@@ -265,7 +482,8 @@ SparseMatrix<double> featkSolverBase<Dimension, Order>::getGlobalMatrixFromEleme
             }
         }
 
-        MatrixXd elementMatrix = getElementMatrix(element, attributeIDs);
+        numberOfElements++;
+        MatrixXd elementMatrix = this->getCachedElementMatrix(getElementMatrix, element, attributeIDs, elementMatrices);
 
         for (int i=0; i!=elementDOFs.size(); i++) {
 
@@ -277,7 +495,7 @@ SparseMatrix<double> featkSolverBase<Dimension, Order>::getGlobalMatrixFromEleme
                 coefficients[k][l] += elementMatrix(i, j);
             }
         }
-    }
+    });
 
     std::vector<Triplet<double, size_t>> triplets;
 
@@ -295,17 +513,39 @@ SparseMatrix<double> featkSolverBase<Dimension, Order>::getGlobalMatrixFromEleme
     SparseMatrix<double> k(this->numberOfDOFs, this->numberOfDOFs);
     k.setFromTriplets(triplets.begin(), triplets.end());
 
+    if (!elementMatrices.empty()) {
+
+        cout << "featkSolverBase: Info: " << elementMatrices.size() << " element matrices cached for " << numberOfElements << " elements." << endl;
+    }
+
     return k;  // Make sure NRVO is applied here to avoid copying a huge Eigen::SparseMatrix
 }
 
 template<unsigned int Dimension, unsigned int Order>
 VectorXd featkSolverBase<Dimension, Order>::getGlobalVectorFromNBCs() {
 
+    return this->getGlobalVectorFromNBCs(this->naturalBoundaryConditions);
+}
+
+template<unsigned int Dimension, unsigned int Order>
+VectorXd featkSolverBase<Dimension, Order>::getGlobalVectorFromNBCs(featkBoundaryConditions<Dimension, Order>* conditions) {
+
     VectorXd f = VectorXd::Zero(this->numberOfDOFs);
 
-    for (const auto& pair : this->naturalBoundaryConditions->getNonZeroDOFValues()) {
+    if (conditions != nullptr) {
+
+        conditions->compile(this->numberOfDOFs);
+
+        const std::vector<size_t>& dofs = conditions->getCompiledNonZeroDOFs();
+        const VectorXd& values = conditions->getCompiledNonZeroDOFValues();
+
+        for (size_t i=0; i!=dofs.size(); i++) {
 
-        f(pair.first, 0) = pair.second;
+            if (dofs[i] < this->numberOfDOFs) {
+
+                f(dofs[i], 0) = values(i);
+            }
+        }
     }
 
     return f;
@@ -316,7 +556,7 @@ VectorXd featkSolverBase<Dimension, Order>::getGlobalVectorFromElements(VectorXd
 
     VectorXd f = VectorXd::Zero(this->numberOfDOFs);
 
-    for (featkElementInterface<Dimension>* element : this->mesh->getElements()) {
+    this->forEachElement([&](featkElementInterface<Dimension>* element) {
 
         VectorXd elementVector = getElementVector(element, attributeIDs);
         size_t i = 0;
@@ -329,11 +569,23 @@ VectorXd featkSolverBase<Dimension, Order>::getGlobalVectorFromElements(VectorXd
                 i++;
             }
         }
-    }
+    });
 
     return f;
 }
 
+template<unsigned int Dimension, unsigned int Order>
+MatrixXd featkSolverBase<Dimension, Order>::getNodeAttributeValues(std::string name, unsigned int order) const {
+
+    return this->grid != nullptr ? this->grid->getNodeAttributeValues(name, order) : this->mesh->getNodeAttributeValues(name, order);
+}
+
+template<unsigned int Dimension, unsigned int Order>
+featkTimeSeriesAttribute* featkSolverBase<Dimension, Order>::getNodeTimeSeriesAttribute(std::string name) const {
+
+    return this->grid != nullptr ? this->grid->getNodeTimeSeriesAttribute(name) : this->mesh->getNodeTimeSeriesAttribute(name);
+}
+
 template<unsigned int Dimension, unsigned int Order>
 void featkSolverBase<Dimension, Order>::initialize() {
 
@@ -355,14 +607,41 @@ void featkSolverBase<Dimension, Order>::setEssentialBoundaryConditions(featkBoun
 template<unsigned int Dimension, unsigned int Order>
 void featkSolverBase<Dimension, Order>::setInputMesh(featkMesh<Dimension>* mesh) {
 
+    this->grid = nullptr;
     this->mesh = mesh;
     this->numberOfDOFs = mesh->getNumberOfNodes()*this->dofsPerNode;
 }
 
+template<unsigned int Dimension, unsigned int Order>
+void featkSolverBase<Dimension, Order>::setInputStructuredGrid(featkStructuredGrid<Dimension>* grid) {
+
+    this->grid = grid;
+    this->mesh = nullptr;
+    this->numberOfDOFs = grid->getNumberOfNodes()*this->dofsPerNode;
+}
+
 template<unsigned int Dimension, unsigned int Order>
 void featkSolverBase<Dimension, Order>::setNaturalBoundaryConditions(featkBoundaryConditions<Dimension, Order>* conditions) {
 
     this->naturalBoundaryConditions = conditions;
 }
 
+template<unsigned int Dimension, unsigned int Order>
+size_t featkSolverBase<Dimension, Order>::setNodeAttributeFromValues(std::string name, unsigned int order, const MatrixXd& values) {
+
+    return this->grid != nullptr ? this->grid->setNodeAttributeFromValues(name, order, values) : this->mesh->setNodeAttributeFromValues(name, order, values);
+}
+
+template<unsigned int Dimension, unsigned int Order>
+featkTimeSeriesAttribute* featkSolverBase<Dimension, Order>::setNodeTimeSeriesAttribute(std::string name, unsigned int order, featkStoragePrecision precision) {
+
+    return this->grid != nullptr ? this->grid->setNodeTimeSeriesAttribute(name, order, precision) : this->mesh->setNodeTimeSeriesAttribute(name, order, precision);
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkSolverBase<Dimension, Order>::setUseElementMatrixCache(bool use) {
+
+    this->useElementMatrixCache = use;
+}
+
 #endif // FEATKSOLVERBASE_H
@@ -35,6 +35,21 @@
  * featkStaticSolverBase::getGlobalSystemVector(), and
  * featkSolverBase::postProcess() functions.
  *
+ * Several load cases sharing the same global system matrix can be solved
+ * at once: derived classes returning more than one case from
+ * getNumberOfLoadCases() provide the right-hand side and post-processing of
+ * each case through getLoadCaseGlobalSystemVector() and
+ * postProcessLoadCase(). The global system matrix is then assembled and
+ * factorized (setUseDirectSolver()) or preconditioned once, and all cases
+ * are solved as the columns of a single right-hand side block.
+ *
+ * The iterative solver is the conjugate gradient method by default.
+ * setIterativeSolverType() selects one of the communication reducing
+ * variants featkPipelinedConjugateGradient or featkChebyshevIteration
+ * instead, whose stability limits are documented in their respective
+ * classes, or featkMixedPrecisionSolver, i.e. single precision conjugate
+ * gradient iterations within double precision iterative refinement.
+ *
  * @tparam Dimension The cartesian dimension of the problem.
  *
  * @tparam Order The order of the variable the system is solved for.
@@ -44,6 +59,9 @@
 #ifndef FEATKSTATICSOLVERBASE_H
 #define FEATKSTATICSOLVERBASE_H
 
+#include <featk/solve/featkChebyshevIteration.h>
+#include <featk/solve/featkMixedPrecisionSolver.h>
+#include <featk/solve/featkPipelinedConjugateGradient.h>
 #include <featk/solve/featkSolverBase.h>
 
 template<unsigned int Dimension, unsigned int Order>
@@ -53,6 +71,8 @@ class featkStaticSolverBase : public featkSolverBase<Dimension, Order> {
 
         virtual ~featkStaticSolverBase();
 
+        void setIterativeSolverType(featkIterativeSolverType type);
+        void setUseDirectSolver(bool use);
         void solve();
 
     protected:
@@ -61,12 +81,24 @@ class featkStaticSolverBase : public featkSolverBase<Dimension, Order> {
 
         virtual SparseMatrix<double> getGlobalSystemMatrix()=0;
         virtual VectorXd getGlobalSystemVector()=0;
+        virtual VectorXd getLoadCaseGlobalSystemVector(size_t loadCase);
+        virtual size_t getNumberOfLoadCases();
         virtual void postProcess(const VectorXd& solution)=0;
+        virtual void postProcessLoadCase(const VectorXd& solution, size_t loadCase);
+
+        featkIterativeSolverType iterativeSolverType;
+        bool useDirectSolver;
+
+    private:
+
+        template<typename SolverType> MatrixXd solveIteratively(SolverType& solver, const SparseMatrix<double>& k, const MatrixXd& f) const;
 };
 
 template<unsigned int Dimension, unsigned int Order>
 featkStaticSolverBase<Dimension, Order>::featkStaticSolverBase() {
 
+    this->iterativeSolverType = FEATK_CONJUGATE_GRADIENT;
+    this->useDirectSolver = false;
 }
 
 template<unsigned int Dimension, unsigned int Order>
@@ -74,33 +106,116 @@ featkStaticSolverBase<Dimension, Order>::~featkStaticSolverBase() {
 
 }
 
+template<unsigned int Dimension, unsigned int Order>
+VectorXd featkStaticSolverBase<Dimension, Order>::getLoadCaseGlobalSystemVector(size_t loadCase) {
+
+    return this->getGlobalSystemVector();
+}
+
+template<unsigned int Dimension, unsigned int Order>
+size_t featkStaticSolverBase<Dimension, Order>::getNumberOfLoadCases() {
+
+    return 1;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkStaticSolverBase<Dimension, Order>::postProcessLoadCase(const VectorXd& solution, size_t loadCase) {
+
+    this->postProcess(solution);
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkStaticSolverBase<Dimension, Order>::setIterativeSolverType(featkIterativeSolverType type) {
+
+    this->iterativeSolverType = type;
+}
+
+template<unsigned int Dimension, unsigned int Order>
+void featkStaticSolverBase<Dimension, Order>::setUseDirectSolver(bool use) {
+
+    this->useDirectSolver = use;
+}
+
 template<unsigned int Dimension, unsigned int Order>
 void featkStaticSolverBase<Dimension, Order>::solve() {
 
     SparseMatrix<double> k = this->getGlobalSystemMatrix();
-    VectorXd f = this->getGlobalSystemVector();
+    size_t numberOfLoadCases = this->getNumberOfLoadCases();
+    MatrixXd f = MatrixXd(this->numberOfDOFs, numberOfLoadCases);
 
-    this->applyEBC(k, f);
+    for (size_t c=0; c!=numberOfLoadCases; c++) {
 
-    /*k.makeCompressed();
+        VectorXd fc = this->getLoadCaseGlobalSystemVector(c);
+        this->applyEBCToGlobalSystemVector(k, fc);  // Requires the unmodified global system matrix
+        f.col(c) = fc;
+    }
 
-    SimplicialLDLT<SparseMatrix<double>, Lower> solver;
-    solver.compute(k);
+    this->applyEBCToGlobalSystemMatrix(k);
+    k.makeCompressed();
 
-    if (solver.info() != Success) {
+    cout << "featkStaticSolverBase: Info: Solving " << numberOfLoadCases << " load case(s)." << endl;
+
+    MatrixXd q;
+
+    if (this->useDirectSolver) {
+
+        SimplicialLDLT<SparseMatrix<double>, Lower> solver;
+        solver.compute(k);
+
+        if (solver.info() != Success) {
+
+            cout << "featkStaticSolverBase: Warning: Global system matrix decomposition failed." << endl;
+        }
+
+        q = solver.solve(f);
+    }
+
+    else if (this->iterativeSolverType == FEATK_PIPELINED_CONJUGATE_GRADIENT) {
+
+        featkPipelinedConjugateGradient<double> solver;
+        q = this->solveIteratively(solver, k, f);
+    }
+
+    else if (this->iterativeSolverType == FEATK_CHEBYSHEV_ITERATION) {
 
-        cout << "featkDynamicSolverBase: Warning: Global system matrix decomposition failed." << endl;
-    }*/
+        featkChebyshevIteration<double> solver;
+        q = this->solveIteratively(solver, k, f);
+    }
+
+    else if (this->iterativeSolverType == FEATK_MIXED_PRECISION_CONJUGATE_GRADIENT) {
+
+        featkMixedPrecisionSolver<ConjugateGradient<SparseMatrix<float>, Lower|Upper>> solver;
+        q = this->solveIteratively(solver, k, f);
+    }
+
+    else {
+
+        ConjugateGradient<SparseMatrix<double>, Lower|Upper> solver;
+        //solver.setTolerance(1.0e-8);
+        //solver.setMaxIterations(500);
+        q = this->solveIteratively(solver, k, f);
+    }
+
+    for (size_t c=0; c!=numberOfLoadCases; c++) {
+
+        this->postProcessLoadCase(q.col(c), c);
+    }
+}
+
+template<unsigned int Dimension, unsigned int Order>
+template<typename SolverType>
+MatrixXd featkStaticSolverBase<Dimension, Order>::solveIteratively(SolverType& solver, const SparseMatrix<double>& k, const MatrixXd& f) const {
 
-    ConjugateGradient<SparseMatrix<double>, Lower|Upper> solver;
-    //solver.setTolerance(1.0e-8);
-    //solver.setMaxIterations(500);
     solver.compute(k);
 
+    MatrixXd q = solver.solve(f);  // Columns are solved in turn with the same preconditioner
+
+    if (solver.info() != Success) {
 
-    VectorXd q = solver.solve(f);
+        cout << "featkStaticSolverBase: Warning: Global system solver did not converge." << endl;
+    }
 
-    this->postProcess(q);
+    return q;
 }
 
 #endif // FEATKSTATICSOLVERBASE_H
@@ -0,0 +1,63 @@
+/*==========================================================================
+
+  Program:   Finite Element Analysis Toolkit
+  Module:    featkTimeSeriesSinkInterface.h
+
+  Copyright (c) Corentin Martens
+  All rights reserved.
+
+     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+     EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+     OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+     NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR
+     ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR
+     OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING
+     FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+     OTHER DEALINGS IN THE SOFTWARE.
+
+==========================================================================*/
+
+/**
+ *
+ * @class featkTimeSeriesSinkInterface
+ *
+ * @brief Interface for the destinations of solver result time series.
+ *
+ * featkTimeSeriesSinkInterface is an interface allowing
+ * featkDynamicSolverBase to hand its intermediate results over to any
+ * destination, e.g. a featkXDMFTimeSeriesWriter streaming them to disk,
+ * without depending on it. write() receives one snapshot of node values
+ * (one row per node) of the result name at the given time.
+ *
+ */
+
+#ifndef FEATKTIMESERIESSINKINTERFACE_H
+#define FEATKTIMESERIESSINKINTERFACE_H
+
+#include <Eigen/Dense>
+#include <string>
+
+using namespace Eigen;
+
+class featkTimeSeriesSinkInterface {
+
+    public:
+
+        virtual ~featkTimeSeriesSinkInterface();
+
+        virtual void write(std::string name, double time, const MatrixXd& values)=0;
+
+    protected:
+
+        featkTimeSeriesSinkInterface();
+};
+
+inline featkTimeSeriesSinkInterface::featkTimeSeriesSinkInterface() {
+
+}
+
+inline featkTimeSeriesSinkInterface::~featkTimeSeriesSinkInterface() {
+
+}
+
+#endif // FEATKTIMESERIESSINKINTERFACE_H
@@ -1,17 +1,673 @@
+#include <featk/algorithm/featk3DGridSource.h>
+#include <featk/algorithm/featkBinaryMeshReader.h>
+#include <featk/algorithm/featkBinaryMeshWriter.h>
+#include <featk/algorithm/featkGmshReader.h>
+#include <featk/algorithm/featkMaskedGridSource.h>
+#include <featk/algorithm/featkNIfTIImageSampler.h>
+#include <featk/algorithm/featkVTUReader.h>
+#include <featk/algorithm/featkVTUWriter.h>
+#include <featk/algorithm/featkXDMFTimeSeriesWriter.h>
 #include <featk/core/featkDefines.h>
+#include <featk/core/featkNIfTIImage.h>
 #include <featk/geometry/featkHex8Element.h>
 #include <featk/geometry/featkMesh.h>
 #include <featk/geometry/featkNode.h>
+#include <featk/geometry/featkStructuredGrid.h>
 #include <featk/geometry/featkTet4Element.h>
 #include <featk/material/featkIsotropicLinearElastic3DMaterial.h>
 #include <featk/solve/featkBoundaryConditions.h>
+#include <featk/solve/featkChebyshevIteration.h>
+#include <featk/solve/featkDeflatedConjugateGradient.h>
 #include <featk/solve/featkLinearElasticitySolver.h>
+#include <featk/solve/featkMixedPrecisionSolver.h>
+#include <featk/solve/featkPipelinedConjugateGradient.h>
+#include <featk/solve/featkReactionDiffusionSolver.h>
+#include <featk/solve/featkSolverBase.h>
 #include <featk/test/featkTests.h>
 
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
 #include <vector>
 
 using namespace std;
 
+class featkAssemblyTestSolver : public featkSolverBase<3, 0> {
+
+    /**
+     * Exposes the assembly of the global matrices of featkReactionDiffusionSolver.
+     */
+
+    public:
+
+        SparseMatrix<double> getGlobalDiffusionMatrix() { return this->getGlobalMatrixFromElements(&getElementBtCBIntegralMatrix, {this->getElementAttributeID("Diffusion Tensor", 2)}); }
+        SparseMatrix<double> getGlobalMassMatrix() { return this->getGlobalMatrixFromElements(&getElementNtNIntegralMatrix, {}); }
+        VectorXd getGlobalReactionVector() { return this->getGlobalVectorFromElements(&getElementNtCNQNQIntegralVector, {this->getElementAttributeID("Proliferation Rate", 0), this->mesh->getNodeAttributeID("Initial Cell Density", 0)}); }
+        void solve() {}
+
+    protected:
+
+        SparseMatrix<double> getGlobalSystemMatrix() { return SparseMatrix<double>(); }
+        void postProcess(const VectorXd& solution) {}
+};
+
+featkMesh<3>* getReactionDiffusionTestMesh() {
+
+    /**
+     * 8x1x1 hexahedra, i.e. 9x2x2 nodes, with a Gaussian initial density, isotropic diffusion tensors and unit
+     * proliferation rates.
+     */
+
+    featk3DGridSource source = featk3DGridSource();
+    source.setDimensions({9, 2, 2});
+    source.setSpacing({1.0, 1.0, 1.0});
+    source.setElementType(FEATK_HEX8);
+    source.update();
+
+    featkMesh<3>* mesh = source.getOutputMesh();
+
+    MatrixXd densities(mesh->getNumberOfNodes(), 1);
+
+    for (size_t n=0; n!=mesh->getNumberOfNodes(); n++) {
+
+        double x = mesh->getNode(n)->getCoordinates()(0);
+        densities(n, 0) = 0.1+0.8*exp(-0.5*(x-2.0)*(x-2.0));
+    }
+
+    vector<shared_ptr<MatrixXd>> tensors(mesh->getNumberOfElements());
+    vector<shared_ptr<MatrixXd>> rates(mesh->getNumberOfElements());
+
+    for (size_t e=0; e!=mesh->getNumberOfElements(); e++) {
+
+        tensors[e] = make_shared<MatrixXd>(0.5*Matrix3d::Identity());
+        rates[e] = make_shared<MatrixXd>(MatrixXd::Ones(1, 1));
+    }
+
+    mesh->setNodeAttributeFromValues("Initial Cell Density", 0, densities);
+    mesh->setElementAttributes("Diffusion Tensor", 2, tensors);
+    mesh->setElementAttributes("Proliferation Rate", 0, rates);
+
+    return mesh;
+}
+
+VectorXd getReactionDiffusionTestSolution(featkReactionDiffusionSolver<3>& solver, featkMesh<3>* mesh) {
+
+    solver.setInputMesh(mesh);
+    solver.update();
+
+    return mesh->getNodeAttributeValues("Final Cell Density", 0);
+}
+
+SparseMatrix<double> getIterativeSolverTestMatrix(double step, VectorXd& b, VectorXd& x) {
+
+    /**
+     * M + step*D on 16x4x4 hexahedra with anisotropic diffusion tensors varying across elements, a right-hand side b
+     * and its solution x by a sparse Cholesky decomposition.
+     */
+
+    featk3DGridSource source = featk3DGridSource();
+    source.setDimensions({17, 5, 5});
+    source.setSpacing({1.0, 0.5, 0.5});
+    source.setElementType(FEATK_HEX8);
+    source.update();
+
+    featkMesh<3>* mesh = source.getOutputMesh();
+    vector<shared_ptr<MatrixXd>> tensors(mesh->getNumberOfElements());
+
+    for (size_t e=0; e!=mesh->getNumberOfElements(); e++) {
+
+        tensors[e] = make_shared<MatrixXd>(Matrix3d::Constant(0.1*double(e%5)) + Matrix3d::Identity()*double(1+e%3));
+    }
+
+    mesh->setElementAttributes("Diffusion Tensor", 2, tensors);
+
+    featkAssemblyTestSolver solver;
+    solver.setInputMesh(mesh);
+    SparseMatrix<double> a = solver.getGlobalMassMatrix() + step*solver.getGlobalDiffusionMatrix();
+
+    delete mesh;
+
+    b = VectorXd::LinSpaced(a.rows(), 0.0, double(a.rows()-1)).array().sin();
+    x = SimplicialLDLT<SparseMatrix<double>>(a).solve(b);
+
+    return a;
+}
+
+bool featkAdaptiveTimeStepTest() {
+
+    /**
+     * Adaptive SBDF1/SBDF2 and SBDF1/CNAB2 pairs up to t = 2 against a fixed step SBDF2 reference.
+     */
+
+    featkMesh<3>* mesh = getReactionDiffusionTestMesh();
+
+    featkReactionDiffusionSolver<3> reference;
+    reference.setTimeIntegrationScheme(FEATK_SBDF2);
+    reference.setTimeStep(1.0/256.0);
+    reference.setNumberOfIterations(512);
+    reference.setUseDirectSolver(true);
+
+    VectorXd u = getReactionDiffusionTestSolution(reference, mesh);
+
+    bool result = true;
+
+    for (featkTimeIntegrationScheme scheme : {FEATK_SBDF1, FEATK_CNAB2}) {
+
+        featkReactionDiffusionSolver<3> solver;
+        solver.setTimeIntegrationScheme(scheme);
+        solver.setUseAdaptiveTimeStep(true);
+        solver.setEndTime(2.0);
+        solver.setTimeStep(0.01);
+        solver.setAbsoluteTolerance(1.0e-6);
+        solver.setRelativeTolerance(1.0e-4);
+        solver.setUseDirectSolver(true);
+
+        VectorXd v = getReactionDiffusionTestSolution(solver, mesh);
+
+        result = result && solver.getNumberOfAcceptedSteps() > 2 && (v-u).cwiseAbs().maxCoeff() < 1.0e-3;
+    }
+
+    delete mesh;
+
+    return result;
+}
+
+bool featkBinaryMeshWriterReaderRoundTripTest() {
+
+    /**
+     * A hexahedron between two tetrahedra with a scalar node attribute and scalar and tensor element attributes are
+     * written and read back. Elements are grouped by type, tetrahedra first, their attributes following them.
+     */
+
+    const unsigned int Dimension = 3;
+
+    vector<featkNode<3>*> nodes;
+
+    for (size_t n=0; n!=8; n++) {
+
+        nodes.push_back(new featkNode<3>(n, (AttributeValueType<Dimension, 1>() << double(n%2), double(n/2%2), double(n/4)).finished()));
+    }
+
+    nodes.push_back(new featkNode<3>(8, (AttributeValueType<Dimension, 1>() << 0.5, 0.5, 2.0).finished()));
+    nodes.push_back(new featkNode<3>(9, (AttributeValueType<Dimension, 1>() << 0.5, 0.5, -1.0).finished()));
+
+    vector<featkElementInterface<3>*> elements = {new featkTet4Element({nodes[4], nodes[5], nodes[6], nodes[8]}),
+                                                  new featkHex8Element({nodes[0], nodes[1], nodes[3], nodes[2], nodes[4], nodes[5], nodes[7], nodes[6]}),
+                                                  new featkTet4Element({nodes[0], nodes[2], nodes[1], nodes[9]})};
+    vector<size_t> order = {0, 2, 1};  // Input element of each output element
+
+    featkMesh<3>* mesh = new featkMesh<3>(nodes, elements);
+
+    vector<shared_ptr<MatrixXd>> temperatures;
+    vector<shared_ptr<MatrixXd>> rates;
+    vector<shared_ptr<MatrixXd>> tensors;
+
+    for (size_t n=0; n!=nodes.size(); n++) {
+
+        temperatures.push_back(make_shared<MatrixXd>(MatrixXd::Constant(1, 1, 0.5*n)));
+    }
+
+    for (size_t e=0; e!=elements.size(); e++) {
+
+        rates.push_back(make_shared<MatrixXd>(MatrixXd::Constant(1, 1, 1.0+e)));
+        tensors.push_back(make_shared<MatrixXd>(MatrixXd::Random(3, 3)));
+    }
+
+    mesh->setNodeAttributes("Temperature", 0, temperatures);
+    mesh->setElementAttributes("Proliferation Rate", 0, rates);
+    mesh->setElementAttributes("Diffusion Tensor", 2, tensors);
+
+    string fileName = "featkBinaryMeshWriterReaderRoundTripTest.fbm";
+
+    featkBinaryMeshWriter writer = featkBinaryMeshWriter();
+    writer.setInputMesh(mesh);
+    writer.setFileName(fileName);
+    bool result = writer.update();
+
+    featkBinaryMeshReader reader = featkBinaryMeshReader();
+    reader.setFileName(fileName);
+    reader.passAllAttributesOn();
+    result = result && reader.update();
+
+    featkMesh<3>* output = reader.getOutputMesh();
+
+    if (!result || output == nullptr || output->getNumberOfNodes() != nodes.size() || output->getNumberOfElements() != elements.size()) {
+
+        delete output;
+        delete mesh;
+        remove(fileName.c_str());
+
+        return false;
+    }
+
+    size_t temperatureID = output->getNodeAttributeID("Temperature", 0);
+    size_t rateID = output->getElementAttributeID("Proliferation Rate", 0);
+    size_t tensorID = output->getElementAttributeID("Diffusion Tensor", 2);
+
+    for (size_t n=0; n!=nodes.size(); n++) {
+
+        featkNode<3>* node = output->getNode(n);
+
+        if (!node->getCoordinates().isApprox(nodes[n]->getCoordinates(), EPS) || !node->getAttributeValue(temperatureID).isApprox(*temperatures[n], EPS)) {
+
+            result = false;
+        }
+    }
+
+    for (size_t e=0; e!=elements.size(); e++) {
+
+        featkElementInterface<3>* element = output->getElement(e);
+        size_t i = order[e];
+
+        if (element->getElementType() != elements[i]->getElementType() || !element->getAttributeValue(rateID).isApprox(*rates[i], EPS) || !element->getAttributeValue(tensorID).isApprox(*tensors[i], EPS)) {
+
+            result = false;
+            continue;
+        }
+
+        for (unsigned int j=0; j!=(element->getElementType() == FEATK_TET4 ? 4 : 8); j++) {
+
+            if (element->getNode(j)->getID() != elements[i]->getNode(j)->getID()) {
+
+                result = false;
+            }
+        }
+    }
+
+    result = result && reader.getConnectivity(FEATK_TET4).rows() == 2 && reader.getConnectivity(FEATK_HEX8).rows() == 1 && reader.getConnectivity(FEATK_HEX8)(0, 2) == 3;
+    result = result && reader.getElementAttribute("Proliferation Rate").col(0).transpose() == RowVector3d(1.0, 3.0, 2.0);
+
+    delete output;
+    delete mesh;
+    remove(fileName.c_str());
+
+    return result;
+}
+
+bool featkBoundaryConditionsCompileTest() {
+
+    const unsigned int Dimension = 3;
+    const unsigned int Order = 1;
+
+    vector<featkNode<3>*> nodes;
+
+    for (size_t n=0; n!=5; n++) {
+
+        nodes.push_back(new featkNode<3>(n, (AttributeValueType<Dimension, 1>() << double(n), 0.0, 0.0).finished()));
+    }
+
+    featkMesh<3>* mesh = new featkMesh<3>(nodes, {});
+
+    featkBoundaryConditions<Dimension, Order> conditions = featkBoundaryConditions<Dimension, Order>();
+    conditions.setDOFValue(2, 1, 5.0);
+    conditions.addDOFValue(2, 1, 1.0);
+    conditions.setDOFValue(0, 0, 0.0);
+    conditions.setDOFValues(vector<size_t>({1, 3}), 2, 0.0);
+    conditions.setDOFValues(mesh, [](const AttributeValueType<Dimension, 1>& coordinates) { return coordinates(0, 0) > 3.5; }, 1, 7.0);
+    conditions.compile(mesh->getNumberOfNodes()*POWER(Dimension, Order));
+
+    vector<size_t> dofs = {0, 5, 7, 11, 13};
+    vector<size_t> nonZeroDOFs = {7, 13};
+    VectorXd values = (VectorXd(5) << 0.0, 0.0, 6.0, 0.0, 7.0).finished();
+
+    bool result = conditions.getCompiledDOFs() == dofs && conditions.getCompiledNonZeroDOFs() == nonZeroDOFs && conditions.getCompiledDOFValues().isApprox(values, EPS);
+
+    for (size_t dof=0; dof!=conditions.getCompiledDOFMask().size(); dof++) {
+
+        if (conditions.getCompiledDOFMask()[dof] != (find(dofs.begin(), dofs.end(), dof) != dofs.end())) {
+
+            result = false;
+        }
+    }
+
+    delete mesh;
+
+    return result;
+}
+
+bool featkChebyshevIterationTest() {
+
+    /**
+     * Solve with estimated spectral bounds against a sparse Cholesky decomposition.
+     */
+
+    VectorXd b;
+    VectorXd x;
+    SparseMatrix<double> a = getIterativeSolverTestMatrix(0.5, b, x);
+
+    featkChebyshevIteration<double> solver;
+    solver.setTolerance(1.0e-10);
+    solver.compute(a);
+    VectorXd y = solver.solve(b);
+
+    return solver.info() == Success && solver.error() <= 1.0e-10 && y.isApprox(x, 1.0e-8);
+}
+
+bool featkCheckpointRestartTest() {
+
+    /**
+     * Seven steps run without interruption, writing a checkpoint at step 4, then steps 5 to 7 restarted from it on a
+     * new mesh: the intermediate and final results must be identical, for first and second order schemes with the
+     * deflated solver whose Ritz vectors are checkpointed. A checkpoint whose matrix size exceeds the file must then
+     * be rejected.
+     */
+
+    string fileName = "featkCheckpointRestartTest.ckp";
+    vector<unsigned int> iterations = {0, 1, 2, 3, 4, 5, 6};
+
+    bool result = true;
+
+    for (featkTimeIntegrationScheme scheme : {FEATK_SBDF1, FEATK_SBDF2, FEATK_CNAB2}) {
+
+        featkMesh<3>* mesh = getReactionDiffusionTestMesh();
+        featkReactionDiffusionSolver<3> solver;
+        solver.setTimeIntegrationScheme(scheme);
+        solver.setTimeStep(0.25);
+        solver.setNumberOfIterations(7);
+        solver.setUseDeflation(true);
+        solver.setIntermediateProcessIterations(iterations);
+        solver.setCheckpointFileName(fileName);
+        solver.setCheckpointFrequency(4);
+        VectorXd u = getReactionDiffusionTestSolution(solver, mesh);
+
+        featkMesh<3>* restartMesh = getReactionDiffusionTestMesh();
+        featkReactionDiffusionSolver<3> restartSolver;
+        restartSolver.setTimeIntegrationScheme(scheme);
+        restartSolver.setTimeStep(0.25);
+        restartSolver.setNumberOfIterations(7);
+        restartSolver.setUseDeflation(true);
+        restartSolver.setIntermediateProcessIterations(iterations);
+        restartSolver.setRestartFileName(fileName);
+        VectorXd v = getReactionDiffusionTestSolution(restartSolver, restartMesh);
+
+        result = result && u == v;
+
+        for (unsigned int i=4; i!=7; i++) {
+
+            ostringstream stream;
+            stream << fixed << setprecision(2) << i*0.25;
+            string name = "Final Cell Density (" + stream.str() + ")";
+
+            result = result && restartMesh->getNodeAttributeID(name, 0) != 0 && mesh->getNodeAttributeValues(name, 0) == restartMesh->getNodeAttributeValues(name, 0);
+        }
+
+        delete restartMesh;
+        delete mesh;
+    }
+
+    featkCheckpoint checkpoint;
+    result = result && checkpoint.read(fileName) && checkpoint.iteration == 4 && !checkpoint.ritzVectors.empty();
+
+    ifstream input(fileName, ios::binary | ios::ate);
+    streamoff size = input.tellg();
+    input.close();
+
+    ofstream stream(fileName, ios::binary | ios::in);  // Sizes of the last Ritz vectors, whose product overflows to 0
+    stream.seekp(size-4-checkpoint.ritzVectors.back().size()*8-16);
+    array<uint64_t, 2> sizes = {uint64_t(1) << 62, 4};
+    stream.write(reinterpret_cast<const char*>(sizes.data()), sizeof(sizes));
+    stream.close();
+
+    result = result && !checkpoint.read(fileName) && checkpoint.iteration == 4;
+
+    remove(fileName.c_str());
+
+    return result;
+}
+
+bool featkDeflatedConjugateGradientTest() {
+
+    /**
+     * Successive solves with the same matrix and different right-hand sides against a sparse Cholesky decomposition.
+     * The first solve, without Ritz vectors, is a Jacobi preconditioned conjugate gradient; the following ones must
+     * need markedly fewer iterations once the Ritz vectors have been collected.
+     */
+
+    VectorXd b;
+    VectorXd x;
+    SparseMatrix<double> a = getIterativeSolverTestMatrix(10.0, b, x);
+    SimplicialLDLT<SparseMatrix<double>> direct(a);
+
+    featkDeflatedConjugateGradient<double> solver;
+    solver.setTolerance(1.0e-10);
+    solver.setDeflationSpaceSize(8);
+    solver.setDeflationUpdateFrequency(1);
+    solver.compute(a);
+
+    bool result = solver.getNumberOfRitzVectors() == 0;
+    Index iterations = 0;
+
+    for (unsigned int i=0; i!=4; i++) {
+
+        VectorXd bi = (1.0+0.5*i)*b + VectorXd::Constant(b.size(), double(i));
+        VectorXd xi = direct.solve(bi);
+        VectorXd y = solver.solveWithGuess(bi, VectorXd::Zero(b.size()));
+
+        result = result && solver.info() == Success && y.isApprox(xi, 1.0e-8) && solver.getNumberOfRitzVectors() == 8;
+
+        if (i == 0) {
+
+            iterations = solver.iterations();
+        }
+
+        else {
+
+            result = result && 4*solver.iterations() < 3*iterations;
+        }
+    }
+
+    return result;
+}
+
+bool featkElementMatrixCacheTest() {
+
+    /**
+     * Mass and diffusion matrices assembled with and without the element matrix cache, on a grid mesh and on the
+     * same mesh with perturbed nodes, diffusion tensors differing only by their magnitude across elements.
+     */
+
+    bool result = true;
+
+    for (featkElementType type : {FEATK_HEX8, FEATK_TET4}) {
+
+        for (bool perturbed : {false, true}) {
+
+            featk3DGridSource source = featk3DGridSource();
+            source.setDimensions({4, 3, 2});
+            source.setSpacing({1.0, 0.5, 2.0});
+            source.setElementType(type);
+            source.update();
+
+            featkMesh<3>* mesh = source.getOutputMesh();
+
+            if (mesh == nullptr) {
+
+                result = false;
+                continue;
+            }
+
+            if (perturbed) {
+
+                MatrixXd coordinates = mesh->getNodeAttributeValues("Cartesian Coordinates", 1);
+
+                for (Index i=0; i!=coordinates.rows(); i++) {
+
+                    coordinates(i, 0) += 0.1*sin(double(i));
+                }
+
+                mesh->setNodeAttributeFromValues("Cartesian Coordinates", 1, coordinates);
+            }
+
+            vector<shared_ptr<MatrixXd>> attributes(mesh->getNumberOfElements());
+
+            for (size_t e=0; e!=mesh->getNumberOfElements(); e++) {
+
+                attributes[e] = make_shared<MatrixXd>((Matrix3d() << 2.0, 0.5, 0.0,
+                                                                     0.5, 1.0, 0.0,
+                                                                     0.0, 0.0, 1.0).finished()*double(1+e%3));
+            }
+
+            mesh->setElementAttributes("Diffusion Tensor", 2, attributes);
+
+            featkAssemblyTestSolver solver;
+            solver.setInputMesh(mesh);
+
+            MatrixXd m = MatrixXd(solver.getGlobalMassMatrix());
+            MatrixXd d = MatrixXd(solver.getGlobalDiffusionMatrix());
+
+            solver.setUseElementMatrixCache(true);
+
+            result = result && MatrixXd(solver.getGlobalMassMatrix()).isApprox(m, EPS) && MatrixXd(solver.getGlobalDiffusionMatrix()).isApprox(d, EPS);
+
+            delete mesh;
+        }
+    }
+
+    return result;
+}
+
+bool featkGmshReaderTest() {
+
+    /**
+     * A MSH 4.1 binary file with a hexahedron and a tetrahedron in two volumes of distinct physical groups, a triangle
+     * and an unused node, which are both skipped.
+     */
+
+    string data = "$MeshFormat\n4.1 1 8\n";
+
+    auto append = [&data](auto value) { data.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+    append(int(1));
+    data += "\n$EndMeshFormat\n$PhysicalNames\n3\n2 3 \"Skin\"\n3 1 \"Muscle\"\n3 2 \"Tumor\"\n$EndPhysicalNames\n$Entities\n";
+
+    for (uint64_t number : {0, 0, 0, 2}) {
+
+        append(number);
+    }
+
+    for (int volume : {1, 2}) {
+
+        append(volume);
+
+        for (unsigned int i=0; i!=6; i++) {
+
+            append(0.0);
+        }
+
+        append(uint64_t(1));
+        append(volume);
+        append(uint64_t(0));
+    }
+
+    data += "\n$EndEntities\n$Nodes\n";
+
+    for (uint64_t number : {1, 10, 1, 10}) {
+
+        append(number);
+    }
+
+    append(int(3));
+    append(int(1));
+    append(int(0));
+    append(uint64_t(10));
+
+    for (uint64_t tag=1; tag!=11; tag++) {
+
+        append(tag);
+    }
+
+    vector<AttributeValueType<3, 1>> coordinates;
+
+    for (unsigned int n=0; n!=8; n++) {
+
+        coordinates.push_back((AttributeValueType<3, 1>() << double(n%2), double(n/2%2), double(n/4)).finished());
+    }
+
+    coordinates.push_back((AttributeValueType<3, 1>() << 0.5, 0.5, 2.0).finished());
+    coordinates.push_back((AttributeValueType<3, 1>() << 5.0, 5.0, 5.0).finished());
+
+    for (const AttributeValueType<3, 1>& point : coordinates) {
+
+        append(point(0));
+        append(point(1));
+        append(point(2));
+    }
+
+    data += "\n$EndNodes\n$Elements\n";
+
+    vector<vector<uint64_t>> blocks = {{3, 1, 5, 1, 2, 4, 3, 5, 6, 8, 7}, {2, 3, 2, 5, 6, 7}, {3, 2, 4, 5, 6, 7, 9}};  // Dimension, entity, type, node tags
+
+    for (uint64_t number : {3, 3, 1, 3}) {
+
+        append(number);
+    }
+
+    for (size_t b=0; b!=blocks.size(); b++) {
+
+        append(int(blocks[b][0]));
+        append(int(blocks[b][1]));
+        append(int(blocks[b][2]));
+        append(uint64_t(1));
+        append(uint64_t(b+1));
+
+        for (size_t j=3; j!=blocks[b].size(); j++) {
+
+            append(blocks[b][j]);
+        }
+    }
+
+    data += "\n$EndElements\n";
+
+    string fileName = "featkGmshReaderTest.msh";
+    ofstream(fileName, ios::binary).write(data.data(), data.size());
+
+    featkGmshReader reader = featkGmshReader();
+    reader.setFileName(fileName);
+    reader.update();
+
+    featkMesh<3>* mesh = reader.getOutputMesh();
+    remove(fileName.c_str());
+
+    if (mesh == nullptr || mesh->getNumberOfNodes() != 9 || mesh->getNumberOfElements() != 2) {
+
+        delete mesh;
+        return false;
+    }
+
+    map<int, string> physicalNames = {{1, "Muscle"}, {2, "Tumor"}};
+    bool result = reader.getPhysicalNames() == physicalNames;
+
+    for (size_t n=0; n!=9; n++) {
+
+        result = result && mesh->getNode(n)->getCoordinates().isApprox(coordinates[n], EPS);
+    }
+
+    size_t id = mesh->getElementAttributeID("Physical Group", 0);
+    vector<vector<size_t>> connectivity = {{0, 1, 3, 2, 4, 5, 7, 6}, {4, 5, 6, 8}};
+
+    for (size_t e=0; e!=2; e++) {
+
+        featkElementInterface<3>* element = mesh->getElement(e);
+        result = result && element->getElementType() == (e == 0 ? FEATK_HEX8 : FEATK_TET4) && element->getAttributeValue(id)(0, 0) == double(e+1);
+
+        for (size_t j=0; result && j!=connectivity[e].size(); j++) {
+
+            result = element->getNode(j)->getID() == connectivity[e][j];
+        }
+    }
+
+    delete mesh;
+
+    return result;
+}
+
 bool featkHex8StiffnessMatrixTest() {
 
     /**
@@ -70,11 +726,390 @@ bool featkHex8StiffnessMatrixTest() {
     return result;
 }
 
+bool featkMaskedGridSourceTest() {
+
+    /**
+     * An L-shaped mask of four voxels, one even and three odd, meshed with hexahedra and tetrahedra.
+     */
+
+    vector<int> mask = {1, 1, 2, 0,   // z = 0, x varying fastest
+                        1, 0, 0, 0};  // z = 1
+
+    bool result = true;
+
+    for (featkElementType type : {FEATK_HEX8, FEATK_TET4}) {
+
+        featkMaskedGridSource source = featkMaskedGridSource();
+        source.setDimensions({2, 2, 2});
+        source.setSpacing({2.0, 1.0, 0.5});
+        source.setMask(mask);
+        source.setElementType(type);
+        source.update();
+
+        featkMesh<3>* mesh = source.getOutputMesh();
+
+        if (mesh == nullptr || mesh->getNumberOfNodes() != 20 || mesh->getNumberOfElements() != (type == FEATK_TET4 ? 20 : 4)) {
+
+            delete mesh;
+            result = false;
+            continue;
+        }
+
+        for (size_t n=0; n!=mesh->getNumberOfNodes(); n++) {
+
+            result = result && mesh->getNode(n)->getID() == n;
+
+            if (n != 0) {  // Nodes numbered in z, y, x order
+
+                AttributeValueType<3, 1> previous = mesh->getNode(n-1)->getCoordinates();
+                AttributeValueType<3, 1> current = mesh->getNode(n)->getCoordinates();
+
+                result = result && (previous(2) < current(2) || (previous(2) == current(2) && (previous(1) < current(1) || (previous(1) == current(1) && previous(0) < current(0)))));
+            }
+        }
+
+        size_t id = mesh->getElementAttributeID("Label", 0);
+        double labels = 0.0;
+        double volume = 0.0;
+
+        for (size_t e=0; e!=mesh->getNumberOfElements(); e++) {
+
+            featkElementInterface<3>* element = mesh->getElement(e);
+            labels += element->getAttributeValue(id)(0, 0);
+
+            if (type == FEATK_TET4) {
+
+                Matrix3d edges;
+
+                for (unsigned int j=0; j!=3; j++) {
+
+                    edges.col(j) = element->getNode(j+1)->getCoordinates()-element->getNode(0)->getCoordinates();
+                }
+
+                result = result && edges.determinant() > 0.0;
+                volume += edges.determinant()/6.0;
+            }
+        }
+
+        result = result && labels == (type == FEATK_TET4 ? 25.0 : 5.0) && (type == FEATK_HEX8 || abs(volume-4.0) < EPS);
+
+        delete mesh;
+    }
+
+    return result;
+}
+
+bool featkMixedPrecisionSolverTest() {
+
+    /**
+     * Iterative refinement of single precision conjugate gradient solves against a sparse Cholesky decomposition, the
+     * requested accuracy lying well beyond single precision.
+     */
+
+    VectorXd b;
+    VectorXd x;
+    SparseMatrix<double> a = getIterativeSolverTestMatrix(0.5, b, x);
+
+    featkMixedPrecisionSolver<ConjugateGradient<SparseMatrix<float>, Lower|Upper>> solver;
+    solver.setTolerance(1.0e-10);
+    solver.compute(a);
+    VectorXd y = solver.solve(b);
+
+    return solver.info() == Success && solver.error() <= 1.0e-10 && y.isApprox(x, 1.0e-8);
+}
+
+bool featkNIfTIImageSamplerTest() {
+
+    /**
+     * A 3x2x2 float NIfTI-1 image sampled onto the nodes of the grid of its voxel centers, which take the voxel values
+     * exactly. Truncated headers or voxel data, voxel offsets out of the file and dimensions whose product overflows
+     * must then be rejected.
+     */
+
+    string fileName = "featkNIfTIImageSamplerTest.nii";
+
+    auto getData = [](int16_t dimension, float offset, size_t size) {
+
+        string data(352, '\0');
+        auto set = [&data](size_t position, auto value) { memcpy(&data[position], &value, sizeof(value)); };
+
+        set(0, int32_t(348));
+        set(40, int16_t(dimension == 3 ? 3 : 7));
+
+        for (size_t i=1; i!=8; i++) {
+
+            set(40+2*i, int16_t(dimension == 3 ? (i == 1 ? 3 : i <= 3 ? 2 : 1) : dimension));
+            set(76+4*i, 1.0f);
+        }
+
+        set(70, int16_t(FEATK_NIFTI_FLOAT32));
+        set(72, int16_t(32));
+        set(108, offset);
+        set(112, 1.0f);
+        memcpy(&data[344], "n+1", 4);
+
+        for (size_t v=0; v!=12; v++) {
+
+            float value = 1.0f+0.5f*v;
+            data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        return data.substr(0, size);
+    };
+
+    auto write = [&fileName](const string& data) {
+
+        ofstream stream(fileName, ios::binary | ios::trunc);
+        stream.write(data.data(), data.size());
+    };
+
+    write(getData(3, 352.0f, 400));
+
+    featk3DGridSource source = featk3DGridSource();
+    source.setDimensions({3, 2, 2});
+    source.setSpacing({1.0, 1.0, 1.0});
+    source.setElementType(FEATK_HEX8);
+    source.update();
+
+    featkMesh<3>* mesh = source.getOutputMesh();
+
+    featkNIfTIImageSampler sampler = featkNIfTIImageSampler();
+    sampler.setInputMesh(mesh);
+    sampler.setFileName(fileName);
+    sampler.setAttributeName("Intensity");
+    sampler.setSamplingLocationToNodes();
+    sampler.update();
+
+    bool result = mesh->getNodeAttributeID("Intensity", 0) != 0;
+
+    for (size_t n=0; n!=mesh->getNumberOfNodes() && result; n++) {
+
+        AttributeValueType<3, 1> x = mesh->getNode(n)->getCoordinates();
+        double value = 1.0+0.5*(x(0)+3.0*(x(1)+2.0*x(2)));
+
+        result = abs(mesh->getNodeAttributeValues("Intensity", 0)(n, 0)-value) < EPS;
+    }
+
+    delete mesh;
+
+    featkNIfTIImage image;
+    result = result && image.open(fileName) && image.getDimensions() == array<int64_t, 3>({3, 2, 2}) && image.getNumberOfComponents() == 1;
+
+    for (const string& data : {getData(3, 352.0f, 200), getData(3, 352.0f, 376), getData(3, 100.0f, 400), getData(3, 1.0e6f, 400), getData(3, -1.0f, 400), getData(32767, 352.0f, 400)}) {
+
+        write(data);
+        featkNIfTIImage invalidImage;
+        result = result && !invalidImage.open(fileName);
+    }
+
+    remove(fileName.c_str());
+
+    return result;
+}
+
+bool featkPipelinedConjugateGradientTest() {
+
+    /**
+     * Solve against a sparse Cholesky decomposition, error() returning the true residual.
+     */
+
+    VectorXd b;
+    VectorXd x;
+    SparseMatrix<double> a = getIterativeSolverTestMatrix(0.5, b, x);
+
+    featkPipelinedConjugateGradient<double> solver;
+    solver.setTolerance(1.0e-10);
+    solver.compute(a);
+    VectorXd y = solver.solve(b);
+
+    return solver.info() == Success && solver.error() <= 1.0e-10 && y.isApprox(x, 1.0e-8);
+}
+
+bool featkQuadraticReactionKernelTest() {
+
+    /**
+     * Consistent quadratic reaction vector computed by the kernel on a mesh and on the equivalent implicit grid,
+     * against the assembly of the element vectors, for hexahedra and tetrahedra.
+     */
+
+    array<unsigned int, 3> dimensions = {4, 3, 2};
+    array<double, 3> spacing = {1.0, 0.5, 2.0};
+    array<double, 3> origin = {1.0, 0.0, -1.0};
+
+    bool result = true;
+
+    for (featkElementType type : {FEATK_HEX8, FEATK_TET4}) {
+
+        featk3DGridSource source = featk3DGridSource();
+        source.setDimensions(dimensions);
+        source.setSpacing(spacing);
+        source.setOrigin(origin);
+        source.setElementType(type);
+        source.update();
+
+        featkMesh<3>* mesh = source.getOutputMesh();
+        featkStructuredGrid<3> grid(dimensions, spacing, origin, type);
+
+        if (mesh == nullptr || mesh->getNumberOfElements() != grid.getNumberOfElements()) {
+
+            delete mesh;
+            result = false;
+            continue;
+        }
+
+        MatrixXd densities(mesh->getNumberOfNodes(), 1);
+        MatrixXd rates(mesh->getNumberOfElements(), 1);
+        vector<shared_ptr<MatrixXd>> attributes(mesh->getNumberOfElements());
+
+        for (size_t n=0; n!=mesh->getNumberOfNodes(); n++) {
+
+            densities(n, 0) = 0.1+0.05*double(n%7);
+        }
+
+        for (size_t e=0; e!=mesh->getNumberOfElements(); e++) {
+
+            rates(e, 0) = 0.5+0.25*double(e%3);
+            attributes[e] = make_shared<MatrixXd>(rates.row(e));
+        }
+
+        mesh->setNodeAttributeFromValues("Initial Cell Density", 0, densities);
+        mesh->setElementAttributes("Proliferation Rate", 0, attributes);
+        grid.setElementAttributeFromValues("Proliferation Rate", 0, rates);
+
+        featkAssemblyTestSolver solver;
+        solver.setInputMesh(mesh);
+        VectorXd expected = solver.getGlobalReactionVector();
+
+        featkQuadraticReactionKernel<3> meshKernel;
+        meshKernel.compute(mesh, mesh->getElementAttributeID("Proliferation Rate", 0));
+        VectorXd meshVector;
+        meshKernel.getNtCNQNQIntegralVector(densities.col(0), meshVector);
+
+        featkQuadraticReactionKernel<3> gridKernel;
+        gridKernel.compute(&grid, grid.getElementAttributeID("Proliferation Rate", 0));
+        VectorXd gridVector;
+        gridKernel.getNtCNQNQIntegralVector(densities.col(0), gridVector);
+
+        result = result && expected.size() == (Index)mesh->getNumberOfNodes() && meshVector.isApprox(expected, EPS) && gridVector.isApprox(expected, EPS);
+
+        delete mesh;
+    }
+
+    return result;
+}
+
 void featkRunAllTests() {
 
+    cout << featkAdaptiveTimeStepTest() << endl;
+    cout << featkBinaryMeshWriterReaderRoundTripTest() << endl;
+    cout << featkBoundaryConditionsCompileTest() << endl;
+    cout << featkChebyshevIterationTest() << endl;
+    cout << featkCheckpointRestartTest() << endl;
+    cout << featkDeflatedConjugateGradientTest() << endl;
+    cout << featkElementMatrixCacheTest() << endl;
+    cout << featkGmshReaderTest() << endl;
     cout << featkHex8StiffnessMatrixTest() << endl;
+    cout << featkMaskedGridSourceTest() << endl;
+    cout << featkMixedPrecisionSolverTest() << endl;
+    cout << featkNIfTIImageSamplerTest() << endl;
+    cout << featkPipelinedConjugateGradientTest() << endl;
+    cout << featkQuadraticReactionKernelTest() << endl;
+    cout << featkSteadyStateTest() << endl;
+    cout << featkStructuredGridAssemblyTest() << endl;
     cout << featkTet4StiffnessMatrixTest() << endl;
     cout << featkTet4LinearElasticitySolverTest() << endl;
+    cout << featkTimeIntegrationOrderTest() << endl;
+    cout << featkVTUWriterReaderRoundTripTest() << endl;
+    cout << featkXDMFTimeSeriesWriterTest() << endl;
+}
+
+bool featkSteadyStateTest() {
+
+    /**
+     * The logistic growth saturates the density at 1, where the time loop must stop.
+     */
+
+    featkMesh<3>* mesh = getReactionDiffusionTestMesh();
+
+    featkReactionDiffusionSolver<3> solver;
+    solver.setTimeStep(0.5);
+    solver.setNumberOfIterations(1000);
+    solver.setSteadyStateTolerance(1.0e-4);
+    solver.setUseDirectSolver(true);
+
+    VectorXd u = getReactionDiffusionTestSolution(solver, mesh);
+
+    bool result = solver.getSteadyStateTime() > 0.0 && solver.getSteadyStateTime() < 500.0 && solver.getComponentSteadyStateTimes()[0] >= 0.0 && (u.array()-1.0).abs().maxCoeff() < 1.0e-2;
+
+    delete mesh;
+
+    return result;
+}
+
+bool featkStructuredGridAssemblyTest() {
+
+    /**
+     * Mass and diffusion matrices assembled on an implicit grid, on the equivalent explicit grid and on the mesh returned by toMesh().
+     */
+
+    array<unsigned int, 3> dimensions = {4, 3, 2};
+    array<double, 3> spacing = {1.0, 0.5, 2.0};
+    array<double, 3> origin = {1.0, 0.0, -1.0};
+
+    bool result = true;
+
+    for (featkElementType type : {FEATK_HEX8, FEATK_TET4}) {
+
+        featk3DGridSource source = featk3DGridSource();
+        source.setDimensions(dimensions);
+        source.setSpacing(spacing);
+        source.setOrigin(origin);
+        source.setElementType(type);
+        source.update();
+
+        featkMesh<3>* mesh = source.getOutputMesh();
+        featkStructuredGrid<3> grid(dimensions, spacing, origin, type);
+
+        if (mesh == nullptr || mesh->getNumberOfElements() != grid.getNumberOfElements()) {
+
+            delete mesh;
+            result = false;
+            continue;
+        }
+
+        MatrixXd tensors(grid.getNumberOfElements()*3, 3);
+        vector<shared_ptr<MatrixXd>> attributes(grid.getNumberOfElements());
+
+        for (size_t e=0; e!=grid.getNumberOfElements(); e++) {
+
+            Matrix3d a = Matrix3d::Constant(0.1*double(e%5)) + Matrix3d::Identity()*double(1+e%3);  // Symmetric positive definite, varying per element
+            tensors.block<3, 3>(e*3, 0) = a;
+            attributes[e] = make_shared<MatrixXd>(a);
+        }
+
+        grid.setElementAttributeFromValues("Diffusion Tensor", 2, tensors);
+        mesh->setElementAttributes("Diffusion Tensor", 2, attributes);
+
+        featkMesh<3>* gridMesh = grid.toMesh();
+
+        featkAssemblyTestSolver meshSolver;
+        meshSolver.setInputMesh(mesh);
+        featkAssemblyTestSolver gridSolver;
+        gridSolver.setInputStructuredGrid(&grid);
+        featkAssemblyTestSolver gridMeshSolver;
+        gridMeshSolver.setInputMesh(gridMesh);
+
+        MatrixXd m = MatrixXd(meshSolver.getGlobalMassMatrix());
+        MatrixXd d = MatrixXd(meshSolver.getGlobalDiffusionMatrix());
+
+        result = result && MatrixXd(gridSolver.getGlobalMassMatrix()).isApprox(m, EPS) && MatrixXd(gridSolver.getGlobalDiffusionMatrix()).isApprox(d, EPS);
+        result = result && MatrixXd(gridMeshSolver.getGlobalMassMatrix()).isApprox(m, EPS) && MatrixXd(gridMeshSolver.getGlobalDiffusionMatrix()).isApprox(d, EPS);
+
+        delete gridMesh;
+        delete mesh;
+    }
+
+    return result;
 }
 
 bool featkTet4StiffnessMatrixTest() {
@@ -217,3 +1252,184 @@ bool featkTet4LinearElasticitySolverTest() {
 
     return result;
 }
+
+bool featkTimeIntegrationOrderTest() {
+
+    /**
+     * Errors at t = 1 for steps of 0.1 and 0.05 against a reference computed with the same scheme and a 16 times
+     * smaller step. Halving the step must divide the error by about 2^order.
+     */
+
+    map<featkTimeIntegrationScheme, unsigned int> orders = {{FEATK_SBDF1, 1}, {FEATK_CNAB2, 2}, {FEATK_SBDF2, 2}, {FEATK_STRANG, 2}, {FEATK_FORWARD_EULER, 1}, {FEATK_SSPRK2, 2}, {FEATK_SSPRK3, 3}};
+
+    featkMesh<3>* mesh = getReactionDiffusionTestMesh();
+    bool result = true;
+
+    for (const auto& pair : orders) {
+
+        vector<VectorXd> solutions;
+
+        for (unsigned int refinement : {1, 2, 16}) {
+
+            featkReactionDiffusionSolver<3> solver;
+            solver.setTimeIntegrationScheme(pair.first);
+            solver.setTimeStep(0.1/refinement);
+            solver.setNumberOfIterations(10*refinement);
+            solver.setUseDirectSolver(true);
+
+            solutions.push_back(getReactionDiffusionTestSolution(solver, mesh));
+        }
+
+        double ratio = (solutions[0]-solutions[2]).norm()/(solutions[1]-solutions[2]).norm();
+
+        result = result && ratio > 0.75*pow(2.0, pair.second) && ratio < 1.5*pow(2.0, pair.second);
+    }
+
+    delete mesh;
+
+    return result;
+}
+
+bool featkVTUWriterReaderRoundTripTest() {
+
+    /**
+     * A hexahedron and a tetrahedron with a scalar node attribute and a tensor element attribute are written raw and
+     * compressed, and read back.
+     */
+
+    const unsigned int Dimension = 3;
+
+    vector<featkNode<3>*> nodes;
+
+    for (size_t n=0; n!=8; n++) {
+
+        nodes.push_back(new featkNode<3>(n, (AttributeValueType<Dimension, 1>() << double(n%2), double(n/2%2), double(n/4)).finished()));
+    }
+
+    nodes.push_back(new featkNode<3>(8, (AttributeValueType<Dimension, 1>() << 0.5, 0.5, 2.0).finished()));
+
+    vector<featkElementInterface<3>*> elements = {new featkHex8Element({nodes[0], nodes[1], nodes[3], nodes[2], nodes[4], nodes[5], nodes[7], nodes[6]}),
+                                                  new featkTet4Element({nodes[4], nodes[5], nodes[6], nodes[8]})};
+
+    featkMesh<3>* mesh = new featkMesh<3>(nodes, elements);
+
+    vector<shared_ptr<MatrixXd>> temperatures;
+    vector<shared_ptr<MatrixXd>> tensors;
+
+    for (size_t n=0; n!=nodes.size(); n++) {
+
+        temperatures.push_back(make_shared<MatrixXd>(MatrixXd::Constant(1, 1, 0.5*n)));
+    }
+
+    for (size_t e=0; e!=elements.size(); e++) {
+
+        tensors.push_back(make_shared<MatrixXd>(MatrixXd::Random(3, 3)));
+    }
+
+    mesh->setNodeAttributes("Temperature", 0, temperatures);
+    mesh->setElementAttributes("Diffusion Tensor", 2, tensors);
+
+    string fileName = "featkVTUWriterReaderRoundTripTest.vtu";
+    bool result = true;
+
+    for (bool compression : {false, true}) {
+
+        featkVTUWriter writer = featkVTUWriter();
+        writer.setInputMesh(mesh);
+        writer.setFileName(fileName);
+        writer.setUseCompression(compression);
+        writer.update();
+
+        featkVTUReader reader = featkVTUReader();
+        reader.setFileName(fileName);
+        reader.update();
+
+        featkMesh<3>* output = reader.getOutputMesh();
+
+        if (output == nullptr || output->getNumberOfNodes() != nodes.size() || output->getNumberOfElements() != elements.size()) {
+
+            result = false;
+            delete output;
+            continue;
+        }
+
+        size_t temperatureID = output->getNodeAttributeID("Temperature", 0);
+        size_t tensorID = output->getElementAttributeID("Diffusion Tensor", 2);
+
+        for (size_t n=0; n!=nodes.size(); n++) {
+
+            featkNode<3>* node = output->getNode(n);
+
+            if (!node->getCoordinates().isApprox(nodes[n]->getCoordinates(), EPS) || !node->getAttributeValue(temperatureID).isApprox(*temperatures[n], EPS)) {
+
+                result = false;
+            }
+        }
+
+        for (size_t e=0; e!=elements.size(); e++) {
+
+            featkElementInterface<3>* element = output->getElement(e);
+
+            if (element->getElementType() != elements[e]->getElementType() || !element->getAttributeValue(tensorID).isApprox(*tensors[e], EPS)) {
+
+                result = false;
+                continue;
+            }
+
+            for (unsigned int j=0; j!=(element->getElementType() == FEATK_TET4 ? 4 : 8); j++) {
+
+                if (element->getNode(j)->getID() != elements[e]->getNode(j)->getID()) {
+
+                    result = false;
+                }
+            }
+        }
+
+        delete output;
+    }
+
+    remove(fileName.c_str());
+    delete mesh;
+
+    return result;
+}
+
+bool featkXDMFTimeSeriesWriterTest() {
+
+    /**
+     * Two snapshots of an attribute whose name contains XML special characters, which must be escaped in the XDMF
+     * file, the raw binary file holding the topology, the geometry and both snapshots.
+     */
+
+    featkMesh<3>* mesh = getReactionDiffusionTestMesh();
+    string fileName = "featkXDMFTimeSeriesWriterTest.xdmf";
+    string name = "Density \"A\" <1> & B";
+
+    featkXDMFTimeSeriesWriter<3> writer;
+    writer.setInputMesh(mesh);
+    writer.setFileName(fileName);
+    bool result = writer.update();
+
+    VectorXd values = mesh->getNodeAttributeValues("Initial Cell Density", 0);
+    writer.write(name, 0.0, values);
+    writer.write(name, 1.0, 2.0*values);
+    writer.close();
+
+    ifstream stream(fileName);
+    string xdmf((istreambuf_iterator<char>(stream)), istreambuf_iterator<char>());
+    stream.close();
+
+    ifstream raw("featkXDMFTimeSeriesWriterTest.bin", ios::binary | ios::ate);
+    streamoff size = raw.tellg();
+    raw.close();
+
+    streamoff expectedSize = mesh->getNumberOfElements()*9*4 + mesh->getNumberOfNodes()*3*8 + 2*mesh->getNumberOfNodes()*8;
+
+    result = result && xdmf.find("Name=\"Density &quot;A&quot; &lt;1&gt; &amp; B\"") != string::npos && xdmf.find(name) == string::npos && size == expectedSize;
+
+    remove(fileName.c_str());
+    remove("featkXDMFTimeSeriesWriterTest.bin");
+    delete mesh;
+
+    return result;
+}
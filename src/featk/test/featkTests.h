@@ -5,9 +5,27 @@
 
 #define EPS 1.0E-4
 
+FEATK_EXPORT bool featkAdaptiveTimeStepTest();
+FEATK_EXPORT bool featkBinaryMeshWriterReaderRoundTripTest();
+FEATK_EXPORT bool featkBoundaryConditionsCompileTest();
+FEATK_EXPORT bool featkChebyshevIterationTest();
+FEATK_EXPORT bool featkCheckpointRestartTest();
+FEATK_EXPORT bool featkDeflatedConjugateGradientTest();
+FEATK_EXPORT bool featkElementMatrixCacheTest();
+FEATK_EXPORT bool featkGmshReaderTest();
 FEATK_EXPORT bool featkHex8StiffnessMatrixTest();
+FEATK_EXPORT bool featkMaskedGridSourceTest();
+FEATK_EXPORT bool featkMixedPrecisionSolverTest();
+FEATK_EXPORT bool featkNIfTIImageSamplerTest();
+FEATK_EXPORT bool featkPipelinedConjugateGradientTest();
+FEATK_EXPORT bool featkQuadraticReactionKernelTest();
 FEATK_EXPORT void featkRunAllTests();
+FEATK_EXPORT bool featkSteadyStateTest();
+FEATK_EXPORT bool featkStructuredGridAssemblyTest();
 FEATK_EXPORT bool featkTet4StiffnessMatrixTest();
 FEATK_EXPORT bool featkTet4LinearElasticitySolverTest();
+FEATK_EXPORT bool featkTimeIntegrationOrderTest();
+FEATK_EXPORT bool featkVTUWriterReaderRoundTripTest();
+FEATK_EXPORT bool featkXDMFTimeSeriesWriterTest();
 
 #endif // FEATKTESTS_H